@@ -0,0 +1 @@
+#include "../../../src/libs/data-staging/DTRJournal.h"
@@ -0,0 +1 @@
+#include "../../../src/hed/libs/message/PayloadGzip.h"
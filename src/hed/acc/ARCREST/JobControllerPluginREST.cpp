@@ -20,6 +20,7 @@
 
 #include "SubmitterPluginREST.h"
 #include "JobControllerPluginREST.h"
+#include "TarArchive.h"
 
 namespace Arc {
 
@@ -460,5 +461,42 @@ namespace Arc {
     return true;
   }
 
+  bool JobControllerPluginREST::RetrieveJobFiles(const Job& job, const URL& src, std::list<std::string>& files, const std::string& dstdir) const {
+    // Few files, possibly big ones, are transferred faster one by one
+    // using parallel streams. Archive pays off for many small files.
+    if (files.size() < 10) return false;
+    logger.msg(VERBOSE, "Retrieving %u files of job %s as archive", (unsigned int)files.size(), job.JobID);
+    Arc::URL archiveUrl(src);
+    archiveUrl.AddHTTPOption("archive","tar");
+    // Archive is compressed on the fly by service and decompressed by HTTP MCC
+    archiveUrl.AddOption("compression=gzip",false);
+    Arc::MCCConfig cfg;
+    usercfg->ApplyToConfig(cfg);
+    Arc::ClientHTTP client(cfg, archiveUrl, usercfg->Timeout());
+    Arc::PayloadRaw request;
+    Arc::PayloadStreamInterface* response(NULL);
+    Arc::HTTPClientInfo info;
+    Arc::MCC_Status res = client.process(Arc::ClientHTTPAttributes("GET"), &request, &info, &response);
+    if((!res) || (info.code != 200) || (response == NULL) || (info.type != "application/x-tar")) {
+      // Older service ignores archive option and returns directory listing
+      logger.msg(VERBOSE, "Failed retrieving archive of job files: %s", (!res) ? std::string(res) : Arc::tostring(info.code));
+      delete response;
+      return false;
+    }
+    std::set<std::string> selection(files.begin(), files.end());
+    std::set<std::string> extracted;
+    bool ok = TarExtract(*response, dstdir, selection, extracted);
+    delete response;
+    if(!ok) logger.msg(WARNING, "Failed to unpack archive of job files into %s", dstdir);
+    for(std::list<std::string>::iterator file = files.begin(); file != files.end();) {
+      if(extracted.find(*file) != extracted.end()) {
+        file = files.erase(file);
+      } else {
+        ++file;
+      }
+    }
+    return files.empty();
+  }
+
 } // namespace Arc
 
@@ -28,6 +28,7 @@ namespace Arc {
 
     virtual bool GetURLToJobResource(const Job& job, Job::ResourceType resource, URL& url) const;
     virtual bool GetJobDescription(const Job& job, std::string& desc_str) const;
+    virtual bool RetrieveJobFiles(const Job& job, const URL& src, std::list<std::string>& files, const std::string& dstdir) const;
 
     class InfoNodeProcessor {
      public:
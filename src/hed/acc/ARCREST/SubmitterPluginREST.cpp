@@ -23,6 +23,7 @@
 #include <arc/delegation/DelegationInterface.h>
 
 #include "SubmitterPluginREST.h"
+#include "TarArchive.h"
 //#include "AREXClient.h"
 
 namespace Arc {
@@ -153,6 +154,46 @@ namespace Arc {
     return true;
   }
 
+  bool SubmitterPluginREST::PutFilesArchive(const JobDescription& job, const URL& url) const {
+    // Few files, possibly big ones, are transferred faster one by one
+    // using parallel streams. Archive pays off for many small files.
+    TarFileStream archive;
+    unsigned int files = 0;
+    for (std::list<InputFileType>::const_iterator it = job.DataStaging.InputFiles.begin();
+         it != job.DataStaging.InputFiles.end(); ++it) {
+      if (it->Sources.empty()) continue;
+      const URL& src = it->Sources.front();
+      if (src.Protocol() != "file") continue;
+      // Anything except plain file is left for generic upload
+      if (!archive.Add(it->Name, src.Path())) return false;
+      ++files;
+    }
+    if (files < 10) return false;
+    logger.msg(VERBOSE, "Uploading %u input files as archive", files);
+    Arc::URL archiveUrl(url);
+    archiveUrl.AddHTTPOption("archive","tar");
+    Arc::MCCConfig cfg;
+    usercfg->ApplyToConfig(cfg);
+    Arc::ClientHTTP client(cfg, archiveUrl, usercfg->Timeout());
+    Arc::PayloadRawInterface* response(NULL);
+    Arc::HTTPClientInfo info;
+    Arc::MCC_Status res = client.process(Arc::ClientHTTPAttributes("PUT"), &archive, &info, &response);
+    delete response;
+    if (!archive) {
+      // Upload was aborted. Files which service received completely are
+      // already accepted. The rest is retried by generic upload which
+      // reports the problem with the input file.
+      logger.msg(WARNING, "Failed uploading archive of input files: %s", archive.Failure());
+      return false;
+    }
+    if ((!res) || (info.code != 200)) {
+      // Older service does not accept archives
+      logger.msg(VERBOSE, "Failed uploading archive of input files: %s", (!res) ? std::string(res) : Arc::tostring(info.code));
+      return false;
+    }
+    return true;
+  }
+
   SubmissionStatus SubmitterPluginREST::SubmitInternal(const std::list<JobDescription>& jobdescs,
                                            const ExecutionTarget* et, const std::string& endpoint,
                          EntityConsumer<Job>& jc, std::list<const JobDescription*>& notSubmitted) {
@@ -285,7 +326,7 @@ namespace Arc {
       // compensate for time between request and response on slow networks
       sessionUrl.AddOption("encryption=optional",false);
       // TODO: implement multi job PutFiles or run multiple in parallel
-      if (!PutFiles(it->first, sessionUrl)) {
+      if (!PutFilesArchive(it->first, sessionUrl) && !PutFiles(it->first, sessionUrl)) {
         logger.msg(INFO, "Failed uploading local input files");
         notSubmitted.push_back(&(*(it->second)));
         retval |= SubmissionStatus::DESCRIPTION_NOT_SUBMITTED;
@@ -35,6 +35,7 @@ namespace Arc {
 
   private:
     bool AddDelegation(std::string& product, std::string const& delegationId);
+    bool PutFilesArchive(const JobDescription& job, const URL& url) const;
     SubmissionStatus SubmitInternal(const std::list<JobDescription>& jobdescs, const ExecutionTarget* et, const std::string& endpoint,
                          EntityConsumer<Job>& jc, std::list<const JobDescription*>& notSubmitted);
 
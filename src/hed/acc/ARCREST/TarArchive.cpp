@@ -0,0 +1,101 @@
+// -*- indent-tabs-mode: nil -*-
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <vector>
+
+#include <arc/FileUtils.h>
+
+#include "TarArchive.h"
+
+namespace Arc {
+
+  // Accepts only relative paths which stay inside destination
+  static bool tar_safe_name(std::string& name) {
+    while (name.compare(0, 2, "./") == 0) name.erase(0, 2);
+    while (!name.empty() && (name[name.length()-1] == '/')) name.resize(name.length()-1);
+    if (name.empty() || (name[0] == '/')) return false;
+    std::string::size_type start = 0;
+    for (;;) {
+      std::string::size_type end = name.find('/', start);
+      std::string item = name.substr(start, (end == std::string::npos) ? std::string::npos : (end - start));
+      if (item.empty() || (item == "..")) return false;
+      if (end == std::string::npos) break;
+      start = end + 1;
+    }
+    return true;
+  }
+
+  static bool tar_write(int h, const char* buf, unsigned long long int size) {
+    while (size > 0) {
+      ssize_t l = ::write(h, buf, size);
+      if (l < 0) {
+        if (errno == EINTR) continue;
+        return false;
+      }
+      buf += l;
+      size -= l;
+    }
+    return true;
+  }
+
+  TarFileStream::TarFileStream() {
+  }
+
+  TarFileStream::~TarFileStream() {
+  }
+
+  bool TarFileStream::Add(const std::string& name, const std::string& path) {
+    Entry entry;
+    entry.name = name;
+    if (!tar_safe_name(entry.name)) return false;
+    struct stat st;
+    if ((::stat(path.c_str(), &st) != 0) || !S_ISREG(st.st_mode)) return false;
+    entry.path = path;
+    entry.size = st.st_size;
+    entry.mode = st.st_mode;
+    entry.mtime = st.st_mtime;
+    return PayloadTarStream::Add(entry);
+  }
+
+  bool TarExtract(PayloadStreamInterface& stream, const std::string& dstdir,
+                  const std::set<std::string>& selection, std::set<std::string>& extracted) {
+    std::vector<char> buf(65536);
+    TarReader archive(stream);
+    PayloadTarStream::Entry entry;
+    while (archive.Next(entry)) {
+      // Directories are created together with files
+      if (entry.dir) continue;
+      std::string name = entry.name;
+      if (!tar_safe_name(name)) return false;
+      if (!selection.empty() && (selection.find(name) == selection.end())) continue;
+      std::string path = dstdir + "/" + name;
+      std::string::size_type pos = path.rfind('/');
+      if (!DirCreate(path.substr(0, pos), S_IRWXU, true)) return false;
+      ::unlink(path.c_str());
+      int h = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW, (entry.mode & 0777) | S_IRUSR | S_IWUSR);
+      if (h == -1) return false;
+      bool written = true;
+      for (;;) {
+        int l = buf.size();
+        if (!archive.Read(&buf[0], l)) break;
+        if (!tar_write(h, &buf[0], l)) { written = false; break; }
+      }
+      if ((::close(h) != 0) || !written || archive.Failed()) {
+        ::unlink(path.c_str());
+        return false;
+      }
+      extracted.insert(name);
+    }
+    return !archive.Failed();
+  }
+
+} // namespace Arc
@@ -0,0 +1,42 @@
+// -*- indent-tabs-mode: nil -*-
+
+#ifndef __ARC_TARARCHIVE_H__
+#define __ARC_TARARCHIVE_H__
+
+#include <set>
+#include <string>
+
+#include <arc/message/PayloadTar.h>
+
+namespace Arc {
+
+  /// Stream producing tar archive of local files.
+  /**
+   * Archive is generated while being read, see PayloadTarStream. Input
+   * which can't be read makes stream invalid, so upload of archive is
+   * aborted instead of delivering broken content.
+   **/
+  class TarFileStream : public PayloadTarStream {
+  public:
+    TarFileStream();
+    virtual ~TarFileStream();
+    /// Adds regular file at local path to archive under specified name.
+    /// Returns false if path is not a regular file or name is not acceptable.
+    bool Add(const std::string& name, const std::string& path);
+  };
+
+  /// Unpacks tar archive read from stream into local directory.
+  /**
+   * Only regular files and directories are created. Archive containing
+   * absolute paths or paths leading outside of \a dstdir is refused. If
+   * \a selection is not empty only files listed in it are stored. Paths
+   * of stored files are added to \a extracted. File which could not be
+   * written completely is removed.
+   * \return false if archive is broken or file could not be written.
+   **/
+  bool TarExtract(PayloadStreamInterface& stream, const std::string& dstdir,
+                  const std::set<std::string>& selection, std::set<std::string>& extracted);
+
+} // namespace Arc
+
+#endif // __ARC_TARARCHIVE_H__
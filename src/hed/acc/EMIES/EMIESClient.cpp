@@ -1515,8 +1515,6 @@ namespace Arc {
 
 // -----------------------------------------------------------------------------
 
-  // TODO: does it need locking?
-
   EMIESClients::EMIESClients(const UserConfig& usercfg):usercfg_(&usercfg) {
   }
 
@@ -1530,18 +1528,23 @@ namespace Arc {
   }
 
   EMIESClient* EMIESClients::acquire(const URL& url) {
-    std::multimap<URL, EMIESClient*>::iterator it = clients_.find(url);
-    if ( it != clients_.end() ) {
-      // If EMIESClient is already existing for the
-      // given URL then return with that
-      EMIESClient* client = it->second;
-      clients_.erase(it);
-      return client;
+    const UserConfig* usercfg = NULL;
+    {
+      Glib::Mutex::Lock lock(lock_);
+      std::multimap<URL, EMIESClient*>::iterator it = clients_.find(url);
+      if ( it != clients_.end() ) {
+        // If EMIESClient is already existing for the
+        // given URL then return with that
+        EMIESClient* client = it->second;
+        clients_.erase(it);
+        return client;
+      }
+      usercfg = usercfg_;
     }
     // Else create a new one and return with that
     MCCConfig cfg;
-    if(usercfg_) usercfg_->ApplyToConfig(cfg);
-    EMIESClient* client = new EMIESClient(url, cfg, usercfg_?usercfg_->Timeout():0);
+    if(usercfg) usercfg->ApplyToConfig(cfg);
+    EMIESClient* client = new EMIESClient(url, cfg, usercfg?usercfg->Timeout():0);
     return client;
   }
 
@@ -1552,12 +1555,14 @@ namespace Arc {
       return;
     }
     // TODO: maybe strip path from URL?
+    Glib::Mutex::Lock lock(lock_);
     clients_.insert(std::pair<URL, EMIESClient*>(client->url(),client));
   }
 
   void EMIESClients::SetUserConfig(const UserConfig& uc) {
     // Changing user configuration may change identity.
     // Hence all open connections become invalid.
+    Glib::Mutex::Lock lock(lock_);
     usercfg_ = &uc;
     while(true) {
       std::multimap<URL, EMIESClient*>::iterator it = clients_.begin();
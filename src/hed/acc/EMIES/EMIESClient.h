@@ -8,6 +8,7 @@
 #include <arc/URL.h>
 #include <arc/XMLNode.h>
 #include <arc/DateTime.h>
+#include <arc/Thread.h>
 #include <arc/message/MCC.h>
 #include <arc/UserConfig.h>
 #include <arc/message/SOAPEnvelope.h>
@@ -344,9 +345,11 @@ namespace Arc {
     static Logger logger;
   };
 
+  // Pool of connected clients. Safe to be used from several threads.
   class EMIESClients {
     std::multimap<URL, EMIESClient*> clients_;
     const UserConfig* usercfg_;
+    Glib::Mutex lock_;
   public:
     EMIESClients(const UserConfig& usercfg);
     ~EMIESClients(void);
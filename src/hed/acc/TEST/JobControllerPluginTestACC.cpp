@@ -4,6 +4,8 @@
 #include <config.h>
 #endif
 
+#include <glibmm/timer.h>
+
 #include "JobControllerPluginTestACC.h"
 
 namespace Arc {
@@ -17,6 +19,9 @@ namespace Arc {
   }
 
   void JobControllerPluginTestACC::UpdateJobs(std::list<Job*>& jobs, std::list<std::string>& IDsProcessed, std::list<std::string>& IDsNotProcessed, bool isGrouped) const {
+    if (JobControllerPluginTestACCControl::updateDelay > 0) {
+      Glib::usleep(JobControllerPluginTestACCControl::updateDelay*1000);
+    }
     for (std::list<Job*>::const_iterator it = jobs.begin(); it != jobs.end(); ++it) {
       IDsProcessed.push_back((*it)->JobID);
     }
@@ -34,6 +39,9 @@ namespace Arc {
   }
   
   bool JobControllerPluginTestACC::CancelJobs(const std::list<Job*>& jobs, std::list<std::string>& IDsProcessed, std::list<std::string>& IDsNotProcessed, bool isGrouped) const {
+    if (JobControllerPluginTestACCControl::cancelDelay > 0) {
+      Glib::usleep(JobControllerPluginTestACCControl::cancelDelay*1000);
+    }
     for (std::list<Job*>::const_iterator it = jobs.begin(); it != jobs.end(); ++it) {
       if (JobControllerPluginTestACCControl::cancelStatus) {
         IDsProcessed.push_back((*it)->JobID);
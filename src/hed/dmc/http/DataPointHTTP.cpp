@@ -21,6 +21,7 @@
 #include <arc/Utils.h>
 
 #include "StreamBuffer.h"
+#include "StreamControl.h"
 #include "DataPointHTTP.h"
 
 namespace ArcDMCHTTP {
@@ -273,7 +274,9 @@ using namespace Arc;
       reading(false),
       writing(false),
       chunks(NULL),
+      streams(NULL),
       transfers_tofinish(0),
+      transfers_retiring(0),
       partial_read_allowed(url.Option("httpgetpartial") == "yes"),
       partial_write_allowed(url.Option("httpputpartial") == "yes") {
   }
@@ -282,6 +285,7 @@ using namespace Arc;
     StopReading();
     StopWriting();
     if (chunks) delete chunks;
+    if (streams) delete streams;
     for(std::multimap<std::string,ClientHTTP*>::iterator cl = clients.begin(); cl != clients.end(); ++cl) {
       delete cl->second;
     };
@@ -855,25 +859,93 @@ using namespace Arc;
     return DataStatus::Success;
   }
 
+  int DataPointHTTP::BufNum() const {
+    // Adaptive transfer needs buffers for biggest allowed number of streams
+    if (url.Option("threads").empty() &&
+        (partial_write_allowed || (partial_read_allowed && allow_out_of_order))) {
+      unsigned int initial = 1;
+      unsigned int limit = 1;
+      HostStreams::Get(url.Host(), initial, limit);
+      return limit;
+    }
+    return DataPointDirect::BufNum();
+  }
+
+  int DataPointHTTP::start_streams(bool partial_allowed) {
+    if (streams) delete streams;
+    streams = NULL;
+    int transfer_streams = 1;
+    // Number of streams explicitly requested in URL is used as is
+    if (!partial_allowed || !url.Option("threads").empty()) {
+      strtoint(url.Option("threads"),transfer_streams);
+      if (transfer_streams < 1) transfer_streams = 1;
+      if (transfer_streams > MAX_PARALLEL_STREAMS) transfer_streams = MAX_PARALLEL_STREAMS;
+      return transfer_streams;
+    }
+    unsigned int initial = 1;
+    unsigned int limit = 1;
+    streams_host = url.Host();
+    HostStreams::Get(streams_host, initial, limit);
+    streams = new StreamControl(initial, limit);
+    logger.msg(VERBOSE, "Starting transfer with %u streams, up to %u", streams->Target(), limit);
+    return streams->Target();
+  }
+
+  bool DataPointHTTP::adjust_streams(void (*thread)(void*), bool& retiring) {
+    if (!streams) return true;
+    int target = streams->Target();
+    int running = transfers_tofinish - transfers_retiring;
+    if (running > target) {
+      // Target is at least 1 so remaining streams finish transfer
+      ++transfers_retiring;
+      retiring = true;
+      logger.msg(DEBUG, "Reducing number of streams to %i", running - 1);
+      return false;
+    }
+    for (; running < target; ++running) {
+      if (!HostStreams::Acquire(streams_host, false)) break;
+      HTTPInfo_t *info = new HTTPInfo_t;
+      info->point = this;
+      if (!CreateThreadFunction(thread, info, &transfers_started)) {
+        delete info;
+        HostStreams::Release(streams_host);
+        break;
+      }
+      ++transfers_tofinish;
+      logger.msg(DEBUG, "Increasing number of streams to %i", running + 1);
+    }
+    return true;
+  }
+
+  void DataPointHTTP::stop_streams() {
+    if (!streams) return;
+    logger.msg(VERBOSE, "Transfer used up to %u streams, best throughput with %u streams",
+               streams->MaxTarget(), streams->BestTarget());
+    // Next transfer to same host starts with best number of streams
+    HostStreams::Learn(streams_host, streams->BestTarget());
+    delete streams;
+    streams = NULL;
+  }
+
   DataStatus DataPointHTTP::StartReading(DataBuffer& buffer) {
     if (reading) return DataStatus::IsReadingError;
     if (writing) return DataStatus::IsWritingError;
     if (transfers_started.get() != 0) return DataStatus(DataStatus::IsReadingError, EARCLOGIC);
     reading = true;
-    int transfer_streams = 1;
-    strtoint(url.Option("threads"),transfer_streams);
-    if (transfer_streams < 1) transfer_streams = 1;
-    if (transfer_streams > MAX_PARALLEL_STREAMS) transfer_streams = MAX_PARALLEL_STREAMS;
+    int transfer_streams = start_streams(partial_read_allowed && allow_out_of_order);
     DataPointHTTP::buffer = &buffer;
     if (chunks) delete chunks;
     chunks = new ChunkControl;
     transfer_lock.lock();
     transfers_tofinish = 0;
+    transfers_retiring = 0;
     for (int n = 0; n < transfer_streams; ++n) {
+      if (streams && !HostStreams::Acquire(streams_host, n == 0)) break;
       HTTPInfo_t *info = new HTTPInfo_t;
       info->point = this;
       if (!CreateThreadFunction(&read_thread, info, &transfers_started)) {
         delete info;
+        if (streams) HostStreams::Release(streams_host);
       } else {
         ++transfers_tofinish;
       }
@@ -895,6 +967,7 @@ using namespace Arc;
     while (transfers_started.get()) {
       transfers_started.wait(10000); // Just in case
     }
+    stop_streams();
     if (chunks) delete chunks;
     chunks = NULL;
     transfers_tofinish = 0;
@@ -912,20 +985,20 @@ using namespace Arc;
     if (writing) return DataStatus::IsWritingError;
     if (transfers_started.get() != 0) return DataStatus(DataStatus::IsWritingError, EARCLOGIC);
     writing = true;
-    int transfer_streams = 1;
-    strtoint(url.Option("threads"),transfer_streams);
-    if (transfer_streams < 1) transfer_streams = 1;
-    if (transfer_streams > MAX_PARALLEL_STREAMS) transfer_streams = MAX_PARALLEL_STREAMS;
+    int transfer_streams = start_streams(partial_write_allowed);
     DataPointHTTP::buffer = &buffer;
     if (chunks) delete chunks;
     chunks = new ChunkControl;
     transfer_lock.lock();
     transfers_tofinish = 0;
+    transfers_retiring = 0;
     for (int n = 0; n < transfer_streams; ++n) {
+      if (streams && !HostStreams::Acquire(streams_host, n == 0)) break;
       HTTPInfo_t *info = new HTTPInfo_t;
       info->point = this;
       if (!CreateThreadFunction(&write_thread, info, &transfers_started)) {
         delete info;
+        if (streams) HostStreams::Release(streams_host);
       } else {
         ++transfers_tofinish;
       }
@@ -947,6 +1020,7 @@ using namespace Arc;
     while (transfers_started.get()) {
       transfers_started.wait(); // Just in case
     }
+    stop_streams();
     if (chunks) {
       delete chunks;
     }
@@ -1195,7 +1269,12 @@ using namespace Arc;
     std::string path = point.CurrentLocation().FullPathURIEncoded();
     DataStatus failure_code;
     bool partial_allowed = point.partial_read_allowed && point.allow_out_of_order;
+    bool retiring = false;
     if(partial_allowed) for (;;) {
+      point.transfer_lock.lock();
+      bool keep = point.adjust_streams(&read_thread, retiring);
+      point.transfer_lock.unlock();
+      if (!keep) break;
       if(client && client->GetClosed()) client = point.acquire_client(client_url);
       if (!client) {
         transfer_failure = true;
@@ -1221,6 +1300,8 @@ using namespace Arc;
       HTTPClientInfo transfer_info;
       PayloadRaw request;
       PayloadRawInterface *inbuf = NULL;
+      Glib::TimeVal transfer_start;
+      transfer_start.assign_current_time();
       MCC_Status r = client->process("GET", path, transfer_offset,
                                      transfer_end, &request, &transfer_info,
                                      &inbuf);
@@ -1289,6 +1370,8 @@ using namespace Arc;
         transfer_failure = true;
         break;
       }
+      Glib::TimeVal transfer_response;
+      transfer_response.assign_current_time();
       PayloadStreamInterface* instream = NULL;
       try {
         instream = dynamic_cast<PayloadStreamInterface*>(dynamic_cast<MessagePayload*>(inbuf));
@@ -1310,19 +1393,19 @@ using namespace Arc;
       bool whole = (inbuf && (((transfer_info.size == inbuf->Size() &&
                                (inbuf->BufferPos(0) == 0))) ||
                     inbuf->Size() == -1));
-      point.transfer_lock.lock();
-      point.chunks->Unclaim(transfer_offset, chunk_length);
+      // Body is read without holding transfer_lock so that streams
+      // really proceed in parallel. Requested chunk stays claimed while
+      // being read and only part not delivered is returned afterwards.
+      uint64_t transfer_first = instream->Pos();
       uint64_t transfer_pos = 0;
+      uint64_t transfer_bytes = 0;
       for(;;) {
         if (transfer_handle == -1) {
-          point.transfer_lock.unlock();
           if (!point.buffer->for_read(transfer_handle, transfer_size, true)) {
             // No transfer buffer - must be failure or close initiated
             // externally
-            point.transfer_lock.lock();
             break;
           }
-          point.transfer_lock.lock();
         }
         int l = transfer_size;
         uint64_t pos = instream->Pos();
@@ -1333,16 +1416,37 @@ using namespace Arc;
         point.chunks->Claim(pos, l);
         transfer_handle = -1;
         transfer_pos = pos + l;
+        transfer_bytes += l;
       }
       if (transfer_handle != -1) point.buffer->is_read(transfer_handle, 0, 0);
+      uint64_t chunk_end = transfer_offset + chunk_length;
+      if(inbuf && (inbuf->Size() > 0) && ((uint64_t)(inbuf->Size()) < chunk_end)) chunk_end = inbuf->Size();
+      if (chunk_end < transfer_offset) chunk_end = transfer_offset;
+      if (transfer_pos <= transfer_first) {
+        point.chunks->Unclaim(transfer_offset, chunk_length);
+      } else {
+        if (transfer_first > transfer_offset)
+          point.chunks->Unclaim(transfer_offset, ((transfer_first < chunk_end) ? transfer_first : chunk_end) - transfer_offset);
+        if (transfer_pos < chunk_end) {
+          uint64_t missing = (transfer_pos > transfer_offset) ? transfer_pos : transfer_offset;
+          point.chunks->Unclaim(missing, chunk_end - missing);
+        }
+      }
       if (inbuf) delete inbuf;
+      if (point.streams) {
+        Glib::TimeVal transfer_done;
+        transfer_done.assign_current_time();
+        point.streams->Report(transfer_bytes, (transfer_done - transfer_start).as_double(),
+                              (transfer_response - transfer_start).as_double());
+      }
       // If server returned chunk which is not overlaping requested one - seems
       // like server has nothing to say any more.
       if (transfer_pos <= transfer_offset) whole = true;
-      point.transfer_lock.unlock();
       if (whole) break;
     }
     point.transfer_lock.lock();
+    if (retiring) --(point.transfers_retiring);
+    if (point.streams) HostStreams::Release(point.streams_host);
     --(point.transfers_tofinish);
     if (transfer_failure) {
       point.failure_code = failure_code;
@@ -1487,8 +1591,13 @@ using namespace Arc;
     std::string path = client_url.FullPathURIEncoded();
     bool partial_failure = !point.partial_write_allowed;
     DataStatus failure_code;
+    bool retiring = false;
     // Fall through if partial PUT is not allowed
     if(!partial_failure) for (;;) {
+      point.transfer_lock.lock();
+      bool keep = point.adjust_streams(&write_thread, retiring);
+      point.transfer_lock.unlock();
+      if (!keep) break;
       if(client && client->GetClosed()) client = point.acquire_client(client_url);
       if (!client) {
         transfer_failure = true;
@@ -1510,6 +1619,8 @@ using namespace Arc;
                               transfer_offset, transfer_size,
                               point.CheckSize() ? point.GetSize() : 0);
       PayloadRawInterface *response = NULL;
+      Glib::TimeVal transfer_start;
+      transfer_start.assign_current_time();
       MCC_Status r = client->process("PUT", path, &request, &transfer_info,
                                      &response);
       if (response) delete response;
@@ -1551,8 +1662,16 @@ using namespace Arc;
       }
       retries = 0;
       point.buffer->is_written(transfer_handle);
+      if (point.streams) {
+        // Response to PUT comes after body, so latency can't be separated
+        Glib::TimeVal transfer_done;
+        transfer_done.assign_current_time();
+        point.streams->Report(transfer_size, (transfer_done - transfer_start).as_double(), 0);
+      }
     }
     point.transfer_lock.lock();
+    if (retiring) --(point.transfers_retiring);
+    if (point.streams) HostStreams::Release(point.streams_host);
     --(point.transfers_tofinish);
     if (transfer_failure) {
       point.failure_code = failure_code;
@@ -12,6 +12,7 @@ namespace ArcDMCHTTP {
 using namespace Arc;
 
   class ChunkControl;
+  class StreamControl;
 
   /**
    * This class allows access through HTTP to remote resources. HTTP over SSL
@@ -41,11 +42,17 @@ using namespace Arc;
     virtual bool ProvidesMeta() const;
     virtual bool RequiresCredentials() const { return ((url.Protocol() != "http")&&(url.Protocol() != "dav")); };
     virtual bool WriteOutOfOrder() const { return partial_write_allowed; };
+    virtual int BufNum() const;
   private:
     static void read_thread(void *arg);
     static bool read_single(void *arg);
     static void write_thread(void *arg);
     static bool write_single(void *arg);
+    /// Prepares adaptive control of streams unless number of streams is fixed
+    int start_streams(bool partial_allowed);
+    /// Starts or retires threads to follow wanted number of streams
+    bool adjust_streams(void (*thread)(void*), bool& retiring);
+    void stop_streams();
     DataStatus do_stat_http(URL& curl, FileInfo& file);
     DataStatus do_stat_webdav(URL& curl, FileInfo& file);
     DataStatus do_list_webdav(URL& rurl, std::list<FileInfo>& files, DataPointInfoType verb);
@@ -62,9 +69,12 @@ using namespace Arc;
     bool reading;
     bool writing;
     ChunkControl *chunks;
+    StreamControl *streams;
+    std::string streams_host;
     std::multimap<std::string,ClientHTTP*> clients;
     SimpleCounter transfers_started;
     int transfers_tofinish;
+    int transfers_retiring;
     Glib::Mutex transfer_lock;
     Glib::Mutex clients_lock;
     bool partial_read_allowed;
@@ -0,0 +1,199 @@
+// -*- indent-tabs-mode: nil -*-
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <list>
+
+#include <arc/Logger.h>
+#include <arc/StringConv.h>
+#include <arc/Utils.h>
+#include <arc/data/DataPointDirect.h>
+
+#include "StreamControl.h"
+
+namespace ArcDMCHTTP {
+
+using namespace Arc;
+
+  // Minimal time throughput is measured over before decision is made
+  static const double stream_window = 1.0;
+  // Relative throughput gain needed to keep adding streams
+  static const double stream_gain = 1.1;
+  // Relative throughput drop making transfer reduce streams
+  static const double stream_drop = 0.5;
+  // Number of stable measurements before probing for more streams again
+  static const unsigned int stream_reprobe = 10;
+  // Default limit of streams per host
+  static const unsigned int stream_limit = 8;
+
+  StreamControl::StreamControl(unsigned int initial, unsigned int limit)
+    : target_(initial), limit_(limit), max_target_(initial), best_target_(initial),
+      best_rate_(0), probing_(true), stable_(0),
+      window_bytes_(0), window_busy_(0), window_latency_(0), window_chunks_(0) {
+    if (limit_ < 1) limit_ = 1;
+    if (target_ < 1) target_ = 1;
+    if (target_ > limit_) target_ = limit_;
+    max_target_ = best_target_ = target_;
+    window_start_.assign_current_time();
+  }
+
+  StreamControl::~StreamControl() {}
+
+  void StreamControl::Report(uint64_t bytes, double elapsed, double latency) {
+    Glib::TimeVal now;
+    now.assign_current_time();
+    Report(bytes, elapsed, latency, now);
+  }
+
+  void StreamControl::Report(uint64_t bytes, double elapsed, double latency, const Glib::TimeVal& now) {
+    Glib::Mutex::Lock lock(lock_);
+    window_bytes_ += bytes;
+    window_busy_ += elapsed;
+    window_latency_ += latency;
+    ++window_chunks_;
+    double duration = (now - window_start_).as_double();
+    // Every stream should contribute to measurement
+    if ((duration < stream_window) || (window_chunks_ < target_)) return;
+    double rate = ((double)window_bytes_) / duration;
+    bool high_latency = (window_busy_ > 0) && ((window_latency_ / window_busy_) > 0.5);
+    window_start_ = now;
+    window_bytes_ = 0;
+    window_busy_ = 0;
+    window_latency_ = 0;
+    window_chunks_ = 0;
+    if (rate > best_rate_ * stream_gain) {
+      best_rate_ = rate;
+      best_target_ = target_;
+      if (!probing_) return;
+    } else if (probing_) {
+      // Last increase did not help
+      probing_ = false;
+      stable_ = 0;
+      target_ = best_target_;
+      return;
+    } else if (rate < best_rate_ * stream_drop) {
+      // Conditions changed - fewer streams may be better now
+      if (target_ > 1) --target_;
+      best_target_ = target_;
+      best_rate_ = rate;
+      stable_ = 0;
+      return;
+    } else if (++stable_ < stream_reprobe) {
+      return;
+    } else {
+      // Check if more streams help now
+      best_rate_ = rate;
+      best_target_ = target_;
+      probing_ = true;
+      stable_ = 0;
+    }
+    if (target_ >= limit_) {
+      probing_ = false;
+      return;
+    }
+    target_ = high_latency ? (target_ * 2) : (target_ + 1);
+    if (target_ > limit_) target_ = limit_;
+    if (target_ > max_target_) max_target_ = target_;
+  }
+
+  unsigned int StreamControl::Target() {
+    Glib::Mutex::Lock lock(lock_);
+    return target_;
+  }
+
+  unsigned int StreamControl::MaxTarget() {
+    Glib::Mutex::Lock lock(lock_);
+    return max_target_;
+  }
+
+  unsigned int StreamControl::BestTarget() {
+    Glib::Mutex::Lock lock(lock_);
+    return best_target_;
+  }
+
+  Glib::Mutex HostStreams::lock_;
+  std::map<std::string,HostStreams::host_t> HostStreams::hosts_;
+  bool HostStreams::configured_ = false;
+
+  void HostStreams::Parse(const std::string& config_str) {
+    // Streams of running transfers are still counted after reconfiguration
+    std::map<std::string,host_t> old_hosts;
+    old_hosts.swap(hosts_);
+    host_t defaults = { 1, stream_limit, 0 };
+    hosts_["*"] = defaults;
+    std::list<std::string> items;
+    tokenize(config_str, items, " ,");
+    for (std::list<std::string>::iterator item = items.begin(); item != items.end(); ++item) {
+      std::string::size_type eq = item->find('=');
+      std::string::size_type colon = item->find(':', eq);
+      host_t config = { 1, stream_limit, 0 };
+      if ((eq == std::string::npos) || (colon == std::string::npos) ||
+          !stringto(item->substr(eq+1, colon-eq-1), config.initial) ||
+          !stringto(item->substr(colon+1), config.limit)) {
+        Logger::getRootLogger().msg(WARNING, "Ignoring wrong stream configuration %s", *item);
+        continue;
+      }
+      if (config.limit < 1) config.limit = 1;
+      if (config.limit > MAX_PARALLEL_STREAMS) config.limit = MAX_PARALLEL_STREAMS;
+      if (config.initial < 1) config.initial = 1;
+      if (config.initial > config.limit) config.initial = config.limit;
+      hosts_[item->substr(0, eq)] = config;
+    }
+    for (std::map<std::string,host_t>::iterator h = old_hosts.begin(); h != old_hosts.end(); ++h) {
+      if (h->second.active == 0) continue;
+      std::map<std::string,host_t>::iterator c = hosts_.find(h->first);
+      if (c == hosts_.end()) {
+        c = hosts_.insert(std::make_pair(h->first, hosts_["*"])).first;
+      }
+      c->second.active = h->second.active;
+    }
+    configured_ = true;
+  }
+
+  void HostStreams::Configure(const std::string& config) {
+    Glib::Mutex::Lock lock(lock_);
+    Parse(config);
+  }
+
+  HostStreams::host_t& HostStreams::Host(const std::string& host) {
+    if (!configured_) Parse(GetEnv("ARC_HTTP_STREAMS"));
+    std::map<std::string,host_t>::iterator h = hosts_.find(host);
+    if (h != hosts_.end()) return h->second;
+    host_t& config = hosts_[host];
+    config = hosts_["*"];
+    config.active = 0;
+    return config;
+  }
+
+  void HostStreams::Get(const std::string& host, unsigned int& initial, unsigned int& limit) {
+    Glib::Mutex::Lock lock(lock_);
+    host_t& config = Host(host);
+    initial = config.initial;
+    limit = config.limit;
+  }
+
+  void HostStreams::Learn(const std::string& host, unsigned int streams) {
+    Glib::Mutex::Lock lock(lock_);
+    host_t& config = Host(host);
+    if (streams < 1) streams = 1;
+    if (streams > config.limit) streams = config.limit;
+    config.initial = streams;
+  }
+
+  bool HostStreams::Acquire(const std::string& host, bool force) {
+    Glib::Mutex::Lock lock(lock_);
+    host_t& config = Host(host);
+    if ((!force) && (config.active >= config.limit)) return false;
+    ++config.active;
+    return true;
+  }
+
+  void HostStreams::Release(const std::string& host) {
+    Glib::Mutex::Lock lock(lock_);
+    host_t& config = Host(host);
+    if (config.active > 0) --config.active;
+  }
+
+} // namespace ArcDMCHTTP
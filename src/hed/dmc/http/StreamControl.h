@@ -0,0 +1,86 @@
+// -*- indent-tabs-mode: nil -*-
+
+#ifndef __ARCDMCHTTP_STREAMCONTROL_H__
+#define __ARCDMCHTTP_STREAMCONTROL_H__
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+#include <glibmm/thread.h>
+#include <glibmm/timeval.h>
+
+namespace ArcDMCHTTP {
+
+  // Decides how many parallel streams a transfer should use. Streams
+  // report every transferred chunk and number of streams is increased
+  // as long as it improves measured throughput. If most of time is spent
+  // waiting for responses (high latency) number of streams is doubled,
+  // otherwise it grows by one. Once throughput stops improving transfer
+  // returns to best known number of streams and later probes again.
+  class StreamControl {
+  private:
+    Glib::Mutex lock_;
+    unsigned int target_;
+    unsigned int limit_;
+    unsigned int max_target_;
+    unsigned int best_target_;
+    double best_rate_;
+    bool probing_;
+    unsigned int stable_;
+    Glib::TimeVal window_start_;
+    uint64_t window_bytes_;
+    double window_busy_;
+    double window_latency_;
+    unsigned int window_chunks_;
+  public:
+    StreamControl(unsigned int initial, unsigned int limit);
+    ~StreamControl();
+    // Report chunk transferred by one of streams. 'elapsed' is time
+    // spent on transfer and 'latency' part of it spent waiting for
+    // response to request.
+    void Report(uint64_t bytes, double elapsed, double latency);
+    // Same as above with explicitly specified current time
+    void Report(uint64_t bytes, double elapsed, double latency, const Glib::TimeVal& now);
+    // Number of streams transfer should use now
+    unsigned int Target();
+    // Biggest number of streams used during transfer
+    unsigned int MaxTarget();
+    // Number of streams which gave best throughput
+    unsigned int BestTarget();
+  };
+
+  // Streams of all transfers to same host within process. Initial number
+  // of streams for new transfer is learned from previous transfers in same
+  // process and limit applies to transfers of that process only. Site
+  // may set initial number and limit for total number of streams per host
+  // through ARC_HTTP_STREAMS environment variable as list of
+  // host=initial:limit separated by spaces. Host * applies to any host.
+  class HostStreams {
+  private:
+    typedef struct {
+      unsigned int initial;
+      unsigned int limit;
+      unsigned int active;
+    } host_t;
+    static Glib::Mutex lock_;
+    static std::map<std::string,host_t> hosts_;
+    static bool configured_;
+    static host_t& Host(const std::string& host);
+    static void Parse(const std::string& config);
+  public:
+    // Replaces configuration taken from ARC_HTTP_STREAMS and forgets
+    // everything learned so far. Streams already taken are kept.
+    static void Configure(const std::string& config);
+    static void Get(const std::string& host, unsigned int& initial, unsigned int& limit);
+    static void Learn(const std::string& host, unsigned int streams);
+    // Takes stream slot of host. Forced slot is given even above limit,
+    // so every transfer can have at least one stream.
+    static bool Acquire(const std::string& host, bool force);
+    static void Release(const std::string& host);
+  };
+
+} // namespace ArcDMCHTTP
+
+#endif // __ARCDMCHTTP_STREAMCONTROL_H__
@@ -0,0 +1,185 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <arc/data/DataPointDirect.h>
+
+#include "../StreamControl.h"
+
+using namespace ArcDMCHTTP;
+
+class StreamControlTest
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(StreamControlTest);
+  CPPUNIT_TEST(TestLimits);
+  CPPUNIT_TEST(TestGrowth);
+  CPPUNIT_TEST(TestHighLatency);
+  CPPUNIT_TEST(TestNoGain);
+  CPPUNIT_TEST(TestDrop);
+  CPPUNIT_TEST(TestHostConfig);
+  CPPUNIT_TEST(TestHostSlots);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void TestLimits();
+  void TestGrowth();
+  void TestHighLatency();
+  void TestNoGain();
+  void TestDrop();
+  void TestHostConfig();
+  void TestHostSlots();
+
+private:
+  Glib::TimeVal now;
+  // Makes every stream report chunk and closes measurement window
+  // 2 seconds later, so measured rate is streams*bytes/2.
+  void Window(StreamControl& control, uint64_t bytes, double latency);
+};
+
+void StreamControlTest::Window(StreamControl& control, uint64_t bytes, double latency) {
+  unsigned int streams = control.Target();
+  for (unsigned int n = 1; n < streams; ++n) control.Report(bytes, 1.0, latency, now);
+  now.add_seconds(2);
+  control.Report(bytes, 1.0, latency, now);
+}
+
+void StreamControlTest::TestLimits() {
+  StreamControl none(0, 0);
+  CPPUNIT_ASSERT_EQUAL(1U, none.Target());
+  StreamControl over(5, 3);
+  CPPUNIT_ASSERT_EQUAL(3U, over.Target());
+  CPPUNIT_ASSERT_EQUAL(3U, over.MaxTarget());
+  CPPUNIT_ASSERT_EQUAL(3U, over.BestTarget());
+}
+
+void StreamControlTest::TestGrowth() {
+  now.assign_current_time();
+  StreamControl control(1, 4);
+  // Too short window does not change anything
+  Glib::TimeVal soon(now);
+  soon.add_milliseconds(100);
+  control.Report(0, 0.1, 0.0, soon);
+  CPPUNIT_ASSERT_EQUAL(1U, control.Target());
+  // Every stream brings same throughput - grow by one up to limit
+  Window(control, 1000, 0.1);
+  CPPUNIT_ASSERT_EQUAL(2U, control.Target());
+  Window(control, 1000, 0.1);
+  CPPUNIT_ASSERT_EQUAL(3U, control.Target());
+  Window(control, 1000, 0.1);
+  CPPUNIT_ASSERT_EQUAL(4U, control.Target());
+  Window(control, 1000, 0.1);
+  CPPUNIT_ASSERT_EQUAL(4U, control.Target());
+  CPPUNIT_ASSERT_EQUAL(4U, control.MaxTarget());
+  CPPUNIT_ASSERT_EQUAL(4U, control.BestTarget());
+}
+
+void StreamControlTest::TestHighLatency() {
+  now.assign_current_time();
+  StreamControl control(1, 6);
+  // Most of time spent waiting for response - double streams
+  Window(control, 1000, 0.9);
+  CPPUNIT_ASSERT_EQUAL(2U, control.Target());
+  Window(control, 1000, 0.9);
+  CPPUNIT_ASSERT_EQUAL(4U, control.Target());
+  // Doubling is capped by limit
+  Window(control, 1000, 0.9);
+  CPPUNIT_ASSERT_EQUAL(6U, control.Target());
+  CPPUNIT_ASSERT_EQUAL(6U, control.MaxTarget());
+}
+
+void StreamControlTest::TestNoGain() {
+  now.assign_current_time();
+  StreamControl control(1, 8);
+  Window(control, 1000, 0.1);
+  Window(control, 1000, 0.1);
+  CPPUNIT_ASSERT_EQUAL(3U, control.Target());
+  // Third stream brings nothing - return to two
+  Window(control, 666, 0.1);
+  CPPUNIT_ASSERT_EQUAL(2U, control.Target());
+  CPPUNIT_ASSERT_EQUAL(2U, control.BestTarget());
+  CPPUNIT_ASSERT_EQUAL(3U, control.MaxTarget());
+  // Stable throughput keeps streams until it is time to probe again
+  for (int n = 1; n < 10; ++n) {
+    Window(control, 1000, 0.1);
+    CPPUNIT_ASSERT_EQUAL(2U, control.Target());
+  }
+  Window(control, 1000, 0.1);
+  CPPUNIT_ASSERT_EQUAL(3U, control.Target());
+}
+
+void StreamControlTest::TestDrop() {
+  now.assign_current_time();
+  StreamControl control(1, 8);
+  Window(control, 1000, 0.1);
+  Window(control, 1000, 0.1);
+  Window(control, 1000, 0.1);
+  CPPUNIT_ASSERT_EQUAL(4U, control.Target());
+  Window(control, 750, 0.1);
+  CPPUNIT_ASSERT_EQUAL(3U, control.Target());
+  // Throughput collapses - use fewer streams
+  Window(control, 100, 0.1);
+  CPPUNIT_ASSERT_EQUAL(2U, control.Target());
+  CPPUNIT_ASSERT_EQUAL(2U, control.BestTarget());
+}
+
+void StreamControlTest::TestHostConfig() {
+  HostStreams::Configure("a.org=4:6 *=2:3, b.org=30:50 c.org=5:2 wrong d.org=x:1");
+  unsigned int initial = 0;
+  unsigned int limit = 0;
+  HostStreams::Get("a.org", initial, limit);
+  CPPUNIT_ASSERT_EQUAL(4U, initial);
+  CPPUNIT_ASSERT_EQUAL(6U, limit);
+  HostStreams::Get("other.org", initial, limit);
+  CPPUNIT_ASSERT_EQUAL(2U, initial);
+  CPPUNIT_ASSERT_EQUAL(3U, limit);
+  HostStreams::Get("b.org", initial, limit);
+  CPPUNIT_ASSERT_EQUAL((unsigned int)MAX_PARALLEL_STREAMS, initial);
+  CPPUNIT_ASSERT_EQUAL((unsigned int)MAX_PARALLEL_STREAMS, limit);
+  HostStreams::Get("c.org", initial, limit);
+  CPPUNIT_ASSERT_EQUAL(2U, initial);
+  CPPUNIT_ASSERT_EQUAL(2U, limit);
+  HostStreams::Get("d.org", initial, limit);
+  CPPUNIT_ASSERT_EQUAL(2U, initial);
+  CPPUNIT_ASSERT_EQUAL(3U, limit);
+  // Learned number of streams is used by next transfer within limit
+  HostStreams::Learn("a.org", 5);
+  HostStreams::Get("a.org", initial, limit);
+  CPPUNIT_ASSERT_EQUAL(5U, initial);
+  HostStreams::Learn("a.org", 10);
+  HostStreams::Get("a.org", initial, limit);
+  CPPUNIT_ASSERT_EQUAL(6U, initial);
+  // Without configuration every host starts with one stream
+  HostStreams::Configure("");
+  HostStreams::Get("a.org", initial, limit);
+  CPPUNIT_ASSERT_EQUAL(1U, initial);
+  CPPUNIT_ASSERT_EQUAL(8U, limit);
+}
+
+void StreamControlTest::TestHostSlots() {
+  HostStreams::Configure("a.org=1:2");
+  CPPUNIT_ASSERT(HostStreams::Acquire("a.org", false));
+  CPPUNIT_ASSERT(HostStreams::Acquire("a.org", false));
+  CPPUNIT_ASSERT(!HostStreams::Acquire("a.org", false));
+  // Other hosts are not affected
+  CPPUNIT_ASSERT(HostStreams::Acquire("b.org", false));
+  // Every transfer gets at least one stream
+  CPPUNIT_ASSERT(HostStreams::Acquire("a.org", true));
+  HostStreams::Release("a.org");
+  CPPUNIT_ASSERT(!HostStreams::Acquire("a.org", false));
+  HostStreams::Release("a.org");
+  CPPUNIT_ASSERT(HostStreams::Acquire("a.org", false));
+  // Reconfiguration does not forget running streams
+  HostStreams::Configure("a.org=1:3");
+  CPPUNIT_ASSERT(HostStreams::Acquire("a.org", false));
+  CPPUNIT_ASSERT(!HostStreams::Acquire("a.org", false));
+  HostStreams::Configure("");
+  for (int n = 1; n < 8; ++n) CPPUNIT_ASSERT(HostStreams::Acquire("b.org", false));
+  CPPUNIT_ASSERT(!HostStreams::Acquire("b.org", false));
+  for (int n = 0; n < 8; ++n) HostStreams::Release("b.org");
+  for (int n = 0; n < 3; ++n) HostStreams::Release("a.org");
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StreamControlTest);
@@ -340,6 +340,11 @@ namespace Arc {
       "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
     };
 
+    // Fixed width numeric fields are formatted with snprintf because
+    // times are rendered for every control file and log record and
+    // creating stream for each of them is noticeably slower.
+    char buf[64];
+
     switch (format) {
 
     case ASCTime:  // Day Mon DD HH:MM:SS YYYY
@@ -347,19 +352,12 @@ namespace Arc {
         tm tmtime;
         localtime_r(&gtime, &tmtime);
 
-        std::stringstream ss;
-
-        ss << std::setfill('0');
-
-        ss << day[tmtime.tm_wday] << ' '
-           << month[tmtime.tm_mon] << ' '
-           << std::setw(2) << tmtime.tm_mday << ' '
-           << std::setw(2) << tmtime.tm_hour << ':'
-           << std::setw(2) << tmtime.tm_min << ':'
-           << std::setw(2) << tmtime.tm_sec << ' '
-           << std::setw(4) << tmtime.tm_year + 1900;
+        snprintf(buf, sizeof(buf), "%s %s %02d %02d:%02d:%02d %04d",
+                 day[tmtime.tm_wday], month[tmtime.tm_mon],
+                 tmtime.tm_mday, tmtime.tm_hour, tmtime.tm_min,
+                 tmtime.tm_sec, tmtime.tm_year + 1900);
 
-        return ss.str();
+        return buf;
       }
 
     case UserTime:
@@ -367,18 +365,11 @@ namespace Arc {
         tm tmtime;
         localtime_r(&gtime, &tmtime);
 
-        std::stringstream ss;
-
-        ss << std::setfill('0');
-
-        ss << std::setw(4) << tmtime.tm_year + 1900 << '-'
-           << std::setw(2) << tmtime.tm_mon + 1 << '-'
-           << std::setw(2) << tmtime.tm_mday << ' '
-           << std::setw(2) << tmtime.tm_hour << ':'
-           << std::setw(2) << tmtime.tm_min << ':'
-           << std::setw(2) << tmtime.tm_sec;
+        snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d",
+                 tmtime.tm_year + 1900, tmtime.tm_mon + 1, tmtime.tm_mday,
+                 tmtime.tm_hour, tmtime.tm_min, tmtime.tm_sec);
 
-        return ss.str();
+        return buf;
       }
 
     case UserExtTime:
@@ -386,19 +377,12 @@ namespace Arc {
         tm tmtime;
         localtime_r(&gtime, &tmtime);
 
-        std::stringstream ss;
+        snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d.%06u",
+                 tmtime.tm_year + 1900, tmtime.tm_mon + 1, tmtime.tm_mday,
+                 tmtime.tm_hour, tmtime.tm_min, tmtime.tm_sec,
+                 (unsigned int)(gnano/1000));
 
-        ss << std::setfill('0');
-
-        ss << std::setw(4) << tmtime.tm_year + 1900 << '-'
-           << std::setw(2) << tmtime.tm_mon + 1 << '-'
-           << std::setw(2) << tmtime.tm_mday << ' '
-           << std::setw(2) << tmtime.tm_hour << ':'
-           << std::setw(2) << tmtime.tm_min << ':'
-           << std::setw(2) << tmtime.tm_sec << '.'
-           << std::setw(6) << gnano/1000;
-
-        return ss.str();
+        return buf;
       }
 
     case ElasticTime:
@@ -406,19 +390,12 @@ namespace Arc {
         tm tmtime;
         localtime_r(&gtime, &tmtime);
 
-        std::stringstream ss;
-
-        ss << std::setfill('0');
-
-        ss << std::setw(4) << tmtime.tm_year + 1900 << '-'
-           << std::setw(2) << tmtime.tm_mon + 1 << '-'
-           << std::setw(2) << tmtime.tm_mday << ' '
-           << std::setw(2) << tmtime.tm_hour << ':'
-           << std::setw(2) << tmtime.tm_min << ':'
-           << std::setw(2) << tmtime.tm_sec << '.'
-           << std::setw(3) << gnano/1000000;
+        snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d.%03u",
+                 tmtime.tm_year + 1900, tmtime.tm_mon + 1, tmtime.tm_mday,
+                 tmtime.tm_hour, tmtime.tm_min, tmtime.tm_sec,
+                 (unsigned int)(gnano/1000000));
 
-        return ss.str();
+        return buf;
       }
 
     case MDSTime:
@@ -426,18 +403,11 @@ namespace Arc {
         tm tmtime;
         gmtime_r(&gtime, &tmtime);
 
-        std::stringstream ss;
+        snprintf(buf, sizeof(buf), "%04d%02d%02d%02d%02d%02dZ",
+                 tmtime.tm_year + 1900, tmtime.tm_mon + 1, tmtime.tm_mday,
+                 tmtime.tm_hour, tmtime.tm_min, tmtime.tm_sec);
 
-        ss << std::setfill('0');
-
-        ss << std::setw(4) << tmtime.tm_year + 1900
-           << std::setw(2) << tmtime.tm_mon + 1
-           << std::setw(2) << tmtime.tm_mday
-           << std::setw(2) << tmtime.tm_hour
-           << std::setw(2) << tmtime.tm_min
-           << std::setw(2) << tmtime.tm_sec << 'Z';
-
-        return ss.str();
+        return buf;
       }
 
     case ISOTime:
@@ -445,21 +415,15 @@ namespace Arc {
         tm tmtime;
         localtime_r(&gtime, &tmtime);
         time_t tzoffset = timegm(&tmtime) - gtime;
+        long tzabs = (long)((tzoffset < 0) ? -tzoffset : tzoffset);
 
-        std::stringstream ss;
-
-        ss << std::setfill('0');
-
-        ss << std::setw(4) << tmtime.tm_year + 1900 << '-'
-           << std::setw(2) << tmtime.tm_mon + 1 << '-'
-           << std::setw(2) << tmtime.tm_mday << 'T'
-           << std::setw(2) << tmtime.tm_hour << ':'
-           << std::setw(2) << tmtime.tm_min << ':'
-           << std::setw(2) << tmtime.tm_sec << (tzoffset < 0 ? '-' : '+')
-           << std::setw(2) << abs(tzoffset) / Time::HOUR << ':'
-           << std::setw(2) << (abs(tzoffset) % Time::HOUR) / 60;
+        snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02d%c%02ld:%02ld",
+                 tmtime.tm_year + 1900, tmtime.tm_mon + 1, tmtime.tm_mday,
+                 tmtime.tm_hour, tmtime.tm_min, tmtime.tm_sec,
+                 (tzoffset < 0 ? '-' : '+'),
+                 tzabs / Time::HOUR, (tzabs % Time::HOUR) / 60);
 
-        return ss.str();
+        return buf;
       }
 
     case UTCTime:
@@ -467,18 +431,11 @@ namespace Arc {
         tm tmtime;
         gmtime_r(&gtime, &tmtime);
 
-        std::stringstream ss;
+        snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02dZ",
+                 tmtime.tm_year + 1900, tmtime.tm_mon + 1, tmtime.tm_mday,
+                 tmtime.tm_hour, tmtime.tm_min, tmtime.tm_sec);
 
-        ss << std::setfill('0');
-
-        ss << std::setw(4) << tmtime.tm_year + 1900 << '-'
-           << std::setw(2) << tmtime.tm_mon + 1 << '-'
-           << std::setw(2) << tmtime.tm_mday << 'T'
-           << std::setw(2) << tmtime.tm_hour << ':'
-           << std::setw(2) << tmtime.tm_min << ':'
-           << std::setw(2) << tmtime.tm_sec << 'Z';
-
-        return ss.str();
+        return buf;
       }
 
     case RFC1123Time:
@@ -486,19 +443,12 @@ namespace Arc {
         tm tmtime;
         gmtime_r(&gtime, &tmtime);
 
-        std::stringstream ss;
-
-        ss << std::setfill('0');
-
-        ss << day[tmtime.tm_wday] << ", "
-           << std::setw(2) << tmtime.tm_mday << ' '
-           << month[tmtime.tm_mon] << ' '
-           << std::setw(4) << tmtime.tm_year + 1900 << ' '
-           << std::setw(2) << tmtime.tm_hour << ':'
-           << std::setw(2) << tmtime.tm_min << ':'
-           << std::setw(2) << tmtime.tm_sec << " GMT";
+        snprintf(buf, sizeof(buf), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+                 day[tmtime.tm_wday], tmtime.tm_mday, month[tmtime.tm_mon],
+                 tmtime.tm_year + 1900, tmtime.tm_hour, tmtime.tm_min,
+                 tmtime.tm_sec);
 
-        return ss.str();
+        return buf;
       }
     case EpochTime:
       {
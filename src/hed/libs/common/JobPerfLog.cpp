@@ -3,21 +3,187 @@
 #endif
 
 #include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <pthread.h>
 #include <fstream>
+#include <map>
+#include <vector>
 
 #ifdef _MACOSX
 #include <mach/clock.h>
 #include <mach/mach.h>
 #endif
 
+#include <glibmm/thread.h>
+
 #include <arc/DateTime.h>
+#include <arc/Thread.h>
 
 #include "JobPerfLog.h"
 
 namespace Arc {
 
+static bool get_perf_time(timespec& t) {
+#ifdef _MACOSX // OS X does not have clock_gettime, use clock_get_time
+  clock_serv_t cclock;
+  mach_timespec_t mts;
+  host_get_clock_service(mach_host_self(), CALENDAR_CLOCK, &cclock);
+  clock_get_time(cclock, &mts);
+  mach_port_deallocate(mach_task_self(), cclock);
+  t.tv_sec = mts.tv_sec;
+  t.tv_nsec = mts.tv_nsec;
+  return true;
+#else
+  return (clock_gettime(CLOCK_MONOTONIC, &t) == 0) || (clock_gettime(CLOCK_REALTIME, &t) == 0);
+#endif
+}
 
-JobPerfLog::JobPerfLog(): log_enabled(false) {
+// Buffer of trace spans shared by all JobPerfLog objects writing to
+// same file. Spans are collected under short lock and written by
+// dedicated thread once per second or when buffer is half full. If
+// writer does not keep up spans are dropped and their number is
+// recorded in trace instead. Objects are never destroyed because
+// copies of JobPerfLog may be used till process exits.
+class JobPerfTrace {
+ public:
+  static JobPerfTrace* Get(const std::string& path);
+  void Add(const std::string& name, const std::string& id, const timespec& start, const timespec& end);
+  void Flush(void);
+ private:
+  class Span {
+   public:
+    std::string name;
+    std::string id;
+    timespec start;
+    timespec end;
+    unsigned long int tid;
+  };
+  static const std::vector<Span>::size_type capacity = 16384;
+  static const int flush_interval = 1000; // ms
+  static Glib::Mutex traces_lock;
+  static std::map<std::string,JobPerfTrace*> traces;
+  std::string path_;
+  Glib::Mutex lock_;
+  std::vector<Span> spans_;
+  unsigned long int dropped_;
+  Glib::Mutex write_lock_;
+  SimpleCondition flush_cond_;
+  JobPerfTrace(const std::string& path);
+  static void flush_thread(void* arg);
+};
+
+Glib::Mutex JobPerfTrace::traces_lock;
+std::map<std::string,JobPerfTrace*> JobPerfTrace::traces;
+
+JobPerfTrace* JobPerfTrace::Get(const std::string& path) {
+  Glib::Mutex::Lock lock(traces_lock);
+  std::map<std::string,JobPerfTrace*>::iterator trace = traces.find(path);
+  if(trace != traces.end()) return trace->second;
+  JobPerfTrace* new_trace = new JobPerfTrace(path);
+  traces[path] = new_trace;
+  CreateThreadFunction(&flush_thread, new_trace);
+  return new_trace;
+}
+
+JobPerfTrace::JobPerfTrace(const std::string& path): path_(path), dropped_(0) {
+  spans_.reserve(capacity);
+}
+
+void JobPerfTrace::Add(const std::string& name, const std::string& id, const timespec& start, const timespec& end) {
+  unsigned long int tid = (unsigned long int)pthread_self();
+  Glib::Mutex::Lock lock(lock_);
+  if(spans_.size() >= capacity) {
+    ++dropped_;
+    return;
+  };
+  spans_.resize(spans_.size()+1);
+  Span& span = spans_.back();
+  span.name = name;
+  span.id = id;
+  span.start = start;
+  span.end = end;
+  span.tid = tid;
+  if(spans_.size() == capacity/2) flush_cond_.signal();
+}
+
+static void json_escape(std::string& out, const std::string& str) {
+  for(std::string::size_type n = 0; n < str.length(); ++n) {
+    char c = str[n];
+    if((c == '"') || (c == '\\')) {
+      out += '\\'; out += c;
+    } else if((unsigned char)c < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", (unsigned int)(unsigned char)c);
+      out += buf;
+    } else {
+      out += c;
+    };
+  };
+}
+
+static uint64_t to_us(const timespec& t) {
+  return ((uint64_t)t.tv_sec)*1000000 + t.tv_nsec/1000;
+}
+
+void JobPerfTrace::Flush(void) {
+  std::vector<Span> spans;
+  spans.reserve(capacity);
+  unsigned long int dropped;
+  Glib::Mutex::Lock wlock(write_lock_);
+  {
+    Glib::Mutex::Lock lock(lock_);
+    spans.swap(spans_);
+    dropped = dropped_;
+    dropped_ = 0;
+  };
+  if(spans.empty() && (dropped == 0)) return;
+  // Chrome trace format allows unterminated array, so file
+  // can be appended to by restarted service.
+  struct stat st;
+  bool fresh = (::stat(path_.c_str(), &st) != 0) || (st.st_size == 0);
+  std::ofstream out(path_.c_str(), std::ofstream::app);
+  if(!out.is_open()) return;
+  if(fresh) out << "[" << std::endl;
+  int pid = (int)::getpid();
+  std::string line;
+  char buf[128];
+  for(std::vector<Span>::iterator span = spans.begin(); span != spans.end(); ++span) {
+    std::string::size_type sep = span->name.find(':');
+    line = "{\"name\":\"";
+    json_escape(line, span->name);
+    line += "\",\"cat\":\"";
+    json_escape(line, (sep == std::string::npos) ? std::string("job") : span->name.substr(0,sep));
+    uint64_t start = to_us(span->start);
+    uint64_t end = to_us(span->end);
+    snprintf(buf, sizeof(buf), "\",\"ph\":\"X\",\"pid\":%d,\"tid\":%lu,\"ts\":%llu,\"dur\":%llu,\"args\":{\"id\":\"",
+             pid, span->tid, (unsigned long long int)start,
+             (unsigned long long int)((end > start) ? (end - start) : 0));
+    line += buf;
+    json_escape(line, span->id);
+    line += "\"}},";
+    out << line << std::endl;
+  };
+  if(dropped > 0) {
+    timespec now;
+    if(!get_perf_time(now)) now.tv_sec = now.tv_nsec = 0;
+    snprintf(buf, sizeof(buf), "{\"name\":\"dropped\",\"ph\":\"i\",\"s\":\"p\",\"pid\":%d,\"ts\":%llu,\"args\":{\"count\":%lu}},",
+             pid, (unsigned long long int)to_us(now), dropped);
+    out << buf << std::endl;
+  };
+}
+
+void JobPerfTrace::flush_thread(void* arg) {
+  JobPerfTrace* it = reinterpret_cast<JobPerfTrace*>(arg);
+  for(;;) {
+    it->flush_cond_.wait(flush_interval);
+    it->Flush();
+  };
+}
+
+
+JobPerfLog::JobPerfLog(): log_enabled(false), trace(NULL) {
 }
 
 JobPerfLog::~JobPerfLog() {
@@ -27,6 +193,11 @@ void JobPerfLog::SetOutput(const std::string& filename) {
   log_path = filename;
 }
 
+void JobPerfLog::SetTraceOutput(const std::string& filename) {
+  trace_path = filename;
+  trace = trace_path.empty() ? NULL : JobPerfTrace::Get(trace_path);
+}
+
 void JobPerfLog::SetEnabled(bool enabled) {
   if(enabled != log_enabled) {
     log_enabled = enabled;
@@ -45,18 +216,7 @@ void JobPerfRecord::Start(const std::string& id) {
   start_recorded = false;
   if(&perf_log == NULL) return;
   if(!perf_log.GetEnabled()) return;
-#ifdef _MACOSX // OS X does not have clock_gettime, use clock_get_time
-  clock_serv_t cclock;
-  mach_timespec_t mts;
-  host_get_clock_service(mach_host_self(), CALENDAR_CLOCK, &cclock);
-  clock_get_time(cclock, &mts);
-  mach_port_deallocate(mach_task_self(), cclock);
-  start_time.tv_sec = mts.tv_sec;
-  start_time.tv_nsec = mts.tv_nsec;
-  {
-#else
-  if((clock_gettime(CLOCK_MONOTONIC, &start_time) == 0) || (clock_gettime(CLOCK_REALTIME, &start_time) == 0)) {
-#endif
+  if(get_perf_time(start_time)) {
     start_recorded = true;
     start_id = id;
   };
@@ -66,19 +226,19 @@ void JobPerfRecord::Start(const std::string& id) {
 void JobPerfRecord::End(const std::string& name) {
   if(start_recorded) {
     timespec end_time;
-#ifdef _MACOSX // OS X does not have clock_gettime, use clock_get_time
-    clock_serv_t cclock;
-    mach_timespec_t mts;
-    host_get_clock_service(mach_host_self(), CALENDAR_CLOCK, &cclock);
-    clock_get_time(cclock, &mts);
-    mach_port_deallocate(mach_task_self(), cclock);
-    end_time.tv_sec = mts.tv_sec;
-    end_time.tv_nsec = mts.tv_nsec;
-    {
-#else
-    if((clock_gettime(CLOCK_MONOTONIC, &end_time) == 0) || (clock_gettime(CLOCK_REALTIME, &end_time) == 0)) {
-#endif
+    if(get_perf_time(end_time)) {
       perf_log.Log(name, start_id, start_time, end_time);
+      perf_log.Trace(name, start_id, start_time, end_time);
+    };
+    start_recorded = false;
+  };
+}
+
+void JobPerfRecord::Trace(const std::string& name) {
+  if(start_recorded) {
+    timespec end_time;
+    if(get_perf_time(end_time)) {
+      perf_log.Trace(name, start_id, start_time, end_time);
     };
     start_recorded = false;
   };
@@ -94,5 +254,34 @@ void JobPerfLog::Log(const std::string& name, const std::string& id, const times
   };
 }
 
-} // namespace Arc
+void JobPerfLog::Trace(const std::string& name, const std::string& id, const timespec& start, const timespec& end) {
+  if(!log_enabled) return;
+  if(!trace) return;
+  trace->Add(name, id, start, end);
+}
+
+void JobPerfLog::FlushTrace() {
+  if(trace) trace->Flush();
+}
+
+JobPerfSpan::JobPerfSpan(JobPerfLog* log, const std::string& name, const std::string& id):
+    perf_log(log), start_recorded(false) {
+  if(!perf_log) return;
+  if(!perf_log->GetTraceEnabled()) return;
+  if(get_perf_time(start_time)) {
+    start_recorded = true;
+    span_name = name;
+    span_id = id;
+  };
+}
 
+JobPerfSpan::~JobPerfSpan() {
+  if(start_recorded) {
+    timespec end_time;
+    if(get_perf_time(end_time)) {
+      perf_log->Trace(span_name, span_id, start_time, end_time);
+    };
+  };
+}
+
+} // namespace Arc
@@ -6,6 +6,8 @@
 
 namespace Arc {
 
+class JobPerfTrace;
+
 class JobPerfLog {
  public:
   JobPerfLog();
@@ -14,19 +16,37 @@ class JobPerfLog {
   
   void SetOutput(const std::string& filename);
 
+  /** Set file to store trace of recorded spans. Trace is written in Chrome
+      trace event format which can be loaded into chrome://tracing or
+      Perfetto. Empty name disables tracing. All JobPerfLog objects with
+      same trace file share one in-memory buffer. */
+  void SetTraceOutput(const std::string& filename);
+
   void SetEnabled(bool enabled);
 
   const std::string& GetOutput() const { return log_path; };
 
+  const std::string& GetTraceOutput() const { return trace_path; };
+
   bool GetEnabled() const { return log_enabled; };
 
+  bool GetTraceEnabled() const { return log_enabled && trace; };
+
   /** Log one performance record. */
   void Log(const std::string& name, const std::string& id, const timespec& start, const timespec& end);
 
+  /** Add one span to trace. Spans are buffered in memory and written
+      to trace file asynchronously. */
+  void Trace(const std::string& name, const std::string& id, const timespec& start, const timespec& end);
+
+  /** Write buffered trace spans to file immediately. */
+  void FlushTrace();
 
  private:
    std::string log_path;
    bool log_enabled;
+   std::string trace_path;
+   JobPerfTrace* trace;
 
 };
 
@@ -41,9 +61,13 @@ class JobPerfRecord {
   /** Prepare to log one record by remembering start time of action being measured. */
   void Start(const std::string& id);
 
-  /** Log performance record started by previous LogStart(). */
+  /** Log performance record started by previous LogStart(). 
+      Record is also added to trace if tracing is enabled. */
   void End(const std::string& name);
 
+  /** Add span started by previous Start() to trace only. */
+  void Trace(const std::string& name);
+
   bool Started() { return start_recorded; };
 
  private:
@@ -54,6 +78,26 @@ class JobPerfRecord {
 
 };
 
+/** Records span covering lifetime of object into trace. Does nothing if
+    log is NULL or tracing is not enabled. */
+class JobPerfSpan {
+ public:
+  JobPerfSpan(JobPerfLog* log, const std::string& name, const std::string& id);
+
+  ~JobPerfSpan();
+
+ private:
+   JobPerfLog* perf_log;
+   bool start_recorded;
+   timespec start_time;
+   std::string span_name;
+   std::string span_id;
+
+   JobPerfSpan(JobPerfSpan const &);
+   JobPerfSpan& operator=(JobPerfSpan const &);
+
+};
+
 } // namespace Arc
 
 #endif // __ARC_JOB_PERF_LOGGER__
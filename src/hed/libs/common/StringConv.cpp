@@ -5,6 +5,7 @@
 #endif
 
 #include <vector>
+#include <limits>
 #include <ctype.h>
 #include <algorithm>
 #include <glib.h>
@@ -492,6 +493,195 @@ namespace Arc {
     return s;
   }
 
+  // Converts numbers of form [+-]?[0-9]+ which fit into T. Anything else,
+  // including surrounding spaces, is left for stream based conversion so
+  // that error reporting and handling of unusual input stay unchanged.
+  template<typename T>
+  static bool plain_to_int(const std::string& s, T& t) {
+    std::string::size_type p = 0;
+    std::string::size_type l = s.length();
+    bool negative = false;
+    if((p < l) && ((s[p] == '+') || (s[p] == '-'))) {
+      negative = (s[p] == '-');
+      ++p;
+    }
+    if(p >= l) return false;
+    // stream wraps negative values of unsigned types around
+    if(negative && !std::numeric_limits<T>::is_signed) return false;
+    unsigned long long limit = (unsigned long long)std::numeric_limits<T>::max();
+    if(negative) limit += 1;
+    unsigned long long n = 0;
+    for(;p < l;++p) {
+      char c = s[p];
+      if((c < '0') || (c > '9')) return false;
+      unsigned int d = (unsigned int)(c - '0');
+      if(n > (limit - d) / 10) return false;
+      n = n * 10 + d;
+    }
+    if(negative && (n != 0)) {
+      t = (T)(-(long long)(n - 1) - 1);
+    } else {
+      t = (T)n;
+    }
+    return true;
+  }
+
+  // Converts numbers of form [+-]?[0-9]+(.[0-9]+)?([eE][+-]?[0-9]+)? which
+  // have at most max_digits significant digits and decimal exponent not
+  // exceeding max_exp. Both mantissa and power of 10 are then exactly
+  // representable in T and single multiplication or division gives
+  // correctly rounded result - same as produced by stream.
+  template<typename T>
+  static bool plain_to_float(const std::string& s, T& t, unsigned int max_digits, int max_exp) {
+    static const double powers[] = {
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    std::string::size_type p = 0;
+    std::string::size_type l = s.length();
+    bool negative = false;
+    if((p < l) && ((s[p] == '+') || (s[p] == '-'))) {
+      negative = (s[p] == '-');
+      ++p;
+    }
+    unsigned long long mantissa = 0;
+    unsigned int digits = 0;
+    int exponent = 0;
+    std::string::size_type start = p;
+    for(;(p < l) && (s[p] >= '0') && (s[p] <= '9');++p) {
+      unsigned int d = (unsigned int)(s[p] - '0');
+      if((mantissa != 0) || (d != 0)) {
+        if(++digits > max_digits) return false;
+      }
+      mantissa = mantissa * 10 + d;
+    }
+    if(p == start) return false;
+    if((p < l) && (s[p] == '.')) {
+      ++p;
+      start = p;
+      for(;(p < l) && (s[p] >= '0') && (s[p] <= '9');++p) {
+        unsigned int d = (unsigned int)(s[p] - '0');
+        if((mantissa != 0) || (d != 0)) {
+          if(++digits > max_digits) return false;
+        }
+        mantissa = mantissa * 10 + d;
+        --exponent;
+      }
+      if(p == start) return false;
+    }
+    if((p < l) && ((s[p] == 'e') || (s[p] == 'E'))) {
+      ++p;
+      bool exp_negative = false;
+      if((p < l) && ((s[p] == '+') || (s[p] == '-'))) {
+        exp_negative = (s[p] == '-');
+        ++p;
+      }
+      start = p;
+      int e = 0;
+      for(;(p < l) && (s[p] >= '0') && (s[p] <= '9');++p) {
+        e = e * 10 + (s[p] - '0');
+        if(e > 1000) return false;
+      }
+      if(p == start) return false;
+      exponent += exp_negative ? -e : e;
+    }
+    if(p != l) return false;
+    if((exponent > max_exp) || (exponent < -max_exp)) return false;
+    T v = (T)mantissa;
+    if(exponent < 0) {
+      v /= (T)powers[-exponent];
+    } else {
+      v *= (T)powers[exponent];
+    }
+    t = negative ? -v : v;
+    return true;
+  }
+
+  static bool plain_to_number(const std::string& s, float& t) {
+    // 10^7 < 2^24 and 5^10 < 2^24
+    return plain_to_float(s, t, 7, 10);
+  }
+
+  static bool plain_to_number(const std::string& s, double& t) {
+    // 10^15 < 2^53 and 5^22 < 2^53
+    return plain_to_float(s, t, 15, 22);
+  }
+
+  template<typename T>
+  static bool plain_to_number(const std::string& s, T& t) {
+    return plain_to_int(s, t);
+  }
+
+#define STRINGTO_SPECIALIZATION(T) \
+  template<> T stringto<T>(const std::string& s) { \
+    T t; \
+    if(plain_to_number(s, t)) return t; \
+    return stringto_stream<T>(s); \
+  } \
+  template<> bool stringto<T>(const std::string& s, T& t) { \
+    if(plain_to_number(s, t)) return true; \
+    return stringto_stream<T>(s, t); \
+  }
+
+  STRINGTO_SPECIALIZATION(int)
+  STRINGTO_SPECIALIZATION(unsigned int)
+  STRINGTO_SPECIALIZATION(long)
+  STRINGTO_SPECIALIZATION(unsigned long)
+  STRINGTO_SPECIALIZATION(long long)
+  STRINGTO_SPECIALIZATION(unsigned long long)
+  STRINGTO_SPECIALIZATION(float)
+  STRINGTO_SPECIALIZATION(double)
+
+#undef STRINGTO_SPECIALIZATION
+
+  // Same output as stream with default flags and setw(width)
+  static std::string number_to_string(unsigned long long n, bool negative, int width) {
+    char buf[32];
+    char* e = buf + sizeof(buf);
+    char* p = e;
+    do {
+      *(--p) = (char)('0' + (n % 10));
+      n /= 10;
+    } while(n);
+    if(negative) *(--p) = '-';
+    std::string::size_type len = e - p;
+    if((width > 0) && ((std::string::size_type)width > len)) {
+      std::string s((std::string::size_type)width - len, ' ');
+      s.append(p, len);
+      return s;
+    }
+    return std::string(p, len);
+  }
+
+  static std::string number_to_string(long long t, int width) {
+    if(t < 0) return number_to_string(((unsigned long long)(-(t + 1))) + 1, true, width);
+    return number_to_string((unsigned long long)t, false, width);
+  }
+
+  template<> std::string tostring<int>(int t, int width, int) {
+    return number_to_string((long long)t, width);
+  }
+
+  template<> std::string tostring<unsigned int>(unsigned int t, int width, int) {
+    return number_to_string((unsigned long long)t, false, width);
+  }
+
+  template<> std::string tostring<long>(long t, int width, int) {
+    return number_to_string((long long)t, width);
+  }
+
+  template<> std::string tostring<unsigned long>(unsigned long t, int width, int) {
+    return number_to_string((unsigned long long)t, false, width);
+  }
+
+  template<> std::string tostring<long long>(long long t, int width, int) {
+    return number_to_string(t, width);
+  }
+
+  template<> std::string tostring<unsigned long long>(unsigned long long t, int width, int) {
+    return number_to_string(t, false, width);
+  }
+
   std::string json_encode(const std::string& str) {
     std::string out = str;
     std::string::size_type p = 0;
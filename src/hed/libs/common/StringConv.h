@@ -17,9 +17,13 @@ namespace Arc {
 
   extern Logger stringLogger;
 
-  /// This method converts a string to any type.
+  /// This method converts a string to any type using stream.
+  /** Generic implementation behind stringto(). Specialisations of stringto()
+      for numeric types use it for any input which is not plain decimal
+      number.
+      \since Added in 7.0.0. */
   template<typename T>
-  T stringto(const std::string& s) {
+  T stringto_stream(const std::string& s) {
     T t;
     if (s.empty()) {
       stringLogger.msg(ERROR, "Empty string");
@@ -36,9 +40,10 @@ namespace Arc {
     return t;
   }
 
-  /// This method converts a string to any type but lets calling function process errors.
+  /// This method converts a string to any type using stream but lets calling function process errors.
+  /** \since Added in 7.0.0. */
   template<typename T>
-  bool stringto(const std::string& s, T& t) {
+  bool stringto_stream(const std::string& s, T& t) {
     t = 0;
     if (s.empty())
       return false;
@@ -51,6 +56,37 @@ namespace Arc {
     return true;
   }
 
+  /// This method converts a string to any type.
+  template<typename T>
+  T stringto(const std::string& s) {
+    return stringto_stream<T>(s);
+  }
+
+  /// This method converts a string to any type but lets calling function process errors.
+  template<typename T>
+  bool stringto(const std::string& s, T& t) {
+    return stringto_stream<T>(s, t);
+  }
+
+  // Specialisations for numeric types convert plain decimal numbers
+  // without creating stream and produce same results as generic code.
+  template<> int stringto<int>(const std::string& s);
+  template<> unsigned int stringto<unsigned int>(const std::string& s);
+  template<> long stringto<long>(const std::string& s);
+  template<> unsigned long stringto<unsigned long>(const std::string& s);
+  template<> long long stringto<long long>(const std::string& s);
+  template<> unsigned long long stringto<unsigned long long>(const std::string& s);
+  template<> float stringto<float>(const std::string& s);
+  template<> double stringto<double>(const std::string& s);
+  template<> bool stringto<int>(const std::string& s, int& t);
+  template<> bool stringto<unsigned int>(const std::string& s, unsigned int& t);
+  template<> bool stringto<long>(const std::string& s, long& t);
+  template<> bool stringto<unsigned long>(const std::string& s, unsigned long& t);
+  template<> bool stringto<long long>(const std::string& s, long long& t);
+  template<> bool stringto<unsigned long long>(const std::string& s, unsigned long long& t);
+  template<> bool stringto<float>(const std::string& s, float& t);
+  template<> bool stringto<double>(const std::string& s, double& t);
+
 
 
 #define stringtoi(A) stringto < int > ((A))
@@ -97,6 +133,15 @@ namespace Arc {
     return ss.str();
   }
 
+  // Specialisations for integer types format number directly
+  // into string without creating stream.
+  template<> std::string tostring<int>(int t, int width, int precision);
+  template<> std::string tostring<unsigned int>(unsigned int t, int width, int precision);
+  template<> std::string tostring<long>(long t, int width, int precision);
+  template<> std::string tostring<unsigned long>(unsigned long t, int width, int precision);
+  template<> std::string tostring<long long>(long long t, int width, int precision);
+  template<> std::string tostring<unsigned long long>(unsigned long long t, int width, int precision);
+
   /// Convert long long integer to textual representation for specified base.
   /** The result is left-padded with zeroes to make the string size width. */
   std::string inttostr(signed long long t, int base = 10, int width = 0);
@@ -1275,12 +1275,41 @@ namespace Arc {
     InsertExternalNamespaces(out_xml_str, ns_str);
   }
 
+  static int write_to_stream(void* context,const char* buffer,int len) {
+    if(!context) return -1;
+    std::ostream* out = (std::ostream*)context;
+    if(len <= 0) return 0;
+    if(!buffer) return -1;
+    if(!out->write(buffer,len)) return -1;
+    return len;
+  }
+
+  bool XMLNode::GetXML(std::ostream& out, bool user_friendly) const {
+    if (!node_) return (bool)out;
+    if (node_->type != XML_ELEMENT_NODE) return (bool)out;
+    xmlDocPtr doc = node_->doc;
+    if (doc == NULL) return (bool)out;
+    std::map<xmlNsPtr,xmlNsPtr> extns;
+    CollectExternalNamespaces(node_, extns);
+    if(!extns.empty()) {
+      // Namespaces can only be inserted into already rendered text.
+      // Usually that happens for small subtrees only.
+      std::string s;
+      GetXML(s, user_friendly);
+      out << s;
+      return (bool)out;
+    }
+    xmlOutputBufferPtr buf =
+     xmlOutputBufferCreateIO(&write_to_stream,&close_string,&out,NULL);
+    if(buf == NULL) return false;
+    xmlNodeDumpOutput(buf, doc, node_, 0, user_friendly ? 1 : 0, (const char*)(doc->encoding));
+    if(xmlOutputBufferClose(buf) < 0) return false;
+    return (bool)out;
+  }
+
   bool XMLNode::SaveToStream(std::ostream& out) const {
-    std::string s;
-    GetXML(s);
     out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>" << std::endl;
-    out << s;
-    return (bool)out;
+    return GetXML(out);
   }
 
   bool XMLNode::SaveToFile(const std::string& file_name) const {
@@ -1298,6 +1327,19 @@ namespace Arc {
     return out;
   }
 
+  // Returns top element of parsed document. If there is none then
+  // document is destroyed.
+  static xmlNodePtr DocElement(xmlDocPtr doc) {
+    if (doc == NULL)
+      return NULL;
+    xmlNodePtr p = doc->children;
+    for (; p; p = p->next)
+      if (p->type == XML_ELEMENT_NODE) break;
+    if (!p)
+      xmlFreeDoc(doc);
+    return p;
+  }
+
   bool XMLNode::ReadFromStream(std::istream& in) {
     std::string s;
     std::getline<char>(in, s, 0);
@@ -1306,15 +1348,9 @@ namespace Arc {
     //xmlDocPtr doc = xmlParseMemory((char*)(s.c_str()), s.length());
     xmlDocPtr doc = xmlReadMemory(s.c_str(),s.length(),NULL,NULL,
                                   XML_PARSE_NODICT|XML_PARSE_NOERROR|XML_PARSE_NOWARNING);
-    if (doc == NULL)
-      return false;
-    xmlNodePtr p = doc->children;
-    for (; p; p = p->next)
-      if (p->type == XML_ELEMENT_NODE) break;
-    if (!p) {
-      xmlFreeDoc(doc);
+    xmlNodePtr p = DocElement(doc);
+    if (!p)
       return false;
-    }
     if (node_ != NULL)
       if (is_owner_) {
         xmlFreeDoc(node_->doc);
@@ -1327,6 +1363,39 @@ namespace Arc {
     return true;
   }
 
+  static int read_from_streambuf(void* context,char* buffer,int len) {
+    if(!context) return -1;
+    std::streambuf* in = (std::streambuf*)context;
+    if(len <= 0) return 0;
+    // Zero means end of document for libxml
+    std::streamsize l = in->sgetn(buffer,len);
+    if(l < 0) return -1;
+    return (int)l;
+  }
+
+  static int close_streambuf(void* context) {
+    if(!context) return -1;
+    return 0;
+  }
+
+  bool XMLNode::ReadFromStreamBuf(std::streambuf& in) {
+    // libxml pulls data in chunks and parses them while reading
+    xmlDocPtr doc = xmlReadIO(&read_from_streambuf,&close_streambuf,&in,NULL,NULL,
+                              XML_PARSE_NODICT|XML_PARSE_NOERROR|XML_PARSE_NOWARNING);
+    xmlNodePtr p = DocElement(doc);
+    if (!p)
+      return false;
+    if (node_ != NULL)
+      if (is_owner_) {
+        xmlFreeDoc(node_->doc);
+        node_ = NULL;
+        is_owner_ = false;
+      }
+    node_ = p;
+    is_owner_ = true;
+    return true;
+  }
+
   bool XMLNode::ReadFromFile(const std::string& file_name) {
     std::ifstream in(file_name.c_str(), std::ios::in);
     if (!in)
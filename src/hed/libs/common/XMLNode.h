@@ -270,6 +270,10 @@ namespace Arc {
        if the XML subtree corresponds to the encoding format specified in the
        argument, e.g. utf-8. */
     void GetXML(std::string& out_xml_str, const std::string& encoding, bool user_friendly = false) const;
+    /// Writes this instance XML subtree textual representation to stream.
+    /** Text is passed to stream while being rendered, so it is never
+       collected in memory as whole. Returns false if writing failed. */
+    bool GetXML(std::ostream& out, bool user_friendly = false) const;
     /// Fills out_xml_str with whole XML document textual representation.
     void GetDoc(std::string& out_xml_str, bool user_friendly = false) const;
     /// Returns textual content of node excluding content of children nodes.
@@ -377,6 +381,11 @@ namespace Arc {
     bool ReadFromFile(const std::string& file_name);
     /// Read XML document from stream and associate it with this node.
     bool ReadFromStream(std::istream& in);
+    /// Read XML document from stream buffer and associate it with this node.
+    /** Document is parsed while being read, so its complete textual
+       representation is never kept in memory. Everything till end of
+       buffer is treated as part of the document. */
+    bool ReadFromStreamBuf(std::streambuf& in);
     // Remove all eye-candy information leaving only informational parts
     //   void Purify(void);.
     /// XML schema validation against the schema file defined as argument.
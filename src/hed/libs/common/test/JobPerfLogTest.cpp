@@ -0,0 +1,99 @@
+// -*- indent-tabs-mode: nil -*-
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string>
+#include <list>
+#include <sys/stat.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <arc/FileUtils.h>
+#include <arc/JobPerfLog.h>
+
+class JobPerfLogTest
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(JobPerfLogTest);
+  CPPUNIT_TEST(TestTraceDisabled);
+  CPPUNIT_TEST(TestTrace);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp();
+  void tearDown();
+  void TestTraceDisabled();
+  void TestTrace();
+
+private:
+  std::string tmpdir;
+};
+
+void JobPerfLogTest::setUp() {
+  CPPUNIT_ASSERT(Arc::TmpDirCreate(tmpdir));
+}
+
+void JobPerfLogTest::tearDown() {
+  Arc::DirDelete(tmpdir, true);
+}
+
+void JobPerfLogTest::TestTraceDisabled() {
+  Arc::JobPerfLog log;
+  log.SetTraceOutput(tmpdir + "/disabled.json");
+  CPPUNIT_ASSERT(!log.GetTraceEnabled());
+  {
+    Arc::JobPerfSpan span(&log, "control:test", "job1");
+  }
+  {
+    Arc::JobPerfSpan span(NULL, "control:test", "job1");
+  }
+  log.FlushTrace();
+  struct stat st;
+  CPPUNIT_ASSERT(!Arc::FileStat(tmpdir + "/disabled.json", &st, true));
+}
+
+void JobPerfLogTest::TestTrace() {
+  std::string trace = tmpdir + "/trace.json";
+  Arc::JobPerfLog log;
+  log.SetOutput("");
+  log.SetEnabled(true);
+  log.SetTraceOutput(trace);
+  CPPUNIT_ASSERT(log.GetTraceEnabled());
+  // Copies share same buffer
+  Arc::JobPerfLog copy(log);
+  {
+    Arc::JobPerfSpan span(&log, "control:state_write", "job1");
+  }
+  Arc::JobPerfRecord record(copy, "job\"2");
+  record.End("ACCEPTED-PREPARING");
+  record.Start("job3");
+  record.Trace("DTR:TRANSFERRING");
+  log.FlushTrace();
+
+  std::list<std::string> lines;
+  CPPUNIT_ASSERT(Arc::FileRead(trace, lines));
+  CPPUNIT_ASSERT_EQUAL(4, (int)lines.size());
+  std::list<std::string>::iterator line = lines.begin();
+  CPPUNIT_ASSERT_EQUAL(std::string("["), *line);
+  ++line;
+  CPPUNIT_ASSERT(line->find("\"name\":\"control:state_write\",\"cat\":\"control\",\"ph\":\"X\"") != std::string::npos);
+  CPPUNIT_ASSERT(line->find("\"args\":{\"id\":\"job1\"}},") != std::string::npos);
+  ++line;
+  CPPUNIT_ASSERT(line->find("\"name\":\"ACCEPTED-PREPARING\",\"cat\":\"job\"") != std::string::npos);
+  CPPUNIT_ASSERT(line->find("\"id\":\"job\\\"2\"") != std::string::npos);
+  ++line;
+  CPPUNIT_ASSERT(line->find("\"cat\":\"DTR\"") != std::string::npos);
+
+  // Appending does not repeat array start
+  {
+    Arc::JobPerfSpan span(&copy, "script:submit-fork-job", "job3");
+  }
+  copy.FlushTrace();
+  lines.clear();
+  CPPUNIT_ASSERT(Arc::FileRead(trace, lines));
+  CPPUNIT_ASSERT_EQUAL(5, (int)lines.size());
+  CPPUNIT_ASSERT(lines.back().find("\"cat\":\"script\"") != std::string::npos);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(JobPerfLogTest);
@@ -0,0 +1,120 @@
+// -*- indent-tabs-mode: nil -*-
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <arc/DateTime.h>
+#include <arc/StringConv.h>
+
+// Compares numeric conversions of StringConv with generic stream based
+// implementation. Not part of regular tests because results depend on
+// machine load. Run manually to see timings.
+
+class StringConvBenchmark
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(StringConvBenchmark);
+  CPPUNIT_TEST(BenchStringToInt);
+  CPPUNIT_TEST(BenchStringToDouble);
+  CPPUNIT_TEST(BenchToString);
+  CPPUNIT_TEST(BenchTime);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp();
+  void BenchStringToInt();
+  void BenchStringToDouble();
+  void BenchToString();
+  void BenchTime();
+
+private:
+  static const int rounds = 1000000;
+  std::vector<std::string> integers;
+  std::vector<std::string> doubles;
+};
+
+static double Now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void Report(const std::string& name, double fast, double stream) {
+  std::cout << std::endl << name << ": " << (int)(fast * 1000) << " ms, stream: "
+            << (int)(stream * 1000) << " ms";
+}
+
+void StringConvBenchmark::setUp() {
+  integers.clear();
+  doubles.clear();
+  for(int n = 0; n < 1000; ++n) {
+    integers.push_back(Arc::tostring((n % 100000) * 7919 - 100000));
+    doubles.push_back(Arc::tostring(n * 7919) + "." + Arc::tostring(n % 100));
+  }
+}
+
+void StringConvBenchmark::BenchStringToInt() {
+  long long sum_fast = 0;
+  long long sum_stream = 0;
+  double start = Now();
+  for(int n = 0; n < rounds; ++n) sum_fast += Arc::stringto<int>(integers[n % integers.size()]);
+  double fast = Now() - start;
+  start = Now();
+  for(int n = 0; n < rounds; ++n) sum_stream += Arc::stringto_stream<int>(integers[n % integers.size()]);
+  double stream = Now() - start;
+  Report("stringto<int>", fast, stream);
+  CPPUNIT_ASSERT_EQUAL(sum_stream, sum_fast);
+}
+
+void StringConvBenchmark::BenchStringToDouble() {
+  double sum_fast = 0;
+  double sum_stream = 0;
+  double start = Now();
+  for(int n = 0; n < rounds; ++n) sum_fast += Arc::stringto<double>(doubles[n % doubles.size()]);
+  double fast = Now() - start;
+  start = Now();
+  for(int n = 0; n < rounds; ++n) sum_stream += Arc::stringto_stream<double>(doubles[n % doubles.size()]);
+  double stream = Now() - start;
+  Report("stringto<double>", fast, stream);
+  CPPUNIT_ASSERT_EQUAL(sum_stream, sum_fast);
+}
+
+void StringConvBenchmark::BenchToString() {
+  std::string::size_type len_fast = 0;
+  std::string::size_type len_stream = 0;
+  double start = Now();
+  for(int n = 0; n < rounds; ++n) len_fast += Arc::tostring((n % 100000) * 7919 - 100000).length();
+  double fast = Now() - start;
+  start = Now();
+  for(int n = 0; n < rounds; ++n) {
+    std::stringstream ss;
+    ss << ((n % 100000) * 7919 - 100000);
+    len_stream += ss.str().length();
+  }
+  double stream = Now() - start;
+  Report("tostring<int>", fast, stream);
+  CPPUNIT_ASSERT_EQUAL(len_stream, len_fast);
+}
+
+void StringConvBenchmark::BenchTime() {
+  Arc::Time t;
+  std::string::size_type len = 0;
+  double start = Now();
+  for(int n = 0; n < rounds / 10; ++n) {
+    len += t.str(Arc::MDSTime).length();
+    len += t.str(Arc::UTCTime).length();
+  }
+  double elapsed = Now() - start;
+  std::cout << std::endl << "Time::str: " << (int)(elapsed * 1000) << " ms" << std::endl;
+  CPPUNIT_ASSERT(len > 0);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StringConvBenchmark);
@@ -2,6 +2,9 @@
 #include <config.h>
 #endif
 
+#include <iomanip>
+#include <sstream>
+
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <arc/StringConv.h>
@@ -13,6 +16,7 @@ class StringConvTest
   CPPUNIT_TEST(TestStringConv);
   CPPUNIT_TEST(TestURIEncode);
   CPPUNIT_TEST(TestIntegers);
+  CPPUNIT_TEST(TestNumbers);
   CPPUNIT_TEST(TestJoin);
   CPPUNIT_TEST_SUITE_END();
 
@@ -20,6 +24,7 @@ public:
   void TestStringConv();
   void TestURIEncode();
   void TestIntegers();
+  void TestNumbers();
   void TestJoin();
 };
 
@@ -103,6 +108,58 @@ void StringConvTest::TestIntegers() {
   CPPUNIT_ASSERT_EQUAL(12345,n);
 }
 
+// Numeric specialisations of stringto/tostring must behave exactly like
+// generic stream based conversion, also for input they do not handle.
+template<typename T>
+static void CheckStringTo(const std::string& s) {
+  T fast = 0;
+  T stream = 0;
+  CPPUNIT_ASSERT_EQUAL_MESSAGE(s, Arc::stringto_stream<T>(s, stream), Arc::stringto<T>(s, fast));
+  CPPUNIT_ASSERT_EQUAL_MESSAGE(s, stream, fast);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE(s, Arc::stringto_stream<T>(s), Arc::stringto<T>(s));
+}
+
+template<typename T>
+static void CheckToString(T t, int width) {
+  std::stringstream ss;
+  ss << std::setw(width) << t;
+  CPPUNIT_ASSERT_EQUAL(ss.str(), Arc::tostring(t, width));
+}
+
+void StringConvTest::TestNumbers() {
+  const char* strings[] = {
+    "0", "-0", "+7", "007", "12345", "-12345", "2147483647", "2147483648",
+    "-2147483648", "-2147483649", "4294967295", "4294967296",
+    "9223372036854775807", "9223372036854775808", "-9223372036854775808",
+    "18446744073709551615", "18446744073709551616", "", " 1", "1 ", "1a",
+    "+", "-", "0x10", "1.5", "-0.25", "3.14159", "1e3", "2.5E-3", "1.",
+    ".5", "1e", "123456789012345", "1234567890123456", "1e22", "1e23",
+    "0.1", "16777217", "inf", NULL
+  };
+  for(int n = 0; strings[n]; ++n) {
+    CheckStringTo<int>(strings[n]);
+    CheckStringTo<unsigned int>(strings[n]);
+    CheckStringTo<long>(strings[n]);
+    CheckStringTo<unsigned long>(strings[n]);
+    CheckStringTo<long long>(strings[n]);
+    CheckStringTo<unsigned long long>(strings[n]);
+    CheckStringTo<float>(strings[n]);
+    CheckStringTo<double>(strings[n]);
+  }
+
+  CPPUNIT_ASSERT_EQUAL(-2147483647-1, Arc::stringtoi("-2147483648"));
+  CPPUNIT_ASSERT_EQUAL(0.1, Arc::stringtod("0.1"));
+
+  for(int width = -1; width < 22; width += 3) {
+    CheckToString<int>(0, width);
+    CheckToString<int>(-2147483647-1, width);
+    CheckToString<unsigned int>(4294967295U, width);
+    CheckToString<long long>(-9223372036854775807LL-1, width);
+    CheckToString<unsigned long long>(18446744073709551615ULL, width);
+  }
+  CPPUNIT_ASSERT_EQUAL(std::string("   42"), Arc::tostring(42, 5));
+}
+
 void StringConvTest::TestJoin() {
 
   std::list<std::string> strlist;
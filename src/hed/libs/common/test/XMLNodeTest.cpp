@@ -5,6 +5,7 @@
 
 
 #include <string>
+#include <sstream>
 
 #include <cppunit/extensions/HelperMacros.h>
 
@@ -18,6 +19,7 @@ class XMLNodeTest
   CPPUNIT_TEST(TestExchange);
   CPPUNIT_TEST(TestMove);
   CPPUNIT_TEST(TestQuery);
+  CPPUNIT_TEST(TestStreaming);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -27,6 +29,7 @@ public:
   void TestExchange();
   void TestMove();
   void TestQuery();
+  void TestStreaming();
 
 };
 
@@ -232,4 +235,31 @@ void XMLNodeTest::TestQuery() {
   CPPUNIT_ASSERT_EQUAL(1,(int)list6.size());
 }
 
+void XMLNodeTest::TestStreaming() {
+  std::string xml_str("<ns1:root xmlns:ns1=\"http://ns1\">");
+  for(int n = 0; n < 10000; ++n) xml_str += "<ns1:child>value</ns1:child>";
+  xml_str += "</ns1:root>";
+  std::stringbuf in(xml_str);
+  Arc::XMLNode xml;
+  CPPUNIT_ASSERT(xml.ReadFromStreamBuf(in));
+  CPPUNIT_ASSERT_EQUAL(std::string("root"), xml.Name());
+  CPPUNIT_ASSERT_EQUAL(10000, xml.Size());
+
+  std::ostringstream out;
+  CPPUNIT_ASSERT(xml.GetXML(out));
+  CPPUNIT_ASSERT_EQUAL(xml_str, out.str());
+
+  // Namespaces defined above rendered node must still be present
+  std::string s;
+  xml["child"].GetXML(s);
+  std::ostringstream child_out;
+  CPPUNIT_ASSERT(xml["child"].GetXML(child_out));
+  CPPUNIT_ASSERT_EQUAL(s, child_out.str());
+
+  std::stringbuf broken("<root><child></root>");
+  Arc::XMLNode xml2;
+  CPPUNIT_ASSERT(!xml2.ReadFromStreamBuf(broken));
+  CPPUNIT_ASSERT(!xml2);
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(XMLNodeTest);
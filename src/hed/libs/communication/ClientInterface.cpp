@@ -415,6 +415,8 @@ namespace Arc {
     comp.NewChild("Method") = "POST"; // Override using attributes if needed
     comp.NewChild("Endpoint") = url.str(true); // Override using attributes if needed
     if (!cfg.otoken.empty()) comp.NewChild("Authorization") = "Bearer " + cfg.otoken; // TODO: protect and encode
+    // Compressed responses are decoded in any case. This only makes them requested.
+    if (url.Option("compression") == "gzip") comp.NewChild("Compression") = "gzip";
     // Pass information about protocol and hostname to TLS level
     XMLNode compTLS = ConfigFindComponent(xmlcfg["Chain"], "tls.client", NULL);
     if(compTLS) {
@@ -724,6 +726,9 @@ namespace Arc {
     XMLNode comp =
       ConfigMakeComponent(xmlcfg["Chain"], "soap.client", "soap", "http");
     comp.NewAttribute("entry") = "soap";
+    // SOAP responses are never partial, so they may always be compressed
+    XMLNode compHTTP = ConfigFindComponent(xmlcfg["Chain"], "http.client", "http");
+    if (compHTTP && !compHTTP["Compression"]) compHTTP.NewChild("Compression") = "gzip";
   }
 
   ClientSOAP::~ClientSOAP() {}
@@ -14,6 +14,7 @@
 #include <arc/IString.h>
 #include <arc/Logger.h>
 #include <arc/StringConv.h>
+#include <arc/Thread.h>
 #include <arc/XMLNode.h>
 #include <arc/FileUtils.h>
 #include <arc/compute/Endpoint.h>
@@ -86,6 +87,8 @@ namespace Arc {
 
   Logger Job::logger(Logger::getRootLogger(), "Job");
 
+  static Glib::Mutex loader_lock;
+
   JobControllerPluginLoader& Job::getLoader() {
     // For C++ it would be enough to have 
     //   static JobControllerPluginLoader loader;
@@ -93,14 +96,42 @@ namespace Arc {
     // PluginsFactory destructor loop forever waiting for
     // plugins to exit.
     static JobControllerPluginLoader* loader = NULL;
+    Glib::Mutex::Lock lock(loader_lock);
     if(!loader) {
       loader = new JobControllerPluginLoader();
     }
     return *loader;
   }
-  
-  DataHandle* Job::data_source = NULL;
-  DataHandle* Job::data_destination = NULL;
+
+  // Connections to source and destination are kept between calls to
+  // CopyJobFile. Each call takes its own pair of handles out of the
+  // pool, so files of different jobs may be copied concurrently.
+  class JobFileHandles {
+  public:
+    JobFileHandles(void) : source(NULL), destination(NULL) {}
+    DataHandle* source;
+    DataHandle* destination;
+  };
+
+  static Glib::Mutex file_handles_lock;
+  // Objects might be pointing to allocated memory upon termination, leave it as garbage.
+  static std::list<JobFileHandles>* file_handles = NULL;
+
+  static JobFileHandles AcquireFileHandles(void) {
+    Glib::Mutex::Lock lock(file_handles_lock);
+    JobFileHandles handles;
+    if (file_handles && !file_handles->empty()) {
+      handles = file_handles->front();
+      file_handles->pop_front();
+    }
+    return handles;
+  }
+
+  static void ReleaseFileHandles(const JobFileHandles& handles) {
+    Glib::Mutex::Lock lock(file_handles_lock);
+    if (!file_handles) file_handles = new std::list<JobFileHandles>;
+    file_handles->push_front(handles);
+  }
 
   Job::Job()
     : ExitCode(-1),
@@ -912,9 +943,9 @@ namespace Arc {
     const std::string dstpath = dst.Path() + (dst.Path().empty() || *dst.Path().rbegin() != G_DIR_SEPARATOR ? G_DIR_SEPARATOR_S : "");
 
     std::list<URLLocation> files;
+    std::list<std::string> paths;
     bool data_files_listed = false;
     if(src.Locations().empty()) {
-      std::list<std::string> paths;
       if (!ListFilesRecursive(uc, src, paths)) {
         logger.msg(ERROR, "Unable to retrieve list of job files to download for job %s", JobID);
         return false;
@@ -966,6 +997,25 @@ namespace Arc {
       return false;
     }
 
+    if (data_files_listed && !paths.empty()) {
+      // Plugin may be able to transfer whole directory at once. Files
+      // it did not retrieve are left in list and downloaded one by one.
+      std::list<std::string> remaining(paths);
+      jc->RetrieveJobFiles(*this, src, remaining, dst.Path());
+      if (remaining.size() < paths.size()) {
+        std::set<std::string> left(remaining.begin(), remaining.end());
+        std::list<URLLocation>::iterator it = files.begin();
+        for (std::size_t n = data_files_num; n > 0; --n) {
+          if (left.find(it->Name()) == left.end()) {
+            it = files.erase(it);
+            --data_files_num;
+          } else {
+            ++it;
+          }
+        }
+      }
+    }
+
     bool ok = true;
     std::set<std::string> processed;
     for (std::list<URLLocation>::const_iterator it = files.begin(); it != files.end(); ++it) {
@@ -1062,26 +1112,29 @@ namespace Arc {
     src_.AddOption("blocksize=1048576",false);
     dst_.AddOption("blocksize=1048576",false);
 
-    if ((!data_source) || (!*data_source) ||
-        (!(*data_source)->SetURL(src_))) {
-      if(data_source) delete data_source;
-      data_source = new DataHandle(src_, uc);
+    JobFileHandles handles = AcquireFileHandles();
+    if ((!handles.source) || (!*handles.source) ||
+        (!(*handles.source)->SetURL(src_))) {
+      if(handles.source) delete handles.source;
+      handles.source = new DataHandle(src_, uc);
     }
-    DataHandle& source = *data_source;
+    DataHandle& source = *handles.source;
     if (!source) {
       logger.msg(ERROR, "Unable to initialise connection to source: %s", src.str());
+      ReleaseFileHandles(handles);
       return false;
     }
 
-    if ((!data_destination) || (!*data_destination) ||
-        (!(*data_destination)->SetURL(dst_))) {
-      if(data_destination) delete data_destination;
-      data_destination = new DataHandle(dst_, uc);
+    if ((!handles.destination) || (!*handles.destination) ||
+        (!(*handles.destination)->SetURL(dst_))) {
+      if(handles.destination) delete handles.destination;
+      handles.destination = new DataHandle(dst_, uc);
     }
-    DataHandle& destination = *data_destination;
+    DataHandle& destination = *handles.destination;
     if (!destination) {
       logger.msg(ERROR, "Unable to initialise connection to destination: %s",
                  dst.str());
+      ReleaseFileHandles(handles);
       return false;
     }
 
@@ -1106,13 +1159,12 @@ namespace Arc {
       // Reset connection because one can't be sure how failure
       // affects server and/or connection state.
       // TODO: Investigate/define DMC behavior in such case.
-      delete data_source;
-      data_source = NULL;
-      delete data_destination;
-      data_destination = NULL;
+      delete handles.source;
+      delete handles.destination;
       return noSourceFound?true:false;
     }
 
+    ReleaseFileHandles(handles);
     return true;
   }
 
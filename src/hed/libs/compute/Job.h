@@ -271,9 +271,6 @@ namespace Arc {
 
     static JobControllerPluginLoader& getLoader();
 
-    // Objects might be pointing to allocated memory upon termination, leave it as garbage.
-    static DataHandle *data_source, *data_destination;
-    
     static Logger logger;
   };
 
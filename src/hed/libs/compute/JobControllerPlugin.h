@@ -49,6 +49,20 @@ namespace Arc {
     virtual bool GetJobDescription(const Job& job, std::string& desc_str) const = 0;
     virtual bool GetURLToJobResource(const Job& job, Job::ResourceType resource, URL& url) const = 0;
 
+    /// Download many files of job in single operation
+    /**
+     * Plugins which can transfer content of job's directory efficiently
+     * may implement this method. On input \a files contains paths of
+     * files relative to \a src (as obtained for Job::STAGEOUTDIR) which
+     * are to be stored under local directory \a dstdir. Retrieved files
+     * are removed from \a files and the rest is downloaded one by one by
+     * the caller, so files which were not retrieved must not be left in
+     * \a dstdir. Default implementation retrieves nothing.
+     * \return false if not all files were retrieved.
+     * \since Added in 7.0.0.
+     **/
+    virtual bool RetrieveJobFiles(const Job& job, const URL& src, std::list<std::string>& files, const std::string& dstdir) const { return files.empty(); }
+
     virtual std::string GetGroupID() const { return ""; }
 
     virtual const std::list<std::string>& SupportedInterfaces() const { return supportedInterfaces; };
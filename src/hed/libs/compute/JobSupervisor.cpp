@@ -6,11 +6,15 @@
 
 #include <algorithm>
 #include <iostream>
+#include <map>
+#include <set>
 
 #include <unistd.h>
 
 #include <arc/CheckSum.h>
+#include <arc/DateTime.h>
 #include <arc/Logger.h>
+#include <arc/Thread.h>
 #include <arc/UserConfig.h>
 #include <arc/compute/Broker.h>
 #include <arc/compute/ComputingServiceRetriever.h>
@@ -23,14 +27,316 @@ namespace Arc {
 
   Logger JobSupervisor::logger(Logger::getRootLogger(), "JobSupervisor");
 
+  // Outcome of operation on single job
+  class JobSupervisorResult {
+  public:
+    JobSupervisorResult(void) : ok(false) {}
+    bool ok;
+    std::list<std::string> processed;
+    std::list<std::string> notprocessed;
+  };
+
+  class JobSupervisorPool;
+
+  // Set of jobs belonging to same plugin and endpoint which are
+  // processed together by one worker.
+  class JobSupervisorTask {
+  public:
+    JobSupervisorTask(JobControllerPlugin* jc, const std::string& endpoint) : jc(jc), endpoint(endpoint), pool(NULL) {}
+    JobControllerPlugin* jc;
+    std::string endpoint;
+    JobSupervisorPool* pool;
+    std::list<Job*> jobs;
+    // Used by operations processing all jobs of task at once
+    std::list<std::string> processed;
+    std::list<std::string> notprocessed;
+    // Used by operations processing job by job
+    std::map<Job*, JobSupervisorResult> results;
+  };
+
+  class JobSupervisorOperation {
+  public:
+    virtual ~JobSupervisorOperation(void) {}
+    virtual void Process(JobSupervisorTask& task) const = 0;
+    // Tells if slow processing means endpoint is not responding
+    virtual bool Limited(void) const { return true; }
+    // Called instead of Process for tasks of unresponsive endpoints
+    virtual void Skip(JobSupervisorTask& task) const {
+      for (std::list<Job*>::iterator itJ = task.jobs.begin();
+           itJ != task.jobs.end(); ++itJ) {
+        JobSupervisorResult& r = task.results[*itJ];
+        r.ok = false;
+        r.notprocessed.push_back((*itJ)->JobID);
+      }
+    }
+  };
+
+  class JobSupervisorUpdate: public JobSupervisorOperation {
+  public:
+    virtual void Process(JobSupervisorTask& task) const {
+      task.jc->UpdateJobs(task.jobs, task.processed, task.notprocessed);
+    }
+    virtual void Skip(JobSupervisorTask& task) const {
+      for (std::list<Job*>::iterator itJ = task.jobs.begin();
+           itJ != task.jobs.end(); ++itJ) {
+        task.notprocessed.push_back((*itJ)->JobID);
+      }
+    }
+  };
+
+  // Calls one of JobControllerPlugin methods for every job separately
+  class JobSupervisorPluginCall: public JobSupervisorOperation {
+  public:
+    typedef bool (JobControllerPlugin::*Method)(const std::list<Job*>&, std::list<std::string>&, std::list<std::string>&, bool) const;
+    JobSupervisorPluginCall(Method method) : method(method) {}
+    virtual void Process(JobSupervisorTask& task) const;
+    // Every call is timed separately by Process
+    virtual bool Limited(void) const { return false; }
+  private:
+    Method method;
+  };
+
+  class JobSupervisorRetrieve: public JobSupervisorOperation {
+  public:
+    JobSupervisorRetrieve(const UserConfig& usercfg, const std::map<Job*, URL>& downloaddirs, bool force)
+      : usercfg(usercfg), downloaddirs(downloaddirs), force(force) {}
+    virtual void Process(JobSupervisorTask& task) const {
+      for (std::list<Job*>::iterator itJ = task.jobs.begin();
+           itJ != task.jobs.end(); ++itJ) {
+        JobSupervisorResult& r = task.results[*itJ];
+        std::map<Job*, URL>::const_iterator itD = downloaddirs.find(*itJ);
+        r.ok = (itD != downloaddirs.end()) && (*itJ)->Retrieve(usercfg, itD->second, force);
+        (r.ok ? r.processed : r.notprocessed).push_back((*itJ)->JobID);
+      }
+    }
+    // Transfer of big files is not a sign of unresponsive endpoint
+    virtual bool Limited(void) const { return false; }
+  private:
+    const UserConfig& usercfg;
+    const std::map<Job*, URL>& downloaddirs;
+    bool force;
+  };
+
+  // State shared by worker threads processing list of tasks
+  class JobSupervisorPool {
+  public:
+    JobSupervisorPool(std::list<JobSupervisorTask>& tasks, const JobSupervisorOperation& op, EntityConsumer<Job>* consumer, int timeout)
+      : next(tasks.begin()), end(tasks.end()), op(op), consumer(consumer), timeout(timeout) {}
+    // Takes next task and processes it. Returns false if there are no more tasks.
+    bool RunTask(void);
+    static void Worker(void* arg);
+    // Tells if endpoint did not fail to respond yet
+    bool Responsive(const std::string& endpoint);
+    // Records call to endpoint which started at specified time. Endpoint
+    // is considered unresponsive if call took longer than timeout.
+    void Called(const std::string& endpoint, const Time& start);
+    std::set<std::string> unresponsive;
+    SimpleCounter workers;
+  private:
+    Glib::Mutex lock;
+    std::list<JobSupervisorTask>::iterator next;
+    std::list<JobSupervisorTask>::iterator end;
+    const JobSupervisorOperation& op;
+    EntityConsumer<Job>* consumer;
+    int timeout;
+  };
+
+  bool JobSupervisorPool::RunTask(void) {
+    JobSupervisorTask* task = NULL;
+    bool skip = false;
+    {
+      Glib::Mutex::Lock l(lock);
+      if (next == end) return false;
+      task = &(*next);
+      ++next;
+      skip = (unresponsive.find(task->endpoint) != unresponsive.end());
+    }
+    if (skip) {
+      op.Skip(*task);
+    } else {
+      task->pool = this;
+      Time start;
+      op.Process(*task);
+      if (op.Limited()) Called(task->endpoint, start);
+    }
+    if (consumer) {
+      Glib::Mutex::Lock l(lock);
+      for (std::list<Job*>::iterator itJ = task->jobs.begin();
+           itJ != task->jobs.end(); ++itJ) {
+        consumer->addEntity(**itJ);
+      }
+    }
+    return true;
+  }
+
+  void JobSupervisorPool::Worker(void* arg) {
+    JobSupervisorPool* pool = (JobSupervisorPool*)arg;
+    while (pool->RunTask()) {}
+  }
+
+  bool JobSupervisorPool::Responsive(const std::string& endpoint) {
+    Glib::Mutex::Lock l(lock);
+    return (unresponsive.find(endpoint) == unresponsive.end());
+  }
+
+  void JobSupervisorPool::Called(const std::string& endpoint, const Time& start) {
+    if ((timeout > 0) && ((Time() - start) > Period(timeout))) {
+      Glib::Mutex::Lock l(lock);
+      unresponsive.insert(endpoint);
+    }
+  }
+
+  // Endpoint is checked before every call, so jobs of unresponsive
+  // endpoint are not processed even if they belong to tasks which are
+  // already running.
+  void JobSupervisorPluginCall::Process(JobSupervisorTask& task) const {
+    for (std::list<Job*>::iterator itJ = task.jobs.begin();
+         itJ != task.jobs.end(); ++itJ) {
+      JobSupervisorResult& r = task.results[*itJ];
+      if (!task.pool->Responsive(task.endpoint)) {
+        r.ok = false;
+        r.notprocessed.push_back((*itJ)->JobID);
+        continue;
+      }
+      Time start;
+      r.ok = (task.jc->*method)(std::list<Job*>(1, *itJ), r.processed, r.notprocessed, false);
+      task.pool->Called(task.endpoint, start);
+    }
+  }
+
+  static bool IsRetrievable(const Job& job) {
+    return job.State && job.State != JobState::DELETED && job.State.IsFinished();
+  }
+
+  static bool IsRenewable(const Job& job) {
+    return job.State && job.State != JobState::FINISHED && job.State != JobState::KILLED && job.State != JobState::DELETED;
+  }
+
+  static bool IsCancellable(const Job& job) {
+    return job.State && job.State != JobState::DELETED && !job.State.IsFinished();
+  }
+
+  static bool IsCleanable(const Job& job) {
+    return job.State && job.State.IsFinished();
+  }
+
   JobSupervisor::JobSupervisor(const UserConfig& usercfg, const std::list<Job>& jobs)
-    : usercfg(usercfg) {
+    : usercfg(usercfg), maxWorkers(10), maxJobsPerTask(100), progressConsumer(NULL) {
     for (std::list<Job>::const_iterator it = jobs.begin();
          it != jobs.end(); ++it) {
       AddJob(*it);
     }
   }
 
+  void JobSupervisor::SetConcurrency(unsigned int workers, unsigned int jobsPerTask) {
+    maxWorkers = (workers > 0) ? workers : 1;
+    maxJobsPerTask = (jobsPerTask > 0) ? jobsPerTask : 1;
+  }
+
+  void JobSupervisor::MakeTasks(JobControllerPlugin* jc, const std::list<Job*>& jobs, bool byStatusURL, std::list<JobSupervisorTask>& tasks) const {
+    // Tasks are created in order of first appearance of endpoint
+    std::list<std::string> endpoints;
+    std::map<std::string, std::list<Job*> > jobsByEndpoint;
+    for (std::list<Job*>::const_iterator itJ = jobs.begin();
+         itJ != jobs.end(); ++itJ) {
+      std::string endpoint = (byStatusURL ? (*itJ)->JobStatusURL : (*itJ)->JobManagementURL).ConnectionURL();
+      std::map<std::string, std::list<Job*> >::iterator itE = jobsByEndpoint.find(endpoint);
+      if (itE == jobsByEndpoint.end()) {
+        endpoints.push_back(endpoint);
+        itE = jobsByEndpoint.insert(std::make_pair(endpoint, std::list<Job*>())).first;
+      }
+      itE->second.push_back(*itJ);
+    }
+
+    for (std::list<std::string>::iterator itE = endpoints.begin();
+         itE != endpoints.end(); ++itE) {
+      std::list<Job*>& endpointJobs = jobsByEndpoint[*itE];
+      while (!endpointJobs.empty()) {
+        tasks.push_back(JobSupervisorTask(jc, *itE));
+        std::list<Job*>::iterator itJ = endpointJobs.begin();
+        for (unsigned int n = 0; (n < maxJobsPerTask) && (itJ != endpointJobs.end()); ++n) ++itJ;
+        tasks.back().jobs.splice(tasks.back().jobs.end(), endpointJobs, endpointJobs.begin(), itJ);
+      }
+    }
+  }
+
+  void JobSupervisor::RunTasks(std::list<JobSupervisorTask>& tasks, JobSupervisorOperation& op) {
+    if (tasks.empty()) return;
+
+    JobSupervisorPool pool(tasks, op, progressConsumer, usercfg.Timeout());
+    // Calling thread is also processing tasks, so one thread less is needed.
+    unsigned int threads = std::min((std::list<JobSupervisorTask>::size_type)maxWorkers, tasks.size());
+    for (unsigned int n = 1; n < threads; ++n) {
+      if (!CreateThreadFunction(&JobSupervisorPool::Worker, &pool, &pool.workers)) {
+        logger.msg(DEBUG, "Failed to start worker thread, continuing with %u threads", n);
+        break;
+      }
+    }
+    JobSupervisorPool::Worker(&pool);
+    pool.workers.wait();
+
+    for (std::set<std::string>::iterator itE = pool.unresponsive.begin();
+         itE != pool.unresponsive.end(); ++itE) {
+      logger.msg(WARNING, "Endpoint %s did not respond within %d seconds, remaining jobs at it were not processed", *itE, usercfg.Timeout());
+    }
+  }
+
+  bool JobSupervisor::ProcessJobs(bool (*eligible)(const Job&), JobSupervisorOperation& op) {
+    notprocessed.clear();
+    processed.clear();
+    bool ok = true;
+
+    std::list<JobSupervisorTask> tasks;
+    for (JobSelectionMap::iterator it = jcJobMap.begin();
+         it != jcJobMap.end(); ++it) {
+      std::list<Job*> jobs;
+      for (std::list<Job*>::iterator itJ = it->second.first.begin();
+           itJ != it->second.first.end(); ++itJ) {
+        if (eligible(**itJ)) jobs.push_back(*itJ);
+      }
+      MakeTasks(it->first, jobs, false, tasks);
+    }
+
+    RunTasks(tasks, op);
+
+    std::map<Job*, JobSupervisorResult*> results;
+    for (std::list<JobSupervisorTask>::iterator itT = tasks.begin();
+         itT != tasks.end(); ++itT) {
+      for (std::map<Job*, JobSupervisorResult>::iterator itR = itT->results.begin();
+           itR != itT->results.end(); ++itR) {
+        results[itR->first] = &(itR->second);
+      }
+    }
+
+    // Collect results in selection order
+    for (JobSelectionMap::iterator it = jcJobMap.begin();
+         it != jcJobMap.end(); ++it) {
+      for (std::list<Job*>::iterator itJ = it->second.first.begin();
+           itJ != it->second.first.end();) {
+        std::map<Job*, JobSupervisorResult*>::iterator itR = results.find(*itJ);
+        if (itR == results.end()) {
+          notprocessed.push_back((*itJ)->JobID);
+          it->second.second.push_back(*itJ);
+          itJ = it->second.first.erase(itJ);
+          continue;
+        }
+
+        processed.splice(processed.end(), itR->second->processed);
+        notprocessed.splice(notprocessed.end(), itR->second->notprocessed);
+        if (!itR->second->ok) {
+          ok = false;
+          it->second.second.push_back(*itJ);
+          itJ = it->second.first.erase(itJ);
+        }
+        else {
+          ++itJ;
+        }
+      }
+    }
+
+    return ok;
+  }
+
   bool JobSupervisor::AddJob(const Job& job) {
     if (job.JobID.empty()) {
       logger.msg(VERBOSE, "Ignoring job, the job ID is empty");
@@ -188,9 +494,19 @@ namespace Arc {
   }
 
   void JobSupervisor::Update() {
+    std::list<JobSupervisorTask> tasks;
     for (JobSelectionMap::iterator it = jcJobMap.begin();
          it != jcJobMap.end(); ++it) {
-      it->first->UpdateJobs(it->second.first, processed, notprocessed);
+      MakeTasks(it->first, it->second.first, true, tasks);
+    }
+
+    JobSupervisorUpdate op;
+    RunTasks(tasks, op);
+
+    for (std::list<JobSupervisorTask>::iterator itT = tasks.begin();
+         itT != tasks.end(); ++itT) {
+      processed.splice(processed.end(), itT->processed);
+      notprocessed.splice(notprocessed.end(), itT->notprocessed);
     }
   }
 
@@ -208,18 +524,12 @@ namespace Arc {
   }
 
   bool JobSupervisor::Retrieve(const std::string& downloaddirprefix, bool usejobname, bool force, std::list<std::string>& downloaddirectories) {
-    notprocessed.clear();
-    processed.clear();
-    bool ok = true;
-
+    std::map<Job*, URL> downloaddirs;
     for (JobSelectionMap::iterator it = jcJobMap.begin();
          it != jcJobMap.end(); ++it) {
       for (std::list<Job*>::iterator itJ = it->second.first.begin();
-           itJ != it->second.first.end();) {
-        if (!(*itJ)->State || (*itJ)->State == JobState::DELETED || !(*itJ)->State.IsFinished()) {
-          notprocessed.push_back((*itJ)->JobID);
-          it->second.second.push_back(*itJ);
-          itJ = it->second.first.erase(itJ);
+           itJ != it->second.first.end(); ++itJ) {
+        if (!IsRetrievable(**itJ)) {
           continue;
         }
 
@@ -232,7 +542,7 @@ namespace Arc {
           downloaddirname = path.substr(pos + 1);
         }
 
-        URL downloaddir;
+        URL& downloaddir = downloaddirs[*itJ];
         if (!downloaddirprefix.empty()) {
           downloaddir = downloaddirprefix;
           if (downloaddir.Protocol() == "file") {
@@ -243,59 +553,30 @@ namespace Arc {
         } else {
           downloaddir = downloaddirname;
         }
-
-        if (!(*itJ)->Retrieve(usercfg, downloaddir, force)) {
-          ok = false;
-          notprocessed.push_back((*itJ)->JobID);
-          it->second.second.push_back(*itJ);
-          itJ = it->second.first.erase(itJ);
-        }
-        else {
-          processed.push_back((*itJ)->JobID);
-          if (downloaddir.Protocol() == "file") {
-            if (Glib::file_test(downloaddir.Path(), Glib::FILE_TEST_IS_DIR)) {
-              std::string cwd = URL(".").Path();
-              cwd.resize(cwd.size()-1);
-              if (downloaddir.Path().substr(0, cwd.size()) == cwd) {
-                downloaddirectories.push_back(downloaddir.Path().substr(cwd.size()));
-              } else {
-                downloaddirectories.push_back(downloaddir.Path());
-              }
-            }
-          } else {
-            downloaddirectories.push_back(downloaddir.str());
-          }
-          ++itJ;
-        }
       }
     }
 
-    return ok;
-  }
-
-  bool JobSupervisor::Renew() {
-    notprocessed.clear();
-    processed.clear();
-    bool ok = true;
+    JobSupervisorRetrieve op(usercfg, downloaddirs, force);
+    bool ok = ProcessJobs(&IsRetrievable, op);
 
+    // Only successfully retrieved jobs are left selected
     for (JobSelectionMap::iterator it = jcJobMap.begin();
          it != jcJobMap.end(); ++it) {
       for (std::list<Job*>::iterator itJ = it->second.first.begin();
-           itJ != it->second.first.end();) {
-        if (!(*itJ)->State || (*itJ)->State == JobState::FINISHED || (*itJ)->State == JobState::KILLED || (*itJ)->State == JobState::DELETED) {
-          notprocessed.push_back((*itJ)->JobID);
-          it->second.second.push_back(*itJ);
-          itJ = it->second.first.erase(itJ);
-          continue;
-        }
-
-        if (!it->first->RenewJobs(std::list<Job*>(1, *itJ), processed, notprocessed)) {
-          ok = false;
-          it->second.second.push_back(*itJ);
-          itJ = it->second.first.erase(itJ);
-        }
-        else {
-          ++itJ;
+           itJ != it->second.first.end(); ++itJ) {
+        const URL& downloaddir = downloaddirs[*itJ];
+        if (downloaddir.Protocol() == "file") {
+          if (Glib::file_test(downloaddir.Path(), Glib::FILE_TEST_IS_DIR)) {
+            std::string cwd = URL(".").Path();
+            cwd.resize(cwd.size()-1);
+            if (downloaddir.Path().substr(0, cwd.size()) == cwd) {
+              downloaddirectories.push_back(downloaddir.Path().substr(cwd.size()));
+            } else {
+              downloaddirectories.push_back(downloaddir.Path());
+            }
+          }
+        } else {
+          downloaddirectories.push_back(downloaddir.str());
         }
       }
     }
@@ -303,34 +584,14 @@ namespace Arc {
     return ok;
   }
 
-  bool JobSupervisor::Resume() {
-    notprocessed.clear();
-    processed.clear();
-    bool ok = true;
-
-    for (JobSelectionMap::iterator it = jcJobMap.begin();
-         it != jcJobMap.end(); ++it) {
-      for (std::list<Job*>::iterator itJ = it->second.first.begin();
-           itJ != it->second.first.end();) {
-        if (!(*itJ)->State || (*itJ)->State == JobState::FINISHED || (*itJ)->State == JobState::KILLED || (*itJ)->State == JobState::DELETED) {
-          notprocessed.push_back((*itJ)->JobID);
-          it->second.second.push_back(*itJ);
-          itJ = it->second.first.erase(itJ);
-          continue;
-        }
-
-        if (!it->first->ResumeJobs(std::list<Job*>(1, *itJ), processed, notprocessed)) {
-          ok = false;
-          it->second.second.push_back(*itJ);
-          itJ = it->second.first.erase(itJ);
-        }
-        else {
-          ++itJ;
-        }
-      }
-    }
+  bool JobSupervisor::Renew() {
+    JobSupervisorPluginCall op(&JobControllerPlugin::RenewJobs);
+    return ProcessJobs(&IsRenewable, op);
+  }
 
-    return ok;
+  bool JobSupervisor::Resume() {
+    JobSupervisorPluginCall op(&JobControllerPlugin::ResumeJobs);
+    return ProcessJobs(&IsRenewable, op);
   }
 
   bool JobSupervisor::Resubmit(int destination, const std::list<Endpoint>& services, std::list<Job>& resubmittedJobs, const std::list<std::string>& rejectedURLs) {
@@ -600,62 +861,12 @@ namespace Arc {
   }
 
   bool JobSupervisor::Cancel() {
-    notprocessed.clear();
-    processed.clear();
-    bool ok = true;
-
-    for (JobSelectionMap::iterator it = jcJobMap.begin();
-         it != jcJobMap.end(); ++it) {
-      for (std::list<Job*>::iterator itJ = it->second.first.begin();
-           itJ != it->second.first.end();) {
-        if (!(*itJ)->State || (*itJ)->State == JobState::DELETED || (*itJ)->State.IsFinished()) {
-          notprocessed.push_back((*itJ)->JobID);
-          it->second.second.push_back(*itJ);
-          itJ = it->second.first.erase(itJ);
-          continue;
-        }
-
-        if (!it->first->CancelJobs(std::list<Job*>(1, *itJ), processed, notprocessed)) {
-          ok = false;
-          it->second.second.push_back(*itJ);
-          itJ = it->second.first.erase(itJ);
-        }
-        else {
-          ++itJ;
-        }
-      }
-    }
-
-    return ok;
+    JobSupervisorPluginCall op(&JobControllerPlugin::CancelJobs);
+    return ProcessJobs(&IsCancellable, op);
   }
 
   bool JobSupervisor::Clean() {
-    notprocessed.clear();
-    processed.clear();
-    bool ok = true;
-
-    for (JobSelectionMap::iterator it = jcJobMap.begin();
-         it != jcJobMap.end(); ++it) {
-      for (std::list<Job*>::iterator itJ = it->second.first.begin();
-           itJ != it->second.first.end();) {
-        if (!(*itJ)->State || !(*itJ)->State.IsFinished()) {
-          notprocessed.push_back((*itJ)->JobID);
-          it->second.second.push_back(*itJ);
-          itJ = it->second.first.erase(itJ);
-          continue;
-        }
-
-        if (!it->first->CleanJobs(std::list<Job*>(1, *itJ), processed, notprocessed)) {
-          ok = false;
-          it->second.second.push_back(*itJ);
-          itJ = it->second.first.erase(itJ);
-        }
-        else {
-          ++itJ;
-        }
-      }
-    }
-
-    return ok;
+    JobSupervisorPluginCall op(&JobControllerPlugin::CleanJobs);
+    return ProcessJobs(&IsCleanable, op);
   }
 } // namespace Arc
@@ -15,6 +15,8 @@ namespace Arc {
   class Logger;
   class Endpoint;
   class UserConfig;
+  class JobSupervisorTask;
+  class JobSupervisorOperation;
 
   /// Abstract class used for selecting jobs with JobSupervisor
   /**
@@ -77,6 +79,36 @@ namespace Arc {
 
     ~JobSupervisor() {}
 
+    /// Set concurrency of job operations
+    /**
+     * Update, Retrieve, Renew, Resume, Cancel and Clean operations split
+     * selected jobs into tasks per endpoint and per chunk of jobs, and
+     * process those tasks on a pool of worker threads. Results are
+     * reported in same order as with sequential processing. If a call to
+     * an endpoint takes longer than UserConfig::Timeout() the endpoint is
+     * considered unresponsive and none of its remaining jobs are
+     * attempted, also not those in tasks which are already running.
+     * Retrieval of job files is not limited this way. JobControllerPlugin
+     * methods may therefore be called concurrently from different threads.
+     *
+     * @param workers maximal number of worker threads. Value 1 makes all
+     *  processing happen sequentially in calling thread. Default is 10.
+     * @param jobsPerTask maximal number of jobs in one task. Default
+     *  is 100.
+     * \since Added in 7.0.0.
+     **/
+    void SetConcurrency(unsigned int workers, unsigned int jobsPerTask = 100);
+
+    /// Set consumer receiving jobs as soon as they are processed
+    /**
+     * Every job for which an operation is done is passed to the consumer
+     * right after its task is finished, which allows results to be shown
+     * before all endpoints have responded. The consumer is called from
+     * worker threads, but calls are serialized. Pass NULL to disable.
+     * \since Added in 7.0.0.
+     **/
+    void SetProgressConsumer(EntityConsumer<Job>* consumer) { progressConsumer = consumer; }
+
     /// Add job
     /**
      * Add Job object to this JobSupervisor for job management. The Job
@@ -393,6 +425,18 @@ namespace Arc {
 
     JobControllerPluginLoader loader;
 
+    unsigned int maxWorkers;
+    unsigned int maxJobsPerTask;
+    EntityConsumer<Job>* progressConsumer;
+
+    // Split jobs into tasks per endpoint and per chunk
+    void MakeTasks(JobControllerPlugin* jc, const std::list<Job*>& jobs, bool byStatusURL, std::list<JobSupervisorTask>& tasks) const;
+    // Process tasks on pool of worker threads
+    void RunTasks(std::list<JobSupervisorTask>& tasks, JobSupervisorOperation& op);
+    // Common part of operations done job by job. Jobs not passing eligible
+    // check and jobs failed to be processed are deselected.
+    bool ProcessJobs(bool (*eligible)(const Job&), JobSupervisorOperation& op);
+
     static Logger logger;
   };
 
@@ -23,6 +23,8 @@ std::string JobControllerPluginTestACCControl::getJobDescriptionString = "";
 bool JobControllerPluginTestACCControl::resourceExist = true;
 URL JobControllerPluginTestACCControl::resourceURL = URL();
 URL JobControllerPluginTestACCControl::createURL = URL();
+int JobControllerPluginTestACCControl::updateDelay = 0;
+int JobControllerPluginTestACCControl::cancelDelay = 0;
 
 SubmissionStatus SubmitterPluginTestACCControl::submitStatus;
 bool SubmitterPluginTestACCControl::migrateStatus = true;
@@ -78,6 +78,10 @@ class JobControllerPluginTestACCControl {
     static bool resourceExist;
     static URL resourceURL;
     static URL createURL;
+    /// Delay in milliseconds applied to every UpdateJobs call
+    static int updateDelay;
+    /// Delay in milliseconds applied to every CancelJobs call
+    static int cancelDelay;
 };
 
 /**
@@ -0,0 +1,82 @@
+// -*- indent-tabs-mode: nil -*-
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <iostream>
+
+#include <arc/DateTime.h>
+#include <arc/StringConv.h>
+#include <arc/Thread.h>
+#include <arc/URL.h>
+#include <arc/UserConfig.h>
+#include <arc/compute/Job.h>
+#include <arc/compute/JobSupervisor.h>
+#include <arc/compute/TestACCControl.h>
+
+// Measures status update of jobs spread over many endpoints with
+// processing done sequentially and with default concurrency. Latency of
+// endpoints is simulated by TEST plugin. Not part of regular tests
+// because results depend on machine load. Run manually with
+// ARC_PLUGIN_PATH pointing to TEST plugin to see timings.
+
+class JobSupervisorBenchmark
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(JobSupervisorBenchmark);
+  CPPUNIT_TEST(benchUpdate);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  JobSupervisorBenchmark();
+  void tearDown() { Arc::ThreadInitializer().waitExit(); }
+  void benchUpdate();
+
+private:
+  double Update(unsigned int workers);
+  Arc::UserConfig usercfg;
+};
+
+JobSupervisorBenchmark::JobSupervisorBenchmark()
+  : usercfg(Arc::initializeCredentialsType(Arc::initializeCredentialsType::SkipCredentials)) {
+}
+
+// Returns time taken to update all jobs
+double JobSupervisorBenchmark::Update(unsigned int workers) {
+  const int endpoints_num = 20;
+  const int jobs_per_endpoint = 250;
+  Arc::JobSupervisor js(usercfg);
+  js.SetConcurrency(workers);
+  Arc::Job j;
+  j.JobStatusInterfaceName = "org.nordugrid.test";
+  j.JobManagementInterfaceName = "org.nordugrid.test";
+  for (int n = 0; n < endpoints_num * jobs_per_endpoint; ++n) {
+    std::string endpoint = "http://test" + Arc::tostring(n % endpoints_num) + ".nordugrid.org";
+    j.JobID = endpoint + "/1234567890test" + Arc::tostring(n);
+    j.JobStatusURL = Arc::URL(endpoint);
+    j.JobManagementURL = Arc::URL(endpoint);
+    js.AddJob(j);
+  }
+  Arc::Time start;
+  js.Update();
+  Arc::Period elapsed = Arc::Time() - start;
+  CPPUNIT_ASSERT_EQUAL(endpoints_num * jobs_per_endpoint, (int)js.GetIDsProcessed().size());
+  return elapsed.GetPeriod() + elapsed.GetPeriodNanoseconds() / 1000000000.0;
+}
+
+void JobSupervisorBenchmark::benchUpdate() {
+  // Every query to endpoint takes 100 ms
+  Arc::JobControllerPluginTestACCControl::updateDelay = 100;
+  double sequential = Update(1);
+  double concurrent = Update(10);
+  Arc::JobControllerPluginTestACCControl::updateDelay = 0;
+
+  std::cout << std::endl << "Update of 5000 jobs at 20 endpoints: sequential "
+            << (int)(sequential * 1000) << " ms, concurrent "
+            << (int)(concurrent * 1000) << " ms" << std::endl;
+  CPPUNIT_ASSERT(concurrent < sequential);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(JobSupervisorBenchmark);
@@ -6,6 +6,7 @@
 
 #include <stdlib.h>
 
+#include <arc/StringConv.h>
 #include <arc/URL.h>
 #include <arc/UserConfig.h>
 #include <arc/Utils.h>
@@ -26,6 +27,9 @@ class JobSupervisorTest
   CPPUNIT_TEST(TestCancel);
   CPPUNIT_TEST(TestClean);
   CPPUNIT_TEST(TestSelector);
+  CPPUNIT_TEST(TestConcurrentUpdate);
+  CPPUNIT_TEST(TestUnresponsiveEndpoint);
+  CPPUNIT_TEST(TestSlowEndpoint);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -41,6 +45,9 @@ public:
   void TestCancel();
   void TestClean();
   void TestSelector();
+  void TestConcurrentUpdate();
+  void TestUnresponsiveEndpoint();
+  void TestSlowEndpoint();
 
 private:
   Arc::UserConfig usercfg;
@@ -343,4 +350,97 @@ void JobSupervisorTest::TestSelector()
   delete js;
 }
 
+void JobSupervisorTest::TestConcurrentUpdate()
+{
+  js = new Arc::JobSupervisor(usercfg);
+
+  // Two jobs on each of ten endpoints
+  std::list<std::string> ids;
+  for (int i = 0; i < 20; ++i) {
+    std::string endpoint = "http://test" + Arc::tostring(i/2) + ".nordugrid.org";
+    j.JobID = endpoint + "/1234567890test" + Arc::tostring(i);
+    j.JobStatusURL = Arc::URL(endpoint);
+    j.JobManagementURL = Arc::URL(endpoint);
+    CPPUNIT_ASSERT(js->AddJob(j));
+    ids.push_back(j.JobID);
+  }
+
+  // Sequential processing would take 2 seconds
+  Arc::JobControllerPluginTestACCControl::updateDelay = 200;
+  Arc::Time start;
+  js->Update();
+  Arc::Period elapsed = Arc::Time() - start;
+  Arc::JobControllerPluginTestACCControl::updateDelay = 0;
+
+  CPPUNIT_ASSERT(elapsed < Arc::Period(1));
+  CPPUNIT_ASSERT(ids == js->GetIDsProcessed());
+  CPPUNIT_ASSERT_EQUAL(0, (int)js->GetIDsNotProcessed().size());
+
+  delete js;
+
+  j.JobStatusURL = Arc::URL("http://test.nordugrid.org");
+  j.JobManagementURL = Arc::URL("http://test.nordugrid.org");
+}
+
+void JobSupervisorTest::TestUnresponsiveEndpoint()
+{
+  Arc::UserConfig shortcfg(Arc::initializeCredentialsType(Arc::initializeCredentialsType::SkipCredentials));
+  shortcfg.Timeout(1);
+  js = new Arc::JobSupervisor(shortcfg);
+  // All jobs in one task, so only checks between jobs can stop processing
+  js->SetConcurrency(1, 100);
+
+  j.State = Arc::JobStateTEST(Arc::JobState::RUNNING);
+  std::list<std::string> ids;
+  for (int i = 0; i < 4; ++i) {
+    j.JobID = "http://test.nordugrid.org/1234567890test" + Arc::tostring(i);
+    CPPUNIT_ASSERT(js->AddJob(j));
+    ids.push_back(j.JobID);
+  }
+
+  // First call exceeds timeout, remaining jobs must not be attempted
+  Arc::JobControllerPluginTestACCControl::cancelStatus = true;
+  Arc::JobControllerPluginTestACCControl::cancelDelay = 1200;
+  Arc::Time start;
+  CPPUNIT_ASSERT(!js->Cancel());
+  Arc::Period elapsed = Arc::Time() - start;
+  Arc::JobControllerPluginTestACCControl::cancelDelay = 0;
+
+  CPPUNIT_ASSERT(elapsed < Arc::Period(2));
+  CPPUNIT_ASSERT_EQUAL(1, (int)js->GetIDsProcessed().size());
+  CPPUNIT_ASSERT_EQUAL(ids.front(), js->GetIDsProcessed().front());
+  ids.pop_front();
+  CPPUNIT_ASSERT(ids == js->GetIDsNotProcessed());
+
+  delete js;
+}
+
+void JobSupervisorTest::TestSlowEndpoint()
+{
+  Arc::UserConfig shortcfg(Arc::initializeCredentialsType(Arc::initializeCredentialsType::SkipCredentials));
+  shortcfg.Timeout(1);
+  js = new Arc::JobSupervisor(shortcfg);
+  // Two tasks for same endpoint processed one after another
+  js->SetConcurrency(1, 3);
+
+  j.State = Arc::JobStateTEST(Arc::JobState::RUNNING);
+  std::list<std::string> ids;
+  for (int i = 0; i < 6; ++i) {
+    j.JobID = "http://test.nordugrid.org/1234567890test" + Arc::tostring(i);
+    CPPUNIT_ASSERT(js->AddJob(j));
+    ids.push_back(j.JobID);
+  }
+
+  // Every task takes longer than timeout, but every single call is fast enough
+  Arc::JobControllerPluginTestACCControl::cancelStatus = true;
+  Arc::JobControllerPluginTestACCControl::cancelDelay = 400;
+  CPPUNIT_ASSERT(js->Cancel());
+  Arc::JobControllerPluginTestACCControl::cancelDelay = 0;
+
+  CPPUNIT_ASSERT(ids == js->GetIDsProcessed());
+  CPPUNIT_ASSERT_EQUAL(0, (int)js->GetIDsNotProcessed().size());
+
+  delete js;
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(JobSupervisorTest);
@@ -4,7 +4,12 @@
 #include <config.h>
 #endif
 
+#include <algorithm>
 #include <list>
+#include <map>
+#include <sys/stat.h>
+
+#include <glibmm/thread.h>
 
 #include <arc/Logger.h>
 #include <arc/XMLNode.h>
@@ -293,6 +298,110 @@ namespace Arc {
     return gfal_handle->Transfer3rdParty(source, destination, callback);
   }
 
+  // Index of DMC plugins used by DataPointLoader. Plugins are taken from
+  // *.apd descriptors once and URL schemes are assigned to plugins as they
+  // get resolved. So only modules which are really needed are loaded and
+  // creating handle for already seen scheme costs one plugin instantiation.
+  // Index is rebuilt if content of plugin directories changes.
+  class DataPointIndex {
+   public:
+    class Plugin {
+     public:
+      std::string module;
+      std::string name;
+    };
+    DataPointIndex(void): checked(0) {};
+    /// Plugins to try for scheme in order of preference. Modules which have
+    /// no descriptors and hence must be loaded to find their plugins are
+    /// returned separately.
+    void Candidates(PluginsFactory& factory, const std::string& scheme, std::list<Plugin>& plugins,
+                    std::list<std::string>& undescribed);
+    /// Remember plugin which accepted scheme
+    void Found(const std::string& scheme, const Plugin& plugin);
+   private:
+    // How often to check plugin directories for changes
+    static const time_t check_interval = 10;
+    Glib::Mutex lock;
+    time_t checked;
+    std::map<std::string, time_t> paths;
+    // DMC plugins sorted by priority
+    std::list<Plugin> plugins;
+    std::map<std::string, Plugin> schemes;
+    // Modules without descriptors
+    std::list<std::string> undescribed;
+    void Refresh(PluginsFactory& factory);
+  };
+
+  void DataPointIndex::Refresh(PluginsFactory& factory) {
+    time_t now = time(NULL);
+    if ((checked != 0) && (now < checked + check_interval)) return;
+    checked = now;
+    std::map<std::string, time_t> current;
+    std::list<std::string> dirs = FinderLoader::GetPluginPaths();
+    for (std::list<std::string>::iterator dir = dirs.begin(); dir != dirs.end(); ++dir) {
+      struct stat st;
+      current[*dir] = (::stat(dir->c_str(), &st) == 0) ? st.st_mtime : 0;
+    }
+    if (!plugins.empty() && (current == paths)) return;
+    paths = current;
+    schemes.clear();
+    plugins.clear();
+    undescribed.clear();
+    std::list<std::string> names = FinderLoader::GetLibrariesList();
+    std::list<ModuleDesc> modules;
+    factory.scan(names, modules);
+    for (std::list<std::string>::iterator name = names.begin(); name != names.end(); ++name) {
+      std::list<ModuleDesc>::iterator module = modules.begin();
+      for (; module != modules.end(); ++module) {
+        if (module->name == *name) break;
+      }
+      if (module == modules.end()) undescribed.push_back(*name);
+    }
+    PluginsFactory::FilterByKind("HED:DMC", modules);
+    std::list<std::pair<uint32_t, Plugin> > sorted;
+    for (std::list<ModuleDesc>::iterator module = modules.begin(); module != modules.end(); ++module) {
+      for (std::list<PluginDesc>::iterator desc = module->plugins.begin(); desc != module->plugins.end(); ++desc) {
+        Plugin plugin;
+        plugin.module = module->name;
+        plugin.name = desc->name;
+        std::list<std::pair<uint32_t, Plugin> >::iterator pos = sorted.begin();
+        for (; pos != sorted.end(); ++pos) {
+          if (desc->priority > pos->first) break;
+        }
+        sorted.insert(pos, std::pair<uint32_t, Plugin>(desc->priority, plugin));
+      }
+    }
+    for (std::list<std::pair<uint32_t, Plugin> >::iterator p = sorted.begin(); p != sorted.end(); ++p) {
+      plugins.push_back(p->second);
+    }
+  }
+
+  void DataPointIndex::Candidates(PluginsFactory& factory, const std::string& scheme, std::list<Plugin>& candidates,
+                                  std::list<std::string>& modules) {
+    Glib::Mutex::Lock l(lock);
+    Refresh(factory);
+    modules = undescribed;
+    std::map<std::string, Plugin>::iterator known = schemes.find(scheme);
+    if (known != schemes.end()) {
+      candidates.push_back(known->second);
+      return;
+    }
+    // Most plugins are named after scheme they handle, so try those first
+    for (std::list<Plugin>::iterator plugin = plugins.begin(); plugin != plugins.end(); ++plugin) {
+      if (plugin->name == scheme) candidates.push_back(*plugin);
+    }
+    for (std::list<Plugin>::iterator plugin = plugins.begin(); plugin != plugins.end(); ++plugin) {
+      if (plugin->name != scheme) candidates.push_back(*plugin);
+    }
+  }
+
+  void DataPointIndex::Found(const std::string& scheme, const Plugin& plugin) {
+    Glib::Mutex::Lock l(lock);
+    schemes[scheme] = plugin;
+  }
+
+  static DataPointIndex dmc_index;
+
   DataPointLoader::DataPointLoader()
     : Loader(BaseConfig().MakeConfig(Config()).Parent()) {}
 
@@ -300,10 +409,41 @@ namespace Arc {
 
   DataPoint* DataPointLoader::load(const URL& url, const UserConfig& usercfg) {
     DataPointPluginArgument arg(url, usercfg);
-    factory_->load(FinderLoader::GetLibrariesList(), "HED:DMC");
-    DataPoint* point = factory_->GetInstance<DataPoint>("HED:DMC", &arg, false);
-    if(!point) logger.msg(Arc::VERBOSE, "Failed to load plugin for URL %s", url.str());
-    return point;
+    std::list<DataPointIndex::Plugin> candidates;
+    std::list<std::string> undescribed;
+    dmc_index.Candidates(*factory_, url.Protocol(), candidates, undescribed);
+    for (std::list<DataPointIndex::Plugin>::iterator plugin = candidates.begin();
+         plugin != candidates.end(); ++plugin) {
+      // Module is only loaded when first needed
+      if (!factory_->load(plugin->module, "HED:DMC")) continue;
+      DataPoint* point = factory_->GetInstance<DataPoint>("HED:DMC", plugin->name, &arg, false);
+      if (point) {
+        dmc_index.Found(url.Protocol(), *plugin);
+        return point;
+      }
+    }
+    // Modules without descriptors are not in index. Plugins of other
+    // modules were already tried above, so only these are probed here.
+    if (!undescribed.empty() && factory_->load(undescribed, "HED:DMC")) {
+      std::list<ModuleDesc> loaded;
+      factory_->report(loaded);
+      for (std::list<ModuleDesc>::iterator module = loaded.begin(); module != loaded.end(); ++module) {
+        if (std::find(undescribed.begin(), undescribed.end(), module->name) == undescribed.end()) continue;
+        for (std::list<PluginDesc>::iterator desc = module->plugins.begin(); desc != module->plugins.end(); ++desc) {
+          if (desc->kind != "HED:DMC") continue;
+          DataPoint* point = factory_->GetInstance<DataPoint>("HED:DMC", desc->name, &arg, false);
+          if (point) {
+            DataPointIndex::Plugin plugin;
+            plugin.module = module->name;
+            plugin.name = desc->name;
+            dmc_index.Found(url.Protocol(), plugin);
+            return point;
+          }
+        }
+      }
+    }
+    logger.msg(Arc::VERBOSE, "Failed to load plugin for URL %s", url.str());
+    return NULL;
   }
 
   DataPointLoader& DataHandle::getLoader() {
@@ -17,52 +17,85 @@ namespace Arc {
 
   Logger URLMap::logger(Logger::getRootLogger(), "URLMap");
 
-  URLMap::URLMap() {}
+  URLMap::URLMap() : nodes(1) {}
 
   URLMap::~URLMap() {}
 
+  int URLMap::find(const std::string& url) const {
+    // Templates are matched as plain string prefixes. Because protocol and
+    // host come first in URL, first levels of tree effectively split
+    // templates per protocol and host. Walk follows url as deep as tree
+    // allows and picks earliest added template on the way, which is what
+    // checking templates one by one in order of addition would give.
+    if (nodes.empty()) return -1;
+    const prefix_node* node = &nodes[0];
+    int found = node->entry;
+    for (std::string::size_type p = 0; p < url.length(); ++p) {
+      std::map<char, unsigned int>::const_iterator child = node->children.find(url[p]);
+      if (child == node->children.end()) break;
+      node = &nodes[child->second];
+      // nothing below can be better than already found entry
+      if ((found >= 0) && (node->first > found)) break;
+      if ((node->entry >= 0) && ((found < 0) || (node->entry < found))) found = node->entry;
+    }
+    return found;
+  }
+
   bool URLMap::map(URL& url) const {
-    for (std::list<map_entry>::const_iterator i = entries.begin();
-         i != entries.end(); ++i)
-      if (url.str().substr(0, i->initial.str().length()) == i->initial.str()) {
-        std::string tmp_url = url.str();
-        tmp_url.replace(0, i->initial.str().length(), i->replacement.str());
-        URL newurl = tmp_url;
-        /* must return semi-valid url */
-        if (!newurl) {
-          logger.msg(Arc::ERROR, "Can't use URL %s", tmp_url);
-          return false;
-        }
-        if (newurl.Protocol() == "file") { /* local file - check permissions */
-          int h = ::open(newurl.Path().c_str(), O_RDONLY);
-          if (h == -1) {
-            logger.msg(ERROR, "file %s is not accessible", newurl.Path());
-            return false;
-          }
-          close(h);
-          if (i->access) { /* how it should be accessed on nodes */
-            tmp_url.replace(0, i->replacement.str().length(), i->access.str());
-            newurl = tmp_url;
-            newurl.ChangeProtocol("link");
-          }
-        }
-        logger.msg(INFO, "Mapping %s to %s", url.str(), newurl.str());
-        url = newurl;
-        return true;
+    std::string tmp_url = url.str();
+    int n = find(tmp_url);
+    if (n < 0) return false;
+    const map_entry& i = entries[n];
+    tmp_url.replace(0, i.initial_str.length(), i.replacement_str);
+    URL newurl = tmp_url;
+    /* must return semi-valid url */
+    if (!newurl) {
+      logger.msg(Arc::ERROR, "Can't use URL %s", tmp_url);
+      return false;
+    }
+    if (newurl.Protocol() == "file") { /* local file - check permissions */
+      int h = ::open(newurl.Path().c_str(), O_RDONLY);
+      if (h == -1) {
+        logger.msg(ERROR, "file %s is not accessible", newurl.Path());
+        return false;
       }
-    return false;
+      close(h);
+      if (i.access) { /* how it should be accessed on nodes */
+        tmp_url.replace(0, i.replacement_str.length(), i.access_str);
+        newurl = tmp_url;
+        newurl.ChangeProtocol("link");
+      }
+    }
+    logger.msg(INFO, "Mapping %s to %s", url.str(), newurl.str());
+    url = newurl;
+    return true;
   }
 
   bool URLMap::local(const URL& url) const {
-    for (std::list<map_entry>::const_iterator i = entries.begin();
-         i != entries.end(); ++i)
-      if (url.str().substr(0, i->initial.str().length()) == i->initial.str())
-        return true;
-    return false;
+    return (find(url.str()) >= 0);
   }
 
   void URLMap::add(const URL& templ, const URL& repl, const URL& accs) {
+    int n = entries.size();
     entries.push_back(map_entry(templ, repl, accs));
+    const std::string& initial = entries.back().initial_str;
+    if (nodes.empty()) nodes.resize(1);
+    unsigned int node = 0;
+    if (nodes[node].first < 0) nodes[node].first = n;
+    for (std::string::size_type p = 0; p < initial.length(); ++p) {
+      std::map<char, unsigned int>::iterator child = nodes[node].children.find(initial[p]);
+      if (child != nodes[node].children.end()) {
+        node = child->second;
+      } else {
+        unsigned int new_node = nodes.size();
+        // push_back may reallocate, so nodes[node] is not kept as reference
+        nodes.push_back(prefix_node());
+        nodes[node].children[initial[p]] = new_node;
+        node = new_node;
+      }
+      if (nodes[node].first < 0) nodes[node].first = n;
+    }
+    if (nodes[node].entry < 0) nodes[node].entry = n;
   }
 
 } // namespace Arc
@@ -4,6 +4,9 @@
 #define __ARC_URLMAP_H__
 
 #include <list>
+#include <map>
+#include <string>
+#include <vector>
 
 #include <arc/URL.h>
 #include <arc/Logger.h>
@@ -26,14 +29,35 @@ namespace Arc {
       URL initial;
       URL replacement;
       URL access;
+      // String representations are kept to avoid rendering URLs on every match
+      std::string initial_str;
+      std::string replacement_str;
+      std::string access_str;
       map_entry() {}
       map_entry(const URL& templ, const URL& repl, const URL& accs = URL())
         : initial(templ),
           replacement(repl),
-          access(accs) {}
+          access(accs),
+          initial_str(templ.str()),
+          replacement_str(repl.str()),
+          access_str(accs ? accs.str() : std::string()) {}
     };
-    std::list<map_entry> entries;
+    // Node of prefix tree built from templates. Nodes refer to each other
+    // by index so that whole map can be copied as a value.
+    class prefix_node {
+    public:
+      std::map<char, unsigned int> children;
+      // index of first entry whose template ends at this node or -1
+      int entry;
+      // smallest index of entry ending at this node or below it
+      int first;
+      prefix_node() : entry(-1), first(-1) {}
+    };
+    std::vector<map_entry> entries;
+    std::vector<prefix_node> nodes;
     static Logger logger;
+    /// Index of first added entry whose template is prefix of url or -1.
+    int find(const std::string& url) const;
   public:
     /// Construct an empty URLMap.
     URLMap();
@@ -60,6 +84,7 @@ namespace Arc {
     /// Add an entry to the URLMap.
     /**
      * All URLs matching templ will have the templ part replaced by repl.
+     * If several templates match URL, the one added first is used.
      * @param templ template to replace, for example gsiftp://se.org/files
      * @param repl replacement for template, for example /export/grid/files
      * @param accs replacement path if it differs in the place the file will
@@ -0,0 +1,63 @@
+// -*- indent-tabs-mode: nil -*-
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <iostream>
+#include <string>
+
+#include <sys/time.h>
+
+#include <arc/StringConv.h>
+#include <arc/UserConfig.h>
+#include <arc/data/DataHandle.h>
+
+// Measures how many DataHandle objects can be created per second. Not part
+// of regular tests because results depend on machine load. Run manually with
+// ARC_PLUGIN_PATH pointing to directory with file DMC, e.g.
+//   ARC_PLUGIN_PATH=../../../dmc/file/.libs ./DataHandleBenchmark
+
+class DataHandleBenchmark
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(DataHandleBenchmark);
+  CPPUNIT_TEST(benchCreate);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void benchCreate();
+};
+
+static double Now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+void DataHandleBenchmark::benchCreate() {
+  const int handles = 100000;
+  Arc::UserConfig usercfg(Arc::initializeCredentialsType(Arc::initializeCredentialsType::SkipCredentials));
+
+  // First handle loads plugin and is not counted
+  {
+    Arc::DataHandle handle(Arc::URL("file:///tmp/file"), usercfg);
+    CPPUNIT_ASSERT(handle);
+  }
+
+  int created = 0;
+  double start = Now();
+  for (int n = 0; n < handles; ++n) {
+    Arc::DataHandle handle(Arc::URL("file:///tmp/file" + Arc::tostring(n)), usercfg);
+    if (handle) ++created;
+  }
+  double elapsed = Now() - start;
+
+  std::cout << std::endl << created << " handles in " << (int)(elapsed * 1000) << " ms, "
+            << (int)(created / elapsed) << " handles/s" << std::endl;
+  CPPUNIT_ASSERT_EQUAL(handles, created);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DataHandleBenchmark);
@@ -0,0 +1,82 @@
+// -*- indent-tabs-mode: nil -*-
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/time.h>
+
+#include <arc/StringConv.h>
+#include <arc/data/URLMap.h>
+
+// Measures URLMap lookups for big map compared to checking every template
+// in order as URLMap used to do. Not part of regular tests because results
+// depend on machine load. Run manually to see timings.
+
+class URLMapBenchmark
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(URLMapBenchmark);
+  CPPUNIT_TEST(benchLocal);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void benchLocal();
+};
+
+static double Now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+void URLMapBenchmark::benchLocal() {
+  const int templates_num = 500;
+  const int lookups = 200000;
+  Arc::URLMap map;
+  std::vector<Arc::URL> templates;
+  for (int n = 0; n < templates_num; ++n) {
+    Arc::URL templ("gsiftp://se" + Arc::tostring(n % 50) + ".grid.org/data/vo" +
+                   Arc::tostring(n) + "/");
+    map.add(templ, Arc::URL("file:///export/se" + Arc::tostring(n)));
+    templates.push_back(templ);
+  }
+  std::vector<Arc::URL> urls;
+  for (int n = 0; n < 1000; ++n) {
+    urls.push_back(Arc::URL("gsiftp://se" + Arc::tostring(n % 60) + ".grid.org/data/vo" +
+                            Arc::tostring(n % 700) + "/file" + Arc::tostring(n)));
+  }
+
+  int found = 0;
+  double start = Now();
+  for (int n = 0; n < lookups; ++n) {
+    if (map.local(urls[n % urls.size()])) ++found;
+  }
+  double compiled = Now() - start;
+
+  int found_ordered = 0;
+  start = Now();
+  for (int n = 0; n < lookups; ++n) {
+    const Arc::URL& url = urls[n % urls.size()];
+    for (std::vector<Arc::URL>::const_iterator t = templates.begin(); t != templates.end(); ++t) {
+      if (url.str().substr(0, t->str().length()) == t->str()) {
+        ++found_ordered;
+        break;
+      }
+    }
+  }
+  double ordered = Now() - start;
+
+  std::cout << std::endl << lookups << " lookups in " << templates_num << " templates: "
+            << (int)(compiled * 1000) << " ms, ordered: " << (int)(ordered * 1000)
+            << " ms" << std::endl;
+  CPPUNIT_ASSERT_EQUAL(found_ordered, found);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(URLMapBenchmark);
@@ -0,0 +1,116 @@
+// -*- indent-tabs-mode: nil -*-
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <vector>
+
+#include <arc/StringConv.h>
+#include <arc/data/URLMap.h>
+
+class URLMapTest
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(URLMapTest);
+  CPPUNIT_TEST(testEmpty);
+  CPPUNIT_TEST(testMap);
+  CPPUNIT_TEST(testOrder);
+  CPPUNIT_TEST(testCopy);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testEmpty();
+  void testMap();
+  void testOrder();
+  void testCopy();
+};
+
+void URLMapTest::testEmpty() {
+  Arc::URLMap map;
+  CPPUNIT_ASSERT(!map);
+  Arc::URL url("gsiftp://se.org/files/file1");
+  CPPUNIT_ASSERT(!map.local(url));
+  CPPUNIT_ASSERT(!map.map(url));
+  CPPUNIT_ASSERT_EQUAL(std::string("gsiftp://se.org:2811/files/file1"), url.str());
+}
+
+void URLMapTest::testMap() {
+  Arc::URLMap map;
+  map.add(Arc::URL("gsiftp://se.org/files"), Arc::URL("http://cache.org/se"));
+  CPPUNIT_ASSERT(map);
+  Arc::URL url("gsiftp://se.org/files/file1");
+  CPPUNIT_ASSERT(map.local(url));
+  CPPUNIT_ASSERT(map.map(url));
+  CPPUNIT_ASSERT_EQUAL(std::string("http://cache.org:80/se/file1"), url.str());
+  url = Arc::URL("gsiftp://se2.org/files/file1");
+  CPPUNIT_ASSERT(!map.local(url));
+  CPPUNIT_ASSERT(!map.map(url));
+  // templates are matched as string prefixes
+  url = Arc::URL("gsiftp://se.org/files2/file1");
+  CPPUNIT_ASSERT(map.map(url));
+  CPPUNIT_ASSERT_EQUAL(std::string("http://cache.org:80/se2/file1"), url.str());
+}
+
+// Same result as checking templates one by one in order they were added
+static int FirstMatch(const std::vector<std::string>& templates, const std::string& url) {
+  for (std::vector<std::string>::size_type n = 0; n < templates.size(); ++n) {
+    if (url.compare(0, templates[n].length(), templates[n]) == 0) return (int)n;
+  }
+  return -1;
+}
+
+void URLMapTest::testOrder() {
+  // Shorter template added later must not override longer one added first
+  // and vice versa.
+  Arc::URLMap map;
+  map.add(Arc::URL("gsiftp://se.org/files/a"), Arc::URL("http://one.org/a"));
+  map.add(Arc::URL("gsiftp://se.org/files"), Arc::URL("http://two.org/b"));
+  map.add(Arc::URL("gsiftp://se.org/files/a/b"), Arc::URL("http://three.org/c"));
+  Arc::URL url("gsiftp://se.org/files/a/b/file");
+  CPPUNIT_ASSERT(map.map(url));
+  CPPUNIT_ASSERT_EQUAL(std::string("http://one.org:80/a/b/file"), url.str());
+  url = Arc::URL("gsiftp://se.org/files/c");
+  CPPUNIT_ASSERT(map.map(url));
+  CPPUNIT_ASSERT_EQUAL(std::string("http://two.org:80/b/c"), url.str());
+
+  // Compare with ordered matching for many overlapping templates
+  Arc::URLMap big;
+  std::vector<std::string> templates;
+  for (int n = 0; n < 200; ++n) {
+    Arc::URL templ("gsiftp://se" + Arc::tostring(n % 7) + ".org/d" +
+                   Arc::tostring(n % 13) + "/" + Arc::tostring(n));
+    big.add(templ, Arc::URL("http://cache.org/" + Arc::tostring(n) + "_"));
+    templates.push_back(templ.str());
+  }
+  for (int n = 0; n < 2000; ++n) {
+    Arc::URL url("gsiftp://se" + Arc::tostring(n % 11) + ".org/d" +
+                 Arc::tostring(n % 17) + "/" + Arc::tostring(n % 300) + "/file");
+    int expected = FirstMatch(templates, url.str());
+    CPPUNIT_ASSERT_EQUAL(expected >= 0, big.local(url));
+    if (expected < 0) continue;
+    CPPUNIT_ASSERT(big.map(url));
+    CPPUNIT_ASSERT(url.str().find("http://cache.org:80/" + Arc::tostring(expected) + "_") == 0);
+  }
+}
+
+void URLMapTest::testCopy() {
+  Arc::URLMap copy;
+  {
+    Arc::URLMap map;
+    map.add(Arc::URL("gsiftp://se.org/files"), Arc::URL("http://cache.org/se"));
+    copy = map;
+  }
+  copy.add(Arc::URL("gsiftp://se2.org/files"), Arc::URL("http://cache2.org/se"));
+  Arc::URL url("gsiftp://se.org/files/file1");
+  CPPUNIT_ASSERT(copy.map(url));
+  CPPUNIT_ASSERT_EQUAL(std::string("http://cache.org:80/se/file1"), url.str());
+  url = Arc::URL("gsiftp://se2.org/files/file1");
+  CPPUNIT_ASSERT(copy.map(url));
+  CPPUNIT_ASSERT_EQUAL(std::string("http://cache2.org:80/se/file1"), url.str());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(URLMapTest);
@@ -23,12 +23,12 @@ namespace Arc {
     return true;
   }
 
-  const std::list<std::string> FinderLoader::GetLibrariesList(void) {
+  const std::list<std::string> FinderLoader::GetPluginPaths(void) {
     BaseConfig basecfg;
     NS ns;
     Config cfg(ns);
     basecfg.MakeConfig(cfg);
-    std::list<std::string> names;
+    std::list<std::string> paths;
 
     for (XMLNode n = cfg["ModuleManager"]; n; ++n) {
       for (XMLNode m = n["Path"]; m; ++m) {
@@ -36,16 +36,26 @@ namespace Arc {
         if ((std::string)m == "/usr/lib" || (std::string)m == "/usr/lib64" ||
             (std::string)m == "/usr/bin" || (std::string)m == "/usr/libexec")
           continue;
-        try {
-          Glib::Dir dir((std::string)m);
-          for (Glib::DirIterator file = dir.begin();
-                                file != dir.end(); file++) {
-            std::string name = *file;
-            if(name_is_plugin(name)) names.push_back(name);
-          }
-        } catch (Glib::FileError&) {}
+        paths.push_back((std::string)m);
       }
     }
+    return paths;
+  }
+
+  const std::list<std::string> FinderLoader::GetLibrariesList(void) {
+    std::list<std::string> paths = GetPluginPaths();
+    std::list<std::string> names;
+
+    for (std::list<std::string>::iterator path = paths.begin(); path != paths.end(); ++path) {
+      try {
+        Glib::Dir dir(*path);
+        for (Glib::DirIterator file = dir.begin();
+                              file != dir.end(); file++) {
+          std::string name = *file;
+          if(name_is_plugin(name)) names.push_back(name);
+        }
+      } catch (Glib::FileError&) {}
+    }
     return names;
   }
 
@@ -21,6 +21,8 @@ namespace Arc {
   public:
     //static const PluginList GetPluginList(const std::string& kind);
     static const std::list<std::string> GetLibrariesList(void);
+    /// Directories in which GetLibrariesList() looks for modules
+    static const std::list<std::string> GetPluginPaths(void);
   };
 
 } // namespace Arc
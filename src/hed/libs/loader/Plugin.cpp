@@ -663,12 +663,13 @@ namespace Arc {
   }
 
   void PluginsFactory::report(std::list<ModuleDesc>& descs) {
+    Glib::Mutex::Lock lock(lock_);
     modules_t_::miterator m = modules_;
     for(;m;++m) {
       ModuleDesc md;
       md.name = m->first;
       for(std::list<descriptor_t_>::iterator d = m->second.plugins.begin();
-                        d != m->second.plugins.end();++m) {
+                        d != m->second.plugins.end();++d) {
         md.plugins.push_back(d->desc_i);
       };
       descs.push_back(md);
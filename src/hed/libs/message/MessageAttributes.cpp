@@ -4,94 +4,371 @@
 
 // MessageAttributes.h
 
+#include <algorithm>
+#include <set>
+
+#include <arc/Thread.h>
+
 #include "MessageAttributes.h"
 
 namespace Arc {
 
-  AttributeIterator::AttributeIterator(){
+  // Registry of interned keys is split into independently locked
+  // stripes. Keys are never removed, so pointers to them stay valid.
+  static const unsigned int key_stripes_num = 16;
+
+  struct KeyStripe {
+    Glib::Mutex lock;
+    std::set<std::string> keys;
+  };
+
+  static KeyStripe* key_stripes(void) {
+    static KeyStripe stripes[key_stripes_num];
+    return stripes;
+  }
+
+  static unsigned int key_hash(const std::string& key) {
+    unsigned int hash = 2166136261U;
+    for (std::string::size_type n = 0; n < key.length(); ++n)
+      hash = (hash ^ (unsigned char)key[n]) * 16777619U;
+    return hash;
+  }
+
+  // Keys used by ARC components for most of messages, including names
+  // of common HTTP headers as stored by HTTP MCC. These are interned in
+  // advance, so attributes set using strings do not need own copies of
+  // them. Set is never modified after creation and needs no locking.
+  static const char* const known_key_names[] = {
+    "ENDPOINT", "HTTP:CODE", "HTTP:ENDPOINT", "HTTP:KEEPALIVE", "HTTP:METHOD",
+    "HTTP:RANGEEND", "HTTP:RANGESTART", "HTTP:REASON",
+    "HTTP:accept", "HTTP:accept-encoding", "HTTP:authorization", "HTTP:cache-control",
+    "HTTP:connection", "HTTP:content-encoding", "HTTP:content-length",
+    "HTTP:content-range", "HTTP:content-type", "HTTP:cookie", "HTTP:date",
+    "HTTP:etag", "HTTP:expect", "HTTP:host", "HTTP:keep-alive",
+    "HTTP:last-modified", "HTTP:location", "HTTP:range", "HTTP:server",
+    "HTTP:soapaction", "HTTP:transfer-encoding", "HTTP:user-agent", "HTTP:vary",
+    "PLEXER:EXTENSION", "PLEXER:PATTERN", "SEC:LOCALID", "SOAP:ENDPOINT",
+    "TCP:ENDPOINT", "TCP:HOST", "TCP:PORT", "TCP:REMOTEHOST", "TCP:REMOTEPORT",
+    "TLS:CADN", "TLS:IDENTITYDN", "TLS:LOCALDN", "TLS:PEERDN", NULL
+  };
+
+  class KnownKeys {
+  public:
+    std::vector<std::string> keys; // sorted
+    KnownKeys(void) {
+      for (int n = 0; known_key_names[n]; ++n) keys.push_back(known_key_names[n]);
+      std::sort(keys.begin(), keys.end());
+    }
+    const std::string* find(const std::string& key) const {
+      std::vector<std::string>::const_iterator k = std::lower_bound(keys.begin(), keys.end(), key);
+      if ((k == keys.end()) || (*k != key)) return NULL;
+      return &(*k);
+    }
+    bool contains(const std::string* key) const {
+      return (key >= &(keys.front())) && (key <= &(keys.back()));
+    }
+  };
+
+  static const KnownKeys& known_keys(void) {
+    static const KnownKeys keys;
+    return keys;
   }
 
-  AttributeIterator::AttributeIterator(AttrConstIter begin,
-				       AttrConstIter end) :
-    current_(begin), end_(end) {
+  // Most of messages carry fewer attributes
+  static const unsigned int attributes_reserve = 16;
+
+  AttributeKey::AttributeKey(const std::string& key) {
+    key_ = known_keys().find(key);
+    if (key_) return;
+    KeyStripe& stripe = key_stripes()[key_hash(key) % key_stripes_num];
+    Glib::Mutex::Lock lock(stripe.lock);
+    key_ = &(*(stripe.keys.insert(key).first));
+  }
+
+  AttributeIterator::AttributeIterator() :
+    top_(NULL), level_(NULL), key_(NULL), current_(0) {
+  }
+
+  AttributeIterator::AttributeIterator(const MessageAttributes* attributes,
+                                       const std::string* key) :
+    top_(attributes), level_(attributes), key_(key), current_(0) {
+    skip();
+  }
+
+  void AttributeIterator::skip() {
+    while (level_) {
+      for (; current_ < level_->attributes_.size(); ++current_) {
+        const std::string* key = level_->attributes_[current_].key;
+        if (key_ && (key != key_)) continue;
+        // Value of shared object is hidden if key is owned by sharing one
+        bool visible = true;
+        for (const MessageAttributes* l = top_; l != level_; l = l->shared_) {
+          if (l->owns(key)) {
+            visible = false;
+            break;
+          }
+        }
+        if (visible) return;
+      }
+      // Nothing of requested key can come from shared objects
+      if (key_ && level_->owns(key_)) break;
+      level_ = level_->shared_;
+      current_ = 0;
+    }
+    level_ = NULL;
   }
-  
+
   const std::string& AttributeIterator::operator*() const {
-    return current_->second;
+    return level_->attributes_[current_].value;
   }
 
   const std::string* AttributeIterator::operator->() const {
-    return &(current_->second);
+    return &(level_->attributes_[current_].value);
   }
 
   const std::string& AttributeIterator::key(void) const {
-    return current_->first;
+    return *(level_->attributes_[current_].key);
   }
 
   const AttributeIterator& AttributeIterator::operator++() {
     ++current_;
+    skip();
     return *this;
   }
 
   AttributeIterator AttributeIterator::operator++(int) {
-    AttrConstIter recent=current_++;
-    return AttributeIterator(recent,end_);
+    AttributeIterator recent(*this);
+    ++(*this);
+    return recent;
   }
 
   bool AttributeIterator::hasMore() const {
-    return current_!=end_;
+    return level_ != NULL;
+  }
+
+  MessageAttributes::MessageAttributes() : shared_(NULL) {
+  }
+
+  MessageAttributes::MessageAttributes(const MessageAttributes* shared) :
+    shared_(shared) {
+  }
+
+  MessageAttributes::MessageAttributes(const MessageAttributes& other) :
+    shared_(NULL) {
+    operator=(other);
+  }
+
+  MessageAttributes& MessageAttributes::operator=(const MessageAttributes& other) {
+    if (&other == this) return *this;
+    attributes_ = other.attributes_;
+    owned_ = other.owned_;
+    shared_ = other.shared_;
+    local_keys_.clear();
+    // Keys local to other object must be replaced by own copies
+    for (std::list<std::string>::const_iterator k = other.local_keys_.begin();
+         k != other.local_keys_.end(); ++k) {
+      local_keys_.push_back(*k);
+      const std::string* key = &(local_keys_.back());
+      for (std::vector<Attribute>::iterator a = attributes_.begin();
+           a != attributes_.end(); ++a)
+        if (a->key == &(*k)) a->key = key;
+      for (std::vector<const std::string*>::iterator o = owned_.begin();
+           o != owned_.end(); ++o)
+        if (*o == &(*k)) *o = key;
+    }
+    return *this;
   }
 
-  MessageAttributes::MessageAttributes() {
+  const std::string* MessageAttributes::find(const std::string& key) const {
+    for (const MessageAttributes* l = this; l; l = l->shared_) {
+      for (std::vector<Attribute>::const_iterator a = l->attributes_.begin();
+           a != l->attributes_.end(); ++a)
+        if (*(a->key) == key) return a->key;
+      for (std::vector<const std::string*>::const_iterator o = l->owned_.begin();
+           o != l->owned_.end(); ++o)
+        if (**o == key) return *o;
+    }
+    return NULL;
+  }
+
+  const std::string* MessageAttributes::resolve(const std::string* key) const {
+    // Known keys are never stored as local ones
+    if (known_keys().contains(key)) return key;
+    for (const MessageAttributes* l = this; l; l = l->shared_) {
+      if (!l->local_keys_.empty()) {
+        // Same key may be already stored as local one
+        const std::string* k = find(*key);
+        return k ? k : key;
+      }
+    }
+    return key;
+  }
+
+  const std::string* MessageAttributes::key(const std::string& key) {
+    const std::string* k = known_keys().find(key);
+    if (k) return k;
+    k = find(key);
+    if (k) return k;
+    // Keys may come from remote side (like HTTP headers), so they
+    // are never interned implicitly and live as long as this object.
+    // Interned keys are matched to them in resolve().
+    local_keys_.push_back(key);
+    return &(local_keys_.back());
+  }
+
+  bool MessageAttributes::owns(const std::string* key) const {
+    if (!shared_) return true;
+    for (std::vector<const std::string*>::const_iterator o = owned_.begin();
+         o != owned_.end(); ++o)
+      if (*o == key) return true;
+    return false;
+  }
+
+  void MessageAttributes::own(const std::string* key) {
+    if (owns(key)) return;
+    for (AttributeIterator i(shared_, key); i.hasMore(); ++i) {
+      Attribute attribute;
+      attribute.key = key;
+      attribute.value = *i;
+      attributes_.push_back(attribute);
+    }
+    owned_.push_back(key);
   }
 
   void MessageAttributes::set(const std::string& key,
 			      const std::string& value) {
-    removeAll(key);
-    add(key, value);
+    set(this->key(key), value);
   }
 
   void MessageAttributes::add(const std::string& key,
 			      const std::string& value) {
-    attributes_.insert(make_pair(key, value));
+    add(this->key(key), value);
   }
 
   void MessageAttributes::removeAll(const std::string& key) {
-    attributes_.erase(key);
+    const std::string* k = find(key);
+    if (k) removeAll(k);
   }
 
   void MessageAttributes::remove(const std::string& key,
 				 const std::string& value) {
-    AttrIter end   = attributes_.upper_bound(key);
-    for (AttrIter i=attributes_.lower_bound(key); i!=end;)
-      if (i->second==value) {
-	attributes_.erase(i);
-        i = attributes_.lower_bound(key);
+    const std::string* k = find(key);
+    if (!k) return;
+    own(k);
+    for (std::vector<Attribute>::iterator a = attributes_.begin();
+         a != attributes_.end();) {
+      if ((a->key == k) && (a->value == value)) {
+        a = attributes_.erase(a);
       } else {
-        ++i;
+        ++a;
       }
+    }
   }
 
   int MessageAttributes::count(const std::string& key) const {
-    return attributes_.count(key);
+    const std::string* k = find(key);
+    if (!k) return 0;
+    return count(k);
   }
 
   const std::string& MessageAttributes::get(const std::string& key) const {
     static std::string emptyString="";
-    if (count(key)==1)
-      return attributes_.find(key)->second;
-    else
-      return emptyString; // Throw an exception?
+    const std::string* k = find(key);
+    if (!k) return emptyString;
+    return get(k);
   }
 
   AttributeIterator MessageAttributes::getAll(const std::string& key) const {
-    return AttributeIterator(attributes_.lower_bound(key),
-			     attributes_.upper_bound(key));
+    const std::string* k = find(key);
+    if (!k) return AttributeIterator();
+    return AttributeIterator(this, k);
   }
 
   AttributeIterator MessageAttributes::getAll(void) const {
-    return AttributeIterator(attributes_.begin(),
-			     attributes_.end());
+    return AttributeIterator(this, NULL);
+  }
+
+  void MessageAttributes::set(const AttributeKey& key,
+			      const std::string& value) {
+    set(resolve(key.key_), value);
+  }
+
+  void MessageAttributes::add(const AttributeKey& key,
+			      const std::string& value) {
+    add(resolve(key.key_), value);
+  }
+
+  void MessageAttributes::removeAll(const AttributeKey& key) {
+    removeAll(resolve(key.key_));
+  }
+
+  int MessageAttributes::count(const AttributeKey& key) const {
+    return count(resolve(key.key_));
+  }
+
+  const std::string& MessageAttributes::get(const AttributeKey& key) const {
+    return get(resolve(key.key_));
+  }
+
+  AttributeIterator MessageAttributes::getAll(const AttributeKey& key) const {
+    return AttributeIterator(this, resolve(key.key_));
+  }
+
+  void MessageAttributes::set(const std::string* key,
+			      const std::string& value) {
+    removeAll(key);
+    add(key, value);
+  }
+
+  void MessageAttributes::add(const std::string* key,
+			      const std::string& value) {
+    own(key);
+    if (attributes_.capacity() == 0) attributes_.reserve(attributes_reserve);
+    Attribute attribute;
+    attribute.key = key;
+    attribute.value = value;
+    attributes_.push_back(attribute);
+  }
+
+  void MessageAttributes::removeAll(const std::string* key) {
+    // Values of shared object need not be copied if they are removed anyway
+    if (!owns(key)) owned_.push_back(key);
+    for (std::vector<Attribute>::iterator a = attributes_.begin();
+         a != attributes_.end();) {
+      if (a->key == key) {
+        a = attributes_.erase(a);
+      } else {
+        ++a;
+      }
+    }
+  }
+
+  int MessageAttributes::count(const std::string* key) const {
+    for (const MessageAttributes* l = this; l; l = l->shared_) {
+      if (!l->owns(key)) continue;
+      int n = 0;
+      for (std::vector<Attribute>::const_iterator a = l->attributes_.begin();
+           a != l->attributes_.end(); ++a)
+        if (a->key == key) ++n;
+      return n;
+    }
+    return 0;
+  }
+
+  const std::string& MessageAttributes::get(const std::string* key) const {
+    static std::string emptyString="";
+    for (const MessageAttributes* l = this; l; l = l->shared_) {
+      if (!l->owns(key)) continue;
+      const std::string* value = NULL;
+      for (std::vector<Attribute>::const_iterator a = l->attributes_.begin();
+           a != l->attributes_.end(); ++a) {
+        if (a->key != key) continue;
+        if (value) return emptyString; // Throw an exception?
+        value = &(a->value);
+      }
+      return value ? *value : emptyString;
+    }
+    return emptyString;
   }
 
 }
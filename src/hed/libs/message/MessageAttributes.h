@@ -3,36 +3,81 @@
 #ifndef __ARC_MESSAGE_ATTRIBUTES__
 #define __ARC_MESSAGE_ATTRIBUTES__
 
+#include <list>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace Arc {
 
   //! A typefed of a multimap for storage of message attributes.
-  /*! This typedef is used as a shorthand for a multimap that uses
-    strings for keys as well as values. It is used within the
-    MesssageAttributes class for internal storage of message
-    attributes, but is not visible externally.
+  /*! This typedef was used for internal storage of message attributes
+    before keys were interned. It is kept for source compatibility
+    only and is not used by MessageAttributes anymore.
   */
   typedef std::multimap<std::string,std::string> AttrMap;
 
 
   //! A typedef of a const_iterator for AttrMap.
-  /*! This typedef is used as a shorthand for a const_iterator for
-    AttrMap. It is used extensively within the MessageAttributes class
-    as well as the AttributesIterator class, but is not visible
-    externally.
+  /*! Kept for source compatibility only.
    */
   typedef AttrMap::const_iterator AttrConstIter;
 
 
   //! A typedef of an (non-const) iterator for AttrMap.
-  /*! This typedef is used as a shorthand for a (non-const) iterator
-    for AttrMap. It is used in one method within the MessageAttributes
-    class, but is not visible externally.
+  /*! Kept for source compatibility only.
    */
   typedef AttrMap::iterator AttrIter;
 
+  class MessageAttributes;
+
+
+  //! An interned key of message attribute.
+  /*! Every distinct attribute key is stored only once per process and
+    keys are compared by address. Components which use the same keys
+    for every message may keep AttributeKey objects and pass them to
+    methods of MessageAttributes instead of strings. That avoids any
+    string comparison while accessing attributes. Interned keys are
+    never freed, so AttributeKey must only be created for keys fixed
+    in code and never for keys coming from input like HTTP header names.
+
+    Typical usage is:
+    \code
+    static const AttributeKey remotehost_key("TCP:REMOTEHOST");
+    ...
+    const std::string& remotehost = attributes.get(remotehost_key);
+    \endcode
+   */
+  class AttributeKey {
+  public:
+
+    //! Interns key.
+    /*! Registry of keys is split into independently locked parts,
+      so threads interning different keys rarely wait for each other.
+      Key stays in registry till process exits.
+      \param key The key of attribute.
+     */
+    explicit AttributeKey(const std::string& key);
+
+    //! The string value of key.
+    const std::string& str(void) const { return *key_; }
+
+    bool operator==(const AttributeKey& key) const { return key_ == key.key_; }
+    bool operator!=(const AttributeKey& key) const { return key_ != key.key_; }
+
+  private:
+
+    //! Wraps already interned key.
+    AttributeKey(const std::string* key):key_(key) { }
+
+    //! Interned string. Never deleted.
+    const std::string* key_;
+
+    friend class MessageAttributes;
+    friend class AttributeIterator;
+
+  };
+
 
   //! A const iterator class for accessing multiple values of an attribute.
   /*! This is an iterator class that is used when accessing multiple
@@ -101,31 +146,30 @@ namespace Arc {
 
     //! Protected constructor used by the MessageAttributes class.
     /*! This constructor is used to create an iterator for iteration
-      over all values of an attribute. It is not supposed to be
-      visible externally, but is only used from within the getAll()
-      method of MessageAttributes class.
-      \param begin A const_iterator pointing to the first matching
-      key-value pair in the internal multimap of the MessageAttributes
-      class.
-      \param end A const_iterator pointing to the first key-value pair
-      in the internal multimap of the MessageAttributes class where
-      the key is larger than the key searched for.
-     */
-    AttributeIterator(AttrConstIter begin, AttrConstIter end);
-
-    //! A const_iterator pointing to the current key-value pair.
-    /*! This iterator is the internal representation of the current
-      value. It points to the corresponding key-value pair in the
-      internal multimap of the MessageAttributes class.
-    */
-    AttrConstIter current_;
+      over values of an attribute. It is not supposed to be visible
+      externally, but is only used from within the getAll() methods
+      of MessageAttributes class.
+      \param attributes The object which values are iterated,
+      including values shared with it.
+      \param key The interned key of attribute or NULL for iteration
+      over all attributes.
+     */
+    AttributeIterator(const MessageAttributes* attributes, const std::string* key);
 
-    //! A const_iterator pointing beyond the last key-value pair.
-    /*! A const_iterator pointing to the first key-value pair in the
-      internal multimap of the MessageAttributes class where the key
-      is larger than the key searched for.
-    */
-    AttrConstIter end_;
+    //! Moves to first visible value starting from current position.
+    void skip(void);
+
+    //! Attributes for which iterator was created.
+    const MessageAttributes* top_;
+
+    //! Attributes which own current value - top_ or one shared by it.
+    const MessageAttributes* level_;
+
+    //! Interned key of iterated attribute or NULL for all.
+    const std::string* key_;
+
+    //! Position of current value inside level_.
+    unsigned int current_;
 
     //! The MessageAttributes class is a friend.
     /*! The constructor that creates an AttributeIterator that is
@@ -164,6 +208,16 @@ namespace Arc {
     shall be sent. This attribute is produced by e.g. the HTTP MCC
     and used by the plexer for routing the message to the
     appropriate service.
+
+    Keys are interned (see AttributeKey) and attributes are stored in
+    a vector, which is faster than a map for the few tens of
+    attributes a message usually carries. Keys passed as strings are
+    never interned. Unless such key is one of keys commonly used by
+    ARC components or is already used by the object it is stored in
+    the object itself and freed together with it. Attributes which stay the
+    same for many messages - like those describing a connection - may
+    be kept in a separate object which is shared by the attributes of
+    every message instead of being copied into each of them.
     */
   class MessageAttributes {
   public:
@@ -175,6 +229,22 @@ namespace Arc {
      */
     MessageAttributes();
 
+    //! Constructor sharing attributes of another object.
+    /*! Constructs an object which initially has the same attributes as
+      \a shared but does not copy them. Modifications are stored in
+      the new object only and \a shared is never changed through it.
+      The shared object must exist and stay unmodified as long as
+      this object is used.
+      \param shared The attributes to share.
+     */
+    explicit MessageAttributes(const MessageAttributes* shared);
+
+    //! Copy constructor.
+    MessageAttributes(const MessageAttributes& other);
+
+    //! Assignment operator.
+    MessageAttributes& operator=(const MessageAttributes& other);
+
     //! Sets a unique value of an attribute.
     /*! This method removes any previous value of an attribute and
       sets the new value as the only value.
@@ -239,13 +309,67 @@ namespace Arc {
     //! Access all value and attributes.
     AttributeIterator getAll(void) const;
 
+    //! Sets a unique value of an attribute identified by interned key.
+    void set(const AttributeKey& key, const std::string& value);
+
+    //! Adds a value to an attribute identified by interned key.
+    void add(const AttributeKey& key, const std::string& value);
+
+    //! Removes all attributes with a certain interned key.
+    void removeAll(const AttributeKey& key);
+
+    //! Returns the number of values of an attribute identified by interned key.
+    int count(const AttributeKey& key) const;
+
+    //! Returns the value of a single-valued attribute identified by interned key.
+    const std::string& get(const AttributeKey& key) const;
+
+    //! Access the value(s) of an attribute identified by interned key.
+    AttributeIterator getAll(const AttributeKey& key) const;
+
   protected:
 
-    //! Internal storage of attributes.
-    /*! An AttrMap (multimap) in which all attributes (key-value
-      pairs) are stored.
-     */
-    AttrMap attributes_;
+    //! Single value of attribute.
+    struct Attribute {
+      const std::string* key;
+      std::string value;
+    };
+
+    //! Internal storage of attributes in order of addition.
+    std::vector<Attribute> attributes_;
+
+    //! Attributes shared with this object, may be NULL.
+    const MessageAttributes* shared_;
+
+    //! Keys for which values of shared_ are replaced by own values.
+    std::vector<const std::string*> owned_;
+
+    //! Keys which are not interned. List keeps their addresses stable.
+    std::list<std::string> local_keys_;
+
+    //! Finds key used by this object or shared ones. Returns NULL if
+    //! there is no such attribute.
+    const std::string* find(const std::string& key) const;
+
+    //! Key used for interned key - it may be stored as local one.
+    const std::string* resolve(const std::string* key) const;
+
+    //! Finds key used by this object or shared ones or stores it in this object.
+    const std::string* key(const std::string& key);
+
+    void set(const std::string* key, const std::string& value);
+    void add(const std::string* key, const std::string& value);
+    void removeAll(const std::string* key);
+    int count(const std::string* key) const;
+    const std::string& get(const std::string* key) const;
+
+    //! True if values of key are taken from this object.
+    bool owns(const std::string* key) const;
+
+    //! Makes this object own key, copying values from shared object.
+    void own(const std::string* key);
+
+    friend class AttributeIterator;
 
   };
 
@@ -0,0 +1,167 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <strings.h>
+#include <zlib.h>
+
+#include <arc/StringConv.h>
+
+#include "PayloadGzip.h"
+
+namespace Arc {
+
+static const int gzip_buffer_size = 65536;
+
+PayloadGzipStream::PayloadGzipStream(PayloadRawInterface& source,bool own,int level):
+    rsource_(&source),ssource_(NULL),own_(own),zstream_(NULL),ibuf_(NULL),rnum_(0),
+    source_eof_(false),finished_(false),valid_(false),in_size_(0),out_size_(0) {
+  init(level);
+}
+
+PayloadGzipStream::PayloadGzipStream(PayloadStreamInterface& source,bool own,int level):
+    rsource_(NULL),ssource_(&source),own_(own),zstream_(NULL),ibuf_(NULL),rnum_(0),
+    source_eof_(false),finished_(false),valid_(false),in_size_(0),out_size_(0) {
+  ibuf_ = new char[gzip_buffer_size];
+  init(level);
+}
+
+void PayloadGzipStream::init(int level) {
+  zstream_ = new z_stream;
+  zstream_->zalloc = Z_NULL;
+  zstream_->zfree = Z_NULL;
+  zstream_->opaque = Z_NULL;
+  zstream_->next_in = Z_NULL;
+  zstream_->avail_in = 0;
+  // 16 added to window bits produces gzip header and trailer
+  if(deflateInit2(zstream_,level,Z_DEFLATED,15+16,8,Z_DEFAULT_STRATEGY) != Z_OK) {
+    delete zstream_; zstream_ = NULL;
+    return;
+  };
+  valid_ = true;
+}
+
+PayloadGzipStream::~PayloadGzipStream(void) {
+  if(zstream_) {
+    deflateEnd(zstream_);
+    delete zstream_;
+  };
+  delete[] ibuf_;
+  if(own_) {
+    if(rsource_) delete rsource_;
+    if(ssource_) delete ssource_;
+  };
+}
+
+// Makes more input available to compressor
+bool PayloadGzipStream::fill(void) {
+  if(source_eof_) return false;
+  if(rsource_) {
+    // Raw buffers are compressed in place
+    for(;;) {
+      char* buf = rsource_->Buffer(rnum_);
+      if(!buf) break;
+      PayloadRawInterface::Size_t size = rsource_->BufferSize(rnum_);
+      ++rnum_;
+      if(size <= 0) continue;
+      zstream_->next_in = (Bytef*)buf;
+      zstream_->avail_in = size;
+      in_size_ += size;
+      return true;
+    };
+  } else if(ssource_) {
+    for(;;) {
+      int size = gzip_buffer_size;
+      if(!ssource_->Get(ibuf_,size)) {
+        // Broken source must not look like complete content
+        if(!*ssource_) valid_ = false;
+        break;
+      };
+      if(size <= 0) continue;
+      zstream_->next_in = (Bytef*)ibuf_;
+      zstream_->avail_in = size;
+      in_size_ += size;
+      return true;
+    };
+  };
+  source_eof_ = true;
+  return false;
+}
+
+bool PayloadGzipStream::Get(char* buf,int& size) {
+  if((!valid_) || finished_ || (size <= 0)) { size = 0; return false; };
+  zstream_->next_out = (Bytef*)buf;
+  zstream_->avail_out = size;
+  for(;zstream_->avail_out > 0;) {
+    if((zstream_->avail_in == 0) && (!source_eof_)) {
+      // Do not wait for more input if there is something to return already
+      if(zstream_->avail_out < (unsigned int)size) break;
+      fill();
+      if(!valid_) break;
+    };
+    int r = deflate(zstream_,source_eof_?Z_FINISH:Z_NO_FLUSH);
+    if(r == Z_STREAM_END) { finished_ = true; break; };
+    if((r != Z_OK) && (r != Z_BUF_ERROR)) { valid_ = false; break; };
+  };
+  size -= zstream_->avail_out;
+  out_size_ += size;
+  return (size > 0);
+}
+
+bool PayloadGzipStream::Put(const char* /* buf */,PayloadStreamInterface::Size_t /* size */) {
+  return false;
+}
+
+int PayloadGzipStream::Timeout(void) const {
+  if(ssource_) return ssource_->Timeout();
+  return 0;
+}
+
+void PayloadGzipStream::Timeout(int to) {
+  if(ssource_) ssource_->Timeout(to);
+}
+
+PayloadStreamInterface::Size_t PayloadGzipStream::Pos(void) const {
+  return out_size_;
+}
+
+PayloadStreamInterface::Size_t PayloadGzipStream::Size(void) const {
+  return 0;
+}
+
+PayloadStreamInterface::Size_t PayloadGzipStream::Limit(void) const {
+  return 0;
+}
+
+bool GzipAccepted(const std::list<std::string>& accept_encoding) {
+  std::list<std::string> encodings;
+  for(std::list<std::string>::const_iterator h = accept_encoding.begin(); h != accept_encoding.end(); ++h) {
+    tokenize(*h, encodings, ",");
+  };
+  int gzip_accepted = -1;
+  int any_accepted = -1;
+  for(std::list<std::string>::iterator enc = encodings.begin(); enc != encodings.end(); ++enc) {
+    std::string params;
+    std::string::size_type pos = enc->find(';');
+    if(pos != std::string::npos) {
+      params = enc->substr(pos+1);
+      enc->erase(pos);
+    };
+    std::string coding = lower(trim(*enc));
+    int accepted = 1;
+    params = trim(params);
+    if(strncasecmp(params.c_str(),"q=",2) == 0) {
+      double q = 1;
+      if(stringto(params.substr(2),q) && (q <= 0)) accepted = 0;
+    };
+    if((coding == "gzip") || (coding == "x-gzip")) {
+      gzip_accepted = accepted;
+    } else if(coding == "*") {
+      any_accepted = accepted;
+    };
+  };
+  if(gzip_accepted >= 0) return (gzip_accepted > 0);
+  return (any_accepted > 0);
+}
+
+} // namespace Arc
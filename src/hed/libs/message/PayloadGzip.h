@@ -0,0 +1,71 @@
+#ifndef __ARC_PAYLOADGZIP_H__
+#define __ARC_PAYLOADGZIP_H__
+
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
+
+#include <list>
+#include <string>
+
+#include "PayloadRaw.h"
+#include "PayloadStream.h"
+
+struct z_stream_s;
+
+namespace Arc {
+
+/** Stream which provides gzip compressed content of another payload.
+  Content is compressed while being read through Get(), so neither
+  compressed nor original content is kept in memory as whole. Source
+  may be PayloadRawInterface or PayloadStreamInterface. Because size
+  of compressed content is not known in advance Size() and Limit()
+  return 0 and HTTP body made of this object is sent chunked.
+  If stream source fails while being read this object becomes
+  invalid instead of finishing compressed content. */
+class PayloadGzipStream: public PayloadStreamInterface {
+ protected:
+  PayloadRawInterface* rsource_;    /** source with raw interface */
+  PayloadStreamInterface* ssource_; /** source with stream interface */
+  bool own_;                        /** if true source is owned by this */
+  struct z_stream_s* zstream_;
+  char* ibuf_;                      /** buffer for reading stream source */
+  unsigned int rnum_;               /** next buffer of raw source */
+  bool source_eof_;                 /** all data was taken from source */
+  bool finished_;                   /** compressed stream is complete */
+  bool valid_;
+  uint64_t in_size_;                /** amount of data taken from source */
+  uint64_t out_size_;               /** amount of compressed data produced */
+  void init(int level);
+  bool fill(void);
+ public:
+  /** Compress content of raw payload.
+    If 'own' is true source is destroyed together with this object. */
+  PayloadGzipStream(PayloadRawInterface& source,bool own = true,int level = -1);
+  /** Compress content of stream payload starting from its current position. */
+  PayloadGzipStream(PayloadStreamInterface& source,bool own = true,int level = -1);
+  virtual ~PayloadGzipStream(void);
+  /** Amount of original content consumed so far */
+  uint64_t InSize(void) const { return in_size_; };
+  /** Amount of compressed content produced so far */
+  uint64_t OutSize(void) const { return out_size_; };
+  // PayloadStreamInterface implemented methods
+  virtual bool Get(char* buf,int& size);
+  virtual bool Put(const char* buf,PayloadStreamInterface::Size_t size);
+  virtual operator bool(void) { return valid_; };
+  virtual bool operator!(void) { return !valid_; };
+  virtual int Timeout(void) const;
+  virtual void Timeout(int to);
+  virtual PayloadStreamInterface::Size_t Pos(void) const;
+  virtual PayloadStreamInterface::Size_t Size(void) const;
+  virtual PayloadStreamInterface::Size_t Limit(void) const;
+};
+
+/** Checks if gzip content coding is acceptable according to values of
+  HTTP Accept-Encoding header. Explicit gzip entry takes precedence over
+  wildcard and zero quality value means refusal. */
+bool GzipAccepted(const std::list<std::string>& accept_encoding);
+
+} // namespace Arc
+
+#endif /* __ARC_PAYLOADGZIP_H__ */
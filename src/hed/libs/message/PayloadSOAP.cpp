@@ -1,18 +1,119 @@
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
+
+#include <streambuf>
+
 #include "PayloadSOAP.h"
 #include "PayloadRaw.h"
+#include "PayloadStream.h"
 
 namespace Arc {
 
-PayloadSOAP::PayloadSOAP(const MessagePayload& source):SOAPEnvelope(ContentFromPayload(source)) {
+// Presents content of payload to XML parser. Buffers of raw payload
+// are passed as they are. Stream is read in chunks.
+class PayloadSOAPInBuf: public std::streambuf {
+ private:
+  PayloadRawInterface* raw_;
+  PayloadStreamInterface* stream_;
+  unsigned int num_;
+  char buf_[16384];
+ public:
+  PayloadSOAPInBuf(const MessagePayload& source,bool use_stream):raw_(NULL),stream_(NULL),num_(0) {
+    MessagePayload& payload = const_cast<MessagePayload&>(source);
+    try {
+      raw_ = dynamic_cast<PayloadRawInterface*>(&payload);
+    } catch(std::exception& e) { };
+    // Only payloads with well defined content (like HTTP body)
+    // are read as stream. Pure streams have no end of message.
+    if(raw_ && use_stream) try {
+      stream_ = dynamic_cast<PayloadStreamInterface*>(&payload);
+    } catch(std::exception& e) { };
+  }
+  // Allows temporary object to be passed to SOAPEnvelope
+  std::streambuf& Buf(void) { return *this; }
+ protected:
+  virtual int_type underflow(void) {
+    if(gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    if(stream_) {
+      for(;;) {
+        int size = sizeof(buf_);
+        if(!stream_->Get(buf_,size)) return traits_type::eof();
+        if(size <= 0) continue;
+        setg(buf_,buf_,buf_+size);
+        return traits_type::to_int_type(*gptr());
+      };
+    };
+    if(raw_) {
+      for(;;) {
+        char* b = raw_->Buffer(num_);
+        if(!b) return traits_type::eof();
+        PayloadRawInterface::Size_t l = raw_->BufferSize(num_);
+        ++num_;
+        if(l <= 0) continue;
+        setg(b,b,b+l);
+        return traits_type::to_int_type(*gptr());
+      };
+    };
+    return traits_type::eof();
+  }
+};
+
+static const PayloadRawInterface::Size_t min_out_chunk = 4096;
+static const PayloadRawInterface::Size_t max_out_chunk = 1024*1024;
+
+// Appends written data to raw payload in growing chunks
+class PayloadSOAPOutBuf: public std::streambuf {
+ private:
+  PayloadRawInterface& payload_;
+  PayloadRawInterface::Size_t chunk_;
+  bool failed_;
+ public:
+  PayloadSOAPOutBuf(PayloadRawInterface& payload):payload_(payload),chunk_(min_out_chunk),failed_(false) {
+  }
+  // Releases unused part of last chunk
+  bool Finish(void) {
+    if(pbase() && (epptr() > pptr())) {
+      // Keep content null-terminated like PayloadRaw::Insert does
+      *pptr() = 0;
+      if(!payload_.Truncate(payload_.Size() - (epptr() - pptr()))) failed_ = true;
+    };
+    setp(NULL,NULL);
+    return !failed_;
+  }
+ protected:
+  virtual int_type overflow(int_type c) {
+    if(failed_) return traits_type::eof();
+    if(pptr() >= epptr()) {
+      // Current chunk is full or there is no chunk yet
+      char* b = payload_.Insert(payload_.Size(),chunk_);
+      if(!b) {
+        failed_ = true;
+        return traits_type::eof();
+      };
+      setp(b,b+chunk_);
+      if(chunk_ < max_out_chunk) chunk_*=2;
+    };
+    if(traits_type::eq_int_type(c,traits_type::eof())) return traits_type::not_eof(c);
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+    return c;
+  }
+};
+
+PayloadSOAP::PayloadSOAP(const MessagePayload& source):SOAPEnvelope(PayloadSOAPInBuf(source,true).Buf()) {
   if(XMLNode::operator!()) {
     // TODO: implement error reporting in SOAP parsing
     failure_ = MCC_Status(GENERIC_ERROR,"SOAP","Failed to parse SOAP message");
   }
 }
 
+PayloadSOAP::PayloadSOAP(const MessagePayload& source,bool use_stream):SOAPEnvelope(PayloadSOAPInBuf(source,use_stream).Buf()) {
+  if(XMLNode::operator!()) {
+    failure_ = MCC_Status(GENERIC_ERROR,"SOAP","Failed to parse SOAP message");
+  }
+}
+
 PayloadSOAP::PayloadSOAP(const SOAPEnvelope& soap):SOAPEnvelope(soap) {
 }
 
@@ -22,4 +123,12 @@ PayloadSOAP::PayloadSOAP(const NS& ns,bool fault):SOAPEnvelope(ns,fault) {
 PayloadSOAP::~PayloadSOAP(void) {
 }
 
+bool SOAPToPayload(const SOAPEnvelope& soap,PayloadRawInterface& payload) {
+  PayloadSOAPOutBuf buf(payload);
+  std::ostream out(&buf);
+  bool r = soap.GetXML(out);
+  if(!buf.Finish()) r = false;
+  return r;
+}
+
 } // namespace Arc
@@ -2,6 +2,7 @@
 #define __ARC_PAYLOADSOAP_H__
 
 #include "Message.h"
+#include "PayloadRaw.h"
 #include "SOAPEnvelope.h"
 
 namespace Arc {
@@ -17,11 +18,26 @@ class PayloadSOAP: public SOAPEnvelope, virtual public MessagePayload {
     Provided SOAP document is copied to new object. */
   PayloadSOAP(const SOAPEnvelope& soap);
   /** Constructor - creates SOAP message from payload.
-    PayloadRawInterface and derived classes are supported. */
+    PayloadRawInterface and derived classes are supported. Content is
+    parsed buffer by buffer without being collected into one piece.
+    If payload also implements PayloadStreamInterface (like incoming
+    HTTP message) content is parsed while being read from stream. */
   PayloadSOAP(const MessagePayload& source);
+  /** Constructor - creates SOAP message from payload.
+    If use_stream is false content is taken only from buffers of
+    PayloadRawInterface and stream interface of payload is left
+    untouched, so payload which is not SOAP can still be read by
+    someone else. */
+  PayloadSOAP(const MessagePayload& source,bool use_stream);
   virtual ~PayloadSOAP(void);
 };
 
+/// Stores textual representation of SOAP message in raw payload.
+/** Text is appended to payload in chunks while being rendered instead of
+  being collected into intermediate string first. Returns false if
+  payload could not be filled. */
+bool SOAPToPayload(const SOAPEnvelope& soap,PayloadRawInterface& payload);
+
 } // namespace Arc
 
 #endif /* __ARC_PAYLOADSOAP_H__ */
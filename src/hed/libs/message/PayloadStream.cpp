@@ -138,17 +138,20 @@ bool PayloadStreamInterface::Get(PayloadStreamInterface& dest,int& size) {
 }
 
 bool PayloadStreamInterface::Put(PayloadStreamInterface& source,Size_t size) {
-  char tbuf[1024];
+  // Big buffer because this is used for passing whole files
+  const int tbufsize = 65536;
+  char* tbuf = new char[tbufsize];
   bool r = false;
   while(true) {
     if(size == 0) { r = true; break; };
-    int l = size;
-    if((size == -1) || (l > (int)sizeof(tbuf))) l = (int)sizeof(tbuf);
+    int l = tbufsize;
+    if((size != -1) && (size < tbufsize)) l = size;
     if(!source.Get(tbuf,l)) break;
     if(l <= 0) { r = true; break; };
     if(!Put(tbuf,l)) break;
     if(size != -1) size -= l;
   };
+  delete[] tbuf;
   return r;
 }
 
@@ -69,6 +69,20 @@ class PayloadStreamInterface: virtual public MessagePayload {
   virtual Size_t Limit(void) const = 0;
 };
 
+/// Stream-like Payload which delivers content of regular file.
+/** Streams attached to sockets may use handle of such payload in their
+ implementation of Put(PayloadStreamInterface&,Size_t) to move content
+ from file to socket inside kernel instead of reading it through Get(). */
+class PayloadFileStreamInterface: virtual public PayloadStreamInterface {
+ public:
+  PayloadFileStreamInterface(void) { };
+  virtual ~PayloadFileStreamInterface(void) { };
+  /** Returns handle of open regular file or -1 if not available.
+    Content is taken from current position of handle up to Limit(),
+    hence reading from handle advances Pos() just like Get() does. */
+  virtual int FileHandle(void) const = 0;
+};
+
 /// POSIX handle as Payload
 /** This is an implemetation of PayloadStreamInterface for generic POSIX handle. */
 class PayloadStream: virtual public PayloadStreamInterface {
@@ -0,0 +1,371 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include <arc/Logger.h>
+
+#include "PayloadTar.h"
+
+namespace Arc {
+
+static Logger logger(Logger::getRootLogger(), "PayloadTar");
+
+static const unsigned int tar_block_size = 512;
+static const unsigned int tar_name_size = 100;
+static const unsigned int tar_prefix_size = 155;
+static const unsigned int tar_buffer_size = 65536;
+
+static unsigned long long int tar_padded(unsigned long long int size) {
+  return ((size + tar_block_size - 1) / tar_block_size) * tar_block_size;
+}
+
+// Numeric fields are octal with terminating NUL. Values which do not
+// fit are stored in GNU base-256 format.
+static void tar_put_number(char* field, unsigned int len, unsigned long long int value) {
+  if(value < (1ULL << (3*(len-1)))) {
+    field[len-1] = '\0';
+    for(int n = len-2; n >= 0; --n) { field[n] = '0' + (value & 7); value >>= 3; };
+  } else {
+    for(int n = len-1; n > 0; --n) { field[n] = (char)(value & 0xff); value >>= 8; };
+    field[0] = (char)0x80;
+  };
+}
+
+// Parses octal number or GNU base-256 encoded one
+static bool tar_get_number(const char* field, unsigned int len, unsigned long long int& value) {
+  value = 0;
+  if((unsigned char)field[0] & 0x80) {
+    for(unsigned int n = 1; n < len; ++n) value = (value << 8) | (unsigned char)field[n];
+    return true;
+  };
+  unsigned int n = 0;
+  while((n < len) && (field[n] == ' ')) ++n;
+  for(; n < len; ++n) {
+    if((field[n] == '\0') || (field[n] == ' ')) break;
+    if((field[n] < '0') || (field[n] > '7')) return false;
+    value = value*8 + (field[n] - '0');
+  };
+  return true;
+}
+
+static std::string tar_get_string(const char* field, unsigned int len) {
+  return std::string(field, strnlen(field, len));
+}
+
+// Splits name into ustar prefix and name fields. Returns false if
+// name does not fit into header.
+static bool tar_split_name(std::string const& name, std::string::size_type& split) {
+  split = std::string::npos;
+  if(name.length() <= tar_name_size) return true;
+  std::string::size_type start = name.length() - tar_name_size - 1;
+  for(std::string::size_type p = start; (p < name.length()) && (p <= tar_prefix_size); ++p) {
+    if((name[p] == '/') && (p > 0) && (p < name.length()-1)) {
+      split = p;
+      return true;
+    };
+  };
+  return false;
+}
+
+static void tar_put_header(std::string& block, std::string const& name, char type,
+                           unsigned long long int size, mode_t mode, time_t mtime,
+                           uid_t uid, gid_t gid) {
+  std::string::size_type offset = block.length();
+  block.append(tar_block_size, '\0');
+  char* h = &block[offset];
+  std::string::size_type split;
+  if(tar_split_name(name, split) && (split != std::string::npos)) {
+    memcpy(h+345, name.c_str(), split);
+    memcpy(h, name.c_str()+split+1, name.length()-split-1);
+  } else {
+    // Name too long for ustar is preceded by GNU long name header
+    memcpy(h, name.c_str(), (name.length() < tar_name_size)?name.length():tar_name_size);
+  };
+  tar_put_number(h+100, 8, mode & 07777);
+  tar_put_number(h+108, 8, uid);
+  tar_put_number(h+116, 8, gid);
+  tar_put_number(h+124, 12, size);
+  tar_put_number(h+136, 12, (mtime > 0)?mtime:0);
+  h[156] = type;
+  memcpy(h+257, "ustar", 6);
+  memcpy(h+263, "00", 2);
+  // Checksum is calculated with checksum field filled with spaces
+  memset(h+148, ' ', 8);
+  unsigned int sum = 0;
+  for(unsigned int n = 0; n < tar_block_size; ++n) sum += (unsigned char)h[n];
+  tar_put_number(h+148, 7, sum);
+  h[155] = ' ';
+}
+
+static unsigned long long int tar_entry_size(PayloadTarStream::Entry const& entry) {
+  unsigned long long int size = tar_block_size;
+  std::string::size_type split;
+  if(!tar_split_name(entry.name, split)) size += tar_block_size + tar_padded(entry.name.length()+1);
+  if(!entry.dir) size += tar_padded(entry.size);
+  return size;
+}
+
+PayloadTarStream::PayloadTarStream(uid_t uid, gid_t gid):
+    started_(false),uid_(uid),gid_(gid),block_pos_(0),file_open_(false),
+    file_left_(0),pad_left_(0),finished_(false),valid_(true),timeout_(0),
+    pos_(0),size_(2*tar_block_size),handle_(-1) {
+}
+
+PayloadTarStream::~PayloadTarStream(void) {
+  // Virtual methods of inheriting classes are not available anymore
+  if(handle_ != -1) ::close(handle_);
+}
+
+bool PayloadTarStream::Add(Entry const& entry) {
+  if(started_) return false;
+  Entry e(entry);
+  if(e.dir) {
+    e.size = 0;
+    if(e.name.empty() || (e.name[e.name.length()-1] != '/')) e.name += "/";
+  };
+  size_ += tar_entry_size(e);
+  entries_.push_back(e);
+  return true;
+}
+
+void PayloadTarStream::MakeHeader(Entry const& entry) {
+  block_.resize(0);
+  block_pos_ = 0;
+  std::string::size_type split;
+  if(!tar_split_name(entry.name, split)) {
+    tar_put_header(block_, "././@LongLink", 'L', entry.name.length()+1, 0, 0, 0, 0);
+    block_.append(entry.name);
+    block_.append(tar_padded(entry.name.length()+1)-entry.name.length(), '\0');
+  };
+  tar_put_header(block_, entry.name, entry.dir?'5':'0', entry.size, entry.mode, entry.mtime, uid_, gid_);
+}
+
+void PayloadTarStream::Fail(std::string const& failure) {
+  logger.msg(ERROR, "Archive can't be completed: %s", failure);
+  failure_ = failure;
+  valid_ = false;
+  if(file_open_) {
+    CloseFile();
+    file_open_ = false;
+  };
+}
+
+bool PayloadTarStream::Get(char* buf,int& size) {
+  if((!valid_) || (size <= 0)) { size = 0; return false; };
+  if(!started_) {
+    started_ = true;
+    current_ = entries_.begin();
+  };
+  int got = 0;
+  while(got < size) {
+    if(block_pos_ < block_.length()) {
+      int l = block_.length() - block_pos_;
+      if(l > (size - got)) l = size - got;
+      memcpy(buf+got, block_.c_str()+block_pos_, l);
+      block_pos_ += l;
+      got += l;
+      continue;
+    };
+    if(file_left_ > 0) {
+      int l = size - got;
+      if((unsigned long long int)l > file_left_) l = file_left_;
+      if(file_open_) {
+        if(!ReadFile(buf+got, l)) {
+          Fail("failed to read file "+file_->path);
+          break;
+        };
+        if(l <= 0) {
+          // File got shorter - rest is filled with zeros
+          logger.msg(WARNING, "File %s got shorter while being archived", file_->path);
+          CloseFile();
+          file_open_ = false;
+          continue;
+        };
+      } else {
+        memset(buf+got, 0, l);
+      };
+      got += l;
+      file_left_ -= l;
+      continue;
+    };
+    if(file_open_) {
+      CloseFile();
+      file_open_ = false;
+    };
+    if(pad_left_ > 0) {
+      int l = size - got;
+      if((unsigned int)l > pad_left_) l = pad_left_;
+      memset(buf+got, 0, l);
+      got += l;
+      pad_left_ -= l;
+      continue;
+    };
+    if(finished_) break;
+    if(current_ == entries_.end()) {
+      // End of archive is marked by two empty blocks
+      block_.assign(2*tar_block_size, '\0');
+      block_pos_ = 0;
+      finished_ = true;
+      continue;
+    };
+    if((!current_->dir) && (current_->size > 0)) {
+      // File is opened before its header is produced so that
+      // nothing is promised for file which is not accessible.
+      if(!OpenFile(*current_)) {
+        Fail("failed to open file "+current_->path);
+        break;
+      };
+      file_open_ = true;
+      file_ = current_;
+    };
+    MakeHeader(*current_);
+    if(!current_->dir) {
+      file_left_ = current_->size;
+      pad_left_ = tar_padded(current_->size) - current_->size;
+    };
+    ++current_;
+  };
+  size = got;
+  pos_ += got;
+  return (got > 0);
+}
+
+bool PayloadTarStream::Put(const char* /* buf */,Size_t /* size */) {
+  return false;
+}
+
+bool PayloadTarStream::OpenFile(Entry const& entry) {
+  handle_ = ::open(entry.path.c_str(), O_RDONLY);
+  return (handle_ != -1);
+}
+
+bool PayloadTarStream::ReadFile(char* buf,int& size) {
+  if(handle_ == -1) return false;
+  ssize_t l;
+  do { l = ::read(handle_, buf, size); } while((l == -1) && (errno == EINTR));
+  if(l < 0) { size = 0; return false; };
+  size = l;
+  return true;
+}
+
+void PayloadTarStream::CloseFile(void) {
+  if(handle_ != -1) {
+    ::close(handle_);
+    handle_ = -1;
+  };
+}
+
+TarReader::TarReader(PayloadStreamInterface& stream):
+    stream_(stream),left_(0),pad_(0),failed_(false),finished_(false) {
+}
+
+TarReader::~TarReader(void) {
+}
+
+bool TarReader::ReadExact(char* buf, unsigned long long int size) {
+  while(size > 0) {
+    int l = (size > tar_buffer_size)?tar_buffer_size:size;
+    if((!stream_.Get(buf, l)) || (l <= 0)) return false;
+    buf += l;
+    size -= l;
+  };
+  return true;
+}
+
+bool TarReader::Skip(unsigned long long int size) {
+  char buf[tar_block_size];
+  while(size > 0) {
+    unsigned long long int l = (size > tar_block_size)?tar_block_size:size;
+    if(!ReadExact(buf, l)) return false;
+    size -= l;
+  };
+  return true;
+}
+
+bool TarReader::Next(PayloadTarStream::Entry& entry) {
+  if(failed_ || finished_) return false;
+  if(!Skip(left_ + pad_)) { failed_ = true; return false; };
+  left_ = 0;
+  pad_ = 0;
+  std::string longname;
+  char header[tar_block_size];
+  for(;;) {
+    if(!ReadExact(header, tar_block_size)) { failed_ = true; return false; };
+    unsigned int sum = 0;
+    bool empty = true;
+    for(unsigned int n = 0; n < tar_block_size; ++n) {
+      if(header[n]) empty = false;
+      sum += ((n >= 148) && (n < 156)) ? ' ' : (unsigned char)header[n];
+    };
+    if(empty) {
+      // End of archive. Second empty block and anything after it is ignored.
+      finished_ = true;
+      return false;
+    };
+    unsigned long long int chksum = 0;
+    unsigned long long int size = 0;
+    if((!tar_get_number(header+148, 8, chksum)) || (chksum != sum) ||
+       (!tar_get_number(header+124, 12, size))) {
+      failed_ = true;
+      return false;
+    };
+    char type = header[156];
+    if(type == 'L') {
+      // GNU long name of next entry
+      if(size > tar_buffer_size) { failed_ = true; return false; };
+      std::string name(tar_padded(size), '\0');
+      if(!name.empty() && !ReadExact(&name[0], name.length())) { failed_ = true; return false; };
+      longname = tar_get_string(name.c_str(), size);
+      continue;
+    };
+    if((type != '0') && (type != '\0') && (type != '5')) {
+      // Links, devices, extended headers - not stored
+      if(!Skip(tar_padded(size))) { failed_ = true; return false; };
+      longname.clear();
+      continue;
+    };
+    entry = PayloadTarStream::Entry();
+    if(!longname.empty()) {
+      entry.name = longname;
+    } else {
+      entry.name = tar_get_string(header, tar_name_size);
+      std::string prefix = tar_get_string(header+345, tar_prefix_size);
+      if((!prefix.empty()) && (memcmp(header+257, "ustar", 5) == 0)) entry.name = prefix + "/" + entry.name;
+    };
+    unsigned long long int value = 0;
+    tar_get_number(header+100, 8, value);
+    entry.mode = value & 07777;
+    tar_get_number(header+136, 12, value);
+    entry.mtime = value;
+    entry.dir = (type == '5');
+    if(entry.dir) {
+      // Directories have no content
+      pad_ = tar_padded(size);
+    } else {
+      entry.size = size;
+      left_ = size;
+      pad_ = tar_padded(size) - size;
+    };
+    return true;
+  };
+}
+
+bool TarReader::Read(char* buf, int& size) {
+  if(failed_ || (left_ == 0) || (size <= 0)) { size = 0; return false; };
+  if((unsigned long long int)size > left_) size = left_;
+  if((!stream_.Get(buf, size)) || (size <= 0)) {
+    size = 0;
+    failed_ = true;
+    return false;
+  };
+  left_ -= size;
+  return true;
+}
+
+} // namespace Arc
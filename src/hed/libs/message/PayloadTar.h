@@ -0,0 +1,118 @@
+#ifndef __ARC_PAYLOADTAR_H__
+#define __ARC_PAYLOADTAR_H__
+
+#include <sys/types.h>
+
+#include <string>
+#include <list>
+
+#include "PayloadStream.h"
+
+namespace Arc {
+
+/** Stream producing tar archive of files.
+  Archive is generated while being read through Get(), so neither
+  archive nor copies of archived files are stored anywhere. Content of
+  every file is limited to size recorded in its header - file which
+  shrinks while being archived is padded with zeros and growing one is
+  truncated, so produced archive is always consistent. File which can't
+  be opened or read makes this object invalid and Get() fails, so that
+  broken archive is never delivered as complete one. Size of archive is
+  known in advance and reported by Size(). Format is POSIX ustar with
+  GNU extensions for long names and big files.
+  By default files are read directly from local file system. Inheriting
+  classes may provide other ways of accessing files by overloading
+  OpenFile(), ReadFile() and CloseFile(). */
+class PayloadTarStream: public PayloadStreamInterface {
+ public:
+  /** Description of single archived file or directory */
+  class Entry {
+   public:
+    std::string name;  /** path inside archive, relative */
+    std::string path;  /** path of file in file system */
+    bool dir;
+    unsigned long long int size;
+    mode_t mode;
+    time_t mtime;
+    Entry(void):dir(false),size(0),mode(0),mtime(0) { };
+  };
+  /** Files are recorded as owned by specified uid and gid */
+  PayloadTarStream(uid_t uid = 0,gid_t gid = 0);
+  virtual ~PayloadTarStream(void);
+  /** Adds file or directory to archive. Must be called before first Get(). */
+  bool Add(Entry const& entry);
+  /** Number of added entries */
+  unsigned int Entries(void) const { return entries_.size(); };
+  /** Description of problem which made this object invalid */
+  std::string const& Failure(void) const { return failure_; };
+  // PayloadStreamInterface implemented methods
+  virtual bool Get(char* buf,int& size);
+  virtual bool Put(const char* buf,Size_t size);
+  virtual operator bool(void) { return valid_; };
+  virtual bool operator!(void) { return !valid_; };
+  virtual int Timeout(void) const { return timeout_; };
+  virtual void Timeout(int to) { timeout_ = to; };
+  virtual Size_t Pos(void) const { return pos_; };
+  virtual Size_t Size(void) const { return size_; };
+  virtual Size_t Limit(void) const { return size_; };
+ protected:
+  /** Opens archived file. Returns false on error. */
+  virtual bool OpenFile(Entry const& entry);
+  /** Reads next part of opened file. At end of file returns true and
+    sets size to 0. Returns false on error. */
+  virtual bool ReadFile(char* buf,int& size);
+  virtual void CloseFile(void);
+ private:
+  std::list<Entry> entries_;
+  std::list<Entry>::iterator current_;
+  std::list<Entry>::iterator file_;  /** entry of opened file */
+  bool started_;
+  uid_t uid_;
+  gid_t gid_;
+  std::string block_;        /** header or trailer waiting to be delivered */
+  std::string::size_type block_pos_;
+  bool file_open_;
+  unsigned long long int file_left_; /** content of current file to deliver */
+  unsigned int pad_left_;    /** zeros completing last block of file */
+  bool finished_;
+  bool valid_;
+  std::string failure_;
+  int timeout_;
+  Size_t pos_;
+  Size_t size_;
+  int handle_;
+  void MakeHeader(Entry const& entry);
+  void Fail(std::string const& failure);
+};
+
+/** Parser of tar archive coming from stream.
+  Archive is processed while being read, so it is never stored as
+  whole. Only regular files and directories are reported, other types
+  of entries are skipped. Understands POSIX ustar and GNU formats as
+  produced by PayloadTarStream and common tar utilities. Names are
+  reported as stored in archive - it is up to caller to check if they
+  are acceptable. */
+class TarReader {
+ public:
+  TarReader(PayloadStreamInterface& stream);
+  ~TarReader(void);
+  /** Moves to next file or directory. Unread content of current file is skipped.
+    Returns false at end of archive or if archive is broken. */
+  bool Next(PayloadTarStream::Entry& entry);
+  /** Reads content of current file. Returns false when file is over. */
+  bool Read(char* buf,int& size);
+  /** True if archive is broken or ended prematurely. */
+  bool Failed(void) const { return failed_; };
+ private:
+  PayloadStreamInterface& stream_;
+  unsigned long long int left_;  /** content of current file not read yet */
+  unsigned long long int pad_;   /** padding after content of current file */
+  bool failed_;
+  bool finished_;
+  bool ReadExact(char* buf,unsigned long long int size);
+  bool Skip(unsigned long long int size);
+};
+
+} // namespace Arc
+
+#endif /* __ARC_PAYLOADTAR_H__ */
@@ -15,6 +15,123 @@ namespace Arc {
   {
   }
 
+  PlexerRoutes::Node::Node() : prefix(-1), exact(-1) {
+  }
+
+  PlexerRoutes::Node::~Node() {
+    for (std::map<char,Node*>::iterator child = children.begin();
+         child != children.end(); ++child)
+      delete child->second;
+  }
+
+  PlexerRoutes::PlexerRoutes() {
+  }
+
+  PlexerRoutes::~PlexerRoutes() {
+  }
+
+  // Characters having special meaning in basic or extended
+  // regular expressions
+  static const char* regex_special = ".[]\\*^$+?(){}|";
+
+  void PlexerRoutes::Build(const std::list<PlexerEntry>& entries) {
+    for (std::map<char,Node*>::iterator child = root_.children.begin();
+         child != root_.children.end(); ++child)
+      delete child->second;
+    root_.children.clear();
+    root_.prefix = -1;
+    root_.exact = -1;
+    substrings_.clear();
+    regexes_.clear();
+    entries_.clear();
+    for (std::list<PlexerEntry>::const_iterator entry = entries.begin();
+         entry != entries.end(); ++entry) {
+      int priority = entries_.size();
+      entries_.push_back(&(*entry));
+      std::string label = entry->label.getPattern();
+      bool start = false;
+      bool end = false;
+      if (!label.empty() && (label[0] == '^')) {
+        start = true;
+        label.erase(0, 1);
+      }
+      if (!label.empty() && (label[label.length()-1] == '$') &&
+          ((label.length() < 2) || (label[label.length()-2] != '\\'))) {
+        end = true;
+        label.resize(label.length()-1);
+      }
+      if ((label.find_first_of(regex_special) != std::string::npos) ||
+          (!start && (end || label.empty()))) {
+        regexes_.push_back(priority);
+        continue;
+      }
+      if (!start) {
+        substrings_.push_back(std::make_pair(priority, label));
+        continue;
+      }
+      Node* node = &root_;
+      for (std::string::size_type n = 0; n < label.length(); ++n) {
+        Node*& child = node->children[label[n]];
+        if (!child) child = new Node;
+        node = child;
+      }
+      // Entries come newest first, so the label added to Plexer last
+      // claims the slot and shadows older identical labels
+      int& slot = end ? node->exact : node->prefix;
+      if (slot < 0) slot = priority;
+    }
+  }
+
+  const PlexerEntry* PlexerRoutes::Route(const std::string& path, std::string& extension) const {
+    int best = -1;
+    std::string::size_type best_start = 0;
+    std::string::size_type best_end = 0;
+    const Node* node = &root_;
+    for (std::string::size_type n = 0;; ++n) {
+      if ((node->prefix >= 0) && ((best < 0) || (node->prefix < best))) {
+        best = node->prefix;
+        best_end = n;
+      }
+      if (n >= path.length()) {
+        if ((node->exact >= 0) && ((best < 0) || (node->exact < best))) {
+          best = node->exact;
+          best_end = n;
+        }
+        break;
+      }
+      std::map<char,Node*>::const_iterator child = node->children.find(path[n]);
+      if (child == node->children.end()) break;
+      node = child->second;
+    }
+    // Remaining labels are checked only if they have higher priority
+    for (std::vector< std::pair<int,std::string> >::const_iterator s = substrings_.begin();
+         s != substrings_.end(); ++s) {
+      if ((best >= 0) && (s->first > best)) break;
+      std::string::size_type pos = path.find(s->second);
+      if (pos == std::string::npos) continue;
+      best = s->first;
+      best_start = pos;
+      best_end = pos + s->second.length();
+      break;
+    }
+    for (std::vector<int>::const_iterator r = regexes_.begin(); r != regexes_.end(); ++r) {
+      if ((best >= 0) && (*r > best)) break;
+      std::list<std::string> unmatched, matched;
+      if (entries_[*r]->label.match(path, unmatched, matched)) {
+        extension = unmatched.empty() ? std::string("") : *(--unmatched.end());
+        return entries_[*r];
+      }
+    }
+    if (best < 0) return NULL;
+    // Same as last unmatched part reported by regular expression
+    if (best_end < path.length()) {
+      extension = path.substr(best_end);
+    } else {
+      extension = path.substr(0, best_start);
+    }
+    return entries_[best];
+  }
+
   Plexer::Plexer(Config *cfg, PluginArgument* arg) : MCC(cfg, arg) {
   }
 
@@ -27,6 +144,7 @@ namespace Arc {
       RegularExpression regex(label);
       if (regex.isOk()) {
         mccs.push_front(PlexerEntry(regex,next));
+        routes.Build(mccs);
       } else {
         logger.msg(WARNING, "Bad label: \"%s\"", label);
       }
@@ -38,24 +156,23 @@ namespace Arc {
           ++iter;
         }
       }
+      routes.Build(mccs);
     }
   }
   
   MCC_Status Plexer::process(Message& request, Message& response){
-    std::string ep = request.Attributes()->get("ENDPOINT");
+    static const AttributeKey endpoint_key("ENDPOINT");
+    static const AttributeKey pattern_key("PLEXER:PATTERN");
+    static const AttributeKey extension_key("PLEXER:EXTENSION");
+    std::string ep = request.Attributes()->get(endpoint_key);
     std::string path = getPath(ep);
     logger.msg(VERBOSE, "Operation on path \"%s\"",path);
-    std::list<PlexerEntry>::iterator iter;
-    for (iter=mccs.begin(); iter!=mccs.end(); ++iter) {
-      std::list<std::string> unmatched, matched;
-      if (iter->label.match(path, unmatched, matched)) {
-        request.Attributes()->set("PLEXER:PATTERN",iter->label.getPattern());
-        request.Attributes()->set("PLEXER:EXTENSION", "");
-        if(unmatched.size() > 0) {
-          request.Attributes()->set("PLEXER:EXTENSION",*(--unmatched.end()));
-        };
-        return iter->mcc->process(request, response);
-      }
+    std::string extension;
+    const PlexerEntry* entry = routes.Route(path, extension);
+    if (entry) {
+      request.Attributes()->set(pattern_key,entry->label.getPattern());
+      request.Attributes()->set(extension_key,extension);
+      return entry->mcc->process(request, response);
     }
     logger.msg(WARNING, "No next MCC or Service at path \"%s\"",path);
     return MCC_Status(UNKNOWN_SERVICE_ERROR,
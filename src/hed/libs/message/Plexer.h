@@ -4,7 +4,9 @@
 #define __ARC_MCC_PLEXER__
 
 #include <list>
+#include <map>
 #include <string>
+#include <vector>
 #include <arc/ArcRegex.h>
 #include <arc/ArcConfig.h>
 #include <arc/message/MCC.h>
@@ -26,6 +28,48 @@ namespace Arc {
     RegularExpression label;
     MCCInterface* mcc;
     friend class Plexer;
+    friend class PlexerRoutes;
+  };
+
+
+  //! Compiled routing table of Plexer.
+  /*! Labels which are plain paths - optionally anchored with ^ and $ -
+    are stored in a trie indexed by characters of path, so routing
+    takes time proportional to length of path instead of number of
+    labels. Unanchored plain paths are searched as substrings. Only
+    labels using other regular expression features are matched with
+    regexec. Result is always the same as trying labels in order of
+    priority and taking the first one which matches.
+  */
+  class PlexerRoutes {
+  public:
+    PlexerRoutes();
+    ~PlexerRoutes();
+
+    //! Compiles table from entries ordered by decreasing priority.
+    void Build(const std::list<PlexerEntry>& entries);
+
+    //! Finds entry for path.
+    /*! \param path The path part of endpoint.
+      \param extension Set to last part of path not matched by label.
+      \return Matching entry with highest priority or NULL.
+    */
+    const PlexerEntry* Route(const std::string& path, std::string& extension) const;
+
+  private:
+    struct Node {
+      std::map<char,Node*> children;
+      int prefix; // label matching paths starting here
+      int exact;  // label matching path ending here
+      Node();
+      ~Node();
+    };
+    Node root_;
+    std::vector< std::pair<int,std::string> > substrings_;
+    std::vector<int> regexes_;
+    std::vector<const PlexerEntry*> entries_;
+    PlexerRoutes(const PlexerRoutes&);
+    PlexerRoutes& operator=(const PlexerRoutes&);
   };
 
 
@@ -80,6 +124,9 @@ namespace Arc {
       elements with MCC interface. It is used for routing messages.
     */
     std::list<PlexerEntry> mccs;
+
+    //! Routing table compiled from mccs.
+    PlexerRoutes routes;
   };
 
 }
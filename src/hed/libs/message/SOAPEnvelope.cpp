@@ -41,6 +41,12 @@ SOAPEnvelope::SOAPEnvelope(const char* s,int l):XMLNode(s,l) {
   decode();
 }
 
+SOAPEnvelope::SOAPEnvelope(std::streambuf& in):XMLNode() {
+  ReadFromStreamBuf(in);
+  set();
+  decode();
+}
+
 SOAPEnvelope::SOAPEnvelope(const SOAPEnvelope& soap):XMLNode(),fault(NULL) {
   soap.envelope.New(*this);
   set();
@@ -250,6 +256,19 @@ void SOAPEnvelope::GetXML(std::string& out_xml_str,bool user_friendly) const {
   envelope.GetXML(out_xml_str,user_friendly);
 }
 
+bool SOAPEnvelope::GetXML(std::ostream& out,bool user_friendly) const {
+  if(header.Size() == 0) {
+    SOAPEnvelope& it = *(SOAPEnvelope*)this;
+    XMLNode tmp_header;
+    it.header.Move(tmp_header);
+    bool r = envelope.GetXML(out,user_friendly);
+    it.header=it.envelope.NewChild("soap-env:Header",0,true);
+    it.header.Exchange(tmp_header);
+    return r;
+  };
+  return envelope.GetXML(out,user_friendly);
+}
+
 // Wrap existing fault
 SOAPFault::SOAPFault(XMLNode body) {
   ver12 = (body.Namespace() == SOAP12_ENV_NAMESPACE);
@@ -100,6 +100,9 @@ class SOAPEnvelope: public XMLNode {
   SOAPEnvelope(const std::string& xml);
   /** Same as previous */
   SOAPEnvelope(const char* xml,int len = -1);
+  /** Create new SOAP message from XML document read from stream buffer.
+    Document is parsed while being read. Otherwise same as previous. */
+  SOAPEnvelope(std::streambuf& in);
   /** Create new SOAP message with specified namespaces.
     Created XML structure is owned by this instance.
     If argument fault is set to true created message is fault.  */
@@ -133,6 +136,8 @@ class SOAPEnvelope: public XMLNode {
   NS Namespaces(void);
   // Setialize SOAP message into XML document
   void GetXML(std::string& out_xml_str,bool user_friendly = false) const;
+  /** Serialize SOAP message directly into stream */
+  bool GetXML(std::ostream& out,bool user_friendly = false) const;
   /** Get SOAP header as XML node. */
   XMLNode Header(void) { return header; };
   /** Get SOAP body as XML node.
@@ -0,0 +1,140 @@
+// -*- indent-tabs-mode: nil -*-
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/time.h>
+
+#include <arc/StringConv.h>
+#include <arc/message/MessageAttributes.h>
+
+// Measures filling and reading attributes of typical HTTP request
+// compared to multimap of strings with connection attributes copied
+// into every message as MessageAttributes used to do. Not part of
+// regular tests because results depend on machine load. Run manually
+// to see timings.
+
+class MessageAttributesBenchmark
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(MessageAttributesBenchmark);
+  CPPUNIT_TEST(benchRequest);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void benchRequest();
+};
+
+static double Now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+// Same operations as MessageAttributes before keys were interned
+static void MapSet(Arc::AttrMap& attrs, const std::string& key, const std::string& value) {
+  attrs.erase(key);
+  attrs.insert(std::pair<std::string,std::string>(key, value));
+}
+
+static const std::string& MapGet(const Arc::AttrMap& attrs, const std::string& key) {
+  static std::string empty;
+  std::pair<Arc::AttrConstIter,Arc::AttrConstIter> range = attrs.equal_range(key);
+  if ((range.first == range.second) || (++Arc::AttrConstIter(range.first) != range.second)) return empty;
+  return range.first->second;
+}
+
+static const char* const connection_keys[] = {
+  "TCP:HOST", "TCP:PORT", "TCP:REMOTEHOST", "TCP:REMOTEPORT",
+  "TLS:IDENTITYDN", "TLS:PEERDN", "TLS:LOCALDN", "TLS:PEERCERT", NULL
+};
+
+static const char* const header_keys[] = {
+  "HTTP:host", "HTTP:user-agent", "HTTP:accept", "HTTP:accept-encoding",
+  "HTTP:content-type", "HTTP:content-length", "HTTP:connection",
+  "HTTP:x-request-id", "HTTP:authorization", "HTTP:cache-control", NULL
+};
+
+static const char* const read_keys[] = {
+  "HTTP:METHOD", "HTTP:ENDPOINT", "ENDPOINT", "TCP:REMOTEHOST",
+  "TLS:PEERDN", "HTTP:content-type", "HTTP:accept", "HTTP:x-request-id",
+  "PLEXER:PATTERN", "PLEXER:EXTENSION", NULL
+};
+
+void MessageAttributesBenchmark::benchRequest() {
+  const int requests = 200000;
+  std::string value("value of moderate length");
+
+  Arc::MessageAttributes connection;
+  Arc::AttrMap connection_map;
+  for (int n = 0; connection_keys[n]; ++n) {
+    connection.set(connection_keys[n], value);
+    MapSet(connection_map, connection_keys[n], value);
+  }
+
+  unsigned int found = 0;
+  double start = Now();
+  for (int r = 0; r < requests; ++r) {
+    Arc::MessageAttributes attrs(&connection);
+    attrs.set("HTTP:METHOD", "POST");
+    attrs.set("HTTP:ENDPOINT", "/arex/rest/1.0/jobs");
+    attrs.set("ENDPOINT", "https://host:443/arex/rest/1.0/jobs");
+    for (int n = 0; header_keys[n]; ++n) attrs.add(header_keys[n], value);
+    attrs.set("PLEXER:PATTERN", "/arex");
+    attrs.set("PLEXER:EXTENSION", "/rest/1.0/jobs");
+    for (int n = 0; read_keys[n]; ++n) found += attrs.get(read_keys[n]).length();
+  }
+  double strings = Now() - start;
+
+  Arc::AttributeKey method_key("HTTP:METHOD");
+  Arc::AttributeKey endpoint_key("HTTP:ENDPOINT");
+  Arc::AttributeKey global_endpoint_key("ENDPOINT");
+  Arc::AttributeKey pattern_key("PLEXER:PATTERN");
+  Arc::AttributeKey extension_key("PLEXER:EXTENSION");
+  std::vector<Arc::AttributeKey> keys;
+  for (int n = 0; read_keys[n]; ++n) keys.push_back(Arc::AttributeKey(read_keys[n]));
+  unsigned int found_keys = 0;
+  start = Now();
+  for (int r = 0; r < requests; ++r) {
+    Arc::MessageAttributes attrs(&connection);
+    attrs.set(method_key, "POST");
+    attrs.set(endpoint_key, "/arex/rest/1.0/jobs");
+    attrs.set(global_endpoint_key, "https://host:443/arex/rest/1.0/jobs");
+    for (int n = 0; header_keys[n]; ++n) attrs.add(header_keys[n], value);
+    attrs.set(pattern_key, "/arex");
+    attrs.set(extension_key, "/rest/1.0/jobs");
+    for (std::vector<Arc::AttributeKey>::const_iterator k = keys.begin(); k != keys.end(); ++k)
+      found_keys += attrs.get(*k).length();
+  }
+  double interned = Now() - start;
+
+  unsigned int found_map = 0;
+  start = Now();
+  for (int r = 0; r < requests; ++r) {
+    Arc::AttrMap attrs(connection_map);
+    MapSet(attrs, "HTTP:METHOD", "POST");
+    MapSet(attrs, "HTTP:ENDPOINT", "/arex/rest/1.0/jobs");
+    MapSet(attrs, "ENDPOINT", "https://host:443/arex/rest/1.0/jobs");
+    for (int n = 0; header_keys[n]; ++n)
+      attrs.insert(std::pair<std::string,std::string>(header_keys[n], value));
+    MapSet(attrs, "PLEXER:PATTERN", "/arex");
+    MapSet(attrs, "PLEXER:EXTENSION", "/rest/1.0/jobs");
+    for (int n = 0; read_keys[n]; ++n) found_map += MapGet(attrs, read_keys[n]).length();
+  }
+  double multimap = Now() - start;
+
+  std::cout << std::endl << requests << " requests: string keys "
+            << (int)(strings * 1000) << " ms, interned keys: " << (int)(interned * 1000)
+            << " ms, multimap: " << (int)(multimap * 1000) << " ms" << std::endl;
+  CPPUNIT_ASSERT_EQUAL(found_map, found);
+  CPPUNIT_ASSERT_EQUAL(found_map, found_keys);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MessageAttributesBenchmark);
@@ -0,0 +1,158 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <arc/message/MessageAttributes.h>
+
+class MessageAttributesTest
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(MessageAttributesTest);
+  CPPUNIT_TEST(TestAttributes);
+  CPPUNIT_TEST(TestKeys);
+  CPPUNIT_TEST(TestShared);
+  CPPUNIT_TEST(TestLocalKeys);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void TestAttributes();
+  void TestKeys();
+  void TestShared();
+  void TestLocalKeys();
+};
+
+static int countAll(Arc::AttributeIterator i) {
+  int n = 0;
+  for(;i.hasMore();++i) ++n;
+  return n;
+}
+
+void MessageAttributesTest::TestAttributes() {
+  Arc::MessageAttributes attrs;
+  CPPUNIT_ASSERT_EQUAL(0, attrs.count("HTTP:METHOD"));
+  CPPUNIT_ASSERT_EQUAL(std::string(""), attrs.get("HTTP:METHOD"));
+  CPPUNIT_ASSERT(!attrs.getAll("HTTP:METHOD").hasMore());
+  attrs.set("HTTP:METHOD", "GET");
+  attrs.add("HTTP:accept", "text/xml");
+  attrs.add("HTTP:accept", "application/json");
+  CPPUNIT_ASSERT_EQUAL(1, attrs.count("HTTP:METHOD"));
+  CPPUNIT_ASSERT_EQUAL(std::string("GET"), attrs.get("HTTP:METHOD"));
+  CPPUNIT_ASSERT_EQUAL(2, attrs.count("HTTP:accept"));
+  // Multiple values are not returned by get()
+  CPPUNIT_ASSERT_EQUAL(std::string(""), attrs.get("HTTP:accept"));
+  Arc::AttributeIterator i = attrs.getAll("HTTP:accept");
+  CPPUNIT_ASSERT(i.hasMore());
+  CPPUNIT_ASSERT_EQUAL(std::string("HTTP:accept"), i.key());
+  CPPUNIT_ASSERT_EQUAL(std::string("text/xml"), *i);
+  ++i;
+  CPPUNIT_ASSERT_EQUAL(std::string("application/json"), *i);
+  ++i;
+  CPPUNIT_ASSERT(!i.hasMore());
+  CPPUNIT_ASSERT_EQUAL(3, countAll(attrs.getAll()));
+  attrs.set("HTTP:METHOD", "PUT");
+  CPPUNIT_ASSERT_EQUAL(std::string("PUT"), attrs.get("HTTP:METHOD"));
+  attrs.remove("HTTP:accept", "text/xml");
+  CPPUNIT_ASSERT_EQUAL(std::string("application/json"), attrs.get("HTTP:accept"));
+  attrs.removeAll("HTTP:accept");
+  CPPUNIT_ASSERT_EQUAL(0, attrs.count("HTTP:accept"));
+  CPPUNIT_ASSERT_EQUAL(1, countAll(attrs.getAll()));
+  // Copy is independent
+  Arc::MessageAttributes copy(attrs);
+  copy.set("HTTP:METHOD", "POST");
+  CPPUNIT_ASSERT_EQUAL(std::string("PUT"), attrs.get("HTTP:METHOD"));
+  CPPUNIT_ASSERT_EQUAL(std::string("POST"), copy.get("HTTP:METHOD"));
+}
+
+void MessageAttributesTest::TestKeys() {
+  Arc::AttributeKey key1("TCP:REMOTEHOST");
+  Arc::AttributeKey key2(std::string("TCP:")+"REMOTEHOST");
+  Arc::AttributeKey key3("TCP:REMOTEPORT");
+  CPPUNIT_ASSERT(key1 == key2);
+  CPPUNIT_ASSERT(key1 != key3);
+  CPPUNIT_ASSERT_EQUAL(&(key1.str()), &(key2.str()));
+  Arc::MessageAttributes attrs;
+  attrs.set(key1, "127.0.0.1");
+  CPPUNIT_ASSERT_EQUAL(std::string("127.0.0.1"), attrs.get("TCP:REMOTEHOST"));
+  attrs.add("TCP:REMOTEPORT", "2811");
+  CPPUNIT_ASSERT_EQUAL(std::string("2811"), attrs.get(key3));
+  CPPUNIT_ASSERT_EQUAL(1, attrs.count(key3));
+  attrs.removeAll(key3);
+  CPPUNIT_ASSERT_EQUAL(0, attrs.count("TCP:REMOTEPORT"));
+}
+
+void MessageAttributesTest::TestShared() {
+  Arc::MessageAttributes connection;
+  connection.set("TCP:REMOTEHOST", "127.0.0.1");
+  connection.set("TCP:REMOTEPORT", "2811");
+  connection.add("TLS:PEERDN", "/CN=user");
+  connection.add("TLS:PEERDN", "/CN=proxy");
+
+  Arc::MessageAttributes request(&connection);
+  CPPUNIT_ASSERT_EQUAL(std::string("127.0.0.1"), request.get("TCP:REMOTEHOST"));
+  CPPUNIT_ASSERT_EQUAL(2, request.count("TLS:PEERDN"));
+  CPPUNIT_ASSERT_EQUAL(4, countAll(request.getAll()));
+
+  request.set("HTTP:METHOD", "GET");
+  request.set("TCP:REMOTEPORT", "443");
+  request.add("TLS:PEERDN", "/CN=other");
+  CPPUNIT_ASSERT_EQUAL(std::string("443"), request.get("TCP:REMOTEPORT"));
+  CPPUNIT_ASSERT_EQUAL(3, request.count("TLS:PEERDN"));
+  CPPUNIT_ASSERT_EQUAL(6, countAll(request.getAll()));
+  CPPUNIT_ASSERT_EQUAL(3, countAll(request.getAll("TLS:PEERDN")));
+  request.remove("TLS:PEERDN", "/CN=user");
+  CPPUNIT_ASSERT_EQUAL(2, request.count("TLS:PEERDN"));
+  request.removeAll("TCP:REMOTEHOST");
+  CPPUNIT_ASSERT_EQUAL(0, request.count("TCP:REMOTEHOST"));
+  CPPUNIT_ASSERT(!request.getAll("TCP:REMOTEHOST").hasMore());
+  CPPUNIT_ASSERT_EQUAL(4, countAll(request.getAll()));
+
+  // Shared attributes are never modified
+  CPPUNIT_ASSERT_EQUAL(std::string("127.0.0.1"), connection.get("TCP:REMOTEHOST"));
+  CPPUNIT_ASSERT_EQUAL(std::string("2811"), connection.get("TCP:REMOTEPORT"));
+  CPPUNIT_ASSERT_EQUAL(2, connection.count("TLS:PEERDN"));
+  CPPUNIT_ASSERT_EQUAL(0, connection.count("HTTP:METHOD"));
+
+  // Another request on same connection starts from shared attributes again
+  Arc::MessageAttributes next(&connection);
+  CPPUNIT_ASSERT_EQUAL(std::string("2811"), next.get("TCP:REMOTEPORT"));
+  CPPUNIT_ASSERT_EQUAL(0, next.count("HTTP:METHOD"));
+}
+
+void MessageAttributesTest::TestLocalKeys() {
+  // Keys passed as strings are stored in object unless interned already
+  Arc::MessageAttributes* attrs = new Arc::MessageAttributes;
+  attrs->add("HTTP:x-local-key", "value1");
+  attrs->add("HTTP:x-local-key", "value2");
+  attrs->set("HTTP:x-other-key", "other");
+  CPPUNIT_ASSERT_EQUAL(2, attrs->count("HTTP:x-local-key"));
+  // Key interned later still refers to the same attribute
+  Arc::AttributeKey key("HTTP:x-local-key");
+  CPPUNIT_ASSERT_EQUAL(2, attrs->count(key));
+  attrs->add(key, "value3");
+  CPPUNIT_ASSERT_EQUAL(3, attrs->count("HTTP:x-local-key"));
+  CPPUNIT_ASSERT_EQUAL(3, countAll(attrs->getAll(key)));
+  // Copy does not refer to keys of original object
+  Arc::MessageAttributes copy(*attrs);
+  Arc::MessageAttributes assigned;
+  assigned = *attrs;
+  delete attrs;
+  CPPUNIT_ASSERT_EQUAL(std::string("other"), copy.get("HTTP:x-other-key"));
+  CPPUNIT_ASSERT_EQUAL(3, copy.count(key));
+  CPPUNIT_ASSERT_EQUAL(std::string("other"), assigned.get("HTTP:x-other-key"));
+  CPPUNIT_ASSERT_EQUAL(4, countAll(assigned.getAll()));
+  Arc::AttributeIterator i = copy.getAll("HTTP:x-other-key");
+  CPPUNIT_ASSERT(i.hasMore());
+  CPPUNIT_ASSERT_EQUAL(std::string("HTTP:x-other-key"), i.key());
+  // Local keys of shared object are used by sharing one
+  Arc::MessageAttributes request(&copy);
+  request.set("HTTP:x-other-key", "changed");
+  CPPUNIT_ASSERT_EQUAL(std::string("changed"), request.get("HTTP:x-other-key"));
+  CPPUNIT_ASSERT_EQUAL(std::string("other"), copy.get("HTTP:x-other-key"));
+  request.removeAll(key);
+  CPPUNIT_ASSERT_EQUAL(0, request.count("HTTP:x-local-key"));
+  CPPUNIT_ASSERT_EQUAL(3, copy.count("HTTP:x-local-key"));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MessageAttributesTest);
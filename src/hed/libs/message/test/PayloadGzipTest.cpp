@@ -0,0 +1,93 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string>
+#include <list>
+#include <zlib.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <arc/message/PayloadRaw.h>
+#include <arc/message/PayloadGzip.h>
+
+class PayloadGzipTest
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(PayloadGzipTest);
+  CPPUNIT_TEST(TestGzipAccepted);
+  CPPUNIT_TEST(TestGzipRaw);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void TestGzipAccepted();
+  void TestGzipRaw();
+};
+
+static bool Accepted(std::string const& header) {
+  std::list<std::string> headers;
+  headers.push_back(header);
+  return Arc::GzipAccepted(headers);
+}
+
+void PayloadGzipTest::TestGzipAccepted() {
+  CPPUNIT_ASSERT(!Arc::GzipAccepted(std::list<std::string>()));
+  CPPUNIT_ASSERT(Accepted("gzip"));
+  CPPUNIT_ASSERT(Accepted("deflate, GZIP"));
+  CPPUNIT_ASSERT(Accepted("x-gzip"));
+  CPPUNIT_ASSERT(Accepted("gzip;q=0.5"));
+  CPPUNIT_ASSERT(!Accepted("deflate"));
+  CPPUNIT_ASSERT(!Accepted("gzip;q=0"));
+  CPPUNIT_ASSERT(!Accepted("gzip; q=0.000"));
+  CPPUNIT_ASSERT(!Accepted("gzip;Q=0.0"));
+  CPPUNIT_ASSERT(Accepted("*"));
+  CPPUNIT_ASSERT(!Accepted("*;q=0"));
+  // Explicit entry takes precedence over wildcard
+  CPPUNIT_ASSERT(!Accepted("*, gzip;q=0"));
+  CPPUNIT_ASSERT(Accepted("gzip, *;q=0"));
+  // Values of repeated headers are combined
+  std::list<std::string> headers;
+  headers.push_back("deflate");
+  headers.push_back("gzip");
+  CPPUNIT_ASSERT(Arc::GzipAccepted(headers));
+}
+
+void PayloadGzipTest::TestGzipRaw() {
+  std::string content;
+  for(int n = 0; n < 10000; ++n) content += "line of text to compress\n";
+  Arc::PayloadRaw* raw = new Arc::PayloadRaw;
+  raw->Insert(content.c_str(), 0, content.length()/2);
+  raw->Insert(content.c_str()+content.length()/2, content.length()/2, content.length()-content.length()/2);
+  Arc::PayloadGzipStream gzip(*raw, true);
+  std::string compressed;
+  char buf[1000];
+  for(;;) {
+    int size = sizeof(buf);
+    if(!gzip.Get(buf, size)) break;
+    compressed.append(buf, size);
+  }
+  CPPUNIT_ASSERT((bool)gzip);
+  CPPUNIT_ASSERT(compressed.length() < content.length());
+  CPPUNIT_ASSERT_EQUAL((unsigned long long int)content.length(), (unsigned long long int)gzip.InSize());
+  CPPUNIT_ASSERT_EQUAL((unsigned long long int)compressed.length(), (unsigned long long int)gzip.OutSize());
+
+  z_stream strm;
+  strm.zalloc = Z_NULL;
+  strm.zfree = Z_NULL;
+  strm.opaque = Z_NULL;
+  strm.next_in = Z_NULL;
+  strm.avail_in = 0;
+  CPPUNIT_ASSERT_EQUAL(Z_OK, inflateInit2(&strm, 15+16));
+  std::string decompressed(content.length()+1, '\0');
+  strm.next_in = (Bytef*)compressed.c_str();
+  strm.avail_in = compressed.length();
+  strm.next_out = (Bytef*)&(decompressed[0]);
+  strm.avail_out = decompressed.length();
+  int r = inflate(&strm, Z_FINISH);
+  decompressed.resize(decompressed.length() - strm.avail_out);
+  inflateEnd(&strm);
+  CPPUNIT_ASSERT_EQUAL(Z_STREAM_END, r);
+  CPPUNIT_ASSERT(decompressed == content);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PayloadGzipTest);
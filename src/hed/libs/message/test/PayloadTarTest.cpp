@@ -0,0 +1,286 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string>
+#include <map>
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <arc/message/PayloadGzip.h>
+#include <arc/message/PayloadTar.h>
+
+class PayloadTarTest
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(PayloadTarTest);
+  CPPUNIT_TEST(TestTarStream);
+  CPPUNIT_TEST(TestTarReader);
+  CPPUNIT_TEST(TestTarFailure);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void TestTarStream();
+  void TestTarReader();
+  void TestTarFailure();
+};
+
+// Archive with content of files taken from memory
+class MemoryTarStream: public Arc::PayloadTarStream {
+ public:
+  std::map<std::string,std::string> files;
+  std::string unreadable;
+  MemoryTarStream(void):Arc::PayloadTarStream(1000,1000),pos_(0) {}
+  void Add(std::string const& name, std::string const& content, unsigned long long int size) {
+    Entry entry;
+    entry.name = name;
+    entry.path = name;
+    entry.size = size;
+    entry.mode = 0644;
+    entry.mtime = 1600000000;
+    files[name] = content;
+    Arc::PayloadTarStream::Add(entry);
+  }
+  std::string Read(void) {
+    std::string out;
+    char buf[1000];
+    for(;;) {
+      int size = sizeof(buf);
+      if(!Get(buf, size)) break;
+      out.append(buf, size);
+    }
+    return out;
+  }
+ protected:
+  virtual bool OpenFile(Entry const& entry) {
+    if(files.find(entry.path) == files.end()) return false;
+    content_ = files[entry.path]; path_ = entry.path; pos_ = 0;
+    return true;
+  }
+  virtual bool ReadFile(char* buf, int& size) {
+    if(path_ == unreadable) { size = 0; return false; }
+    if(pos_ >= content_.length()) { size = 0; return true; }
+    if((std::string::size_type)size > content_.length()-pos_) size = content_.length()-pos_;
+    memcpy(buf, content_.c_str()+pos_, size);
+    pos_ += size;
+    return true;
+  }
+  virtual void CloseFile(void) { content_.clear(); path_.clear(); }
+ private:
+  std::string content_;
+  std::string path_;
+  std::string::size_type pos_;
+};
+
+static void FillTar(MemoryTarStream& tar) {
+  Arc::PayloadTarStream::Entry dir;
+  dir.name = "out";
+  dir.dir = true;
+  dir.mode = 0755;
+  tar.Arc::PayloadTarStream::Add(dir);
+  tar.Add("out/small", "hello", 5);
+  tar.Add("out/" + std::string(150, 'n'), std::string(1000, 'x'), 1000);
+  // File which got shorter after being listed
+  tar.Add("shrunk", "abc", 10);
+}
+
+void PayloadTarTest::TestTarStream() {
+  MemoryTarStream tar;
+  FillTar(tar);
+  std::string out = tar.Read();
+  CPPUNIT_ASSERT((bool)tar);
+  // Size is known in advance and all blocks are complete
+  CPPUNIT_ASSERT_EQUAL((unsigned long long int)tar.Size(), (unsigned long long int)out.length());
+  CPPUNIT_ASSERT_EQUAL((std::string::size_type)0, out.length() % 512);
+  // directory, small file, long name header + file, shrunk file, end of archive
+  CPPUNIT_ASSERT_EQUAL((std::string::size_type)(512 + 1024 + 1024 + 1536 + 1024 + 1024), out.length());
+
+  CPPUNIT_ASSERT_EQUAL(std::string("out/"), std::string(out.c_str()));
+  CPPUNIT_ASSERT_EQUAL('5', out[156]);
+  CPPUNIT_ASSERT_EQUAL(std::string("ustar"), std::string(out.c_str()+257));
+  // Checksum covers header with checksum field treated as spaces
+  std::string header(out, 512, 512);
+  unsigned int sum = 0;
+  for(unsigned int n = 0; n < 512; ++n) sum += (n >= 148 && n < 156) ? ' ' : (unsigned char)header[n];
+  char chksum[8];
+  snprintf(chksum, sizeof(chksum), "%06o", sum);
+  CPPUNIT_ASSERT_EQUAL(std::string(chksum), std::string(header.c_str()+148));
+  CPPUNIT_ASSERT_EQUAL(std::string("out/small"), std::string(header.c_str()));
+  CPPUNIT_ASSERT_EQUAL(std::string("00000000005"), std::string(header.c_str()+124));
+  CPPUNIT_ASSERT_EQUAL(std::string("0001750"), std::string(header.c_str()+108));
+  CPPUNIT_ASSERT_EQUAL(std::string("hello"), out.substr(1024, 5));
+  CPPUNIT_ASSERT_EQUAL(std::string(507, '\0'), out.substr(1029, 507));
+
+  header = out.substr(1536, 512);
+  CPPUNIT_ASSERT_EQUAL(std::string("././@LongLink"), std::string(header.c_str()));
+  CPPUNIT_ASSERT_EQUAL('L', header[156]);
+  CPPUNIT_ASSERT_EQUAL("out/" + std::string(150, 'n'), std::string(out.c_str()+2048));
+  CPPUNIT_ASSERT_EQUAL('0', out[2560+156]);
+  CPPUNIT_ASSERT_EQUAL(std::string(1000, 'x'), out.substr(3072, 1000));
+
+  CPPUNIT_ASSERT_EQUAL(std::string("shrunk"), std::string(out.c_str()+4096));
+  CPPUNIT_ASSERT_EQUAL(std::string("abc") + std::string(7, '\0'), out.substr(4608, 10));
+  CPPUNIT_ASSERT_EQUAL(std::string(1024, '\0'), out.substr(out.length()-1024));
+
+  // Compressed archive must decompress to same content
+  MemoryTarStream* ztar = new MemoryTarStream;
+  FillTar(*ztar);
+  Arc::PayloadGzipStream zstream(*ztar, true);
+  CPPUNIT_ASSERT_EQUAL((unsigned long long int)0, (unsigned long long int)zstream.Size());
+  std::string zout;
+  for(;;) {
+    char buf[1000];
+    int size = sizeof(buf);
+    if(!zstream.Get(buf, size)) break;
+    zout.append(buf, size);
+  }
+  CPPUNIT_ASSERT((bool)zstream);
+  CPPUNIT_ASSERT(zout.length() < out.length());
+  z_stream zs;
+  memset(&zs, 0, sizeof(zs));
+  CPPUNIT_ASSERT_EQUAL(Z_OK, inflateInit2(&zs, 15+16));
+  std::string unzout(out.length() + 1, '\0');
+  zs.next_in = (Bytef*)zout.c_str();
+  zs.avail_in = zout.length();
+  zs.next_out = (Bytef*)&unzout[0];
+  zs.avail_out = unzout.length();
+  CPPUNIT_ASSERT_EQUAL(Z_STREAM_END, inflate(&zs, Z_FINISH));
+  unzout.resize(unzout.length() - zs.avail_out);
+  inflateEnd(&zs);
+  CPPUNIT_ASSERT(unzout == out);
+}
+
+// Stream delivering content of string in small pieces
+class StringStream: public Arc::PayloadStreamInterface {
+ public:
+  StringStream(std::string const& content):content_(content),pos_(0) {}
+  virtual bool Get(char* buf, int& size) {
+    if(pos_ >= content_.length()) { size = 0; return false; }
+    if(size > 700) size = 700;
+    if((std::string::size_type)size > content_.length()-pos_) size = content_.length()-pos_;
+    memcpy(buf, content_.c_str()+pos_, size);
+    pos_ += size;
+    return true;
+  }
+  virtual bool Put(const char*, Size_t) { return false; }
+  virtual operator bool(void) { return true; }
+  virtual bool operator!(void) { return false; }
+  virtual int Timeout(void) const { return 0; }
+  virtual void Timeout(int) { }
+  virtual Size_t Pos(void) const { return pos_; }
+  virtual Size_t Size(void) const { return content_.length(); }
+  virtual Size_t Limit(void) const { return content_.length(); }
+ private:
+  std::string content_;
+  std::string::size_type pos_;
+};
+
+static std::string ReadTarFile(Arc::TarReader& reader) {
+  std::string content;
+  char buf[300];
+  for(;;) {
+    int size = sizeof(buf);
+    if(!reader.Read(buf, size)) break;
+    content.append(buf, size);
+  }
+  return content;
+}
+
+void PayloadTarTest::TestTarReader() {
+  MemoryTarStream tar;
+  FillTar(tar);
+  std::string out = tar.Read();
+
+  StringStream stream(out);
+  Arc::TarReader reader(stream);
+  Arc::PayloadTarStream::Entry entry;
+  CPPUNIT_ASSERT(reader.Next(entry));
+  CPPUNIT_ASSERT(entry.dir);
+  CPPUNIT_ASSERT_EQUAL(std::string("out/"), entry.name);
+  CPPUNIT_ASSERT(reader.Next(entry));
+  CPPUNIT_ASSERT(!entry.dir);
+  CPPUNIT_ASSERT_EQUAL(std::string("out/small"), entry.name);
+  CPPUNIT_ASSERT_EQUAL((mode_t)0644, entry.mode);
+  CPPUNIT_ASSERT_EQUAL((time_t)1600000000, entry.mtime);
+  CPPUNIT_ASSERT_EQUAL(std::string("hello"), ReadTarFile(reader));
+  // Content which is not read is skipped
+  CPPUNIT_ASSERT(reader.Next(entry));
+  CPPUNIT_ASSERT_EQUAL("out/" + std::string(150, 'n'), entry.name);
+  CPPUNIT_ASSERT_EQUAL((unsigned long long int)1000, entry.size);
+  CPPUNIT_ASSERT(reader.Next(entry));
+  CPPUNIT_ASSERT_EQUAL(std::string("shrunk"), entry.name);
+  CPPUNIT_ASSERT_EQUAL(std::string("abc") + std::string(7, '\0'), ReadTarFile(reader));
+  CPPUNIT_ASSERT(!reader.Next(entry));
+  CPPUNIT_ASSERT(!reader.Failed());
+
+  // Truncated archive
+  StringStream truncated(out.substr(0, 3500));
+  Arc::TarReader treader(truncated);
+  CPPUNIT_ASSERT(treader.Next(entry));
+  CPPUNIT_ASSERT(treader.Next(entry));
+  CPPUNIT_ASSERT(treader.Next(entry));
+  CPPUNIT_ASSERT_EQUAL((std::string::size_type)(3500-3072), ReadTarFile(treader).length());
+  CPPUNIT_ASSERT(treader.Failed());
+  CPPUNIT_ASSERT(!treader.Next(entry));
+
+  // Corrupted header
+  std::string corrupted(out);
+  corrupted[512] = 'O';
+  StringStream cstream(corrupted);
+  Arc::TarReader creader(cstream);
+  CPPUNIT_ASSERT(creader.Next(entry));
+  CPPUNIT_ASSERT(!creader.Next(entry));
+  CPPUNIT_ASSERT(creader.Failed());
+}
+
+void PayloadTarTest::TestTarFailure() {
+  Arc::PayloadTarStream::Entry entry;
+
+  // File which can't be opened is not replaced with zeros
+  MemoryTarStream missing;
+  FillTar(missing);
+  entry.name = "missing";
+  entry.path = "missing";
+  entry.size = 100;
+  missing.Arc::PayloadTarStream::Add(entry);
+  std::string out = missing.Read();
+  CPPUNIT_ASSERT(!missing);
+  CPPUNIT_ASSERT(!missing.Failure().empty());
+  CPPUNIT_ASSERT(out.length() < (std::string::size_type)missing.Size());
+  // Nothing is promised for missing file
+  StringStream mstream(out);
+  Arc::TarReader mreader(mstream);
+  while(mreader.Next(entry)) CPPUNIT_ASSERT(entry.name != "missing");
+  CPPUNIT_ASSERT(mreader.Failed());
+
+  // Read error breaks archive instead of padding file
+  MemoryTarStream broken;
+  FillTar(broken);
+  broken.unreadable = "out/small";
+  out = broken.Read();
+  CPPUNIT_ASSERT(!broken);
+  StringStream bstream(out);
+  Arc::TarReader breader(bstream);
+  CPPUNIT_ASSERT(breader.Next(entry));
+  CPPUNIT_ASSERT(breader.Next(entry));
+  CPPUNIT_ASSERT_EQUAL(std::string("out/small"), entry.name);
+  ReadTarFile(breader);
+  CPPUNIT_ASSERT(breader.Failed());
+
+  // Compressed stream of broken archive is not finished
+  MemoryTarStream* zbroken = new MemoryTarStream;
+  FillTar(*zbroken);
+  zbroken->unreadable = "shrunk";
+  Arc::PayloadGzipStream zstream(*zbroken, true);
+  for(;;) {
+    char buf[1000];
+    int size = sizeof(buf);
+    if(!zstream.Get(buf, size)) break;
+  }
+  CPPUNIT_ASSERT(!zstream);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PayloadTarTest);
@@ -0,0 +1,130 @@
+// -*- indent-tabs-mode: nil -*-
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <sys/time.h>
+
+#include <arc/ArcRegex.h>
+#include <arc/StringConv.h>
+#include <arc/message/Message.h>
+#include <arc/message/Plexer.h>
+
+// Measures routing of requests by Plexer compared to matching every
+// label as regular expression in order as Plexer used to do. Not part
+// of regular tests because results depend on machine load. Run manually
+// to see timings.
+
+class PlexerBenchmark
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(PlexerBenchmark);
+  CPPUNIT_TEST(benchRoute);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void benchRoute();
+};
+
+static double Now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+// Same as private Plexer::getPath()
+static std::string GetPath(const std::string& url) {
+  std::string::size_type ds = url.find("://");
+  std::string::size_type ps = url.find("/", (ds == std::string::npos) ? 0 : (ds + 3));
+  return (ps == std::string::npos) ? std::string("") : url.substr(ps);
+}
+
+class NamedMCC: public Arc::MCCInterface {
+public:
+  std::string name;
+  NamedMCC(const std::string& n):Arc::MCCInterface(NULL),name(n) { };
+  virtual Arc::MCC_Status process(Arc::Message&, Arc::Message&) {
+    return Arc::MCC_Status(Arc::STATUS_OK, name);
+  }
+};
+
+void PlexerBenchmark::benchRoute() {
+  const int lookups = 200000;
+  // Labels as configured for typical A-REX server, in order of adding
+  const char* labels[] = {
+    "^/emies/[0-9]*$", "^/arex", "^/arex/candypond", "^/datadeliveryservice",
+    "/Echo", "^/isis", NULL
+  };
+  Arc::Plexer plexer(NULL, NULL);
+  std::list<NamedMCC*> services;
+  std::list< std::pair<Arc::RegularExpression,std::string> > ordered_labels;
+  for (int n = 0; labels[n]; ++n) {
+    NamedMCC* service = new NamedMCC(labels[n]);
+    services.push_back(service);
+    plexer.Next(service, labels[n]);
+    ordered_labels.push_front(std::make_pair(Arc::RegularExpression(labels[n]), std::string(labels[n])));
+  }
+  std::vector<std::string> endpoints;
+  for (int n = 0; n < 100; ++n) {
+    std::string id = Arc::tostring(1000000 + n);
+    endpoints.push_back("https://arex.grid.org:443/arex/rest/1.0/jobs/" + id + "/session/file" + id);
+    endpoints.push_back("https://arex.grid.org:443/arex/rest/1.0/jobs/" + id + "/status");
+    endpoints.push_back("https://arex.grid.org:443/arex/candypond/" + id);
+    endpoints.push_back("https://arex.grid.org:443/datadeliveryservice");
+    endpoints.push_back("https://arex.grid.org:443/services/Echo");
+    endpoints.push_back("https://arex.grid.org:443/emies/" + id);
+    endpoints.push_back("https://arex.grid.org:443/unknown/" + id);
+  }
+
+  std::vector<std::string> routed;
+  double start = Now();
+  for (int n = 0; n < lookups; ++n) {
+    Arc::Message request;
+    Arc::Message response;
+    Arc::MessageAttributes attributes;
+    attributes.set("ENDPOINT", endpoints[n % endpoints.size()]);
+    request.Attributes(&attributes);
+    Arc::MCC_Status status = plexer.process(request, response);
+    if (n < (int)endpoints.size())
+      routed.push_back(status ? (status.getOrigin() + ":" + attributes.get("PLEXER:EXTENSION")) : "");
+  }
+  double compiled = Now() - start;
+
+  std::vector<std::string> routed_ordered;
+  start = Now();
+  for (int n = 0; n < lookups; ++n) {
+    Arc::Message request;
+    Arc::MessageAttributes attributes;
+    attributes.set("ENDPOINT", endpoints[n % endpoints.size()]);
+    request.Attributes(&attributes);
+    std::string path = GetPath(request.Attributes()->get("ENDPOINT"));
+    std::string result;
+    for (std::list< std::pair<Arc::RegularExpression,std::string> >::iterator l = ordered_labels.begin();
+         l != ordered_labels.end(); ++l) {
+      std::list<std::string> unmatched, matched;
+      if (l->first.match(path, unmatched, matched)) {
+        request.Attributes()->set("PLEXER:PATTERN", l->first.getPattern());
+        request.Attributes()->set("PLEXER:EXTENSION", unmatched.empty() ? std::string("") : *(--unmatched.end()));
+        result = l->second + ":" + attributes.get("PLEXER:EXTENSION");
+        break;
+      }
+    }
+    if (n < (int)endpoints.size()) routed_ordered.push_back(result);
+  }
+  double ordered = Now() - start;
+
+  std::cout << std::endl << lookups << " requests routed: "
+            << (int)(lookups / compiled) << " per second, ordered: "
+            << (int)(lookups / ordered) << " per second" << std::endl;
+  for (std::list<NamedMCC*>::iterator s = services.begin(); s != services.end(); ++s) delete *s;
+  CPPUNIT_ASSERT(routed_ordered == routed);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PlexerBenchmark);
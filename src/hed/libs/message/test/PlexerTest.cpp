@@ -0,0 +1,172 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <arc/message/Message.h>
+#include <arc/message/Plexer.h>
+
+class PlexerTest
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(PlexerTest);
+  CPPUNIT_TEST(TestPrefix);
+  CPPUNIT_TEST(TestLiteral);
+  CPPUNIT_TEST(TestRegex);
+  CPPUNIT_TEST(TestPriority);
+  CPPUNIT_TEST(TestOverlap);
+  CPPUNIT_TEST(TestRemove);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void TestPrefix();
+  void TestLiteral();
+  void TestRegex();
+  void TestPriority();
+  void TestOverlap();
+  void TestRemove();
+};
+
+// Remembers how it was reached
+class RecordMCC: public Arc::MCCInterface {
+public:
+  std::string name;
+  std::string pattern;
+  std::string extension;
+  RecordMCC(const std::string& n):Arc::MCCInterface(NULL),name(n) { };
+  virtual Arc::MCC_Status process(Arc::Message& request, Arc::Message&) {
+    pattern = request.Attributes()->get("PLEXER:PATTERN");
+    extension = request.Attributes()->get("PLEXER:EXTENSION");
+    return Arc::MCC_Status(Arc::STATUS_OK, name);
+  }
+};
+
+// Returns name of MCC request was passed to or empty string
+static std::string Route(Arc::Plexer& plexer, const std::string& endpoint,
+                         std::string& extension) {
+  Arc::Message request;
+  Arc::Message response;
+  Arc::MessageAttributes attributes;
+  attributes.set("ENDPOINT", endpoint);
+  request.Attributes(&attributes);
+  Arc::MCC_Status status = plexer.process(request, response);
+  if (!status) return "";
+  extension = attributes.get("PLEXER:EXTENSION");
+  return status.getOrigin();
+}
+
+static std::string Route(Arc::Plexer& plexer, const std::string& endpoint) {
+  std::string extension;
+  return Route(plexer, endpoint, extension);
+}
+
+void PlexerTest::TestPrefix() {
+  Arc::Plexer plexer(NULL, NULL);
+  RecordMCC arex("arex");
+  RecordMCC candypond("candypond");
+  plexer.Next(&arex, "^/arex");
+  plexer.Next(&candypond, "^/arex/candypond");
+  std::string extension;
+  CPPUNIT_ASSERT_EQUAL(std::string("arex"), Route(plexer, "https://host:443/arex/rest/1.0/jobs", extension));
+  CPPUNIT_ASSERT_EQUAL(std::string("/rest/1.0/jobs"), extension);
+  CPPUNIT_ASSERT_EQUAL(std::string("^/arex"), arex.pattern);
+  CPPUNIT_ASSERT_EQUAL(std::string("candypond"), Route(plexer, "https://host:443/arex/candypond/x", extension));
+  CPPUNIT_ASSERT_EQUAL(std::string("/x"), extension);
+  CPPUNIT_ASSERT_EQUAL(std::string("candypond"), Route(plexer, "/arex/candypond", extension));
+  CPPUNIT_ASSERT_EQUAL(std::string(""), extension);
+  CPPUNIT_ASSERT_EQUAL(std::string("arex"), Route(plexer, "/arexes", extension));
+  CPPUNIT_ASSERT_EQUAL(std::string("es"), extension);
+  CPPUNIT_ASSERT_EQUAL(std::string(""), Route(plexer, "/are"));
+  CPPUNIT_ASSERT_EQUAL(std::string(""), Route(plexer, "https://host:443/"));
+}
+
+void PlexerTest::TestLiteral() {
+  Arc::Plexer plexer(NULL, NULL);
+  RecordMCC echo("echo");
+  RecordMCC exact("exact");
+  plexer.Next(&echo, "/Echo");
+  plexer.Next(&exact, "^/ping$");
+  std::string extension;
+  CPPUNIT_ASSERT_EQUAL(std::string("echo"), Route(plexer, "/services/Echo/x", extension));
+  CPPUNIT_ASSERT_EQUAL(std::string("/x"), extension);
+  // Part before match is reported if match reaches end of path
+  CPPUNIT_ASSERT_EQUAL(std::string("echo"), Route(plexer, "/services/Echo", extension));
+  CPPUNIT_ASSERT_EQUAL(std::string("/services"), extension);
+  CPPUNIT_ASSERT_EQUAL(std::string("exact"), Route(plexer, "/ping", extension));
+  CPPUNIT_ASSERT_EQUAL(std::string(""), extension);
+  CPPUNIT_ASSERT_EQUAL(std::string(""), Route(plexer, "/ping/"));
+}
+
+void PlexerTest::TestRegex() {
+  Arc::Plexer plexer(NULL, NULL);
+  RecordMCC jobs("jobs");
+  RecordMCC tail("tail");
+  plexer.Next(&jobs, "^/jobs/[0-9]*");
+  plexer.Next(&tail, "/status$");
+  std::string extension;
+  CPPUNIT_ASSERT_EQUAL(std::string("jobs"), Route(plexer, "/jobs/1234/session", extension));
+  CPPUNIT_ASSERT_EQUAL(std::string("/session"), extension);
+  CPPUNIT_ASSERT_EQUAL(std::string("^/jobs/[0-9]*"), jobs.pattern);
+  CPPUNIT_ASSERT_EQUAL(std::string("tail"), Route(plexer, "/other/status", extension));
+  CPPUNIT_ASSERT_EQUAL(std::string("/other"), extension);
+  CPPUNIT_ASSERT_EQUAL(std::string(""), Route(plexer, "/other/status/x"));
+}
+
+void PlexerTest::TestPriority() {
+  Arc::Plexer plexer(NULL, NULL);
+  RecordMCC any("any");
+  RecordMCC data("data");
+  RecordMCC echo("echo");
+  RecordMCC regex("regex");
+  plexer.Next(&any, "^/");
+  plexer.Next(&data, "^/data");
+  // Label added later is tried first even if it matches less
+  CPPUNIT_ASSERT_EQUAL(std::string("data"), Route(plexer, "/data/file"));
+  plexer.Next(&echo, "Echo");
+  CPPUNIT_ASSERT_EQUAL(std::string("echo"), Route(plexer, "/data/Echo"));
+  CPPUNIT_ASSERT_EQUAL(std::string("data"), Route(plexer, "/data/file"));
+  CPPUNIT_ASSERT_EQUAL(std::string("any"), Route(plexer, "/other"));
+  plexer.Next(&regex, "^/d.t");
+  CPPUNIT_ASSERT_EQUAL(std::string("regex"), Route(plexer, "/data/Echo"));
+  CPPUNIT_ASSERT_EQUAL(std::string("any"), Route(plexer, "/other"));
+}
+
+void PlexerTest::TestOverlap() {
+  Arc::Plexer plexer(NULL, NULL);
+  RecordMCC older("older");
+  RecordMCC newer("newer");
+  // Newest label wins even if older one matches longer part of path
+  plexer.Next(&older, "^/data/file");
+  plexer.Next(&newer, "^/data");
+  CPPUNIT_ASSERT_EQUAL(std::string("newer"), Route(plexer, "/data/file"));
+  CPPUNIT_ASSERT_EQUAL(std::string("newer"), Route(plexer, "/data/other"));
+  // Same for identical labels sharing one slot
+  Arc::Plexer same(NULL, NULL);
+  same.Next(&older, "^/ping");
+  same.Next(&newer, "^/ping");
+  CPPUNIT_ASSERT_EQUAL(std::string("newer"), Route(same, "/ping/x"));
+  same.Next(&older, "^/ping$");
+  CPPUNIT_ASSERT_EQUAL(std::string("older"), Route(same, "/ping"));
+  CPPUNIT_ASSERT_EQUAL(std::string("newer"), Route(same, "/ping/x"));
+}
+
+void PlexerTest::TestRemove() {
+  Arc::Plexer plexer(NULL, NULL);
+  RecordMCC arex("arex");
+  RecordMCC candypond("candypond");
+  plexer.Next(&arex, "^/arex");
+  plexer.Next(&candypond, "^/arex/candypond");
+  CPPUNIT_ASSERT_EQUAL(std::string("candypond"), Route(plexer, "/arex/candypond"));
+  plexer.Next(NULL, "^/arex/candypond");
+  CPPUNIT_ASSERT_EQUAL(std::string("arex"), Route(plexer, "/arex/candypond"));
+  plexer.Next(NULL, "^/arex");
+  CPPUNIT_ASSERT_EQUAL(std::string(""), Route(plexer, "/arex/candypond"));
+  // Replacing label moves it to highest priority
+  plexer.Next(&arex, "^/arex");
+  plexer.Next(&candypond, "^/arex/candypond");
+  plexer.Next(&arex, "^/arex");
+  CPPUNIT_ASSERT_EQUAL(std::string("arex"), Route(plexer, "/arex/candypond"));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PlexerTest);
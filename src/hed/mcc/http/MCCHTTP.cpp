@@ -5,6 +5,7 @@
 #include <arc/XMLNode.h>
 #include <arc/StringConv.h>
 #include <arc/message/PayloadRaw.h>
+#include <arc/message/PayloadGzip.h>
 #include <arc/message/SecAttr.h>
 #include <arc/loader/Plugin.h>
 #include <arc/Utils.h>
@@ -138,7 +139,25 @@ bool HTTPSecAttr::Export(SecAttrFormat format,XMLNode &val) const {
   return false;
 }
 
-MCC_HTTP_Service::MCC_HTTP_Service(Config *cfg,PluginArgument* parg):MCC_HTTP(cfg,parg) {
+// Default minimal size of response body worth compressing
+static const unsigned long long int compression_min_size_default = 4096;
+
+MCC_HTTP_Service::MCC_HTTP_Service(Config *cfg,PluginArgument* parg):MCC_HTTP(cfg,parg),
+    compression_(true),compression_min_size_(compression_min_size_default) {
+  std::string compression = lower((std::string)((*cfg)["Compression"]));
+  if(compression == "none") {
+    compression_ = false;
+  } else if(!compression.empty() && (compression != "gzip")) {
+    logger.msg(WARNING, "Unsupported compression %s - compression disabled", compression);
+    compression_ = false;
+  };
+  std::string min_size = (std::string)((*cfg)["CompressionMinSize"]);
+  if(!min_size.empty()) {
+    if(!stringto(min_size,compression_min_size_)) {
+      logger.msg(WARNING, "Wrong value of CompressionMinSize: %s", min_size);
+      compression_min_size_ = compression_min_size_default;
+    };
+  };
   XMLNode header_node = (*cfg)["Header"];
   while(header_node) {
     std::string header = (std::string)header_node;
@@ -241,6 +260,28 @@ static void parse_http_range(PayloadHTTP& http,Message& msg) {
   };
 }
 
+// Only textual content is worth compressing. Most of binary formats
+// are already compressed.
+static bool is_compressible(const std::string& content_type) {
+  std::string type = lower(content_type);
+  std::string::size_type pos = type.find(';');
+  if(pos != std::string::npos) type.erase(pos);
+  type = trim(type);
+  if(type.compare(0,5,"text/") == 0) return true;
+  if(type == "application/json") return true;
+  if(type == "application/xml") return true;
+  if(type == "application/soap+xml") return true;
+  if(type.length() > 4) {
+    std::string suffix = type.substr(type.length()-4);
+    if((suffix == "/xml") || (suffix == "+xml")) return true;
+  };
+  if(type.length() > 5) {
+    std::string suffix = type.substr(type.length()-5);
+    if(suffix == "+json") return true;
+  };
+  return false;
+}
+
 MCC_Status MCC_HTTP_Service::process(Message& inmsg,Message& outmsg) {
   // Extracting payload
   if(!inmsg.Payload()) return MCC_Status();
@@ -250,7 +291,7 @@ MCC_Status MCC_HTTP_Service::process(Message& inmsg,Message& outmsg) {
   } catch(std::exception& e) { };
   if(!inpayload) return MCC_Status();
   // Converting stream payload to HTTP which implements raw and stream interfaces
-  PayloadHTTPIn nextpayload(*inpayload);
+  PayloadHTTPIn nextpayload(*inpayload,false,false,compression_);
   if(!nextpayload) {
     logger.msg(WARNING, "Cannot create http payload");
     return make_http_fault(logger,nextpayload,*inpayload,outmsg,HTTP_BAD_REQUEST,headers_);
@@ -395,6 +436,47 @@ MCC_Status MCC_HTTP_Service::process(Message& inmsg,Message& outmsg) {
     };
   };
 */
+  // Compress response body if client accepts that. Partial content and
+  // content already encoded by service are sent as is.
+  bool compress = false;
+  if(compression_ && (!request_is_head) && (http_code == HTTP_OK) && GzipAccepted(nextpayload.Attributes("accept-encoding"))) {
+    std::string content_type;
+    bool encoded = false;
+    for(AttributeIterator i = nextoutmsg.Attributes()->getAll();i.hasMore();++i) {
+      const char* key = i.key().c_str();
+      if(strcasecmp(key,"HTTP:content-type") == 0) {
+        content_type = *i;
+      } else if((strcasecmp(key,"HTTP:content-encoding") == 0) ||
+                (strcasecmp(key,"HTTP:content-range") == 0)) {
+        encoded = true;
+      };
+    };
+    if((!encoded) && is_compressible(content_type)) {
+      if(retpayload) {
+        unsigned long long int length = 0;
+        for(int n = 0;;++n) {
+          if(retpayload->Buffer(n) == NULL) break;
+          length += retpayload->BufferSize(n);
+        };
+        compress = (retpayload->BufferPos(0) == 0) && (length == (unsigned long long int)retpayload->Size()) &&
+                   (length >= compression_min_size_);
+      } else {
+        // Stream of unknown size is assumed to be big enough
+        PayloadStreamInterface::Size_t size = strpayload->Size();
+        compress = (strpayload->Pos() == 0) && (strpayload->Limit() >= size) &&
+                   ((size == 0) || ((unsigned long long int)size >= compression_min_size_));
+      };
+    };
+  };
+  if(compress) {
+    // Compressed body has no known size and is sent chunked
+    if(retpayload) {
+      strpayload = new PayloadGzipStream(*retpayload,true);
+      retpayload = NULL;
+    } else {
+      strpayload = new PayloadGzipStream(*strpayload,true);
+    };
+  };
   PayloadHTTPOut* outpayload = NULL;
   PayloadHTTPOutRaw* routpayload = NULL;
   PayloadHTTPOutStream* soutpayload = NULL;
@@ -415,9 +497,18 @@ MCC_Status MCC_HTTP_Service::process(Message& inmsg,Message& outmsg) {
     if(strncmp("HTTP:",key,5) == 0) {
       key+=5;
       // TODO: check for special attributes: method, code, reason, endpoint, etc.
+      if(compress && (strcasecmp(key,"etag") == 0) && (strncmp((*i).c_str(),"W/",2) != 0)) {
+        // Compressed representation is not byte-identical anymore
+        outpayload->Attribute(std::string(key),"W/"+*i);
+        continue;
+      };
       outpayload->Attribute(std::string(key),*i);
     };
   };
+  if(compress) {
+    outpayload->Attribute("Content-Encoding","gzip");
+    outpayload->Attribute("Vary","Accept-Encoding");
+  };
   outpayload->KeepAlive(keep_alive);
   if(retpayload) {
     routpayload->Body(*retpayload);
@@ -443,16 +534,22 @@ MCC_Status MCC_HTTP_Service::process(Message& inmsg,Message& outmsg) {
   return MCC_Status(STATUS_OK);
 }
 
-MCC_HTTP_Client::MCC_HTTP_Client(Config *cfg,PluginArgument* parg):MCC_HTTP(cfg,parg) {
+MCC_HTTP_Client::MCC_HTTP_Client(Config *cfg,PluginArgument* parg):MCC_HTTP(cfg,parg),compression_(false) {
   endpoint_=(std::string)((*cfg)["Endpoint"]);
   method_=(std::string)((*cfg)["Method"]);
   authorization_=(std::string)((*cfg)["Authorization"]);
+  std::string compression = lower((std::string)((*cfg)["Compression"]));
+  if(compression == "gzip") {
+    compression_ = true;
+  } else if(!compression.empty() && (compression != "none")) {
+    logger.msg(WARNING, "Unsupported compression %s - compression disabled", compression);
+  };
 }
 
 MCC_HTTP_Client::~MCC_HTTP_Client(void) {
 }
 
-static MCC_Status extract_http_response(Message& nextoutmsg, Message& outmsg, bool is_head, PayloadHTTPIn * & outpayload) {
+static MCC_Status extract_http_response(Message& nextoutmsg, Message& outmsg, bool is_head, bool decode, PayloadHTTPIn * & outpayload) {
   // Do checks and process response - supported response so far is stream
   // Generated result is HTTP payload with Raw and Stream interfaces
   // Check if any payload in message
@@ -469,7 +566,7 @@ static MCC_Status extract_http_response(Message& nextoutmsg, Message& outmsg, bo
     return make_raw_fault(outmsg,"HTTP layer got something that is not stream");
   };
   // Try to parse payload. At least header part.
-  outpayload  = new PayloadHTTPIn(*retpayload,true,is_head);
+  outpayload  = new PayloadHTTPIn(*retpayload,true,is_head,decode);
   if(!outpayload) {
     delete retpayload;
     return make_raw_fault(outmsg,"Returned payload is not recognized as HTTP");
@@ -508,6 +605,18 @@ MCC_Status MCC_HTTP_Client::process(Message& inmsg,Message& outmsg) {
   std::string http_endpoint = inmsg.Attributes()->get("HTTP:ENDPOINT");
   if(http_method.empty()) http_method=method_;
   if(http_endpoint.empty()) http_endpoint=endpoint_;
+  // Body of request is compressed only on explicit request because
+  // there is no way to know in advance if server supports that.
+  AutoPointer<PayloadGzipStream> zpayload;
+  if(lower(inmsg.Attributes()->get("HTTP:COMPRESSION")) == "gzip") {
+    if(inrpayload) {
+      zpayload = new PayloadGzipStream(*inrpayload,false);
+    } else {
+      zpayload = new PayloadGzipStream(*inspayload,false);
+    };
+    inrpayload = NULL;
+    inspayload = zpayload.Ptr();
+  };
   AutoPointer<PayloadHTTPOutRaw> nextrpayload(inrpayload?new PayloadHTTPOutRaw(http_method,http_endpoint):NULL);
   AutoPointer<PayloadHTTPOutStream> nextspayload(inspayload?new PayloadHTTPOutStream(http_method,http_endpoint):NULL);
   PayloadHTTPOut* nextpayload(inrpayload?
@@ -516,6 +625,7 @@ MCC_Status MCC_HTTP_Client::process(Message& inmsg,Message& outmsg) {
   );
   bool expect100 = false;
   bool authorization_present = false;
+  bool accept_encoding_present = false;
   for(AttributeIterator i = inmsg.Attributes()->getAll();i.hasMore();++i) {
     const char* key = i.key().c_str();
     if(strncmp("HTTP:",key,5) == 0) {
@@ -523,6 +633,8 @@ MCC_Status MCC_HTTP_Client::process(Message& inmsg,Message& outmsg) {
       // TODO: check for special attributes: method, code, reason, endpoint, etc.
       if(strcasecmp(key,"METHOD") == 0) continue;
       if(strcasecmp(key,"ENDPOINT") == 0) continue;
+      if(strcasecmp(key,"COMPRESSION") == 0) continue;
+      if(strcasecmp(key,"ACCEPT-ENCODING") == 0) accept_encoding_present = true;
       if(strcasecmp(key,"EXPECT") == 0) {
         if(Arc::lower(*i) == "100-continue") expect100 = true;
       }
@@ -533,6 +645,11 @@ MCC_Status MCC_HTTP_Client::process(Message& inmsg,Message& outmsg) {
   if(!authorization_present) {
     if(!authorization_.empty()) nextpayload->Attribute("Authorization", authorization_);
   };
+  if(zpayload) nextpayload->Attribute("Content-Encoding","gzip");
+  // Compressed response is decoded transparently by PayloadHTTPIn, but only
+  // if it was requested here. Otherwise caller expects content as is.
+  bool decode_response = compression_ && !accept_encoding_present;
+  if(decode_response) nextpayload->Attribute("Accept-Encoding","gzip");
   nextpayload->Attribute("User-Agent","ARC");
   bool request_is_head = (upper(http_method) == "HEAD");
   // Creating message to pass to next MCC and setting new payload..
@@ -558,7 +675,7 @@ MCC_Status MCC_HTTP_Client::process(Message& inmsg,Message& outmsg) {
       delete nextoutmsg.Payload();
       return make_raw_fault(outmsg,ret);
     };
-    ret = extract_http_response(nextoutmsg, outmsg, request_is_head, outpayload);
+    ret = extract_http_response(nextoutmsg, outmsg, request_is_head, decode_response, outpayload);
     if(!ret) return ret;
     // TODO: handle 100 response sent by server just in case
   } else {
@@ -572,7 +689,7 @@ MCC_Status MCC_HTTP_Client::process(Message& inmsg,Message& outmsg) {
       return make_raw_fault(outmsg,ret);
     };
     // Parse response and check if it is 100
-    ret = extract_http_response(nextoutmsg, outmsg, request_is_head, outpayload);
+    ret = extract_http_response(nextoutmsg, outmsg, request_is_head, decode_response, outpayload);
     if(!ret) return ret;
     int resp_code = outpayload->Code();
     if(resp_code == HTTP_CONTINUE) {
@@ -584,7 +701,7 @@ MCC_Status MCC_HTTP_Client::process(Message& inmsg,Message& outmsg) {
         delete nextoutmsg.Payload();
         return make_raw_fault(outmsg,ret);
       };
-      ret = extract_http_response(nextoutmsg, outmsg, request_is_head, outpayload);
+      ret = extract_http_response(nextoutmsg, outmsg, request_is_head, decode_response, outpayload);
       if(!ret) return ret;
     } else {
       // Any other response should mean server can't accept request.
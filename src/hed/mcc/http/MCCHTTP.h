@@ -36,10 +36,19 @@ class MCC_HTTP : public MCC {
    HTTP:name - all 'name' attributes of HTTP header.
   Attributes of response message of HTTP:name type are
  translated into HTTP header with corresponding 'name's.
+  Body of request sent with gzip or deflate Content-Encoding is
+ decompressed while being read. Decompressed body is limited to 100MB
+ if service fetches it as a whole. Response body is compressed with
+ gzip if client accepts that, response is complete, its content type
+ is textual, its size is at least CompressionMinSize and service did
+ not set Content-Encoding itself. Compression and decompression may be
+ turned off by setting Compression configuration element to 'none'.
  */
 class MCC_HTTP_Service: public MCC_HTTP {
     protected:
         std::list< std::pair<std::string,std::string> > headers_;
+        bool compression_;
+        unsigned long long int compression_min_size_;
     public:
         MCC_HTTP_Service(Config *cfg,PluginArgument* parg);
         virtual ~MCC_HTTP_Service(void);
@@ -61,6 +70,11 @@ class MCC_HTTP_Service: public MCC_HTTP {
    HTTP:CODE - response code of HTTP
    HTTP:REASON - reason string of HTTP response
    HTTP:name - all 'name' attributes of HTTP header.
+  If Compression configuration element is set to 'gzip' then compressed
+ response is requested through Accept-Encoding header and decompressed
+ transparently. If upper level sets HTTP:Accept-Encoding itself or
+ response is partial content then body is passed as received. Body of request is
+ compressed if special attribute HTTP:COMPRESSION is set to 'gzip'.
  */
 
 class MCC_HTTP_Client: public MCC_HTTP {
@@ -68,6 +82,7 @@ class MCC_HTTP_Client: public MCC_HTTP {
         std::string method_;
         std::string endpoint_;
         std::string authorization_;
+        bool compression_;
     public:
         MCC_HTTP_Client(Config *cfg,PluginArgument* parg);
         virtual ~MCC_HTTP_Client(void);
@@ -9,6 +9,7 @@
 #endif
 
 #include <stdio.h>
+#include <zlib.h>
 
 #include "PayloadHTTP.h"
 #include <arc/StringConv.h>
@@ -21,6 +22,9 @@ Arc::Logger PayloadHTTP::logger(Arc::Logger::getRootLogger(), "MCC.HTTP");
 
 static std::string empty_string("");
 
+// Limit for decompressed body kept in memory
+static const int64_t max_decoded_body_size = 100*1024*1024;
+
 static bool ParseHTTPVersion(const std::string& s,int& major,int& minor) {
   major=0; minor=0;
   const char* p = s.c_str();
@@ -348,6 +352,82 @@ bool PayloadHTTPIn::flush_multipart(void) {
   return true;
 }
 
+bool PayloadHTTPIn::setup_decoding(void) {
+  if(!decode_) return true;
+  if(head_response_) return true;
+  if(length_ == 0) return true;
+  // Range applies to encoded content, so it can't be decoded separately
+  if((code_ == HTTP_PARTIAL) || (!Attribute("content-range").empty())) return true;
+  std::string encoding = lower(trim(Attribute("content-encoding")));
+  if(encoding.empty() || (encoding == "identity")) return true;
+  // Unknown encodings are passed to upper level as is
+  if((encoding != "gzip") && (encoding != "x-gzip") && (encoding != "deflate")) return true;
+  zstream_ = new z_stream;
+  zstream_->zalloc = Z_NULL;
+  zstream_->zfree = Z_NULL;
+  zstream_->opaque = Z_NULL;
+  zstream_->next_in = Z_NULL;
+  zstream_->avail_in = 0;
+  // 32 added to window bits enables detection of both gzip and zlib format
+  if(inflateInit2(zstream_,15+32) != Z_OK) {
+    delete zstream_; zstream_ = NULL;
+    return false;
+  };
+  zbuf_ = new char[65536];
+  zlength_ = length_; zoffset_ = 0; zeof_ = false;
+  // From now on body is seen as decoded content of unknown length
+  length_ = -1;
+  attributes_.erase("content-encoding");
+  attributes_.erase("content-length");
+  return true;
+}
+
+bool PayloadHTTPIn::read_body(char* buf,int64_t& size) {
+  if(!zstream_) return read_multipart(buf,size);
+  int64_t bufsize = size;
+  size = 0;
+  if(zeof_) return false;
+  if(bufsize > INT_MAX) bufsize = INT_MAX;
+  zstream_->next_out = (Bytef*)buf;
+  zstream_->avail_out = bufsize;
+  for(;zstream_->avail_out > 0;) {
+    if(zstream_->avail_in == 0) {
+      // Do not wait for more data if there is something to return already
+      if(zstream_->avail_out < bufsize) break;
+      int64_t l = 65536;
+      if((zlength_ >= 0) && (l > (zlength_-zoffset_))) l = zlength_-zoffset_;
+      if((l <= 0) || (!read_multipart(zbuf_,l)) || (l <= 0)) {
+        // Compressed data ended prematurely
+        error_ = IString("Compressed body is truncated").str();
+        valid_ = false; zeof_ = true;
+        break;
+      };
+      zoffset_ += l;
+      zstream_->next_in = (Bytef*)zbuf_;
+      zstream_->avail_in = l;
+    };
+    int r = inflate(zstream_,Z_NO_FLUSH);
+    if(r == Z_STREAM_END) {
+      zeof_ = true;
+      // Skip whatever may follow compressed data to keep connection in sync
+      for(;(zlength_ >= 0) && (zoffset_ < zlength_);) {
+        int64_t l = zlength_-zoffset_;
+        if(l > 65536) l = 65536;
+        if(!read_multipart(zbuf_,l)) break;
+        zoffset_ += l;
+      };
+      break;
+    };
+    if((r != Z_OK) && (r != Z_BUF_ERROR)) {
+      error_ = IString("Failed to decompress body").str();
+      valid_ = false; zeof_ = true;
+      break;
+    };
+  };
+  size = bufsize - zstream_->avail_out;
+  return (size > 0);
+}
+
 bool PayloadHTTPIn::read_header(void) {
   std::string line;
   for(;readline_chunked(line) && (!line.empty());) {
@@ -505,6 +585,7 @@ bool PayloadHTTPIn::parse_header(void) {
   }
   // In case of keep_alive (HTTP1.1) there must be length specified
   if(keep_alive_ && (!chunked_) && (length_ == -1)) length_=0;
+  if(!setup_decoding()) return false;
   // If size of object was not reported then try to deduce it.
   if((size_ == 0) && (length_ != -1)) size_=offset_+length_;
   return true;
@@ -543,10 +624,16 @@ bool PayloadHTTPIn::get_body(void) {
       char* new_result = (char*)realloc(result,result_size+chunk_size+1);
       if(new_result == NULL) { free(result); return false; };
       result=new_result;
-      if(!read_multipart(result+result_size,chunk_size)) break;
+      if(!read_body(result+result_size,chunk_size)) break;
       // TODO: logical size is not always same as end of body
       // TODO: protect against insane length of body
       result_size+=chunk_size;
+      if(zstream_ && (result_size > max_decoded_body_size)) {
+        // Small compressed body may expand to huge amount of data
+        error_ = IString("Decompressed body exceeds %llu bytes",(unsigned long long int)max_decoded_body_size).str();
+        free(result);
+        return false;
+      };
     };
   };
   if (result == NULL) {
@@ -565,11 +652,12 @@ bool PayloadHTTPIn::get_body(void) {
   return true;
 }
 
-PayloadHTTPIn::PayloadHTTPIn(PayloadStreamInterface& stream,bool own,bool head_response):
-    head_response_(head_response),chunked_(CHUNKED_NONE),chunk_size_(0),
+PayloadHTTPIn::PayloadHTTPIn(PayloadStreamInterface& stream,bool own,bool head_response,bool decode):
+    head_response_(head_response),decode_(decode),chunked_(CHUNKED_NONE),chunk_size_(0),
     multipart_(MULTIPART_NONE),stream_(&stream),stream_offset_(0),
     stream_own_(own),fetched_(false),header_read_(false),body_read_(false),
-    body_(NULL),body_size_(0) {
+    body_(NULL),body_size_(0),
+    zstream_(NULL),zbuf_(NULL),zlength_(-1),zoffset_(0),zeof_(false) {
   tbuf_[0]=0; tbuflen_=0;
   if(!parse_header()) {
     error_ = IString("Failed to parse HTTP header").str();
@@ -585,6 +673,11 @@ PayloadHTTPIn::~PayloadHTTPIn(void) {
   flush_chunked();
   if(stream_ && stream_own_) delete stream_;
   if(body_) ::free(body_);
+  if(zstream_) {
+    inflateEnd(zstream_);
+    delete zstream_;
+  };
+  delete[] zbuf_;
 }
 
 char PayloadHTTPIn::operator[](PayloadRawInterface::Size_t pos) const {
@@ -697,7 +790,7 @@ bool PayloadHTTPIn::Get(char* buf,int& size) {
   };
   // Ordinary stream with no length known
   int64_t tsize = size;
-  bool r = read_multipart(buf,tsize);
+  bool r = read_body(buf,tsize);
   if(r) stream_offset_+=tsize;
   if(!r) body_read_=true;
   size=tsize;
@@ -980,7 +1073,18 @@ bool PayloadHTTPOut::FlushHeader(PayloadStreamInterface& stream) {
 bool PayloadHTTPOut::FlushBody(PayloadStreamInterface& stream) {
     // TODO: process 100 request/response
     if((length_ > 0) || (use_chunked_transfer_)) {
-      if(sbody_) {
+      PayloadFileStreamInterface* fbody = NULL;
+      if(sbody_ && !use_chunked_transfer_) try {
+        fbody = dynamic_cast<PayloadFileStreamInterface*>(sbody_);
+      } catch(std::exception& e) { };
+      if(fbody && (fbody->FileHandle() != -1)) {
+        // Content of file is passed to stream as whole so that it can
+        // use optimized methods like sendfile()
+        if(!stream.Put(*fbody,length_)) {
+          error_ = IString("Failed to write body to output stream").str();
+          return false;
+        };
+      } else if(sbody_) {
         // stream to stream transfer
         // TODO: choose optimal buffer size
         // TODO: parallel read and write for better performance
@@ -1016,6 +1120,11 @@ bool PayloadHTTPOut::FlushBody(PayloadStreamInterface& stream) {
         };
         delete[] tbuf;
         tbuf = NULL;
+        if(!*sbody_) {
+          // Source failed - body must not look complete to peer
+          error_ = IString("Failed to read body from source").str();
+          return false;
+        };
         if(use_chunked_transfer_) {
           if(!stream.Put("0\r\n\r\n")) {
             error_ = IString("Failed to write body to output stream").str();
@@ -22,6 +22,8 @@
 #define HTTP_CONTINUE     (100)
 #define HTTP_CODE_IS_GOOD(CODE) (((CODE)>=200) && ((CODE)<=300))
 
+struct z_stream_s;
+
 namespace ArcMCCHTTP {
 
 using namespace Arc;
@@ -108,6 +110,7 @@ class PayloadHTTPIn: public PayloadHTTP, public PayloadRawInterface, public Payl
     MULTIPART_ERROR
   } multipart_t;
   bool head_response_;             /** true if HTTP response for HEAD request is expected */
+  bool decode_;                    /** true if body with Content-Encoding is to be decoded */
   chunked_t chunked_;              /** chunked encoding parsing state */
   int64_t chunk_size_;
   multipart_t multipart_;
@@ -127,6 +130,11 @@ class PayloadHTTPIn: public PayloadHTTP, public PayloadRawInterface, public Payl
   int tbuflen_;                    /** amount of data stored in tbuf */
   char* body_;
   int64_t body_size_;
+  struct z_stream_s* zstream_;     /** decompressor if body has Content-Encoding */
+  char* zbuf_;                     /** buffer for compressed data */
+  int64_t zlength_;                /** Content-length of compressed body */
+  int64_t zoffset_;                /** amount of compressed data read */
+  bool zeof_;                      /** decompressed body is over */
 
   bool readtbuf(void);
   /** Read from stream_ till \r\n */
@@ -144,6 +152,11 @@ class PayloadHTTPIn: public PayloadHTTP, public PayloadRawInterface, public Payl
   bool read_multipart(char* buf,int64_t& size);
   bool flush_multipart(void);
 
+  /** Set up decompression if requested and body has supported Content-Encoding */
+  bool setup_decoding(void);
+  /** Read up to 'size' bytes of body with Content-Encoding removed */
+  bool read_body(char* buf,int64_t& size);
+
   /** Read HTTP header and fill internal variables */
   bool read_header(void);
   bool parse_header(void);
@@ -158,8 +171,11 @@ class PayloadHTTPIn: public PayloadHTTP, public PayloadRawInterface, public Payl
     Supplied stream is associated with object for later use. If 'own' is set to true
     then stream will be deleted in destructor. Because stream can be used by this
     object during whole lifetime it is important not to destroy stream till this 
-    object is deleted. */
-  PayloadHTTPIn(PayloadStreamInterface& stream,bool own = false,bool head_response = false);
+    object is deleted. If 'decode' is set to true then body with gzip or deflate
+    Content-Encoding is decompressed while being read. That must be only requested
+    if sender was told compressed body is acceptable. Partial content is never
+    decompressed. */
+  PayloadHTTPIn(PayloadStreamInterface& stream,bool own = false,bool head_response = false,bool decode = false);
 
   virtual ~PayloadHTTPIn(void);
 
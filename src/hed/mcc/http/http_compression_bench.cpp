@@ -0,0 +1,154 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <list>
+#include <iostream>
+#include <iomanip>
+
+#include <glibmm/timeval.h>
+
+#include <arc/StringConv.h>
+#include <arc/message/PayloadRaw.h>
+#include <arc/message/PayloadGzip.h>
+
+#include "PayloadHTTP.h"
+
+// Measures throughput and compression ratio of gzip Content-Encoding
+// in HTTP MCC. Response is produced exactly like MCC_HTTP_Service does
+// it and parsed back exactly like MCC_HTTP_Client does. Network is
+// replaced by memory buffer so only processing cost is measured.
+
+// Stream keeping everything written to it in memory
+class MemoryStream: public Arc::PayloadStreamInterface {
+ private:
+  std::string data_;
+  std::string::size_type pos_;
+ public:
+  MemoryStream(void):pos_(0) { };
+  virtual ~MemoryStream(void) { };
+  virtual bool Get(char* buf,int& size) {
+    if(pos_ >= data_.length()) { size = 0; return false; };
+    if((std::string::size_type)size > (data_.length()-pos_)) size = data_.length()-pos_;
+    memcpy(buf,data_.c_str()+pos_,size);
+    pos_ += size;
+    return true;
+  };
+  virtual bool Put(const char* buf,Size_t size) {
+    data_.append(buf,size);
+    return true;
+  };
+  virtual operator bool(void) { return true; };
+  virtual bool operator!(void) { return false; };
+  virtual int Timeout(void) const { return 0; };
+  virtual void Timeout(int) { };
+  virtual Size_t Pos(void) const { return pos_; };
+  virtual Size_t Size(void) const { return data_.length(); };
+  virtual Size_t Limit(void) const { return data_.length(); };
+};
+
+// Resembles job listing or information document
+static std::string make_body(unsigned long long int size) {
+  std::string body("<?xml version=\"1.0\"?>\n<jobs>\n");
+  for(unsigned int n = 0;body.length() < size;++n) {
+    body += "  <job><id>" + Arc::tostring(n*7919+1234567) + "</id><state>" +
+            ((n%3)?"FINISHED":"INLRMS:R") + "</state><owner>/DC=org/DC=example/CN=User " +
+            Arc::tostring(n%17) + "</owner></job>\n";
+  };
+  body.resize(size);
+  return body;
+}
+
+static void usage(void) {
+  std::cout << "http_compression_bench [-n repetitions] [-l level] [size ...]" << std::endl;
+  std::cout << "  Default sizes are 4096, 65536, 1048576 and 16777216 bytes." << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  int repetitions = 10;
+  int level = -1;
+  int opt;
+  while((opt = getopt(argc, argv, "n:l:h")) != -1) {
+    switch(opt) {
+      case 'n': repetitions = atoi(optarg); break;
+      case 'l': level = atoi(optarg); break;
+      default: usage(); return (opt == 'h')?0:1;
+    };
+  };
+  std::list<unsigned long long int> sizes;
+  for(;optind < argc;++optind) sizes.push_back(strtoull(argv[optind],NULL,10));
+  if(sizes.empty()) {
+    sizes.push_back(4096);
+    sizes.push_back(65536);
+    sizes.push_back(1048576);
+    sizes.push_back(16777216);
+  };
+  if(repetitions < 1) repetitions = 1;
+
+  std::cout << std::setw(10) << "size" << std::setw(12) << "encoded"
+            << std::setw(9) << "ratio" << std::setw(16) << "compress MB/s"
+            << std::setw(16) << "decompress MB/s" << std::endl;
+  char* buf = new char[65536];
+  for(std::list<unsigned long long int>::iterator size = sizes.begin(); size != sizes.end(); ++size) {
+    std::string body = make_body(*size);
+    double compress_time = 0;
+    double decompress_time = 0;
+    unsigned long long int encoded_size = 0;
+    for(int r = 0;r < repetitions;++r) {
+      MemoryStream wire;
+      Glib::TimeVal t0; t0.assign_current_time();
+      {
+        Arc::PayloadRaw* raw = new Arc::PayloadRaw;
+        raw->Insert(body.c_str(),0,body.length());
+        Arc::PayloadGzipStream* gz = new Arc::PayloadGzipStream(*raw,true,level);
+        ArcMCCHTTP::PayloadHTTPOutStream out(200,"OK");
+        out.Attribute("Content-Type","text/xml");
+        out.Attribute("Content-Encoding","gzip");
+        out.Body(*gz);
+        if(!out.Flush(wire)) {
+          std::cerr << "Failed to produce HTTP response" << std::endl;
+          return 1;
+        };
+        encoded_size = gz->OutSize();
+      };
+      Glib::TimeVal t1; t1.assign_current_time();
+      {
+        ArcMCCHTTP::PayloadHTTPIn in(wire,false,false,true);
+        if(!in) {
+          std::cerr << "Failed to parse HTTP response: " << in.GetError() << std::endl;
+          return 1;
+        };
+        std::string::size_type pos = 0;
+        for(;;) {
+          int l = 65536;
+          if(!in.Get(buf,l)) break;
+          if((pos+l > body.length()) || (memcmp(buf,body.c_str()+pos,l) != 0)) {
+            std::cerr << "Decompressed content differs from original" << std::endl;
+            return 1;
+          };
+          pos += l;
+        };
+        if(pos != body.length()) {
+          std::cerr << "Decompressed content is truncated: " << pos << " of " << body.length() << std::endl;
+          return 1;
+        };
+      };
+      Glib::TimeVal t2; t2.assign_current_time();
+      compress_time += (t1-t0).as_double();
+      decompress_time += (t2-t1).as_double();
+    };
+    double mbytes = ((double)body.length())*repetitions/(1024.0*1024.0);
+    std::cout << std::setw(10) << body.length() << std::setw(12) << encoded_size
+              << std::setw(9) << std::fixed << std::setprecision(3)
+              << ((double)encoded_size)/body.length()
+              << std::setw(16) << std::setprecision(1) << mbytes/compress_time
+              << std::setw(16) << mbytes/decompress_time << std::endl;
+  };
+  delete[] buf;
+  return 0;
+}
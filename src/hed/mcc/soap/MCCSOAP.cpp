@@ -169,9 +169,8 @@ static MCC_Status make_raw_fault(Message& outmsg, const char* reason1 = NULL, co
   if(reason2) { if(!reason.empty()) reason+=": "; reason += reason2; };
   if(reason3) { if(!reason.empty()) reason+=": "; reason += reason3; };
   if(!reason.empty()) soap.Fault()->Reason(0, reason.c_str());
-  std::string xml; soap.GetXML(xml);
   PayloadRaw* payload = new PayloadRaw;
-  payload->Insert(xml.c_str());
+  SOAPToPayload(soap,*payload);
   outmsg.Payload(payload);
   return MCC_Status(STATUS_OK);
 }
@@ -224,8 +223,10 @@ MCC_Status MCC_SOAP_Service::process(Message& inmsg,Message& outmsg) {
     }
     return next->process(inmsg,outmsg); 
   }
-  // Converting payload to SOAP
-  PayloadSOAP nextpayload(*inpayload);
+  // Converting payload to SOAP. Parsing through stream consumes it, so if
+  // request may be passed further unparsed only buffers are parsed and
+  // stream is left intact for next MCC.
+  PayloadSOAP nextpayload(*inpayload,!_continueNonSoap);
   if(!nextpayload) {
     if (!_continueNonSoap) {
       logger.msg(WARNING, "incoming message is not SOAP");
@@ -316,10 +317,9 @@ MCC_Status MCC_SOAP_Service::process(Message& inmsg,Message& outmsg) {
       return make_raw_fault(outmsg,"Security check failed for SOAP response", std::string(sret).c_str());
     };
   };
-  // Convert to Raw - TODO: more efficient conversion
+  // Convert to Raw
   PayloadRaw* outpayload = new PayloadRaw;
-  std::string xml; retpayload->GetXML(xml);
-  outpayload->Insert(xml.c_str());
+  SOAPToPayload(*retpayload,*outpayload);
   outmsg = nextoutmsg; outmsg.Payload(NULL);
   // Specifying attributes for binding to underlying protocols - HTTP so far
   std::string soap_action;
@@ -370,8 +370,7 @@ MCC_Status MCC_SOAP_Client::process(Message& inmsg,Message& outmsg) {
   };
   // Converting payload to Raw
   PayloadRaw nextpayload;
-  std::string xml; inpayload->GetXML(xml);
-  nextpayload.Insert(xml.c_str());
+  SOAPToPayload(*inpayload,nextpayload);
   // Creating message to pass to next MCC and setting new payload.. 
   Message nextinmsg = inmsg;
   nextinmsg.Payload(&nextpayload);
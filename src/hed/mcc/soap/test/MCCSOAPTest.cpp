@@ -0,0 +1,132 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string.h>
+
+#include <arc/ArcConfig.h>
+#include <arc/message/Message.h>
+#include <arc/message/PayloadRaw.h>
+#include <arc/message/PayloadSOAP.h>
+#include <arc/message/PayloadStream.h>
+
+#include "../MCCSOAP.h"
+
+class MCCSOAPTest
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(MCCSOAPTest);
+  CPPUNIT_TEST(TestNonSOAP);
+  CPPUNIT_TEST(TestSOAP);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void TestNonSOAP();
+  void TestSOAP();
+};
+
+// Body of request available both as buffer and as stream, like
+// incoming HTTP message. Stream is read independently of buffer.
+class BodyPayload: public Arc::PayloadRawInterface, public Arc::PayloadStreamInterface {
+private:
+  std::string body_;
+  std::string::size_type offset_;
+public:
+  BodyPayload(const std::string& body):body_(body),offset_(0) { };
+  virtual char operator[](Arc::PayloadRawInterface::Size_t pos) const { return body_[pos]; };
+  virtual char* Content(Arc::PayloadRawInterface::Size_t pos = -1) { return (char*)body_.c_str(); };
+  virtual Arc::PayloadRawInterface::Size_t Size(void) const { return body_.length(); };
+  virtual char* Insert(Arc::PayloadRawInterface::Size_t pos = 0,Arc::PayloadRawInterface::Size_t size = 0) { return NULL; };
+  virtual char* Insert(const char* s,Arc::PayloadRawInterface::Size_t pos = 0,Arc::PayloadRawInterface::Size_t size = -1) { return NULL; };
+  virtual char* Buffer(unsigned int num) { return (num == 0) ? (char*)body_.c_str() : NULL; };
+  virtual Arc::PayloadRawInterface::Size_t BufferSize(unsigned int num) const { return (num == 0) ? body_.length() : 0; };
+  virtual Arc::PayloadRawInterface::Size_t BufferPos(unsigned int num) const { return 0; };
+  virtual bool Truncate(Arc::PayloadRawInterface::Size_t size) { return false; };
+  virtual bool Get(char* buf,int& size) {
+    if(offset_ >= body_.length()) return false;
+    if((std::string::size_type)size > (body_.length()-offset_)) size = body_.length()-offset_;
+    memcpy(buf,body_.c_str()+offset_,size);
+    offset_ += size;
+    return true;
+  };
+  virtual bool Put(const char* buf,Arc::PayloadStreamInterface::Size_t size) { return false; };
+  virtual operator bool(void) { return true; };
+  virtual bool operator!(void) { return false; };
+  virtual int Timeout(void) const { return 0; };
+  virtual void Timeout(int to) { };
+  virtual Arc::PayloadStreamInterface::Size_t Pos(void) const { return offset_; };
+  virtual Arc::PayloadStreamInterface::Size_t Limit(void) const { return body_.length(); };
+};
+
+// Reads request body through stream interface like A-REX REST does
+class BodyReader: public Arc::MCCInterface {
+public:
+  std::string body;
+  bool soap;
+  BodyReader():Arc::MCCInterface(NULL),soap(false) { };
+  virtual Arc::MCC_Status process(Arc::Message& request, Arc::Message& response) {
+    body.clear();
+    soap = (dynamic_cast<Arc::PayloadSOAP*>(request.Payload()) != NULL);
+    Arc::PayloadStreamInterface* stream = dynamic_cast<Arc::PayloadStreamInterface*>(request.Payload());
+    if(stream) {
+      char buf[16];
+      int size = sizeof(buf);
+      while(stream->Get(buf,size)) { body.append(buf,size); size = sizeof(buf); };
+    };
+    if(soap) {
+      Arc::PayloadSOAP* out = new Arc::PayloadSOAP(Arc::NS());
+      out->NewChild("Reply");
+      response.Payload(out);
+    } else {
+      response.Payload(new Arc::PayloadRaw);
+    };
+    return Arc::MCC_Status(Arc::STATUS_OK);
+  };
+};
+
+static Arc::MCC_Status Process(Arc::MCCInterface& mcc, const std::string& body) {
+  BodyPayload payload(body);
+  Arc::MessageAttributes attributes;
+  attributes.set("HTTP:METHOD", "POST");
+  Arc::MessageAuth auth;
+  Arc::Message request;
+  request.Payload(&payload);
+  request.Attributes(&attributes);
+  request.Auth(&auth);
+  Arc::Message response;
+  Arc::MCC_Status status = mcc.process(request, response);
+  delete response.Payload();
+  return status;
+}
+
+void MCCSOAPTest::TestNonSOAP() {
+  Arc::Config cfg(std::string("<Component><ContinueNonSOAP>yes</ContinueNonSOAP></Component>"));
+  ArcMCCSOAP::MCC_SOAP_Service service(&cfg, NULL);
+  BodyReader next;
+  service.Next(&next);
+  // XML which is not SOAP, as posted by REST clients without Content-Type
+  std::string body = "<ActivityIDs><id>1234567890</id><id>0987654321</id></ActivityIDs>";
+  CPPUNIT_ASSERT(Process(service, body));
+  CPPUNIT_ASSERT(!next.soap);
+  CPPUNIT_ASSERT_EQUAL(body, next.body);
+  // Not even XML
+  body = "job description";
+  CPPUNIT_ASSERT(Process(service, body));
+  CPPUNIT_ASSERT(!next.soap);
+  CPPUNIT_ASSERT_EQUAL(body, next.body);
+}
+
+void MCCSOAPTest::TestSOAP() {
+  Arc::Config cfg(std::string("<Component><ContinueNonSOAP>yes</ContinueNonSOAP></Component>"));
+  ArcMCCSOAP::MCC_SOAP_Service service(&cfg, NULL);
+  BodyReader next;
+  service.Next(&next);
+  std::string body = "<soap-env:Envelope xmlns:soap-env=\"http://schemas.xmlsoap.org/soap/envelope/\">"
+                     "<soap-env:Body><Request/></soap-env:Body></soap-env:Envelope>";
+  CPPUNIT_ASSERT(Process(service, body));
+  CPPUNIT_ASSERT(next.soap);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MCCSOAPTest);
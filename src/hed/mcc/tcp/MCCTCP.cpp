@@ -500,10 +500,19 @@ void MCC_TCP_Service::executer(void* arg) {
     stream.NoDelay(no_delay);
     MessageContext context;
     MessageAuthContext auth_context;
+    // Attributes of connection are same for all messages and are shared
+    // by attributes of every message instead of being copied into them.
+    MessageAttributes connection_attributes;
+    connection_attributes.set("TCP:HOST",host_attr);
+    connection_attributes.set("TCP:PORT",port_attr);
+    connection_attributes.set("TCP:REMOTEHOST",remotehost_attr);
+    connection_attributes.set("TCP:REMOTEPORT",remoteport_attr);
+    connection_attributes.set("TCP:ENDPOINT",endpoint_attr);
+    connection_attributes.set("ENDPOINT",endpoint_attr);
     for(;;) {
         // TODO: Check state of socket here and leave immediately if not connected anymore.
         // Preparing Message objects for chain
-        MessageAttributes attributes_in;
+        MessageAttributes attributes_in(&connection_attributes);
         MessageAttributes attributes_out;
         MessageAuth auth_in;
         MessageAuth auth_out;
@@ -511,12 +520,6 @@ void MCC_TCP_Service::executer(void* arg) {
         Message nextoutmsg;
         nextinmsg.Payload(&stream);
         nextinmsg.Attributes(&attributes_in);
-        nextinmsg.Attributes()->set("TCP:HOST",host_attr);
-        nextinmsg.Attributes()->set("TCP:PORT",port_attr);
-        nextinmsg.Attributes()->set("TCP:REMOTEHOST",remotehost_attr);
-        nextinmsg.Attributes()->set("TCP:REMOTEPORT",remoteport_attr);
-        nextinmsg.Attributes()->set("TCP:ENDPOINT",endpoint_attr);
-        nextinmsg.Attributes()->set("ENDPOINT",endpoint_attr);
         nextinmsg.Context(&context);
         nextinmsg.Auth(&auth_in);
         TCPSecAttr* tattr = new TCPSecAttr(remotehost_attr, remoteport_attr, host_attr, port_attr);
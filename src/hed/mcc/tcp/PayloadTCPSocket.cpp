@@ -14,6 +14,9 @@
 #include <sys/poll.h>
 #include <netinet/tcp.h>
 #include <fcntl.h>
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
 
 #include <glibmm.h>
 
@@ -233,6 +236,45 @@ bool PayloadTCPSocket::Put(const char* buf,Size_t size) {
   return true;
 }
 
+bool PayloadTCPSocket::Put(PayloadStreamInterface& source,Size_t size) {
+#ifdef HAVE_SYS_SENDFILE_H
+  PayloadFileStreamInterface* file = NULL;
+  try {
+    file = dynamic_cast<PayloadFileStreamInterface*>(&source);
+  } catch(std::exception& e) { };
+  int fhandle = file?file->FileHandle():-1;
+  if((handle_ != -1) && (fhandle != -1)) {
+    // Content of file is passed to socket without copying it through user space
+    Size_t left = file->Limit() - file->Pos();
+    if((size != -1) && (size < left)) left = size;
+    Size_t sent = 0;
+    time_t start = time(NULL);
+    for(;sent < left;) {
+      unsigned int events = POLLOUT | POLLERR;
+      int to = timeout_-(unsigned int)(time(NULL)-start);
+      if(to < 0) to = 0;
+      if(spoll(handle_,to,events) != 1) return false;
+      if(!(events & POLLOUT)) return false;
+      // Limited amount per call to keep timeout meaningful
+      size_t chunk = ((left-sent) > 1024*1024)?(1024*1024):(left-sent);
+      ssize_t l = ::sendfile(handle_, fhandle, NULL, chunk);
+      if(l == -1) {
+        if((errno == EINTR) || (errno == EAGAIN)) continue;
+        // Kernel can't do that for this pair of handles - use ordinary copy
+        if((sent == 0) && ((errno == EINVAL) || (errno == ENOSYS))) break;
+        return false;
+      };
+      if(l == 0) return false; // file is shorter than expected
+      sent += l;
+      start = time(NULL);
+    };
+    if(sent > 0) return (size == -1) || (sent == size);
+    if(left <= 0) return (size <= 0);
+  };
+#endif
+  return PayloadStreamInterface::Put(source,size);
+}
+
 void PayloadTCPSocket::NoDelay(bool val) {
   if(handle_ == -1) return;
   int flag = val?1:0;
@@ -43,6 +43,9 @@ class PayloadTCPSocket: public PayloadStreamInterface {
   virtual bool Put(const char* buf,Size_t size);
   virtual bool Put(const std::string& buf) { return Put(buf.c_str(),buf.length()); };
   virtual bool Put(const char* buf) { return Put(buf,buf?strlen(buf):0); };
+  /** Content of PayloadFileStreamInterface source is sent with sendfile()
+    where possible. Other sources are copied through Get(). */
+  virtual bool Put(PayloadStreamInterface& source,Size_t size);
   virtual operator bool(void) { return (handle_ != -1); };
   virtual bool operator!(void) { return (handle_ == -1); };
   virtual int Timeout(void) const { return timeout_; };
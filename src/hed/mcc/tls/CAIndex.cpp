@@ -0,0 +1,210 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <ctype.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include <fstream>
+
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+
+#include <openssl/err.h>
+#include <openssl/x509.h>
+
+#include <arc/FileUtils.h>
+
+#include "ConfigTLSMCC.h"
+#include "GlobusSigningPolicy.h"
+
+#include "CAIndex.h"
+
+namespace ArcMCCTLS {
+
+#if (OPENSSL_VERSION_NUMBER < 0x10100000L)
+static int X509_STORE_up_ref(X509_STORE* store) {
+  return (CRYPTO_add(&(store->references),1,CRYPTO_LOCK_X509_STORE) > 1) ? 1 : 0;
+}
+#endif
+
+static const char policy_suffix[] = ".signing_policy";
+
+Arc::Logger CAIndex::logger(Arc::Logger::getRootLogger(), "MCC.TLS.CAIndex");
+
+// Owns all indices and destroys them when module is unloaded.
+// Contexts still holding stores keep them alive through reference
+// counting.
+class CAIndexRegistry {
+ public:
+  Glib::Mutex lock;
+  std::map<std::string,CAIndex*> indices;
+  ~CAIndexRegistry(void) {
+    for(std::map<std::string,CAIndex*>::iterator index = indices.begin();
+                                  index != indices.end();++index) {
+      delete index->second;
+    };
+  };
+};
+
+static CAIndexRegistry registry;
+
+// Names used by OpenSSL for hashed directory lookup are
+// <hash>.<N> for certificates and <hash>.r<N> for CRLs.
+static bool is_hashed(const std::string& name) {
+  if(name.length() < 10) return false;
+  for(std::string::size_type n = 0; n < 8; ++n) {
+    if(!isxdigit(name[n])) return false;
+  };
+  return (name[8] == '.');
+}
+
+static bool is_number(const std::string& str, std::string::size_type pos) {
+  if(pos >= str.length()) return false;
+  return (str.find_first_not_of("0123456789",pos) == std::string::npos);
+}
+
+CAIndex* CAIndex::Get(const std::string& ca_file, const std::string& ca_dir) {
+  std::string key = ca_file + "\n" + ca_dir;
+  Glib::Mutex::Lock lock(registry.lock);
+  std::map<std::string,CAIndex*>::iterator index = registry.indices.find(key);
+  if(index != registry.indices.end()) return index->second;
+  CAIndex* new_index = new CAIndex(ca_file, ca_dir);
+  registry.indices[key] = new_index;
+  return new_index;
+}
+
+CAIndex::CAIndex(const std::string& ca_file, const std::string& ca_dir):
+    ca_file_(ca_file), ca_dir_(ca_dir), store_(NULL), loaded_(false),
+    checked_(0), ca_file_mtime_(0), ca_dir_mtime_(0), files_mtime_(0) {
+}
+
+CAIndex::~CAIndex(void) {
+  if(store_) X509_STORE_free(store_);
+  ClearPolicies();
+}
+
+void CAIndex::ClearPolicies(void) {
+  for(std::map<std::string,GlobusSigningPolicy*>::iterator policy = policies_.begin();
+                                   policy != policies_.end();++policy) {
+    delete policy->second;
+  };
+  policies_.clear();
+}
+
+// Files replaced in place (like regularly updated CRLs) do not change
+// modification time of directory, hence every indexed file is checked.
+// Change time is used too because copying may preserve modification time.
+time_t CAIndex::FilesChanged(void) const {
+  time_t newest = 0;
+  struct stat st;
+  for(std::list<std::string>::const_iterator file = files_.begin(); file != files_.end(); ++file) {
+    if(!Arc::FileStat(*file,&st,true)) continue;
+    if(st.st_mtime > newest) newest = st.st_mtime;
+    if(st.st_ctime > newest) newest = st.st_ctime;
+  };
+  return newest;
+}
+
+void CAIndex::Refresh(void) {
+  time_t now = ::time(NULL);
+  if(loaded_ && (now >= checked_) && (now < (checked_ + check_interval))) return;
+  checked_ = now;
+  struct stat st;
+  time_t ca_file_mtime = 0;
+  time_t ca_dir_mtime = 0;
+  if((!ca_file_.empty()) && Arc::FileStat(ca_file_,&st,true)) ca_file_mtime = st.st_mtime;
+  if((!ca_dir_.empty()) && Arc::FileStat(ca_dir_,&st,true)) ca_dir_mtime = st.st_mtime;
+  if(loaded_ && (ca_file_mtime == ca_file_mtime_) && (ca_dir_mtime == ca_dir_mtime_) &&
+     (FilesChanged() == files_mtime_)) return;
+  ca_file_mtime_ = ca_file_mtime;
+  ca_dir_mtime_ = ca_dir_mtime;
+  Load();
+  files_mtime_ = FilesChanged();
+  loaded_ = true;
+}
+
+void CAIndex::Load(void) {
+  failure_.clear();
+  ConfigTLSMCC::ClearError();
+  X509_STORE* store = X509_STORE_new();
+  if(!store) {
+    failure_ = "Can not create store for CA certificates\n";
+    failure_ += ConfigTLSMCC::HandleError();
+  } else if(!ca_file_.empty()) {
+    if(!X509_STORE_load_locations(store, ca_file_.c_str(), NULL)) {
+      failure_ = "Can not assign CA location - "+ca_file_+"\n";
+      failure_ += ConfigTLSMCC::HandleError();
+      X509_STORE_free(store);
+      store = NULL;
+    };
+  };
+  std::map<std::string,GlobusSigningPolicy*> policies;
+  std::list<std::string> files;
+  unsigned int objects = 0;
+  if(store && (!ca_dir_.empty())) {
+    X509_LOOKUP* lookup = X509_STORE_add_lookup(store, X509_LOOKUP_file());
+    try {
+      Glib::Dir dir(ca_dir_);
+      for(;;) {
+        std::string name = dir.read_name();
+        if(name.empty()) break;
+        if(!is_hashed(name)) continue;
+        std::string path = Glib::build_filename(ca_dir_, name);
+        files.push_back(path);
+        if(is_number(name,9) || ((name[9] == 'r') && is_number(name,10))) {
+          int n = lookup ? X509_load_cert_crl_file(lookup, path.c_str(), X509_FILETYPE_PEM) : 0;
+          if(n > 0) objects += n;
+          // Duplicates and broken files are skipped like OpenSSL's
+          // own directory lookup does.
+          ConfigTLSMCC::ClearError();
+        } else if(name.compare(8,std::string::npos,policy_suffix) == 0) {
+          std::ifstream f(path.c_str());
+          if(!f) continue;
+          GlobusSigningPolicy* policy = new GlobusSigningPolicy;
+          if(policy->open(f)) {
+            policies[name.substr(0,8)] = policy;
+          } else {
+            delete policy;
+          };
+        };
+      };
+    } catch(Glib::FileError& e) {
+      logger.msg(Arc::VERBOSE, "Can not read CA directory %s: %s", ca_dir_, e.what());
+    };
+  };
+  if(store_) X509_STORE_free(store_);
+  store_ = store;
+  ClearPolicies();
+  policies_ = policies;
+  files_.swap(files);
+  logger.msg(Arc::VERBOSE, "Loaded %u CA certificates and CRLs and %u signing policies from %s",
+             objects, (unsigned int)policies_.size(), ca_dir_.empty() ? ca_file_ : ca_dir_);
+}
+
+bool CAIndex::Set(SSL_CTX* sslctx, std::string& failure) {
+  Glib::Mutex::Lock lock(lock_);
+  Refresh();
+  if(!store_) {
+    failure = failure_;
+    return false;
+  };
+  // Store is reference counted and freed by context.
+  X509_STORE_up_ref(store_);
+  SSL_CTX_set_cert_store(sslctx, store_);
+  return true;
+}
+
+bool CAIndex::MatchSigningPolicy(const X509_NAME* issuer_subject, const X509_NAME* subject) {
+  unsigned long hash = X509_NAME_hash((X509_NAME*)issuer_subject);
+  char hash_str[32];
+  snprintf(hash_str,sizeof(hash_str)-1,"%08lx",hash);
+  hash_str[sizeof(hash_str)-1]=0;
+  Glib::Mutex::Lock lock(lock_);
+  std::map<std::string,GlobusSigningPolicy*>::iterator policy = policies_.find(hash_str);
+  if(policy == policies_.end()) return true;
+  return policy->second->match(issuer_subject, subject);
+}
+
+} // namespace ArcMCCTLS
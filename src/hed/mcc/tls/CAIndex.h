@@ -0,0 +1,64 @@
+#ifndef __ARC_MCCTLS_CAINDEX_H__
+#define __ARC_MCCTLS_CAINDEX_H__
+
+#include <string>
+#include <map>
+#include <list>
+
+#include <glibmm/thread.h>
+
+#include <openssl/ssl.h>
+
+#include <arc/Logger.h>
+
+namespace ArcMCCTLS {
+
+class GlobusSigningPolicy;
+
+/// In-memory index of trusted CA certificates, CRLs and signing policies.
+/** One index exists per combination of CA file and CA directory and is
+  shared by all TLS contexts in the process. Certificates and CRLs are
+  kept in an X509_STORE which is attached to every SSL_CTX instead of
+  letting OpenSSL look up hashed files in CA directory for every
+  verification. Signing policies are parsed once. Content is reloaded
+  when modification time of CA file or directory or of any indexed file
+  changes, which is checked at most once per check_interval seconds. */
+class CAIndex {
+ public:
+  /// Returns index for specified location, creating it if needed.
+  /// Returned object is owned by the registry and lives till process exits.
+  static CAIndex* Get(const std::string& ca_file, const std::string& ca_dir);
+  /// Assigns trusted certificates and CRLs to SSL context.
+  bool Set(SSL_CTX* sslctx, std::string& failure);
+  /// Checks subject against signing policy of issuer. Returns true if
+  /// there is no signing policy for issuer.
+  bool MatchSigningPolicy(const X509_NAME* issuer_subject, const X509_NAME* subject);
+ private:
+  static const time_t check_interval = 60;
+  static Arc::Logger logger;
+  Glib::Mutex lock_;
+  std::string ca_file_;
+  std::string ca_dir_;
+  X509_STORE* store_;
+  std::map<std::string,GlobusSigningPolicy*> policies_;
+  std::string failure_;
+  bool loaded_;
+  time_t checked_;
+  time_t ca_file_mtime_;
+  time_t ca_dir_mtime_;
+  std::list<std::string> files_; // indexed files in CA directory
+  time_t files_mtime_;           // newest change of indexed files
+  CAIndex(const std::string& ca_file, const std::string& ca_dir);
+  ~CAIndex(void);
+  CAIndex(CAIndex const &);
+  CAIndex& operator=(CAIndex const &);
+  void Refresh(void);
+  void Load(void);
+  void ClearPolicies(void);
+  time_t FilesChanged(void) const;
+  friend class CAIndexRegistry;
+};
+
+} // namespace ArcMCCTLS
+
+#endif // __ARC_MCCTLS_CAINDEX_H__
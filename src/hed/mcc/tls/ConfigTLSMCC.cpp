@@ -11,6 +11,7 @@
 #include "PayloadTLSStream.h"
 
 #include "ConfigTLSMCC.h"
+#include "CAIndex.h"
 
 
 // For early OpenSSL 1.0.0
@@ -217,11 +218,8 @@ ConfigTLSMCC::ConfigTLSMCC(XMLNode cfg,bool client) {
 
 bool ConfigTLSMCC::Set(SSL_CTX* sslctx) {
   if((!ca_file_.empty()) || (!ca_dir_.empty())) {
-    if(!SSL_CTX_load_verify_locations(sslctx, ca_file_.empty()?NULL:ca_file_.c_str(), ca_dir_.empty()?NULL:ca_dir_.c_str())) {
-      failure_ = "Can not assign CA location - "+(ca_dir_.empty()?ca_file_:ca_dir_)+"\n";
-      failure_ += HandleError();
-      return false;
-    };
+    // Trusted certificates and CRLs are shared by all contexts
+    if(!CAIndex::Get(ca_file_, ca_dir_)->Set(sslctx, failure_)) return false;
   };
   if(!credential_.empty()) {
     // First try to use in-memory credential
@@ -188,23 +188,14 @@ static bool get_conditions(std::string s,std::list<std::string>& patterns) {
   return true;
 }
 
-static bool match_all(const std::string& issuer_subject,const std::string& subject,const std::string& policy_ca_subject,std::list<std::string> policy_patterns) {
-  if(issuer_subject == policy_ca_subject) {
-    std::list<std::string>::iterator pattern = policy_patterns.begin();
-    for(;pattern!=policy_patterns.end();++pattern) {
-      std::string::size_type p = 0;
-      for(;;) {
-        p=pattern->find('*',p);
-        if(p == std::string::npos) break;
-        pattern->insert(p,"."); p+=2;
-      };
-      (*pattern)="^"+(*pattern)+"$";
-      RegularExpression re(*pattern);
-      bool r = re.match(subject);
-      if(r) return true;
-    };
+static void to_regex(std::string& pattern) {
+  std::string::size_type p = 0;
+  for(;;) {
+    p=pattern.find('*',p);
+    if(p == std::string::npos) break;
+    pattern.insert(p,"."); p+=2;
   };
-  return false;
+  pattern="^"+pattern+"$";
 }
 
 static void X509_NAME_to_string(std::string& str,const X509_NAME* name) {
@@ -218,26 +209,46 @@ static void X509_NAME_to_string(std::string& str,const X509_NAME* name) {
   return;
 }
 
-bool GlobusSigningPolicy::match(const X509_NAME* issuer_subject,const X509_NAME* subject) {
-  if(!stream_) return false;
-  std::istream& in(*stream_);
+bool GlobusSigningPolicy::match(const X509_NAME* issuer_subject,const X509_NAME* subject) const {
+  if(entries_.empty()) return false;
   std::string issuer_subject_str;
   std::string subject_str;
+  X509_NAME_to_string(issuer_subject_str,issuer_subject);
+  X509_NAME_to_string(subject_str,subject);
+  for(std::list<Entry>::const_iterator entry = entries_.begin();entry != entries_.end();++entry) {
+    if(issuer_subject_str != entry->ca_subject) continue;
+    std::list<RegularExpression>::const_iterator pattern = entry->patterns.begin();
+    for(;pattern!=entry->patterns.end();++pattern) {
+      if(pattern->match(subject_str)) return true;
+    };
+  };
+  return false;
+}
+
+bool GlobusSigningPolicy::open(std::istream& in) {
+  close();
   std::string s;
   std::string policy_ca_subject;
   std::list<std::string> policy_patterns;
   bool rights_defined = false;
   bool failure = false;
-  X509_NAME_to_string(issuer_subject_str,issuer_subject);
-  X509_NAME_to_string(subject_str,subject);
-  for(;;) {
+  // Only complete and valid entries are stored. Empty line is
+  // returned by get_line() only at end of stream.
+  for(bool done = false;!done;) {
     get_line(in,s);
-    if(s.empty()) break;
-    if(s.compare(0,strlen(access_id),access_id) == 0) {
+    done = s.empty();
+    if(done || (s.compare(0,strlen(access_id),access_id) == 0)) {
       if((!policy_ca_subject.empty()) && (rights_defined) && (!failure)) {
-        bool r = match_all(issuer_subject_str,subject_str,policy_ca_subject,policy_patterns);
-        if(r) return true;
+        entries_.push_back(Entry());
+        Entry& entry = entries_.back();
+        entry.ca_subject = policy_ca_subject;
+        for(std::list<std::string>::iterator pattern = policy_patterns.begin();
+                                 pattern != policy_patterns.end();++pattern) {
+          to_regex(*pattern);
+          entry.patterns.push_back(RegularExpression(*pattern));
+        };
       };
+      if(done) break;
       policy_ca_subject.resize(0);
       policy_patterns.resize(0);
       failure=false; rights_defined=false;
@@ -256,26 +267,19 @@ bool GlobusSigningPolicy::match(const X509_NAME* issuer_subject,const X509_NAME*
       failure=true;
     };
   };
-  if((!policy_ca_subject.empty()) && (rights_defined) && (!failure)) {
-    bool r = match_all(issuer_subject_str,subject_str,policy_ca_subject,policy_patterns);
-    if(r) return true;
-  };
-  return false;
+  return true;
 }
 
 bool GlobusSigningPolicy::open(const X509_NAME* issuer_subject,const std::string& ca_path) {
   close();
-  //std::string issuer_subject_str;
-  //X509_NAME_to_string(issuer_subject_str,issuer_subject);
   unsigned long hash = X509_NAME_hash((X509_NAME*)issuer_subject);
   char hash_str[32];
   snprintf(hash_str,sizeof(hash_str)-1,"%08lx",hash);
   hash_str[sizeof(hash_str)-1]=0;
   std::string fname = ca_path+"/"+hash_str+policy_suffix;
-  std::ifstream* f = new std::ifstream(fname.c_str());
-  if(!(*f)) { delete f; return false; };
-  stream_ = f;
-  return true;
+  std::ifstream f(fname.c_str());
+  if(!f) return false;
+  return open(f);
 }
 
 }
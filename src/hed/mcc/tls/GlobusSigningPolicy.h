@@ -4,19 +4,32 @@
 
 #include <openssl/ssl.h>
 
+#include <arc/ArcRegex.h>
+
 namespace ArcMCCTLS {
 
+/// Parsed Globus signing policy of one CA.
+/** Policy is parsed once when opened and kept in memory, so match()
+  may be called repeatedly without accessing file system. */
 class GlobusSigningPolicy {
   public:
-    GlobusSigningPolicy(): stream_(NULL) { };
+    GlobusSigningPolicy() { };
     ~GlobusSigningPolicy() { close(); };
+    /// Reads and parses <hash>.signing_policy file of issuer from CA directory.
     bool open(const X509_NAME* issuer_subject,const std::string& ca_path);
-    void close() { delete stream_; stream_ = NULL; };
-    bool match(const X509_NAME* issuer_subject,const X509_NAME* subject);
+    /// Parses signing policy from stream.
+    bool open(std::istream& in);
+    void close() { entries_.clear(); };
+    bool match(const X509_NAME* issuer_subject,const X509_NAME* subject) const;
   private:
     GlobusSigningPolicy(GlobusSigningPolicy const &);
     GlobusSigningPolicy& operator=(GlobusSigningPolicy const &);
-    std::istream* stream_;
+    class Entry {
+     public:
+      std::string ca_subject;
+      std::list<Arc::RegularExpression> patterns;
+    };
+    std::list<Entry> entries_;
 };
 
 } // namespace ArcMCCTLS
@@ -4,7 +4,7 @@
 
 #include <fstream>
 
-#include "GlobusSigningPolicy.h"
+#include "CAIndex.h"
 
 #include "PayloadTLSMCC.h"
 #include <openssl/err.h>
@@ -105,17 +105,14 @@ static int verify_callback(int ok,X509_STORE_CTX *sctx) {
           if((X509_get_ext_by_NID(cert,NID_proxyCertInfo,-1) < 0) &&
              (X509_NAME_cmp(X509_get_issuer_name(cert),X509_get_subject_name(cert)) != 0)) {
             //std::cerr<<"+++ additional verification: check signing policy - is not proxy"<<std::endl;
-            GlobusSigningPolicy globus_policy;
-            if(globus_policy.open(X509_get_issuer_name(cert),it->Config().CADir())) {
-              //std::cerr<<"+++ additional verification: policy is open"<<std::endl;
-              if(!globus_policy.match(X509_get_issuer_name(cert),X509_get_subject_name(cert))) {
-                it->SetFailure(std::string("Certificate ")+subject_name+" failed Globus signing policy");
-                //std::cerr<<"+++ additional verification: failed: "<<subject_name<<std::endl;
-                ok=0;
-                X509_STORE_CTX_set_error(sctx,X509_V_ERR_SUBJECT_ISSUER_MISMATCH);
-              } else {
-                //std::cerr<<"+++ additional verification: passed: "<<subject_name<<std::endl;
-              };
+            CAIndex* ca_index = CAIndex::Get(it->Config().CAFile(),it->Config().CADir());
+            if(!ca_index->MatchSigningPolicy(X509_get_issuer_name(cert),X509_get_subject_name(cert))) {
+              it->SetFailure(std::string("Certificate ")+subject_name+" failed Globus signing policy");
+              //std::cerr<<"+++ additional verification: failed: "<<subject_name<<std::endl;
+              ok=0;
+              X509_STORE_CTX_set_error(sctx,X509_V_ERR_SUBJECT_ISSUER_MISMATCH);
+            } else {
+              //std::cerr<<"+++ additional verification: passed: "<<subject_name<<std::endl;
             };
           };
         };
@@ -7,6 +7,7 @@
 #include <string>
 #include <cstring>
 #include <fstream>
+#include <sstream>
 #include <unistd.h>
 #include <fcntl.h>
 #include <openssl/x509.h>
@@ -57,12 +58,14 @@ class GlobusSigningPolicyTest
 
   CPPUNIT_TEST_SUITE(GlobusSigningPolicyTest);
   CPPUNIT_TEST(CASubjectMatchTest);
+  CPPUNIT_TEST(RepeatedMatchTest);
   CPPUNIT_TEST_SUITE_END();
 
 public:
   GlobusSigningPolicyTest() : policyfilename1(NULL), policyfilename2(NULL), policyfilename3(NULL) {}
 
   void CASubjectMatchTest();
+  void RepeatedMatchTest();
 
   void setUp();
   void tearDown();
@@ -189,5 +192,38 @@ void GlobusSigningPolicyTest::CASubjectMatchTest() {
   CPPUNIT_ASSERT(!policy.match(caBad1, userGood1));
 }
 
+void GlobusSigningPolicyTest::RepeatedMatchTest() {
+  ArcMCCTLS::GlobusSigningPolicy policy;
+  std::istringstream in(policycontent1);
+  CPPUNIT_ASSERT(policy.open(in));
+
+  X509_NAME* caOther = X509_NAME_new();
+  X509_NAME_add_entry_by_txt(caOther, "C", MBSTRING_ASC, (unsigned char const *)"ca", -1, -1, 0);
+  X509_NAME_add_entry_by_txt(caOther, "O", MBSTRING_ASC, (unsigned char const *)"other", -1, -1, 0);
+
+  X509_NAME* userGood2 = X509_NAME_new();
+  X509_NAME_add_entry_by_txt(userGood2, "O", MBSTRING_ASC, (unsigned char const *)"subject", -1, -1, 0);
+  X509_NAME_add_entry_by_txt(userGood2, "CN", MBSTRING_ASC, (unsigned char const *)"user2", -1, -1, 0);
+  X509_NAME_add_entry_by_txt(userGood2, "emailAddress", MBSTRING_ASC, (unsigned char const *)"alt2", -1, -1, 0);
+
+  X509_NAME* userBad1 = X509_NAME_new();
+  X509_NAME_add_entry_by_txt(userBad1, "O", MBSTRING_ASC, (unsigned char const *)"subject", -1, -1, 0);
+  X509_NAME_add_entry_by_txt(userBad1, "CN", MBSTRING_ASC, (unsigned char const *)"user3", -1, -1, 0);
+
+  // Parsed policy is kept and may be matched many times
+  for(int n = 0; n < 3; ++n) {
+    CPPUNIT_ASSERT(policy.match(policyfilename1, userGood2));
+    CPPUNIT_ASSERT(!policy.match(policyfilename1, userBad1));
+    CPPUNIT_ASSERT(!policy.match(caOther, userGood2));
+  }
+
+  policy.close();
+  CPPUNIT_ASSERT(!policy.match(policyfilename1, userGood2));
+
+  X509_NAME_free(caOther);
+  X509_NAME_free(userGood2);
+  X509_NAME_free(userBad1);
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(GlobusSigningPolicyTest);
 
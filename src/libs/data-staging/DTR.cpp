@@ -72,7 +72,8 @@ namespace DataStaging {
        use_host_cert_for_remote_delivery(false),
        current_owner(GENERATOR),
        log_destinations(logs),
-       perf_record(perf_log)
+       perf_record(perf_log),
+       status_record(perf_log)
   {
     logger = new Arc::Logger(Arc::Logger::getRootLogger(), logname.c_str());
     logger->addDestinations(get_log_destinations());
@@ -211,6 +212,8 @@ namespace DataStaging {
   {
     logger->msg(Arc::VERBOSE, "%s->%s", status.str(), stat.str());
     lock.lock();
+    status_record.Trace("DTR:" + status.str());
+    status_record.Start(parent_job_id);
     status = stat;
     lock.unlock();
     mark_modification();
@@ -371,6 +371,9 @@ namespace DataStaging {
     /// Performance record used for recording transfer time
     Arc::JobPerfRecord perf_record;
 
+    /// Performance record used for tracing time spent in each status
+    Arc::JobPerfRecord status_record;
+
     /// List of callback methods called when DTR moves between processes
     std::map<StagingProcesses,std::list<DTRCallback*> > proc_callback;
 
@@ -0,0 +1,163 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <arc/FileUtils.h>
+#include <arc/StringConv.h>
+
+#include "DTRJournal.h"
+
+namespace DataStaging {
+
+  // Fields are separated by single space, so empty values are possible.
+  // Space, newline and escape character itself are hex encoded.
+  static const std::string escaped_chars(" \n\r\\");
+
+  static std::string escape_field(const std::string& str) {
+    return Arc::escape_chars(str, escaped_chars, '\\', false, Arc::escape_hex);
+  }
+
+  static std::string next_field(const std::string& line, std::string::size_type& pos) {
+    if (pos == std::string::npos) return "";
+    std::string::size_type end = line.find(' ', pos);
+    std::string field;
+    if (end == std::string::npos) {
+      field = line.substr(pos);
+      pos = std::string::npos;
+    } else {
+      field = line.substr(pos, end-pos);
+      pos = end+1;
+    }
+    return Arc::unescape_chars(field, '\\', Arc::escape_hex);
+  }
+
+  bool DTRJournal::Record::operator==(const Record& other) const {
+    return (id == other.id) && (job_id == other.job_id) && (status == other.status) &&
+           (priority == other.priority) && (share == other.share) && (bytes == other.bytes) &&
+           (destination == other.destination) && (delivery_host == other.delivery_host);
+  }
+
+  std::string DTRJournal::Record::str(void) const {
+    return escape_field(id) + " " + escape_field(job_id) + " " + escape_field(status) + " " +
+           Arc::tostring(priority) + " " + escape_field(share) + " " + Arc::tostring(bytes) + " " +
+           escape_field(destination) + " " + escape_field(delivery_host);
+  }
+
+  bool DTRJournal::Record::parse(const std::string& line) {
+    std::string::size_type pos = 0;
+    id = next_field(line, pos);
+    job_id = next_field(line, pos);
+    status = next_field(line, pos);
+    if (!Arc::stringto(next_field(line, pos), priority)) return false;
+    share = next_field(line, pos);
+    if (!Arc::stringto(next_field(line, pos), bytes)) return false;
+    if (pos == std::string::npos) return false;
+    destination = next_field(line, pos);
+    if (pos == std::string::npos) return false;
+    delivery_host = next_field(line, pos);
+    return !id.empty() && (pos == std::string::npos);
+  }
+
+  DTRJournal::DTRJournal(const std::string& path): path(path), lines(0), written(false) {
+  }
+
+  bool DTRJournal::Update(const std::map<std::string, Record>& records) {
+    lock.lock();
+    // Rewriting file is cheaper than keeping history which is mostly obsolete
+    if (!written || (lines > 2*records.size() + 1000)) {
+      bool r = Compact(records);
+      lock.unlock();
+      return r;
+    }
+    std::string data;
+    unsigned int changes = 0;
+    std::map<std::string, Record>::const_iterator rec = records.begin();
+    std::map<std::string, Record>::iterator old = state.begin();
+    // Both maps are sorted by id so one pass is enough to find differences
+    while (rec != records.end() || old != state.end()) {
+      if (old == state.end() || (rec != records.end() && rec->first < old->first)) {
+        data += "+ " + rec->second.str() + "\n";
+        ++rec; ++changes;
+      } else if (rec == records.end() || old->first < rec->first) {
+        data += "- " + escape_field(old->first) + "\n";
+        ++old; ++changes;
+      } else {
+        if (rec->second != old->second) {
+          data += "+ " + rec->second.str() + "\n";
+          ++changes;
+        }
+        ++rec; ++old;
+      }
+    }
+    if (changes == 0) {
+      lock.unlock();
+      return true;
+    }
+    if (!Append(data)) {
+      // File may end with partial line now, so rewrite it next time
+      written = false;
+      lock.unlock();
+      return false;
+    }
+    state = records;
+    lines += changes;
+    lock.unlock();
+    return true;
+  }
+
+  bool DTRJournal::Append(const std::string& data) {
+    int h = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (h == -1) return false;
+    std::string::size_type p = 0;
+    while (p < data.length()) {
+      ssize_t l = ::write(h, data.c_str()+p, data.length()-p);
+      if (l < 0) {
+        if (errno == EINTR) continue;
+        ::close(h);
+        return false;
+      }
+      p += l;
+    }
+    return (::close(h) == 0);
+  }
+
+  bool DTRJournal::Compact(const std::map<std::string, Record>& records) {
+    std::string data;
+    for (std::map<std::string, Record>::const_iterator rec = records.begin(); rec != records.end(); ++rec) {
+      data += "+ " + rec->second.str() + "\n";
+    }
+    // File is replaced atomically so journal is always complete
+    if (!Arc::FileCreate(path, data)) return false;
+    state = records;
+    lines = records.size();
+    written = true;
+    return true;
+  }
+
+  bool DTRJournal::Read(const std::string& path, std::map<std::string, Record>& records) {
+    std::string data;
+    if (!Arc::FileRead(path, data)) return false;
+    std::string::size_type start = 0;
+    for (;;) {
+      std::string::size_type end = data.find('\n', start);
+      // Line without newline at the end of file is incomplete
+      if (end == std::string::npos) break;
+      std::string line(data, start, end-start);
+      start = end+1;
+      if (line.length() < 2 || line[1] != ' ') continue;
+      if (line[0] == '+') {
+        Record rec;
+        if (rec.parse(line.substr(2))) records[rec.id] = rec;
+      } else if (line[0] == '-') {
+        records.erase(Arc::unescape_chars(line.substr(2), '\\', Arc::escape_hex));
+      }
+    }
+    return true;
+  }
+
+} // namespace DataStaging
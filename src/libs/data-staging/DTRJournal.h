@@ -0,0 +1,99 @@
+#ifndef DTRJOURNAL_H_
+#define DTRJOURNAL_H_
+
+#include <map>
+#include <string>
+
+#include <arc/Thread.h>
+
+namespace DataStaging {
+
+  /// Incremental log of DTR state changes.
+  /**
+   * The Scheduler periodically passes the state of all DTRs in the system to
+   * the journal. Only DTRs whose state changed since the previous call are
+   * written, as one short line each, and DTRs which disappeared from the
+   * system are recorded as removed. Hence the cost of keeping the journal is
+   * proportional to the amount of activity rather than to the number of DTRs.
+   * When the journal grows much bigger than the state it describes it is
+   * rewritten (compacted) through a temporary file.
+   *
+   * Read() reconstructs the last known state of DTRs which were still active
+   * when the journal was last written. After a restart it is used to find and
+   * clean up destinations of transfers which were interrupted, to regenerate
+   * DTRs of affected jobs before other jobs and to give them back priority
+   * they had in the Scheduler. DTRs themselves are always regenerated from
+   * job control files, because credentials and callbacks can't be restored
+   * from the journal.
+   * \ingroup datastaging
+   * \headerfile DTRJournal.h arc/data-staging/DTRJournal.h
+   */
+  class DTRJournal {
+    public:
+
+      /// State of one DTR as stored in journal.
+      class Record {
+        public:
+          std::string id;
+          std::string job_id;
+          std::string status;
+          int priority;
+          std::string share;
+          /// Bytes transferred so far. Informational only - interrupted
+          /// transfers are always restarted from the beginning.
+          unsigned long long int bytes;
+          /// Destination and delivery host are only kept while transferring
+          std::string destination;
+          std::string delivery_host;
+          Record(void): priority(0), bytes(0) {};
+          bool operator==(const Record& other) const;
+          bool operator!=(const Record& other) const { return !operator==(other); };
+          /// Journal line representing this record (without newline)
+          std::string str(void) const;
+          /// Fill record from fields of journal line following marker.
+          bool parse(const std::string& line);
+      };
+
+      /// Create journal stored at path. Nothing is written until Update().
+      DTRJournal(const std::string& path);
+
+      /// Store current state of DTRs. Records not present in map are removed.
+      /**
+       * Returns false if journal could not be written. In that case all
+       * changes are kept and written together with next successful update.
+       */
+      bool Update(const std::map<std::string, Record>& records);
+
+      /// Path of journal file
+      const std::string& Path(void) const { return path; };
+
+      /// Read last state of active DTRs from journal file.
+      /**
+       * Incomplete last line, which may be left if process was killed during
+       * write, is ignored. Returns false if file can't be read.
+       */
+      static bool Read(const std::string& path, std::map<std::string, Record>& records);
+
+    private:
+
+      std::string path;
+
+      /// State as it is currently described by file
+      std::map<std::string, Record> state;
+
+      /// Lines in file, used to decide when to compact
+      unsigned int lines;
+
+      /// False until file is written for the first time. First write always
+      /// compacts, removing leftovers of the previous process.
+      bool written;
+
+      Arc::SimpleCondition lock;
+
+      bool Append(const std::string& data);
+      bool Compact(const std::map<std::string, Record>& records);
+  };
+
+} // namespace DataStaging
+
+#endif /* DTRJOURNAL_H_ */
@@ -279,4 +279,27 @@ namespace DataStaging {
     Arc::FileCreate(path, data);
   }
 
+  bool DTRList::journalState(DTRJournal& journal) {
+    std::map<std::string, DTRJournal::Record> records;
+    Lock.lock();
+    for(std::list<DTR_ptr>::iterator it = DTRs.begin();it != DTRs.end(); ++it) {
+      DTRJournal::Record& rec = records[(*it)->get_id()];
+      DTRStatus status = (*it)->get_status();
+      rec.id = (*it)->get_id();
+      rec.job_id = (*it)->get_parent_job_id();
+      rec.status = status.str();
+      rec.priority = (*it)->get_priority();
+      rec.share = (*it)->get_transfer_share();
+      rec.bytes = (*it)->get_bytes_transferred();
+      // same as in dumpState(), needed for recovery after crash
+      if (status == DTRStatus::TRANSFERRING || status == DTRStatus::TRANSFER) {
+        rec.destination = (*it)->get_destination()->CurrentLocation().fullstr();
+        rec.delivery_host = (*it)->get_delivery_endpoint().Host();
+      }
+    }
+    Lock.unlock();
+
+    return journal.Update(records);
+  }
+
 } // namespace DataStaging
@@ -4,6 +4,7 @@
 #include <arc/Thread.h>
 
 #include "DTR.h"
+#include "DTRJournal.h"
 
 namespace DataStaging {
   
@@ -134,6 +135,13 @@ namespace DataStaging {
        */
       void dumpState(const std::string& path);
 
+      /// Record changes in state of current DTRs in journal.
+      /**
+       * DTRs which are no longer in the list are recorded as removed.
+       * @return false if journal could not be written.
+       */
+      bool journalState(DTRJournal& journal);
+
   };
 
 } // namespace DataStaging
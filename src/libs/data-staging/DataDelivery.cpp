@@ -17,13 +17,14 @@ namespace DataStaging {
     DataDeliveryComm* comm;
     bool cancelled;
     Arc::SimpleCounter thread_count;
-    delivery_pair_t(DTR_ptr request, const TransferParameters& params);
+    Arc::SimpleCondition& finished;
+    delivery_pair_t(DTR_ptr request, const TransferParameters& params, Arc::SimpleCondition& finished);
     ~delivery_pair_t();
     void start();
   };
 
-  DataDelivery::delivery_pair_t::delivery_pair_t(DTR_ptr request, const TransferParameters& params)
-    :dtr(request),params(params),comm(NULL),cancelled(false) {}
+  DataDelivery::delivery_pair_t::delivery_pair_t(DTR_ptr request, const TransferParameters& params, Arc::SimpleCondition& finished)
+    :dtr(request),params(params),comm(NULL),cancelled(false),finished(finished) {}
 
   DataDelivery::delivery_pair_t::~delivery_pair_t() {
     if (comm) delete comm;
@@ -31,6 +32,8 @@ namespace DataStaging {
 
   void DataDelivery::delivery_pair_t::start() {
     comm = DataDeliveryComm::CreateInstance(dtr, params);
+    // Wake up main loop as soon as transfer finishes
+    if (comm) comm->SetFinishedCondition(&finished);
   }
 
   DataDelivery::DataDelivery(): delivery_state(INITIATED) {
@@ -55,7 +58,7 @@ namespace DataStaging {
                dtr->get_id(), dtr->get_source()->CurrentLocation().str(), dtr->get_destination()->CurrentLocation().str());
 
     dtr->set_status(DTRStatus::TRANSFERRING);
-    delivery_pair_t* d = new delivery_pair_t(dtr, transfer_params);
+    delivery_pair_t* d = new delivery_pair_t(dtr, transfer_params, cond);
     dtr_list_lock.lock();
     dtr_list.push_back(d);
     dtr_list_lock.unlock();
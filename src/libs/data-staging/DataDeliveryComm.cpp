@@ -15,7 +15,7 @@ namespace DataStaging {
   }
 
   DataDeliveryComm::DataDeliveryComm(DTR_ptr dtr, const TransferParameters& params)
-    : status_pos_(0),transfer_params(params),logger_(dtr->get_logger()),handler_(NULL) {
+    : status_pos_(0),transfer_params(params),logger_(dtr->get_logger()),handler_(NULL),finished_cond_(NULL) {
   }
 
   DataDeliveryCommHandler& DataDeliveryComm::GetHandler() {
@@ -29,6 +29,25 @@ namespace DataStaging {
     return tmp;
   }
 
+  void DataDeliveryComm::SetFinishedCondition(Arc::SimpleCondition* cond) {
+    Glib::Mutex::Lock lock(lock_);
+    finished_cond_ = cond;
+    if((status_.commstatus == CommExited) ||
+       (status_.commstatus == CommClosed) ||
+       (status_.commstatus == CommFailed)) SignalFinished();
+  }
+
+  void DataDeliveryComm::SignalFinished() {
+    if(finished_cond_) finished_cond_->signal();
+  }
+
+  void DataDeliveryComm::BulkPullStatus(std::list<DataDeliveryComm*>& items) {
+    for(std::list<DataDeliveryComm*>::iterator i = items.begin();
+                        i != items.end();++i) {
+      if(*i) (*i)->PullStatus();
+    }
+  }
+
   bool DataDeliveryComm::CheckComm(DTR_ptr dtr, std::vector<std::string>& allowed_dirs, std::string& load_avg) {
     if (!dtr->get_delivery_endpoint() || dtr->get_delivery_endpoint() == DTR::LOCAL_DELIVERY)
       return DataDeliveryLocalComm::CheckComm(dtr, allowed_dirs, load_avg);
@@ -55,6 +74,16 @@ namespace DataStaging {
         ++i;
       }
     }
+    kick_cond_.lock();
+    kicked_.erase(item);
+    kick_cond_.unlock();
+  }
+
+  void DataDeliveryCommHandler::Kick(DataDeliveryComm* item) {
+    kick_cond_.lock();
+    kicked_.insert(item);
+    kick_cond_.signal_nonblock();
+    kick_cond_.unlock();
   }
 
   Glib::Mutex DataDeliveryCommHandler::comm_lock;
@@ -76,20 +105,35 @@ namespace DataStaging {
     Arc::Logger::getRootLogger().setThreadContext();
     Arc::Logger::getRootLogger().removeDestinations();
 
-    // We do not need extremely low latency, so this
-    // thread simply polls for data 2 times per second.
+    // All items are checked 2 times per second. Items which reported
+    // new information through Kick() are checked as soon as possible.
     DataDeliveryCommHandler& it = *(DataDeliveryCommHandler*)arg;
+    Arc::Time next_poll;
     for(;;) {
+      Arc::Time now;
+      if(now < next_poll) {
+        Arc::Period left = next_poll - now;
+        it.kick_cond_.wait(left.GetPeriod()*1000 + left.GetPeriodNanoseconds()/1000000 + 1);
+      }
       {
         Glib::Mutex::Lock lock(it.lock_);
-        for(std::list<DataDeliveryComm*>::iterator i = it.items_.begin();
-                  i != it.items_.end();++i) {
-          DataDeliveryComm* comm = *i;
-          if(comm)
-            comm->PullStatus();
+        // Kicked items are taken under lock_ so none of them can be
+        // removed and destroyed before being processed.
+        std::list<DataDeliveryComm*> kicked;
+        it.kick_cond_.lock();
+        kicked.assign(it.kicked_.begin(), it.kicked_.end());
+        it.kicked_.clear();
+        it.kick_cond_.unlock();
+        // All items of one handler are of same type, so the first one
+        // can decide how to collect states of all of them.
+        if(Arc::Time() >= next_poll) {
+          if(!it.items_.empty() && it.items_.front())
+            it.items_.front()->BulkPullStatus(it.items_);
+          next_poll = Arc::Time() + Arc::Period(0, 500000000);
+        } else if(!kicked.empty()) {
+          kicked.front()->BulkPullStatus(kicked);
         }
       }
-      Glib::usleep(500000);
     }
   }
 
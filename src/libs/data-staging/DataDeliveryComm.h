@@ -1,6 +1,8 @@
 #ifndef DATA_DELIVERY_COMM_H_
 #define DATA_DELIVERY_COMM_H_
 
+#include <set>
+
 #include "DTR.h"
 
 namespace DataStaging {
@@ -84,6 +86,16 @@ namespace DataStaging {
      */
     virtual void PullStatus() = 0;
 
+    /// Check for new state of many transfers at once.
+    /**
+     * Called by the comm handler instead of calling PullStatus() for every
+     * object separately. All items belong to the same handler and hence are
+     * of the same type as this object. The default implementation calls
+     * PullStatus() of every item. Implementations which can obtain states
+     * of many transfers in one operation should override it.
+     */
+    virtual void BulkPullStatus(std::list<DataDeliveryComm*>& items);
+
     /// Returns identifier of the handler/delivery service this object uses to perform transfers.
     virtual std::string DeliveryId() const = 0;
 
@@ -97,9 +109,15 @@ namespace DataStaging {
     /// Access handler used for this DataDeliveryComm object
     DataDeliveryCommHandler& GetHandler();
 
+    /// Signal condition assigned by SetFinishedCondition(), if any.
+    /** Implementations call it with lock_ held when transfer finishes. */
+    void SignalFinished();
+
    private:
     /// Pointer to handler used for this DataDeliveryComm object
     DataDeliveryCommHandler* handler_;
+    /// Condition to signal when transfer finishes
+    Arc::SimpleCondition* finished_cond_;
 
    public:
     /// Factory method to get DataDeliveryComm instance.
@@ -111,6 +129,14 @@ namespace DataStaging {
     /// Obtain status of transfer
     Status GetStatus() const;
 
+    /// Assign condition to be signalled when transfer finishes.
+    /**
+     * This lets user of this object react on end of transfer immediately
+     * instead of waiting for next call to GetStatus(). If transfer has
+     * already finished condition is signalled immediately.
+     */
+    void SetFinishedCondition(Arc::SimpleCondition* cond);
+
     /// Check the delivery method is available. Calls CheckComm of the appropriate subclass.
     /**
      * \param dtr DTR from which credentials are used
@@ -141,6 +167,10 @@ namespace DataStaging {
     Glib::Mutex lock_;
     static void func(void* arg);
     std::list<DataDeliveryComm*> items_;
+    /// Items which have new information and should be checked immediately
+    std::set<DataDeliveryComm*> kicked_;
+    /// Wakes up handler thread. Its lock also protects kicked_.
+    Arc::SimpleCondition kick_cond_;
     static Glib::Mutex comm_lock;
     static std::map<std::string, DataDeliveryCommHandler*> comm_handler;
 
@@ -155,6 +185,12 @@ namespace DataStaging {
     void Add(DataDeliveryComm* item);
     /// Remove a DataDeliveryComm instance from the handler
     void Remove(DataDeliveryComm* item);
+    /// Request status of item to be checked as soon as possible
+    /**
+     * Without this all items are checked periodically. This method may be
+     * called from any thread.
+     */
+    void Kick(DataDeliveryComm* item);
     /// Get the instance of the handler for specified delivery id
     static DataDeliveryCommHandler* getInstance(std::string const & id);
   };
@@ -35,8 +35,31 @@ namespace DataStaging {
     return proxy_new_path;
   }
 
+  DataDeliveryLocalComm::PipeSink::PipeSink(DataDeliveryLocalComm& comm, std::string& buffer,
+                                            std::string::size_type kick_size)
+    : comm_(comm),buffer_(buffer),kick_size_(kick_size) {
+  }
+
+  void DataDeliveryLocalComm::PipeSink::Append(char const* data, unsigned int size) {
+    bool kick = false;
+    {
+      Glib::Mutex::Lock lock(comm_.pipe_lock_);
+      buffer_.append(data, size);
+      kick = (kick_size_ > 0) && (buffer_.length() >= kick_size_);
+    }
+    if(kick) comm_.GetHandler().Kick(&comm_);
+  }
+
+  void DataDeliveryLocalComm::ChildExited(void* arg) {
+    DataDeliveryLocalComm* comm = (DataDeliveryLocalComm*)arg;
+    comm->GetHandler().Kick(comm);
+  }
+
   DataDeliveryLocalComm::DataDeliveryLocalComm(DTR_ptr dtr, const TransferParameters& params)
-    : DataDeliveryComm(dtr, params),child_(NULL),last_comm(Arc::Time()) {
+    : DataDeliveryComm(dtr, params),child_(NULL),
+      stdout_sink_(*this, stdout_buf_, sizeof(status_buf_)),
+      stderr_sink_(*this, stderr_buf_, 0),
+      last_comm(Arc::Time()) {
     // Initial empty status
     memset(&status_,0,sizeof(status_));
     status_.commstatus = CommInit;
@@ -162,6 +185,9 @@ namespace DataStaging {
       child_->KeepStdout(false);
       child_->KeepStderr(false);
       child_->KeepStdin(false);
+      child_->AssignStdout(stdout_sink_);
+      child_->AssignStderr(stderr_sink_);
+      child_->AssignKicker(&ChildExited, this);
       child_->AssignUserId(child_uid);
       child_->AssignGroupId(child_gid);
       child_->AssignStdin(stdin_);
@@ -172,6 +198,8 @@ namespace DataStaging {
         cmd += " ";
       }
       logger_->msg(Arc::DEBUG, "Running command: %s", cmd);
+      // Handler must exist before child can report anything
+      GetHandler();
       if(!child_->Start()) {
         delete child_;
         child_=NULL;
@@ -201,47 +229,47 @@ namespace DataStaging {
   void DataDeliveryLocalComm::PullStatus(void) {
     Glib::Mutex::Lock lock(lock_);
     if(!child_) return;
-    for(;;) {
-      if(status_pos_ < sizeof(status_buf_)) {
-        int l;
-        // TODO: direct redirect
-        for(;;) {
-          char buf[1024+1];
-          l = child_->ReadStderr(0,buf,sizeof(buf)-1);
-          if(l <= 0) break;
-          buf[l] = 0;
-          char* start = buf;
-          for(;*start;) {
-            char* end = strchr(start,'\n');
-            if(end) *end = 0;
-            logger_->msg(Arc::INFO, "DataDelivery: %s", start);
-            if(!end) break;
-            start = end + 1;
-          }
-        }
-        l = child_->ReadStdout(0,((char*)&status_buf_)+status_pos_,sizeof(status_buf_)-status_pos_);
-        if(l == -1) { // child error or closed comm
-          if(child_->Running()) {
-            status_.commstatus = CommClosed;
-          } else {
-            status_.commstatus = CommExited;
-            if(child_->Result() != 0) {
-              logger_->msg(Arc::ERROR, "DataStagingDelivery exited with code %i", child_->Result());
-              status_.commstatus = CommFailed;
-            }
-          }
-          delete child_; child_=NULL; return;
+    // Child is reported as exited only after all its output was passed
+    // to sinks, so nothing is lost if exit is checked first.
+    bool exited = !child_->Running();
+    std::string log;
+    {
+      Glib::Mutex::Lock plock(pipe_lock_);
+      if(!stdout_buf_.empty()) {
+        // Only latest complete status record is of interest
+        std::string::size_type records = stdout_buf_.length() / sizeof(status_buf_);
+        if(records > 0) {
+          memcpy(&status_buf_, stdout_buf_.c_str() + (records-1)*sizeof(status_buf_), sizeof(status_buf_));
+          stdout_buf_.erase(0, records*sizeof(status_buf_));
+          status_buf_.error_desc[sizeof(status_buf_.error_desc)-1] = 0;
+          status_ = status_buf_;
+          // Partial record alone does not prove child is alive
+          last_comm = Arc::Time();
         }
-        if(l == 0) break;
-        status_pos_+=l;
-        last_comm = Arc::Time();
       }
-      if(status_pos_ >= sizeof(status_buf_)) {
-        status_buf_.error_desc[sizeof(status_buf_.error_desc)-1] = 0;
-        status_=status_buf_;
-        status_pos_-=sizeof(status_buf_);
+      // Log complete lines only, unless nothing more will come
+      std::string::size_type end = exited ? stderr_buf_.length() : stderr_buf_.rfind('\n');
+      if(end != std::string::npos) {
+        log = stderr_buf_.substr(0, end);
+        stderr_buf_.erase(0, end+1);
       }
     }
+    for(std::string::size_type start = 0; start < log.length();) {
+      std::string::size_type end = log.find('\n', start);
+      if(end == std::string::npos) end = log.length();
+      logger_->msg(Arc::INFO, "DataDelivery: %s", log.substr(start, end-start));
+      start = end + 1;
+    }
+    if(exited) {
+      status_.commstatus = CommExited;
+      if(child_->Result() != 0) {
+        logger_->msg(Arc::ERROR, "DataStagingDelivery exited with code %i", child_->Result());
+        status_.commstatus = CommFailed;
+      }
+      delete child_; child_=NULL;
+      SignalFinished();
+      return;
+    }
     // check for stuck child process (no report through comm channel)
     Arc::Period t = Arc::Time() - last_comm;
     if (transfer_params.max_inactivity_time > 0 && t >= transfer_params.max_inactivity_time*2) {
@@ -249,6 +277,7 @@ namespace DataStaging {
       child_->Kill(1);
       delete child_;
       child_ = NULL;
+      SignalFinished();
     }
   }
 
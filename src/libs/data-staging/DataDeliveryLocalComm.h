@@ -20,7 +20,7 @@ namespace DataStaging {
     /// This stops the child process
     virtual ~DataDeliveryLocalComm();
 
-    /// Read from stdout of child to get status
+    /// Process status and log messages received from child
     virtual void PullStatus();
 
     /// Returns identifier of delivery handler - localhost.
@@ -35,8 +35,40 @@ namespace DataStaging {
     virtual bool operator!() const { return (child_ == NULL); };
 
   private:
+    /// Collects data written by child to one of its pipes.
+    /**
+     * Pipes of all children are monitored by single thread which calls
+     * Append() as soon as data arrives. Sink stores data and asks handler to
+     * process it, so there is no need to poll pipes of every transfer.
+     */
+    class PipeSink: public Arc::Run::Data {
+     public:
+      /// Handler is kicked when at least kick_size bytes are collected.
+      /// If kick_size is 0 data is only processed by periodic checks.
+      PipeSink(DataDeliveryLocalComm& comm, std::string& buffer, std::string::size_type kick_size);
+      virtual void Append(char const* data, unsigned int size);
+      virtual void Remove(unsigned int size) {};
+      virtual char const* Get() const { return NULL; };
+      virtual unsigned int Size() const { return 0; };
+     private:
+      DataDeliveryLocalComm& comm_;
+      std::string& buffer_;
+      std::string::size_type kick_size_;
+    };
+
     /// Child process
     Arc::Run* child_;
+    /// Data received from stdout (status records) and stderr (log) of child
+    std::string stdout_buf_;
+    std::string stderr_buf_;
+    PipeSink stdout_sink_;
+    PipeSink stderr_sink_;
+    /// Protects received data. Separate from lock_ because sinks are
+    /// called while child monitoring thread is locked and lock_ is held
+    /// while child is destroyed, which needs that thread.
+    Glib::Mutex pipe_lock_;
+    /// Called when child exits
+    static void ChildExited(void* arg);
     /// Stdin of child, used to pass credentials
     std::string stdin_;
     /// Temporary credentails location
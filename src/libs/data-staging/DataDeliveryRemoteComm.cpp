@@ -2,6 +2,8 @@
 #include <config.h>
 #endif
 
+#include <map>
+
 #include <arc/message/SOAPEnvelope.h>
 #include <arc/delegation/DelegationInterface.h>
 
@@ -11,15 +13,140 @@ namespace DataStaging {
 
   Arc::Logger DataDeliveryRemoteComm::logger(Arc::Logger::getRootLogger(), "DataStaging.DataDeliveryRemoteComm");
 
+  // Maximal number of DTRs in one status query
+  static const unsigned int max_query_dtrs = 100;
+
+  // Connections to delivery services are shared by all transfers and kept
+  // open between requests, so that status queries do not need to establish
+  // new TCP connection and TLS session every time.
+  class DeliveryClientPool {
+   public:
+    DeliveryClientPool(): users_(0) {};
+    /// Register object which may use connections from pool.
+    void Attach();
+    /// Unregister object. When last one is gone all idle connections
+    /// are closed.
+    void Detach();
+    /// Get connection identified by key. Idle connection from pool is
+    /// returned if available, otherwise new one is created.
+    Arc::ClientSOAP* Acquire(const std::string& key, const Arc::MCCConfig& cfg,
+                             const Arc::URL& url, int timeout, bool& reused);
+    /// Return working connection to pool. Failed connections must be
+    /// deleted instead.
+    void Release(const std::string& key, Arc::ClientSOAP* client);
+    /// Close all idle connections identified by key. Used when reused
+    /// connection failed because others were probably closed by service
+    /// at same time.
+    void Discard(const std::string& key);
+   private:
+    // Idle connections are closed after this time (seconds) to avoid
+    // reusing connections closed by service and keeping old credentials.
+    static const time_t max_idle_time = 30;
+    static const unsigned int max_idle_per_key = 4;
+    struct Idle {
+      Arc::ClientSOAP* client;
+      time_t since;
+    };
+    Glib::Mutex lock_;
+    std::multimap<std::string, Idle> idle_;
+    unsigned int users_;
+  };
+
+  void DeliveryClientPool::Attach() {
+    Glib::Mutex::Lock lock(lock_);
+    ++users_;
+  }
+
+  void DeliveryClientPool::Detach() {
+    std::list<Arc::ClientSOAP*> unused;
+    {
+      Glib::Mutex::Lock lock(lock_);
+      if (users_ > 0) --users_;
+      if (users_ > 0) return;
+      for (std::multimap<std::string, Idle>::iterator i = idle_.begin(); i != idle_.end(); ++i) {
+        unused.push_back(i->second.client);
+      }
+      idle_.clear();
+    }
+    for (std::list<Arc::ClientSOAP*>::iterator c = unused.begin(); c != unused.end(); ++c) delete *c;
+  }
+
+  Arc::ClientSOAP* DeliveryClientPool::Acquire(const std::string& key, const Arc::MCCConfig& cfg,
+                                               const Arc::URL& url, int timeout, bool& reused) {
+    std::list<Arc::ClientSOAP*> expired;
+    Arc::ClientSOAP* client = NULL;
+    {
+      Glib::Mutex::Lock lock(lock_);
+      time_t now = ::time(NULL);
+      for (std::multimap<std::string, Idle>::iterator i = idle_.begin(); i != idle_.end();) {
+        if ((now - i->second.since) > max_idle_time) {
+          expired.push_back(i->second.client);
+          idle_.erase(i++);
+        } else {
+          ++i;
+        }
+      }
+      std::multimap<std::string, Idle>::iterator i = idle_.find(key);
+      if (i != idle_.end()) {
+        client = i->second.client;
+        idle_.erase(i);
+      }
+    }
+    for (std::list<Arc::ClientSOAP*>::iterator c = expired.begin(); c != expired.end(); ++c) delete *c;
+    reused = (client != NULL);
+    if (!client) client = new Arc::ClientSOAP(cfg, url, timeout);
+    return client;
+  }
+
+  void DeliveryClientPool::Release(const std::string& key, Arc::ClientSOAP* client) {
+    if (!client) return;
+    {
+      Glib::Mutex::Lock lock(lock_);
+      if ((users_ > 0) && (idle_.count(key) < max_idle_per_key)) {
+        Idle idle;
+        idle.client = client;
+        idle.since = ::time(NULL);
+        idle_.insert(std::pair<std::string, Idle>(key, idle));
+        return;
+      }
+    }
+    delete client;
+  }
+
+  void DeliveryClientPool::Discard(const std::string& key) {
+    std::list<Arc::ClientSOAP*> stale;
+    {
+      Glib::Mutex::Lock lock(lock_);
+      std::pair<std::multimap<std::string, Idle>::iterator,
+                std::multimap<std::string, Idle>::iterator> range = idle_.equal_range(key);
+      for (std::multimap<std::string, Idle>::iterator i = range.first; i != range.second; ++i) {
+        stale.push_back(i->second.client);
+      }
+      idle_.erase(range.first, range.second);
+    }
+    for (std::list<Arc::ClientSOAP*>::iterator c = stale.begin(); c != stale.end(); ++c) delete *c;
+  }
+
+  // Pool object itself is never destroyed because at exit underlying
+  // plugins may be already unloaded. Instead idle connections are closed
+  // when last transfer using them is gone.
+  static DeliveryClientPool client_pool;
+
+  static std::string CredentialsKey(const Arc::UserConfig& usercfg) {
+    return usercfg.ProxyPath() + "\n" + usercfg.CertificatePath() + "\n" +
+           usercfg.KeyPath() + "\n" + usercfg.CACertificatesDirectory() + "\n" +
+           usercfg.CredentialString();
+  }
+
   DataDeliveryRemoteComm::DataDeliveryRemoteComm(DTR_ptr dtr, const TransferParameters& params)
     : DataDeliveryComm(dtr, params),
-      client(NULL),
       dtr_full_id(dtr->get_id()),
       query_retries(20),
       endpoint(dtr->get_delivery_endpoint()),
       timeout(dtr->get_usercfg().Timeout()),
       valid(false) {
 
+    client_pool.Attach();
     {
       Glib::Mutex::Lock lock(lock_);
       // Initial empty status
@@ -59,15 +186,16 @@ namespace DataStaging {
       Arc::UserConfig host_cfg(cred_type);
       host_cfg.ProxyPath(""); // to force using cert/key files instead of non-existent proxy
       host_cfg.ApplyToConfig(cfg);
+      client_key = endpoint.str() + "\n" + CredentialsKey(host_cfg);
     } else {
       dtr->get_usercfg().ApplyToConfig(cfg);
+      client_key = endpoint.str() + "\n" + CredentialsKey(dtr->get_usercfg());
     }
 
     // connect to service and make a new transfer request
     logger_->msg(Arc::VERBOSE, "Connecting to Delivery service at %s", endpoint.str());
-    // TODO: implement pool of ClientSOAP objects instead of having one for each Comm
-    // object. That shall reduce number of TCP connections. 
-    client = new Arc::ClientSOAP(cfg, endpoint, timeout);
+    bool reused = false;
+    Arc::ClientSOAP* client = client_pool.Acquire(client_key, cfg, endpoint, timeout, reused);
 
     Arc::NS ns;
     Arc::PayloadSOAP request(ns);
@@ -92,8 +220,17 @@ namespace DataStaging {
 
     // delegate credentials
     Arc::XMLNode op = request.Child(0);
-    if (!SetupDelegation(op, dtr->get_usercfg())) {
+    bool delegated = SetupDelegation(op, dtr->get_usercfg(), *client);
+    if (!delegated && reused) {
+      // Connection kept in pool may have been closed by service meanwhile
+      delete client;
+      client_pool.Discard(client_key);
+      client = new Arc::ClientSOAP(cfg, endpoint, timeout);
+      delegated = SetupDelegation(op, dtr->get_usercfg(), *client);
+    }
+    if (!delegated) {
       logger_->msg(Arc::ERROR, "Failed to set up credential delegation with %s", endpoint.str());
+      delete client;
       return;
     }
 
@@ -109,13 +246,16 @@ namespace DataStaging {
                    endpoint.str(), (std::string)status);
       if (response)
         delete response;
+      delete client;
       return;
     }
 
     if (!response) {
       logger_->msg(Arc::ERROR, "No SOAP response from Delivery service %s", endpoint.str());
+      delete client;
       return;
     }
+    client_pool.Release(client_key, client);
 
     response->GetXML(xml, true);
     logger_->msg(Arc::DEBUG, "Response:\n%s", xml);
@@ -158,8 +298,7 @@ namespace DataStaging {
     // If transfer is still going, send cancellation request to service
     if (valid) CancelDTR();
     GetHandler().Remove(this);
-    Glib::Mutex::Lock lock(lock_);
-    delete client;
+    client_pool.Detach();
   }
 
   std::string DataDeliveryRemoteComm::DeliveryId() const {
@@ -168,7 +307,6 @@ namespace DataStaging {
 
   void DataDeliveryRemoteComm::CancelDTR() {
     Glib::Mutex::Lock lock(lock_);
-    if (!client) return;
     Arc::NS ns;
     Arc::PayloadSOAP request(ns);
     Arc::XMLNode dtrnode = request.NewChild("DataDeliveryCancel").NewChild("DTR");
@@ -181,7 +319,7 @@ namespace DataStaging {
 
     Arc::PayloadSOAP *response = NULL;
 
-    Arc::MCC_Status status = client->process(&request, &response);
+    Arc::MCC_Status status = ProcessRequest(request, &response);
 
     if (!status) {
       logger_->msg(Arc::ERROR, "Failed to send cancel request: %s", (std::string)status);
@@ -224,86 +362,170 @@ namespace DataStaging {
     delete response;
   }
 
-  void DataDeliveryRemoteComm::PullStatus() {
-    // send query request to service and fill status_
-    Glib::Mutex::Lock lock(lock_);
-    if (!client) return;
+  Arc::MCC_Status DataDeliveryRemoteComm::ProcessRequest(Arc::PayloadSOAP& request, Arc::PayloadSOAP** response) {
+    bool reused = false;
+    Arc::ClientSOAP* client = client_pool.Acquire(client_key, cfg, endpoint, timeout, reused);
+    Arc::MCC_Status status = client->process(&request, response);
+    if (reused && (!status || !*response)) {
+      // Connection kept in pool may have been closed by service meanwhile
+      if (*response) {
+        delete *response;
+        *response = NULL;
+      }
+      delete client;
+      client_pool.Discard(client_key);
+      client = new Arc::ClientSOAP(cfg, endpoint, timeout);
+      status = client->process(&request, response);
+    }
+    if (!status || !*response) {
+      delete client;
+    } else {
+      client_pool.Release(client_key, client);
+    }
+    return status;
+  }
 
+  bool DataDeliveryRemoteComm::QueryDue() const {
     // check time since last query - check every second for the first 20s and
     // after every 5s
     // TODO be more intelligent, using transfer rate and file size
-    if (Arc::Time() - start_ < 20 && Arc::Time() - Arc::Time(status_.timestamp) < 1) return;
-    if (Arc::Time() - start_ > 20 && Arc::Time() - Arc::Time(status_.timestamp) < 5) return;
-
-    Arc::NS ns;
-    Arc::PayloadSOAP request(ns);
-    Arc::XMLNode dtrnode = request.NewChild("DataDeliveryQuery").NewChild("DTR");
-
-    dtrnode.NewChild("ID") = dtr_full_id;
-
-    std::string xml;
-    request.GetXML(xml, true);
-    logger_->msg(Arc::DEBUG, "Request:\n%s", xml);
-
-    Arc::PayloadSOAP *response = NULL;
-
-    Arc::MCC_Status status = client->process(&request, &response);
+    if (Arc::Time() - start_ < 20 && Arc::Time() - Arc::Time(status_.timestamp) < 1) return false;
+    if (Arc::Time() - start_ > 20 && Arc::Time() - Arc::Time(status_.timestamp) < 5) return false;
+    return true;
+  }
 
-    if (!status) {
-      logger_->msg(Arc::ERROR, "%s", (std::string)status);
-      status_.commstatus = CommFailed;
-      if (response)
-        delete response;
-      valid = false;
-      return;
-    }
+  void DataDeliveryRemoteComm::PullStatus() {
+    std::list<DataDeliveryComm*> items(1, this);
+    BulkPullStatus(items);
+  }
 
-    if (!response) {
-      if (--query_retries > 0) {
-        HandleQueryFault("No SOAP response from delivery service");
-        return;
+  void DataDeliveryRemoteComm::BulkPullStatus(std::list<DataDeliveryComm*>& items) {
+    // Transfers using same credentials can be queried together
+    std::map<std::string, std::list<DataDeliveryRemoteComm*> > groups;
+    for (std::list<DataDeliveryComm*>::iterator i = items.begin(); i != items.end(); ++i) {
+      DataDeliveryRemoteComm* comm = dynamic_cast<DataDeliveryRemoteComm*>(*i);
+      if (!comm) continue;
+      Glib::Mutex::Lock lock(comm->lock_);
+      if (!comm->valid || !comm->QueryDue()) continue;
+      groups[comm->client_key].push_back(comm);
+    }
+    for (std::map<std::string, std::list<DataDeliveryRemoteComm*> >::iterator g = groups.begin();
+         g != groups.end(); ++g) {
+      std::list<DataDeliveryRemoteComm*> comms;
+      for (std::list<DataDeliveryRemoteComm*>::iterator c = g->second.begin(); c != g->second.end(); ++c) {
+        comms.push_back(*c);
+        if (comms.size() >= max_query_dtrs) {
+          QueryStatus(comms);
+          comms.clear();
+        }
       }
-      logger_->msg(Arc::ERROR, "No SOAP response from delivery service");
-      status_.commstatus = CommFailed;
-      valid = false;
-      return;
+      if (!comms.empty()) QueryStatus(comms);
     }
+  }
 
-    response->GetXML(xml, true);
-    logger_->msg(Arc::DEBUG, "Response:\n%s", xml);
-
-    if (response->IsFault()) {
-      Arc::SOAPFault& fault = *response->Fault();
-      std::string err("SOAP fault: %s", fault.Code());
+  bool DataDeliveryRemoteComm::ParseQueryResponse(Arc::PayloadSOAP& response,
+                                                  std::map<std::string, Arc::XMLNode>& results,
+                                                  std::string& err) {
+    if (response.IsFault()) {
+      Arc::SOAPFault& fault = *response.Fault();
+      err = "SOAP fault";
       for (int n = 0;;++n) {
         if (fault.Reason(n).empty()) break;
         err += ": " + fault.Reason(n);
       }
-      delete response;
-      if (--query_retries > 0) {
-        HandleQueryFault("Failed to query state: " + err);
-        return;
-      }
-      logger_->msg(Arc::ERROR, "Failed to query state: %s", err);
-      status_.commstatus = CommFailed;
-      strncpy(status_.error_desc, "SOAP error in connection with delivery service", sizeof(status_.error_desc));
-      valid = false;
-      return;
+      return false;
     }
-
-    Arc::XMLNode resultnode = (*response)["DataDeliveryQueryResponse"]["DataDeliveryQueryResult"]["Result"][0];
-    if (!resultnode || !resultnode["ResultCode"]) {
-      logger_->msg(Arc::ERROR, "Bad format in XML response: %s", xml);
-      delete response;
-      status_.commstatus = CommFailed;
-      valid = false;
-      return;
+    for (Arc::XMLNode resultnode = response["DataDeliveryQueryResponse"]["DataDeliveryQueryResult"]["Result"];
+         resultnode; ++resultnode) {
+      std::string id = (std::string)resultnode["ID"];
+      if (!id.empty()) results[id] = resultnode;
     }
+    return true;
+  }
 
-    // Fill status fields with results from service
-    FillStatus(resultnode[0]);
+  void DataDeliveryRemoteComm::QueryStatus(std::list<DataDeliveryRemoteComm*>& comms) {
+    // Services of older versions stop reporting at first transfer which is
+    // still in progress. Transfers left without result are queried again
+    // until service stops returning anything new.
+    std::list<DataDeliveryRemoteComm*> pending(comms);
+    while (!pending.empty()) {
+      Arc::NS ns;
+      Arc::PayloadSOAP request(ns);
+      Arc::XMLNode query = request.NewChild("DataDeliveryQuery");
+      for (std::list<DataDeliveryRemoteComm*>::iterator c = pending.begin(); c != pending.end(); ++c) {
+        query.NewChild("DTR").NewChild("ID") = (*c)->dtr_full_id;
+      }
 
-    delete response;
+      std::string xml;
+      request.GetXML(xml, true);
+      logger.msg(Arc::DEBUG, "Request:\n%s", xml);
+
+      // All transfers share service and credentials so any of them
+      // can be used to send request.
+      Arc::PayloadSOAP *response = NULL;
+      Arc::MCC_Status status = pending.front()->ProcessRequest(request, &response);
+
+      std::string err;
+      std::map<std::string, Arc::XMLNode> results;
+      if (!status) {
+        err = (std::string)status;
+      } else if (!response) {
+        err = "No SOAP response from delivery service";
+      } else {
+        response->GetXML(xml, true);
+        logger.msg(Arc::DEBUG, "Response:\n%s", xml);
+        ParseQueryResponse(*response, results, err);
+      }
+
+      // Requesting again makes sense only if service reported anything
+      bool progress = false;
+      for (std::list<DataDeliveryRemoteComm*>::iterator c = pending.begin(); c != pending.end(); ++c) {
+        if (results.find((*c)->dtr_full_id) != results.end()) {
+          progress = true;
+          break;
+        }
+      }
+
+      std::list<DataDeliveryRemoteComm*> unanswered;
+      for (std::list<DataDeliveryRemoteComm*>::iterator c = pending.begin(); c != pending.end(); ++c) {
+        DataDeliveryRemoteComm& comm = **c;
+        Glib::Mutex::Lock lock(comm.lock_);
+
+        if (!err.empty()) {
+          // Communication problem affects every transfer in request but
+          // each of them is failed only after running out of own retries.
+          if (--comm.query_retries > 0) {
+            comm.HandleQueryFault("Failed to query state: " + err);
+            continue;
+          }
+          comm.logger_->msg(Arc::ERROR, "Failed to query state: %s", err);
+          comm.status_.commstatus = CommFailed;
+          strncpy(comm.status_.error_desc, "Failed to query state of transfer at delivery service", sizeof(comm.status_.error_desc));
+          comm.valid = false;
+          comm.SignalFinished();
+          continue;
+        }
+
+        std::map<std::string, Arc::XMLNode>::iterator result = results.find(comm.dtr_full_id);
+        if (result == results.end() && progress) {
+          unanswered.push_back(&comm);
+          continue;
+        }
+        if (result == results.end() || !result->second["ResultCode"]) {
+          comm.logger_->msg(Arc::ERROR, "Bad format in XML response: %s", xml);
+          comm.status_.commstatus = CommFailed;
+          comm.valid = false;
+          comm.SignalFinished();
+          continue;
+        }
+
+        // Fill status fields with results from service
+        comm.FillStatus(result->second);
+      }
+
+      delete response;
+      pending.swap(unanswered);
+    }
   }
 
   bool DataDeliveryRemoteComm::CheckComm(DTR_ptr dtr, std::vector<std::string>& allowed_dirs, std::string& load_avg) {
@@ -479,11 +701,12 @@ namespace DataStaging {
         logger_->msg(Arc::INFO, "DataDelivery log tail:\n%s", log);
       }
       valid = false;
+      SignalFinished();
     }
   }
 
 
-  bool DataDeliveryRemoteComm::SetupDelegation(Arc::XMLNode& op, const Arc::UserConfig& usercfg) {
+  bool DataDeliveryRemoteComm::SetupDelegation(Arc::XMLNode& op, const Arc::UserConfig& usercfg, Arc::ClientSOAP& client) {
     const std::string& cert = (!usercfg.ProxyPath().empty() ? usercfg.ProxyPath() : usercfg.CertificatePath());
     const std::string& key  = (!usercfg.ProxyPath().empty() ? usercfg.ProxyPath() : usercfg.KeyPath());
     const std::string& credentials = usercfg.CredentialString();
@@ -493,12 +716,12 @@ namespace DataStaging {
       return false;
     }
 
-    if(!client->Load()) {
+    if(!client.Load()) {
       logger_->msg(Arc::VERBOSE, "Failed to initiate client connection");
       return false;
     }
 
-    Arc::MCC* entry = client->GetEntry();
+    Arc::MCC* entry = client.GetEntry();
     if(!entry) {
       logger_->msg(Arc::VERBOSE, "Client connection has no entry point");
       return false;
@@ -509,7 +732,7 @@ namespace DataStaging {
     if (!credentials.empty()) deleg = new Arc::DelegationProviderSOAP(credentials);
     else deleg = new Arc::DelegationProviderSOAP(cert, key);
     logger_->msg(Arc::VERBOSE, "Initiating delegation procedure");
-    if (!deleg->DelegateCredentialsInit(*entry, &(client->GetContext()))) {
+    if (!deleg->DelegateCredentialsInit(*entry, &(client.GetContext()))) {
       logger_->msg(Arc::VERBOSE, "Failed to initiate delegation credentials");
       delete deleg;
       return false;
@@ -523,9 +746,6 @@ namespace DataStaging {
     // Just return without changing status
     logger_->msg(Arc::WARNING, err);
     status_.timestamp = time(NULL);
-    // A reconnect may be needed after losing connection
-    delete client;
-    client = new Arc::ClientSOAP(cfg, endpoint, timeout);
   }
 
 } // namespace DataStaging
@@ -1,6 +1,8 @@
 #ifndef DATADELIVERYREMOTECOMM_H_
 #define DATADELIVERYREMOTECOMM_H_
 
+#include <map>
+
 #include <arc/XMLNode.h>
 #include <arc/communication/ClientInterface.h>
 #include <arc/message/MCC.h>
@@ -24,9 +26,27 @@ namespace DataStaging {
     /// Read status from service
     virtual void PullStatus();
 
+    /// Read status of many transfers from service.
+    /**
+     * Transfers which are due for a status check are grouped by the
+     * credentials used to contact the service and the state of every group
+     * is obtained with a single query.
+     */
+    virtual void BulkPullStatus(std::list<DataDeliveryComm*>& items);
+
     /// Returns identifier of delivery handler - URL of delivery service.
     virtual std::string DeliveryId() const;
 
+    /// Split response to status query into results of separate transfers.
+    /**
+     * Results are indexed by DTR ID. Transfers which service did not report
+     * are not present in results. Returns false and fills err if response
+     * is a fault.
+     */
+    static bool ParseQueryResponse(Arc::PayloadSOAP& response,
+                                   std::map<std::string, Arc::XMLNode>& results,
+                                   std::string& err);
+
     /// Pings service to find allowed dirs
     static bool CheckComm(DTR_ptr dtr, std::vector<std::string>& allowed_dirs, std::string& load_avg);
 
@@ -36,8 +56,9 @@ namespace DataStaging {
     virtual bool operator!() const { return !valid; };
 
   private:
-    /// Connection to service
-    Arc::ClientSOAP* client;
+    /// Identifies connections in pool which may be used for this transfer.
+    /// Made of service URL and credentials used to contact service.
+    std::string client_key;
     /// Full DTR ID
     std::string dtr_full_id;
     /// Retries allowed after failing to query transfer status, so that a
@@ -59,12 +80,25 @@ namespace DataStaging {
     /// Cancel a DTR, by sending a cancel request to the service
     void CancelDTR();
 
+    /// Returns true if enough time passed since status was last obtained
+    bool QueryDue() const;
+
+    /// Obtain status of transfers with single request to service. All
+    /// transfers must have same client_key. Transfers not reported by
+    /// service are queried again with separate request.
+    static void QueryStatus(std::list<DataDeliveryRemoteComm*>& comms);
+
+    /// Send request to service using connection from pool. If reused
+    /// connection fails other idle connections to same service are dropped
+    /// and request is repeated over new connection.
+    Arc::MCC_Status ProcessRequest(Arc::PayloadSOAP& request, Arc::PayloadSOAP** response);
+
     /// Fill Status object with data in node. If empty fields are initialised
     /// to default values.
     void FillStatus(const Arc::XMLNode& node = Arc::XMLNode());
 
     /// Set up delegation so the credentials can be used by the service
-    bool SetupDelegation(Arc::XMLNode& op, const Arc::UserConfig& usercfg);
+    bool SetupDelegation(Arc::XMLNode& op, const Arc::UserConfig& usercfg, Arc::ClientSOAP& client);
 
     /// Handle a fault during query of service. Attempts to reconnect
     void HandleQueryFault(const std::string& err="");
@@ -28,7 +28,7 @@ namespace DataStaging {
     return scheduler_instance;
   }
 
-  Scheduler::Scheduler(): remote_size_limit(0), scheduler_state(INITIATED) {
+  Scheduler::Scheduler(): journal(NULL), remote_size_limit(0), scheduler_state(INITIATED) {
     // Conservative defaults
     PreProcessorSlots = 20;
     DeliverySlots = 10;
@@ -84,6 +84,21 @@ namespace DataStaging {
 
   void Scheduler::SetDumpLocation(const std::string& location) {
     dumplocation = location;
+    // Priorities of DTRs left by previous process, so that regenerated
+    // DTRs do not lose priority gained while waiting
+    recovered_priorities.clear();
+    std::map<std::string, DTRJournal::Record> records;
+    if (dumplocation.empty() || !DTRJournal::Read(dumplocation + ".journal", records)) return;
+    for (std::map<std::string, DTRJournal::Record>::iterator rec = records.begin();
+         rec != records.end(); ++rec) {
+      std::pair<std::string, std::string> key(rec->second.job_id, rec->second.share);
+      std::map<std::pair<std::string, std::string>, int>::iterator prio = recovered_priorities.find(key);
+      if (prio == recovered_priorities.end()) {
+        recovered_priorities[key] = rec->second.priority;
+      } else if (prio->second < rec->second.priority) {
+        prio->second = rec->second.priority;
+      }
+    }
   }
 
   void Scheduler::SetJobPerfLog(const Arc::JobPerfLog& perf_log) {
@@ -1324,6 +1339,14 @@ namespace DataStaging {
     // Compute the priority this DTR receives - this is the priority of the
     // share adjusted by the priority of the parent job
     request->set_priority(int(transferSharesConf.get_basic_priority(DtrTransferShare) * request->get_priority() * 0.01));
+    // DTR regenerated after restart continues with priority it had before
+    std::map<std::pair<std::string, std::string>, int>::const_iterator recovered =
+      recovered_priorities.find(std::make_pair(request->get_parent_job_id(), DtrTransferShare));
+    if (recovered != recovered_priorities.end() && recovered->second > request->get_priority()) {
+      request->get_logger()->msg(Arc::VERBOSE, "DTR %s: Restoring priority %i from previous run",
+                                 request->get_short_id(), recovered->second);
+      request->set_priority(recovered->second);
+    }
     /* Shares part ends*/               
 
     DtrList.add_dtr(request);
@@ -1339,9 +1362,14 @@ namespace DataStaging {
 
   void Scheduler::dump_thread(void* arg) {
     Scheduler* sched = (Scheduler*)arg;
+    // seconds between full dumps of state
+    const unsigned int dump_interval = 10;
+    unsigned int count = 0;
     while (sched->scheduler_state == RUNNING && !sched->dumplocation.empty()) {
-      // every second, dump state
-      sched->DtrList.dumpState(sched->dumplocation);
+      // every second, record changes in journal. Writing the full state
+      // costs time proportional to number of DTRs, so it is done less often.
+      if (sched->journal) sched->DtrList.journalState(*(sched->journal));
+      if (count++ % dump_interval == 0) sched->DtrList.dumpState(sched->dumplocation);
       // Performance metric - total number of DTRs in the system
       timespec dummy;
       sched->job_perf_log.Log("DTR_total", Arc::tostring(sched->DtrList.size()), dummy, dummy);
@@ -1394,6 +1422,7 @@ namespace DataStaging {
     }
 
     // Start thread dumping DTR state
+    if (!journal && !dumplocation.empty()) journal = new DTRJournal(dumplocation + ".journal");
     if (!Arc::CreateThreadFunction(&dump_thread, this))
       logger.msg(Arc::ERROR, "Failed to create DTR dump thread");
 
@@ -1428,6 +1457,7 @@ namespace DataStaging {
     // make sure final state is dumped before exit
     dump_signal.signal();
     if (!dumplocation.empty()) DtrList.dumpState(dumplocation);
+    if (journal) DtrList.journalState(*journal);
 
     log_to_root_logger(Arc::INFO, "Scheduler loop exited");
     run_signal.signal();
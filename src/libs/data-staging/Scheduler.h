@@ -81,6 +81,13 @@ class Scheduler: public DTRCallback {
     /// Where to dump DTR state. Currently only a path to a file is supported.
     std::string dumplocation;
 
+    /// Journal of DTR state changes, kept next to dumplocation
+    DTRJournal* journal;
+
+    /// Highest priority of DTRs of each job and share found in journal of
+    /// previous process. Filled by SetDumpLocation and only read afterwards.
+    std::map<std::pair<std::string, std::string>, int> recovered_priorities;
+
     /// Performance metrics logger
     Arc::JobPerfLog job_perf_log;
 
@@ -232,7 +239,7 @@ class Scheduler: public DTRCallback {
     Scheduler();
 
     /// Destructor calls stop(), which cancels all DTRs and waits for them to complete
-    ~Scheduler() { stop(); };
+    ~Scheduler() { stop(); delete journal; };
 
     /* The following Set/Add methods are only effective when called before start() */
 
@@ -271,6 +278,15 @@ class Scheduler: public DTRCallback {
     void SetRemoteSizeLimit(unsigned long long int limit);
 
     /// Set location for periodic dump of DTR state (only file paths currently supported)
+    /**
+     * The full human-readable dump at location is written every 10 seconds
+     * and when the Scheduler stops. Changes of DTR state are recorded every
+     * second in location + ".journal", which can be read with
+     * DTRJournal::Read() to find transfers interrupted by an unclean
+     * shutdown. Journal left by previous process is read here and new DTRs
+     * of the same job and share get back the priority they had before.
+     * Must be called before start().
+     */
     void SetDumpLocation(const std::string& location);
 
     /// Set JobPerfLog object for performance metrics logging
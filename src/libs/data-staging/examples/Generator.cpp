@@ -5,7 +5,7 @@
 Arc::Logger Generator::logger(Arc::Logger::getRootLogger(), "Generator");
 Arc::SimpleCondition Generator::cond;
 
-Generator::Generator() {
+Generator::Generator(): finished(0), total_time(0), max_time(0) {
   // Set up logging
   root_destinations = Arc::Logger::getRootLogger().getDestinations();
   DataStaging::DTR::LOG_LEVEL = Arc::Logger::getRootLogger().getThreshold();
@@ -22,6 +22,18 @@ void Generator::receiveDTR(DataStaging::DTR_ptr dtr) {
   Arc::Logger::getRootLogger().addDestinations(root_destinations);
   logger.msg(Arc::INFO, "Received DTR %s back from scheduler in state %s", dtr->get_id(), dtr->get_status().str());
   Arc::Logger::getRootLogger().removeDestinations();
+  {
+    Glib::Mutex::Lock lock(stats_lock);
+    std::map<std::string, Arc::Time>::iterator start = start_times.find(dtr->get_id());
+    if (start != start_times.end()) {
+      Arc::Period t = Arc::Time() - start->second;
+      unsigned long long int ms = t.GetPeriod()*1000ULL + t.GetPeriodNanoseconds()/1000000;
+      total_time += ms;
+      if (ms > max_time) max_time = ms;
+      ++finished;
+      start_times.erase(start);
+    }
+  }
   counter.dec();
 }
 
@@ -59,6 +71,17 @@ void Generator::run(const std::string& source, const std::string& destination) {
   dtr->registerCallback(this,DataStaging::GENERATOR);
   dtr->registerCallback(&scheduler,DataStaging::SCHEDULER);
   dtr->set_tries_left(5);
-  DataStaging::DTR::push(dtr, DataStaging::SCHEDULER);
+  {
+    Glib::Mutex::Lock lock(stats_lock);
+    start_times[dtr->get_id()] = Arc::Time();
+  }
   counter.inc();
+  DataStaging::DTR::push(dtr, DataStaging::SCHEDULER);
+}
+
+void Generator::report() {
+  Glib::Mutex::Lock lock(stats_lock);
+  if (finished == 0) return;
+  std::cout << finished << " DTRs processed, time per DTR: average "
+            << total_time/finished << " ms, maximum " << max_time << " ms" << std::endl;
 }
@@ -1,6 +1,9 @@
 #ifndef GENERATOR_H_
 #define GENERATOR_H_
 
+#include <map>
+
+#include <arc/DateTime.h>
 #include <arc/Thread.h>
 #include <arc/Logger.h>
 
@@ -25,6 +28,14 @@ class Generator: public DataStaging::DTRCallback {
   // Root LogDestinations to be used in receiveDTR
   std::list<Arc::LogDestination*> root_destinations;
 
+  // Submission time of every DTR and statistics of time (in ms) which
+  // finished DTRs spent in the system
+  std::map<std::string, Arc::Time> start_times;
+  unsigned int finished;
+  unsigned long long int total_time;
+  unsigned long long int max_time;
+  Glib::Mutex stats_lock;
+
  public:
 
   // Counter for main to know how many DTRs are in the system
@@ -45,6 +56,9 @@ class Generator: public DataStaging::DTRCallback {
 
   // Submit a DTR with given source and destination. Increments counter.
   void run(const std::string& source, const std::string& destination);
+
+  // Print average and maximal time taken to process DTRs
+  void report();
 };
 
 #endif /* GENERATOR_H_ */
@@ -67,5 +67,6 @@ int main(int argc, char** argv) {
   while (generator.counter.get() > 0 && run) {
     sleep(1);
   }
+  generator.report();
   return 0;
 }
@@ -0,0 +1,123 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <arc/FileUtils.h>
+
+#include "../DTRJournal.h"
+
+using namespace DataStaging;
+
+class DTRJournalTest
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(DTRJournalTest);
+  CPPUNIT_TEST(TestRecord);
+  CPPUNIT_TEST(TestUpdate);
+  CPPUNIT_TEST(TestIncompleteLine);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void TestRecord();
+  void TestUpdate();
+  void TestIncompleteLine();
+
+  void setUp();
+  void tearDown();
+
+private:
+  std::string tmpdir;
+  DTRJournal::Record MakeRecord(const std::string& id, const std::string& status);
+};
+
+void DTRJournalTest::setUp() {
+  CPPUNIT_ASSERT(Arc::TmpDirCreate(tmpdir));
+}
+
+void DTRJournalTest::tearDown() {
+  Arc::DirDelete(tmpdir, true);
+}
+
+DTRJournal::Record DTRJournalTest::MakeRecord(const std::string& id, const std::string& status) {
+  DTRJournal::Record rec;
+  rec.id = id;
+  rec.job_id = "job" + id;
+  rec.status = status;
+  rec.priority = 50;
+  rec.share = "_default";
+  return rec;
+}
+
+void DTRJournalTest::TestRecord() {
+  DTRJournal::Record rec(MakeRecord("1", "TRANSFERRING"));
+  rec.share = "share with spaces\\";
+  rec.bytes = 12345678901ULL;
+  rec.destination = "file:/session/dir/file 1";
+  rec.delivery_host = "";
+
+  DTRJournal::Record parsed;
+  CPPUNIT_ASSERT(parsed.parse(rec.str()));
+  CPPUNIT_ASSERT(parsed == rec);
+  CPPUNIT_ASSERT(!parsed.parse("1 job1 TRANSFERRING 50"));
+}
+
+void DTRJournalTest::TestUpdate() {
+  std::string path(tmpdir + "/dtr.state.journal");
+  // Leftover from previous process must be replaced on first update
+  CPPUNIT_ASSERT(Arc::FileCreate(path, "+ 0 job0 TRANSFERRING 50 _default 0 file:/old host\n"));
+
+  std::map<std::string, DTRJournal::Record> records;
+  records["1"] = MakeRecord("1", "NEW");
+  records["2"] = MakeRecord("2", "NEW");
+  DTRJournal journal(path);
+  CPPUNIT_ASSERT(journal.Update(records));
+
+  std::map<std::string, DTRJournal::Record> read;
+  CPPUNIT_ASSERT(DTRJournal::Read(path, read));
+  CPPUNIT_ASSERT_EQUAL(2, (int)read.size());
+  CPPUNIT_ASSERT(read["1"] == records["1"]);
+
+  // Change one, remove one, add one
+  records["1"].status = "TRANSFERRING";
+  records["1"].bytes = 1024;
+  records["1"].destination = "file:/session/dir/file";
+  records.erase("2");
+  records["3"] = MakeRecord("3", "NEW");
+  CPPUNIT_ASSERT(journal.Update(records));
+  // Nothing changed - nothing written
+  std::string content;
+  CPPUNIT_ASSERT(Arc::FileRead(path, content));
+  CPPUNIT_ASSERT(journal.Update(records));
+  std::string content2;
+  CPPUNIT_ASSERT(Arc::FileRead(path, content2));
+  CPPUNIT_ASSERT_EQUAL(content, content2);
+
+  read.clear();
+  CPPUNIT_ASSERT(DTRJournal::Read(path, read));
+  CPPUNIT_ASSERT_EQUAL(2, (int)read.size());
+  CPPUNIT_ASSERT(read.find("2") == read.end());
+  CPPUNIT_ASSERT(read["1"] == records["1"]);
+  CPPUNIT_ASSERT(read["3"] == records["3"]);
+
+  // Clean finish leaves empty journal
+  records.clear();
+  CPPUNIT_ASSERT(journal.Update(records));
+  read.clear();
+  CPPUNIT_ASSERT(DTRJournal::Read(path, read));
+  CPPUNIT_ASSERT(read.empty());
+}
+
+void DTRJournalTest::TestIncompleteLine() {
+  std::string path(tmpdir + "/dtr.state.journal");
+  DTRJournal::Record rec(MakeRecord("1", "TRANSFERRING"));
+  std::string line("+ " + rec.str() + "\n");
+  CPPUNIT_ASSERT(Arc::FileCreate(path, line + "- 1\n+ 2 job2 TRANS"));
+
+  std::map<std::string, DTRJournal::Record> read;
+  CPPUNIT_ASSERT(DTRJournal::Read(path, read));
+  CPPUNIT_ASSERT(read.empty());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DTRJournalTest);
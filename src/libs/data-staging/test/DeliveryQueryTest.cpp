@@ -0,0 +1,107 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <arc/message/PayloadSOAP.h>
+
+#include "../DataDeliveryRemoteComm.h"
+
+using namespace DataStaging;
+
+class DeliveryQueryTest
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(DeliveryQueryTest);
+  CPPUNIT_TEST(TestAllResults);
+  CPPUNIT_TEST(TestPartialResults);
+  CPPUNIT_TEST(TestFault);
+  CPPUNIT_TEST(TestNoResults);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void TestAllResults();
+  void TestPartialResults();
+  void TestFault();
+  void TestNoResults();
+
+private:
+  Arc::XMLNode AddResult(Arc::XMLNode results, const std::string& id, const std::string& code);
+};
+
+Arc::XMLNode DeliveryQueryTest::AddResult(Arc::XMLNode results, const std::string& id, const std::string& code) {
+  Arc::XMLNode result = results.NewChild("Result");
+  result.NewChild("ID") = id;
+  if (!code.empty()) result.NewChild("ResultCode") = code;
+  return result;
+}
+
+void DeliveryQueryTest::TestAllResults() {
+  Arc::NS ns;
+  Arc::PayloadSOAP response(ns);
+  Arc::XMLNode results = response.NewChild("DataDeliveryQueryResponse").NewChild("DataDeliveryQueryResult");
+  AddResult(results, "1", "TRANSFERRED").NewChild("CheckSum") = "adler32:12345678";
+  AddResult(results, "2", "TRANSFERRING");
+  AddResult(results, "3", "TRANSFER_ERROR");
+  AddResult(results, "4", "");
+
+  std::map<std::string, Arc::XMLNode> parsed;
+  std::string err;
+  CPPUNIT_ASSERT(DataDeliveryRemoteComm::ParseQueryResponse(response, parsed, err));
+  CPPUNIT_ASSERT(err.empty());
+  CPPUNIT_ASSERT_EQUAL(4, (int)parsed.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("TRANSFERRED"), (std::string)parsed["1"]["ResultCode"]);
+  CPPUNIT_ASSERT_EQUAL(std::string("adler32:12345678"), (std::string)parsed["1"]["CheckSum"]);
+  CPPUNIT_ASSERT_EQUAL(std::string("TRANSFERRING"), (std::string)parsed["2"]["ResultCode"]);
+  CPPUNIT_ASSERT_EQUAL(std::string("TRANSFER_ERROR"), (std::string)parsed["3"]["ResultCode"]);
+  // Result without code is reported so that caller can treat it as bad format
+  CPPUNIT_ASSERT(parsed["4"]);
+  CPPUNIT_ASSERT(!parsed["4"]["ResultCode"]);
+}
+
+void DeliveryQueryTest::TestPartialResults() {
+  // Older services stop at first transfer still in progress
+  Arc::NS ns;
+  Arc::PayloadSOAP response(ns);
+  Arc::XMLNode results = response.NewChild("DataDeliveryQueryResponse").NewChild("DataDeliveryQueryResult");
+  AddResult(results, "1", "TRANSFERRED");
+  AddResult(results, "2", "TRANSFERRING");
+
+  std::map<std::string, Arc::XMLNode> parsed;
+  std::string err;
+  CPPUNIT_ASSERT(DataDeliveryRemoteComm::ParseQueryResponse(response, parsed, err));
+  CPPUNIT_ASSERT_EQUAL(2, (int)parsed.size());
+  CPPUNIT_ASSERT(parsed.find("1") != parsed.end());
+  CPPUNIT_ASSERT(parsed.find("2") != parsed.end());
+  CPPUNIT_ASSERT(parsed.find("3") == parsed.end());
+}
+
+void DeliveryQueryTest::TestFault() {
+  Arc::NS ns;
+  Arc::PayloadSOAP response(ns, true);
+  response.Fault()->Code(Arc::SOAPFault::Receiver);
+  response.Fault()->Reason("Service is overloaded");
+
+  std::map<std::string, Arc::XMLNode> parsed;
+  std::string err;
+  CPPUNIT_ASSERT(!DataDeliveryRemoteComm::ParseQueryResponse(response, parsed, err));
+  CPPUNIT_ASSERT(parsed.empty());
+  CPPUNIT_ASSERT_EQUAL(std::string("SOAP fault: Service is overloaded"), err);
+}
+
+void DeliveryQueryTest::TestNoResults() {
+  Arc::NS ns;
+  Arc::PayloadSOAP response(ns);
+  Arc::XMLNode results = response.NewChild("DataDeliveryQueryResponse").NewChild("DataDeliveryQueryResult");
+  // Result without ID can't be matched to any transfer
+  results.NewChild("Result").NewChild("ResultCode") = "TRANSFERRED";
+
+  std::map<std::string, Arc::XMLNode> parsed;
+  std::string err;
+  CPPUNIT_ASSERT(DataDeliveryRemoteComm::ParseQueryResponse(response, parsed, err));
+  CPPUNIT_ASSERT(parsed.empty());
+  CPPUNIT_ASSERT(err.empty());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DeliveryQueryTest);
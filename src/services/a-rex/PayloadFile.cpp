@@ -229,8 +229,11 @@ Arc::MessagePayload* newFileRead(const char* filename,Arc::PayloadRawInterface::
 }
 
 Arc::MessagePayload* newFileRead(int h,Arc::PayloadRawInterface::Size_t start,Arc::PayloadRawInterface::Size_t end) {
+  // Handle is owned by created object. On failure it is closed either
+  // here or by object being destroyed - never by caller.
+  if(h == -1) return NULL;
   struct stat st;
-  if(fstat(h,&st) != 0) return NULL;
+  if(fstat(h,&st) != 0) { ::close(h); return NULL; };
   if(st.st_size > PayloadBigFile::Threshold()) {
     PayloadBigFile* f = new PayloadBigFile(h,start,end);
     if(!*f) { delete f; return NULL; };
@@ -246,5 +249,44 @@ Arc::MessagePayload* newFileRead(Arc::FileAccess* h,Arc::PayloadRawInterface::Si
   return f;
 }
 
+int reopen_file_read(const std::string& path,const struct stat& fst) {
+  if(path.empty() || !S_ISREG(fst.st_mode)) return -1;
+  // Path is controlled by user and may be replaced at any time. Opening
+  // FIFO without O_NONBLOCK would wait for writer forever.
+  int h = ::open(path.c_str(),O_RDONLY | O_NOFOLLOW | O_NONBLOCK);
+  if(h == -1) return -1;
+  struct stat st;
+  if((::fstat(h,&st) != 0) || !S_ISREG(st.st_mode) ||
+     (st.st_dev != fst.st_dev) || (st.st_ino != fst.st_ino)) {
+    ::close(h);
+    return -1;
+  };
+  int flags = ::fcntl(h,F_GETFL);
+  if((flags == -1) || (::fcntl(h,F_SETFL,flags & ~O_NONBLOCK) == -1)) {
+    ::close(h);
+    return -1;
+  };
+  return h;
+}
+
+Arc::MessagePayload* newFileRead(Arc::FileAccess* h,const std::string& path,Arc::PayloadRawInterface::Size_t start,Arc::PayloadRawInterface::Size_t end) {
+  struct stat fst;
+  if(h && h->fa_fstat(fst)) {
+    // File was opened with permissions of user. Opening it again is
+    // safe as long as it is still same file.
+    int fh = reopen_file_read(path,fst);
+    if(fh != -1) {
+      // fh is taken over by newFileRead() even if it fails
+      Arc::MessagePayload* f = newFileRead(fh,start,end);
+      if(f) {
+        h->fa_close();
+        Arc::FileAccess::Release(h);
+        return f;
+      };
+    };
+  };
+  return newFileRead(h,start,end);
+}
+
 } // namespace ARex
 
@@ -1,6 +1,8 @@
 #ifndef __ARC_PAYLOADFILE_H__
 #define __ARC_PAYLOADFILE_H__
 
+#include <sys/stat.h>
+
 #include <vector>
 
 #include <arc/FileAccess.h>
@@ -43,7 +45,10 @@ class PayloadFile: public Arc::PayloadRawInterface {
   bool operator!(void) { return (handle_ == -1); };
 };
 
-class PayloadBigFile: public Arc::PayloadStream {
+/** Implementation of PayloadStreamInterface for big files.
+  Handle of file is made available to streams which can transfer
+  content directly, e.g. by sendfile(). */
+class PayloadBigFile: public Arc::PayloadStream, public Arc::PayloadFileStreamInterface {
  private:
   static Size_t threshold_;
   off_t limit_; 
@@ -59,6 +64,7 @@ class PayloadBigFile: public Arc::PayloadStream {
   virtual Size_t Size(void) const;
   virtual Size_t Limit(void) const;
   virtual bool Get(char* buf,int& size);
+  virtual int FileHandle(void) const { return handle_; };
 
   operator bool(void) { return (handle_ != -1); };
   bool operator!(void) { return (handle_ == -1); };
@@ -97,8 +103,17 @@ class PayloadFAFile: public Arc::PayloadStreamInterface {
 
 // For ranges start is inclusive and end is exclusive
 Arc::MessagePayload* newFileRead(const char* filename,Arc::PayloadRawInterface::Size_t start = 0,Arc::PayloadRawInterface::Size_t end = (Arc::PayloadRawInterface::Size_t)(-1));
+// Handle h is always taken over. If NULL is returned it is already closed.
 Arc::MessagePayload* newFileRead(int h,Arc::PayloadRawInterface::Size_t start = 0,Arc::PayloadRawInterface::Size_t end = (Arc::PayloadRawInterface::Size_t)(-1));
 Arc::MessagePayload* newFileRead(Arc::FileAccess* h,Arc::PayloadRawInterface::Size_t start = 0,Arc::PayloadRawInterface::Size_t end = (Arc::PayloadRawInterface::Size_t)(-1));
+// Opens file at path directly if it is still regular file identified by fst
+// (obtained through file access helper). Opening never blocks, so path
+// replaced by FIFO or device can't stall the service. Returns -1 on failure.
+int reopen_file_read(const std::string& path,const struct stat& fst);
+// File already opened through h at path is re-opened directly if that gives
+// exactly same file. Then content does not pass through file access helper
+// and may be sent without copying. Otherwise h is used.
+Arc::MessagePayload* newFileRead(Arc::FileAccess* h,const std::string& path,Arc::PayloadRawInterface::Size_t start = 0,Arc::PayloadRawInterface::Size_t end = (Arc::PayloadRawInterface::Size_t)(-1));
 
 } // namespace ARex
 
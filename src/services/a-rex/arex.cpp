@@ -1080,7 +1080,7 @@ Arc::NS ARexService::ns_ = ArexServiceNamespaces();
 ARexService::ARexService(Arc::Config *cfg,Arc::PluginArgument *parg):Arc::Service(cfg,parg),
               logger_(Arc::Logger::rootLogger, "A-REX"),
               delegation_stores_(),
-              infodoc_(true),
+              infodoc_(false),
               infoprovider_wakeup_period_(0),
               all_jobs_count_(0),
               gm_(NULL),
@@ -1207,6 +1207,7 @@ ARexService::~ARexService(void) {
   if(config_.ConfigIsTemp()) unlink(config_.ConfigFile().c_str());
   delete config_.GetContPlugins();
   delete config_.GetJobLog();
+  if(config_.GetJobPerfLog()) config_.GetJobPerfLog()->FlushTrace();
   delete config_.GetJobPerfLog();
   delete config_.GetJobsMetrics();
   delete config_.GetHeartBeatMetrics();
@@ -47,6 +47,42 @@ class OptimizedInformationContainer: public Arc::InformationContainer {
   ~OptimizedInformationContainer(void);
   int OpenDocument(void);
   void Assign(const std::string& xml,const std::string filename = "");
+  /// Take over already stored document by renaming tmpfilename to filename
+  bool AssignFile(const std::string& tmpfilename,const std::string& filename);
+ private:
+  bool Attach(int h,const std::string& tmpfilename,const std::string& filename,Arc::XMLNode& newxml);
+};
+
+/// Informational document as produced by information provider.
+/** Positions of elements A-REX modifies are recorded while document is
+  collected, so published document is rendered by copying template and
+  replacing those elements without parsing whole document again. */
+class InfoDocumentTemplate {
+ public:
+  /// Element of document whose content or presence is controlled by A-REX
+  class Slot {
+   public:
+    bool service;       // counter of ComputingService or its ComputingEndpoint
+    std::string share;  // name of ComputingShare counter belongs to
+    std::string name;   // name of counter, empty if element is to be removed
+    off_t element_start;
+    off_t content_start;
+    off_t content_end;
+    off_t element_end;
+  };
+  InfoDocumentTemplate(void);
+  ~InfoDocumentTemplate(void);
+  /// Take over document stored in tmpfilename by renaming it to filename.
+  /// If slots is NULL document is parsed on every rendering.
+  bool Assign(const std::string& tmpfilename, const std::string& filename, const std::list<Slot>* slots);
+  /// Store document with counters replaced by values from stats (if not NULL)
+  /// and without elements not belonging to GLUE2 into temporary file
+  /// next to filename. Name of temporary file is returned in tmpfilename.
+  bool Render(const JobsStatistics* stats, const std::string& filename, std::string& tmpfilename) const;
+ private:
+  std::string filename_;
+  std::list<Slot> slots_;
+  bool valid_;
 };
 
 #define AREXOP(NAME) Arc::MCC_Status NAME(ARexGMConfig& config,Arc::XMLNode in,Arc::XMLNode out)
@@ -61,6 +97,7 @@ class ARexService: public Arc::Service {
   Arc::Logger logger_;
   DelegationStores delegation_stores_;
   OptimizedInformationContainer infodoc_;
+  InfoDocumentTemplate infotemplate_; // only accessed from information collector thread
   CountedResource infolimit_;
   CountedResource beslimit_;
   CountedResource datalimit_;
@@ -73,6 +110,7 @@ class ARexService: public Arc::Service {
   std::string gmrun_;
   unsigned int infoprovider_wakeup_period_;
   unsigned int all_jobs_count_;
+  JobsStatistics jobs_stats_; // counters last applied to information document
   //Glib::Mutex glue_states_lock_;
   //std::map<std::string,std::string> glue_states_;
   FileChunksList files_chunks_;
@@ -196,6 +234,8 @@ class ARexService: public Arc::Service {
 
   int OpenInfoDocument(void);
   void InformationCollector(void);
+  bool UpdateJobsStatistics(bool force);
+  bool PublishInfoDocument(const JobsStatistics* stats);
   virtual std::string getID();
   void StopChildThreads(void);
 };
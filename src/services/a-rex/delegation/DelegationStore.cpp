@@ -269,6 +269,23 @@ namespace ARex {
     // Instead PeriodicCheckConsumers() is called to do periodic cleaning.
   }
 
+  // Expired records are removed in batches of this size
+  static const unsigned int remove_batch = 256;
+
+  static void RemoveExpired(FileRecord& fstore, std::list<std::pair<std::string,std::string> >& expired, Arc::Logger& logger) {
+    if(expired.empty()) return;
+    std::list<std::pair<std::string,std::string> >::size_type requested = expired.size();
+    if(!fstore.Remove(expired)) {
+      logger.msg(Arc::DEBUG,"DelegationStore: PeriodicCheckConsumers failed to remove old delegations - %s", fstore.Error());
+    } else if(expired.size() != requested) {
+      // It is ok to fail here because Remove checks for delegation locks.
+      // So reporting only for debuging purposes.
+      logger.msg(Arc::DEBUG,"DelegationStore: PeriodicCheckConsumers skipped %u locked old delegations",
+                 (unsigned int)(requested - expired.size()));
+    };
+    expired.clear();
+  }
+
   void DelegationStore::PeriodicCheckConsumers(void) {
     // Go through stored credentials
     // Remove outdated records (those with locks won't be removed)
@@ -285,24 +302,33 @@ namespace ARex {
       if(mrec_ == NULL) {
         mrec_ = fstore_->NewIterator();
       };
-      for(;(bool)(*mrec_);++(*mrec_)) {
+      std::list<std::pair<std::string,std::string> > expired;
+      for(;(bool)(*mrec_);) {
         if(mtimeout_ && (((unsigned int)(::time(NULL) - start)) > mtimeout_)) {
           mrec_->suspend();
+          RemoveExpired(*fstore_, expired, logger_);
           return;
         }
         struct stat st;
         if(::stat(mrec_->path().c_str(),&st) == 0) {
           if(((unsigned int)(::time(NULL) - st.st_mtime)) > expiration_) {
-            if(fstore_->Remove(mrec_->id(),mrec_->owner())) {
-            } else {
-              // It is ok to fail here because Remove checks for delegation locks.
-              // So reporting only for debuging purposes.
-              logger_.msg(Arc::DEBUG,"DelegationStore: PeriodicCheckConsumers failed to remove old delegation %s - %s", mrec_->uid(), fstore_->Error());
-            };
+            expired.push_back(std::pair<std::string,std::string>(mrec_->id(),mrec_->owner()));
           };    
         };
+        ++(*mrec_);
+        // Iterator is already positioned at record not yet checked, so it
+        // can be resumed after collected records are removed.
+        if((expired.size() >= remove_batch) && (bool)(*mrec_)) {
+          mrec_->suspend();
+          RemoveExpired(*fstore_, expired, logger_);
+          if(!mrec_->resume()) {
+            logger_.msg(Arc::WARNING,"DelegationStore: PeriodicCheckConsumers failed to resume iterator");
+            break;
+          };
+        };
       };
       delete mrec_; mrec_ = NULL;
+      RemoveExpired(*fstore_, expired, logger_);
     };
     // TODO: Remove records over threshold
     return;
@@ -367,11 +393,7 @@ namespace ARex {
 
   std::list<std::string> DelegationStore::ListCredIDs(const std::string& client) {
     std::list<std::string> res;
-    FileRecord::Iterator& rec = *(fstore_->NewIterator());
-    for(;(bool)rec;++rec) {
-      if(rec.owner() == client) res.push_back(rec.id());
-    };
-    delete &rec;
+    (void)fstore_->ListIDs(client, res);
     return res;
   }
 
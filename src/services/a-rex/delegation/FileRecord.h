@@ -74,6 +74,13 @@ class FileRecord {
   /// Fully removes credentials slot including file which stores credentials.
   virtual bool Remove(const std::string& id, const std::string& owner) = 0;
 
+  /// Removes multiple credentials slots at once. Slots with active locks are
+  /// skipped. On exit ids contains only identifiers of removed slots.
+  virtual bool Remove(std::list<std::pair<std::string,std::string> >& ids) = 0;
+
+  /// Fills ids with identifiers of credentials belonging to specified owner.
+  virtual bool ListIDs(const std::string& owner, std::list<std::string>& ids) = 0;
+
   // Assign specified credential ids specified lock lock_id
   virtual bool AddLock(const std::string& lock_id, const std::list<std::string>& ids, const std::string& owner) = 0;
 
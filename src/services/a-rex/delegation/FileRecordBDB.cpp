@@ -57,7 +57,8 @@ namespace ARex {
       db_rec_(NULL),
       db_lock_(NULL),
       db_locked_(NULL),
-      db_link_(NULL) {
+      db_link_(NULL),
+      db_owner_(NULL) {
     valid_ = open(create);
   }
 
@@ -125,12 +126,16 @@ namespace ARex {
     // db_link
     //    |---db_lock
     //    \---db_locked
+    // db_rec
+    //    \---db_owner
     db_rec_ = new Db(db_env_,DB_CXX_NO_EXCEPTIONS);
+    db_owner_ = new Db(db_env_,DB_CXX_NO_EXCEPTIONS);
     db_lock_ = new Db(db_env_,DB_CXX_NO_EXCEPTIONS);
     db_locked_ = new Db(db_env_,DB_CXX_NO_EXCEPTIONS);
     db_link_ = new Db(db_env_,DB_CXX_NO_EXCEPTIONS);
     if(!dberr("Error setting flag DB_DUPSORT",db_lock_->set_flags(DB_DUPSORT))) return false;
     if(!dberr("Error setting flag DB_DUPSORT",db_locked_->set_flags(DB_DUPSORT))) return false;
+    if(!dberr("Error setting flag DB_DUPSORT",db_owner_->set_flags(DB_DUPSORT))) return false;
     if(!dberr("Error associating databases",db_link_->associate(NULL,db_lock_,&lock_callback,0))) return false;
     if(!dberr("Error associating databases",db_link_->associate(NULL,db_locked_,&locked_callback,0))) return false;
     if(!dberr("Error opening database 'meta'",
@@ -141,16 +146,24 @@ namespace ARex {
           db_lock_->open(NULL,dbpath.c_str(),  "lock",  DB_BTREE,oflags,mode))) return false;
     if(!dberr("Error opening database 'locked'",
           db_locked_->open(NULL,dbpath.c_str(),"locked",DB_BTREE,oflags,mode))) return false;
+    // Owner index was added later. Store created by older version gets it
+    // created and filled from existing records by whichever process opens
+    // it first, master or not. Filling is skipped if index is not empty.
+    if(!dberr("Error opening database 'owner'",
+          db_owner_->open(NULL,dbpath.c_str(), "owner", DB_BTREE,oflags|DB_CREATE,mode))) return false;
+    if(!dberr("Error associating databases",db_rec_->associate(NULL,db_owner_,&owner_callback,DB_CREATE))) return false;
     return true;
   }
 
   void FileRecordBDB::close(void) {
     valid_ = false;
+    if(db_owner_) db_owner_->close(0);
     if(db_locked_) db_locked_->close(0);
     if(db_lock_) db_lock_->close(0);
     if(db_link_) db_link_->close(0);
     if(db_rec_) db_rec_->close(0);
     if(db_env_) db_env_->close(0);
+    delete db_owner_; db_owner_ = NULL;
     delete db_locked_; db_locked_ = NULL;
     delete db_lock_; db_lock_ = NULL;
     delete db_link_; db_link_ = NULL;
@@ -264,6 +277,16 @@ namespace ARex {
     return 0;
   }
 
+  int FileRecordBDB::owner_callback(Db * secondary, const Dbt * key, const Dbt * data, Dbt * result) {
+    const void* p = key->get_data();
+    uint32_t size = key->get_size();
+    std::string str;
+    p = parse_string(str,p,size); // id - skip
+    result->set_data((void*)p);
+    result->set_size(size);
+    return 0;
+  }
+
   bool FileRecordBDB::Recover(void) {
     Glib::Mutex::Lock lock(lock_);
     // Real recovery not implemented yet.
@@ -414,6 +437,72 @@ namespace ARex {
     return true;
   }
 
+  bool FileRecordBDB::Remove(std::list<std::pair<std::string,std::string> >& ids) {
+    if(!valid_) return false;
+    Glib::Mutex::Lock lock(lock_);
+    bool r = true;
+    std::list<std::string> uids;
+    for(std::list<std::pair<std::string,std::string> >::iterator i = ids.begin(); i != ids.end();) {
+      Dbt key;
+      Dbt data;
+      make_key(i->first,i->second,key);
+      void* pkey = key.get_data();
+      if(db_locked_->get(NULL,&key,&data,0) == 0) {
+        ::free(pkey);
+        i = ids.erase(i); continue; // have locks
+      };
+      if(db_rec_->get(NULL,&key,&data,0) != 0) {
+        ::free(pkey);
+        i = ids.erase(i); continue; // No such record?
+      };
+      std::string uid;
+      std::string id_tmp;
+      std::string owner_tmp;
+      std::list<std::string> meta;
+      parse_record(uid,id_tmp,owner_tmp,meta,key,data);
+      if(!dberr("Failed to delete record from database",db_rec_->del(NULL,&key,0))) {
+        ::free(pkey);
+        r = false;
+        i = ids.erase(i); continue;
+      };
+      ::free(pkey);
+      uids.push_back(uid);
+      ++i;
+    };
+    // Flushing once for all removed records
+    db_rec_->sync(0);
+    for(std::list<std::string>::iterator uid = uids.begin(); uid != uids.end(); ++uid) {
+      remove_file(*uid);
+    };
+    return r;
+  }
+
+  bool FileRecordBDB::ListIDs(const std::string& owner, std::list<std::string>& ids) {
+    if(!valid_) return false;
+    Glib::Mutex::Lock lock(lock_);
+    Dbc* cur = NULL;
+    if(!dberr("listids:cursor",db_owner_->cursor(NULL,&cur,0))) return false;
+    Dbt key;
+    Dbt pkey;
+    Dbt data;
+    make_string(owner,key);
+    void* pskey = key.get_data();
+    if(cur->pget(&key,&pkey,&data,DB_SET) != 0) {
+      ::free(pskey);
+      cur->close(); return true; // no records for this owner
+    };
+    for(;;) {
+      std::string id;
+      uint32_t size = pkey.get_size();
+      parse_string(id,pkey.get_data(),size);
+      ids.push_back(id);
+      if(cur->pget(&key,&pkey,&data,DB_NEXT_DUP) != 0) break;
+    };
+    ::free(pskey);
+    cur->close();
+    return true;
+  }
+
   bool FileRecordBDB::AddLock(const std::string& lock_id, const std::list<std::string>& ids, const std::string& owner) {
     if(!valid_) return false;
     Glib::Mutex::Lock lock(lock_);
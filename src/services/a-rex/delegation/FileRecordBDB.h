@@ -20,6 +20,8 @@ class FileRecordBDB: public FileRecord {
   Db*    db_lock_;
   Db*    db_locked_;
   Db*    db_link_;
+  Db*    db_owner_;
+  static int owner_callback(Db *, const Dbt *, const Dbt *, Dbt * result);
   static int locked_callback(Db *, const Dbt *, const Dbt *, Dbt * result);
   static int lock_callback(Db *, const Dbt *, const Dbt *, Dbt * result);
   bool dberr(const char* s, int err);
@@ -52,6 +54,8 @@ class FileRecordBDB: public FileRecord {
   virtual std::string Find(const std::string& id, const std::string& owner, std::list<std::string>& meta);
   virtual bool Modify(const std::string& id, const std::string& owner, const std::list<std::string>& meta);
   virtual bool Remove(const std::string& id, const std::string& owner);
+  virtual bool Remove(std::list<std::pair<std::string,std::string> >& ids);
+  virtual bool ListIDs(const std::string& owner, std::list<std::string>& ids);
   // Assign specified credential ids specified lock lock_id
   virtual bool AddLock(const std::string& lock_id, const std::list<std::string>& ids, const std::string& owner);
   // Reomove lock lock_id from all associated credentials
@@ -67,6 +67,40 @@ namespace ARex {
       return err;
   }
 
+  int FileRecordSQLite::sqlite3_step_nobusy(sqlite3_stmt* stmt) {
+      int err;
+      while((err = sqlite3_step(stmt)) == SQLITE_BUSY) {
+        (void)sqlite3_reset(stmt);
+        struct timespec delay = { 0, 10000000 }; // 0.01s - should be enough for most cases
+        (void)::nanosleep(&delay, NULL);
+      };
+      return err;
+  }
+
+  sqlite3_stmt* FileRecordSQLite::prepare(const char* sql) {
+    sqlite3_stmt* stmt = NULL;
+    int err;
+    while((err = sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL)) == SQLITE_BUSY) {
+      struct timespec delay = { 0, 10000000 }; // 0.01s - should be enough for most cases
+      (void)::nanosleep(&delay, NULL);
+    };
+    if(!dberr("Failed to prepare database statement", err)) {
+      (void)sqlite3_finalize(stmt);
+      return NULL;
+    };
+    return stmt;
+  }
+
+  static std::string column_text(sqlite3_stmt* stmt, int col) {
+    const unsigned char* text = sqlite3_column_text(stmt, col);
+    if(!text) return "";
+    return std::string((const char*)text);
+  }
+
+  static bool bind_text(sqlite3_stmt* stmt, int col, const std::string& text) {
+    return (sqlite3_bind_text(stmt, col, text.c_str(), text.length(), SQLITE_TRANSIENT) == SQLITE_OK);
+  }
+
   bool FileRecordSQLite::open(bool create) {
     std::string dbpath = basepath_ + G_DIR_SEPARATOR_S + FR_DB_NAME;
     if(db_ != NULL) return true; // already open
@@ -117,6 +151,10 @@ namespace ARex {
         return false;
       };
     };
+    // Owner index was added later, so database created by older version
+    // gets it on first open. Database which can't be modified is still
+    // usable without index.
+    (void)dberr("Error creating index owner", sqlite3_exec_nobusy("CREATE INDEX IF NOT EXISTS owner ON rec (owner)", NULL, NULL, NULL));
     return true;
   }
 
@@ -395,6 +433,72 @@ namespace ARex {
     return true;
   }
 
+  bool FileRecordSQLite::Remove(std::list<std::pair<std::string,std::string> >& ids) {
+    if(!valid_) return false;
+    Glib::Mutex::Lock lock(lock_);
+    sqlite3_stmt* find = prepare("SELECT uid FROM rec WHERE ((id = ?) AND (owner = ?))");
+    sqlite3_stmt* locked = prepare("SELECT uid FROM lock WHERE (uid = ?) LIMIT 1");
+    sqlite3_stmt* del = prepare("DELETE FROM rec WHERE (uid = ?)");
+    bool r = (find && locked && del);
+    // Single transaction instead of one per record
+    if(r) r = dberr("Failed to start transaction", sqlite3_exec_nobusy("BEGIN IMMEDIATE", NULL, NULL, NULL));
+    std::list<std::string> uids;
+    if(r) {
+      for(std::list<std::pair<std::string,std::string> >::iterator i = ids.begin(); i != ids.end();) {
+        std::string uid;
+        (void)sqlite3_reset(find);
+        bind_text(find, 1, sql_escape(i->first));
+        bind_text(find, 2, sql_escape(i->second));
+        int err = sqlite3_step_nobusy(find);
+        if(err == SQLITE_ROW) uid = column_text(find, 0);
+        else if(err != SQLITE_DONE) { r = dberr("Failed to retrieve record from database", err); break; };
+        if(uid.empty()) { i = ids.erase(i); continue; }; // No such record
+        (void)sqlite3_reset(locked);
+        bind_text(locked, 1, uid);
+        err = sqlite3_step_nobusy(locked);
+        if(err == SQLITE_ROW) { i = ids.erase(i); continue; }; // have locks
+        if(err != SQLITE_DONE) { r = dberr("Failed to find locks in database", err); break; };
+        (void)sqlite3_reset(del);
+        bind_text(del, 1, uid);
+        err = sqlite3_step_nobusy(del);
+        if(err != SQLITE_DONE) { r = dberr("Failed to delete record in database", err); break; };
+        uids.push_back(uid);
+        ++i;
+      };
+      if(r) {
+        r = dberr("Failed to commit transaction", sqlite3_exec_nobusy("COMMIT", NULL, NULL, NULL));
+      };
+      if(!r) {
+        (void)sqlite3_exec_nobusy("ROLLBACK", NULL, NULL, NULL);
+        uids.clear();
+      };
+    };
+    if(!r) ids.clear();
+    (void)sqlite3_finalize(find);
+    (void)sqlite3_finalize(locked);
+    (void)sqlite3_finalize(del);
+    for(std::list<std::string>::iterator uid = uids.begin(); uid != uids.end(); ++uid) {
+      remove_file(*uid);
+    };
+    return r;
+  }
+
+  bool FileRecordSQLite::ListIDs(const std::string& owner, std::list<std::string>& ids) {
+    if(!valid_) return false;
+    Glib::Mutex::Lock lock(lock_);
+    sqlite3_stmt* stmt = prepare("SELECT id FROM rec WHERE (owner = ?)");
+    if(!stmt) return false;
+    bool r = bind_text(stmt, 1, sql_escape(owner));
+    while(r) {
+      int err = sqlite3_step_nobusy(stmt);
+      if(err == SQLITE_DONE) break;
+      if(err != SQLITE_ROW) { r = dberr("Failed to retrieve records from database", err); break; };
+      ids.push_back(sql_unescape(column_text(stmt, 0)));
+    };
+    (void)sqlite3_finalize(stmt);
+    return r;
+  }
+
   bool FileRecordSQLite::AddLock(const std::string& lock_id, const std::list<std::string>& ids, const std::string& owner) {
     if(!valid_) return false;
     Glib::Mutex::Lock lock(lock_);
@@ -514,50 +618,92 @@ namespace ARex {
     return true;
   }
 
+  // Number of records read from database at once by iterator
+  static const int iterator_batch = 64;
+
   FileRecordSQLite::Iterator::Iterator(FileRecordSQLite& frec):FileRecord::Iterator(frec) {
     rowid_ = -1;
     Glib::Mutex::Lock lock(frec.lock_);
-    {
-      std::string sqlcmd = "SELECT _rowid_,id,owner,uid,meta FROM rec ORDER BY _rowid_ LIMIT 1";
-      FindCallbackRecArg arg;
-      if(!frec.dberr("listlocks:get",frec.sqlite3_exec_nobusy(sqlcmd.c_str(), &FindCallbackRec, &arg, NULL))) {
-        return;
-      };
-      if(arg.uid.empty()) {
-        return;
+    next_ = frec.prepare("SELECT _rowid_,id,owner,uid,meta FROM rec WHERE (_rowid_ > ?) ORDER BY _rowid_ ASC LIMIT ?");
+    version_stmt_ = frec.prepare("PRAGMA data_version");
+    if(!fetch()) return;
+    take(fetched_.front());
+    fetched_.pop_front();
+  }
+
+  FileRecordSQLite::Iterator::~Iterator(void) {
+    FileRecordSQLite& frec((FileRecordSQLite&)frec_);
+    Glib::Mutex::Lock lock(frec.lock_);
+    (void)sqlite3_finalize(next_);
+    (void)sqlite3_finalize(version_stmt_);
+  }
+
+  // Returns value which changes whenever database is modified through
+  // this or any other connection. Must be called with lock held.
+  std::string FileRecordSQLite::Iterator::version(void) {
+    FileRecordSQLite& frec((FileRecordSQLite&)frec_);
+    // data_version reflects changes made by other connections only
+    std::string v = Arc::tostring(sqlite3_total_changes(frec.db_)) + ":";
+    if(version_stmt_) {
+      (void)sqlite3_reset(version_stmt_);
+      if(frec.sqlite3_step_nobusy(version_stmt_) == SQLITE_ROW) {
+        v += Arc::tostring((long long int)sqlite3_column_int64(version_stmt_, 0));
       };
-      uid_ = arg.uid;
-      id_ = arg.id;
-      owner_ = arg.owner;
-      meta_ = arg.meta;
-      rowid_ = arg.rowid;
+      (void)sqlite3_reset(version_stmt_);
     };
+    return v;
   }
 
-  FileRecordSQLite::Iterator::~Iterator(void) {
+  // Reads next batch of records following rowid_. Must be called with lock held.
+  bool FileRecordSQLite::Iterator::fetch(void) {
+    if(!next_) return false;
+    FileRecordSQLite& frec((FileRecordSQLite&)frec_);
+    fetched_.clear();
+    fetched_version_ = version();
+    (void)sqlite3_reset(next_);
+    (void)sqlite3_bind_int64(next_, 1, rowid_);
+    (void)sqlite3_bind_int(next_, 2, iterator_batch);
+    for(;;) {
+      int err = frec.sqlite3_step_nobusy(next_);
+      if(err == SQLITE_DONE) break;
+      if(err != SQLITE_ROW) {
+        frec.dberr("Iterator:fetch", err);
+        fetched_.clear();
+        break;
+      };
+      Record rec;
+      rec.rowid = sqlite3_column_int64(next_, 0);
+      rec.id = sql_unescape(column_text(next_, 1));
+      rec.owner = sql_unescape(column_text(next_, 2));
+      rec.uid = column_text(next_, 3);
+      parse_strings(rec.meta, (const char*)sqlite3_column_text(next_, 4));
+      if(rec.uid.empty()) continue;
+      fetched_.push_back(rec);
+    };
+    (void)sqlite3_reset(next_);
+    return !fetched_.empty();
+  }
+
+  void FileRecordSQLite::Iterator::take(const Record& rec) {
+    uid_ = rec.uid;
+    id_ = rec.id;
+    owner_ = rec.owner;
+    meta_ = rec.meta;
+    rowid_ = rec.rowid;
   }
 
   FileRecordSQLite::Iterator& FileRecordSQLite::Iterator::operator++(void) {
     if(rowid_ == -1) return *this;
     FileRecordSQLite& frec((FileRecordSQLite&)frec_);
     Glib::Mutex::Lock lock(frec.lock_);
-    {
-      std::string sqlcmd = "SELECT _rowid_,id,owner,uid,meta FROM rec WHERE (_rowid_ > " + Arc::tostring(rowid_) + ") ORDER BY _rowid_ ASC LIMIT 1";
-      FindCallbackRecArg arg;
-      if(!frec.dberr("listlocks:get",frec.sqlite3_exec_nobusy(sqlcmd.c_str(), &FindCallbackRec, &arg, NULL))) {
-        rowid_ = -1;
-        return *this;
-      };
-      if(arg.uid.empty()) {
-        rowid_ = -1;
-        return *this;
-      };
-      uid_ = arg.uid;
-      id_ = arg.id;
-      owner_ = arg.owner;
-      meta_ = arg.meta;
-      rowid_ = arg.rowid;
-    };
+    // Records fetched in advance may be already removed or modified
+    if(!fetched_.empty() && (version() != fetched_version_)) fetched_.clear();
+    if(fetched_.empty() && !fetch()) {
+      rowid_ = -1;
+      return *this;
+    };
+    take(fetched_.front());
+    fetched_.pop_front();
     return *this;
   }
 
@@ -565,6 +711,7 @@ namespace ARex {
     if(rowid_ == -1) return *this;
     FileRecordSQLite& frec((FileRecordSQLite&)frec_);
     Glib::Mutex::Lock lock(frec.lock_);
+    fetched_.clear();
     {
       std::string sqlcmd = "SELECT _rowid_,id,owner,uid,meta FROM rec WHERE (_rowid_ < " + Arc::tostring(rowid_) + ") ORDER BY _rowid_ DESC LIMIT 1";
       FindCallbackRecArg arg;
@@ -17,6 +17,8 @@ class FileRecordSQLite: public FileRecord {
   Glib::Mutex lock_; // TODO: use DB locking
   sqlite3* db_;
   int sqlite3_exec_nobusy(const char *sql, int (*callback)(void*,int,char**,char**), void *arg, char **errmsg);
+  int sqlite3_step_nobusy(sqlite3_stmt* stmt);
+  sqlite3_stmt* prepare(const char* sql);
   bool dberr(const char* s, int err);
   bool open(bool create);
   void close(void);
@@ -27,7 +29,24 @@ class FileRecordSQLite: public FileRecord {
    private:
     Iterator(const Iterator&); // disabled constructor
     Iterator(FileRecordSQLite& frec);
+    struct Record {
+      sqlite3_int64 rowid;
+      std::string uid;
+      std::string id;
+      std::string owner;
+      std::list<std::string> meta;
+    };
     sqlite3_int64 rowid_;
+    // Statement for fetching next records, kept for whole life of iterator
+    sqlite3_stmt* next_;
+    // Records already fetched but not yet reached
+    std::list<Record> fetched_;
+    // Database version at time records were fetched
+    std::string fetched_version_;
+    sqlite3_stmt* version_stmt_;
+    bool fetch(void);
+    std::string version(void);
+    void take(const Record& rec);
    public:
     ~Iterator(void);
     virtual Iterator& operator++(void);
@@ -47,6 +66,8 @@ class FileRecordSQLite: public FileRecord {
   virtual std::string Find(const std::string& id, const std::string& owner, std::list<std::string>& meta);
   virtual bool Modify(const std::string& id, const std::string& owner, const std::list<std::string>& meta);
   virtual bool Remove(const std::string& id, const std::string& owner);
+  virtual bool Remove(std::list<std::pair<std::string,std::string> >& ids);
+  virtual bool ListIDs(const std::string& owner, std::list<std::string>& ids);
   // Assign specified credential ids specified lock lock_id
   virtual bool AddLock(const std::string& lock_id, const std::list<std::string>& ids, const std::string& owner);
   // Reomove lock lock_id from all associated credentials
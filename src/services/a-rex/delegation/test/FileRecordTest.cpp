@@ -0,0 +1,247 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <set>
+
+#include <sqlite3.h>
+
+#include <arc/FileUtils.h>
+#include <arc/StringConv.h>
+
+#include "../FileRecordSQLite.h"
+#ifdef HAVE_DBCXX
+#include "../FileRecordBDB.h"
+#endif
+
+class FileRecordTest
+  : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(FileRecordTest);
+  CPPUNIT_TEST(TestListIDs);
+  CPPUNIT_TEST(TestBatchRemove);
+  CPPUNIT_TEST(TestIterateRemove);
+  CPPUNIT_TEST(TestOwnerIndexSQLite);
+#ifdef HAVE_DBCXX
+  CPPUNIT_TEST(TestOwnerIndexBDB);
+#endif
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp();
+  void tearDown();
+  void TestListIDs();
+  void TestBatchRemove();
+  void TestIterateRemove();
+  void TestOwnerIndexSQLite();
+#ifdef HAVE_DBCXX
+  void TestOwnerIndexBDB();
+#endif
+
+private:
+  std::string dir;
+  // Every test is run for all available database backends
+  std::list<ARex::FileRecord*> Stores();
+  void ListIDs(ARex::FileRecord& frec);
+  void BatchRemove(ARex::FileRecord& frec);
+  void IterateRemove(ARex::FileRecord& frec);
+};
+
+void FileRecordTest::setUp() {
+  char tmpl[] = "/tmp/FileRecordTestXXXXXX";
+  CPPUNIT_ASSERT(mkdtemp(tmpl) != NULL);
+  dir = tmpl;
+}
+
+void FileRecordTest::tearDown() {
+  Arc::DirDelete(dir, true);
+}
+
+std::list<ARex::FileRecord*> FileRecordTest::Stores() {
+  std::list<ARex::FileRecord*> stores;
+  std::string path = dir + "/sqlite";
+  CPPUNIT_ASSERT(Arc::DirCreate(path, S_IRWXU));
+  stores.push_back(new ARex::FileRecordSQLite(path, true));
+#ifdef HAVE_DBCXX
+  path = dir + "/bdb";
+  CPPUNIT_ASSERT(Arc::DirCreate(path, S_IRWXU));
+  stores.push_back(new ARex::FileRecordBDB(path, true));
+#endif
+  for (std::list<ARex::FileRecord*>::iterator s = stores.begin(); s != stores.end(); ++s) {
+    CPPUNIT_ASSERT(**s);
+  }
+  return stores;
+}
+
+void FileRecordTest::ListIDs(ARex::FileRecord& frec) {
+  std::list<std::string> meta;
+  for (int n = 0; n < 3; ++n) {
+    std::string id = "a" + Arc::tostring(n);
+    CPPUNIT_ASSERT(!frec.Add(id, "ownerA", meta).empty());
+  }
+  for (int n = 0; n < 2; ++n) {
+    std::string id = "b" + Arc::tostring(n);
+    CPPUNIT_ASSERT(!frec.Add(id, "ownerB", meta).empty());
+  }
+  // Same id of other owner must not be listed
+  std::string id = "a0";
+  CPPUNIT_ASSERT(!frec.Add(id, "ownerB", meta).empty());
+
+  std::list<std::string> ids;
+  CPPUNIT_ASSERT(frec.ListIDs("ownerA", ids));
+  ids.sort();
+  CPPUNIT_ASSERT_EQUAL(3, (int)ids.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("a0"), ids.front());
+  CPPUNIT_ASSERT_EQUAL(std::string("a2"), ids.back());
+
+  ids.clear();
+  CPPUNIT_ASSERT(frec.ListIDs("ownerB", ids));
+  CPPUNIT_ASSERT_EQUAL(3, (int)ids.size());
+
+  ids.clear();
+  CPPUNIT_ASSERT(frec.ListIDs("ownerC", ids));
+  CPPUNIT_ASSERT(ids.empty());
+}
+
+void FileRecordTest::BatchRemove(ARex::FileRecord& frec) {
+  std::list<std::string> meta;
+  std::list<std::pair<std::string,std::string> > remove;
+  for (int n = 0; n < 5; ++n) {
+    std::string id = "r" + Arc::tostring(n);
+    CPPUNIT_ASSERT(!frec.Add(id, "owner", meta).empty());
+    remove.push_back(std::make_pair(id, std::string("owner")));
+  }
+  // Not existing slot
+  remove.push_back(std::make_pair(std::string("none"), std::string("owner")));
+  // Locked slot must survive
+  CPPUNIT_ASSERT(frec.AddLock("lock", std::list<std::string>(1, "r2"), "owner"));
+
+  CPPUNIT_ASSERT(frec.Remove(remove));
+  CPPUNIT_ASSERT_EQUAL(4, (int)remove.size());
+  for (std::list<std::pair<std::string,std::string> >::iterator r = remove.begin(); r != remove.end(); ++r) {
+    CPPUNIT_ASSERT(r->first != "r2");
+    CPPUNIT_ASSERT(r->first != "none");
+    CPPUNIT_ASSERT(frec.Find(r->first, "owner", meta).empty());
+  }
+  std::list<std::string> ids;
+  CPPUNIT_ASSERT(frec.ListIDs("owner", ids));
+  CPPUNIT_ASSERT_EQUAL(1, (int)ids.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("r2"), ids.front());
+}
+
+void FileRecordTest::IterateRemove(ARex::FileRecord& frec) {
+  // More records than iterator reads at once
+  const int num = 200;
+  std::list<std::string> meta;
+  std::list<std::pair<std::string,std::string> > remove;
+  for (int n = 0; n < num; ++n) {
+    std::string id = "i" + Arc::tostring(n);
+    CPPUNIT_ASSERT(!frec.Add(id, "owner", meta).empty());
+    if (n % 2) remove.push_back(std::make_pair(id, std::string("owner")));
+  }
+  std::set<std::string> removed;
+  std::set<std::string> seen;
+  ARex::FileRecord::Iterator* it = frec.NewIterator();
+  CPPUNIT_ASSERT(it);
+  for (int n = 0; *it; ++(*it), ++n) {
+    CPPUNIT_ASSERT(seen.insert(it->id()).second);
+    CPPUNIT_ASSERT(removed.find(it->id()) == removed.end());
+    if (n == 2) {
+      // Remove half of records while iterating
+      CPPUNIT_ASSERT(frec.Remove(remove));
+      for (std::list<std::pair<std::string,std::string> >::iterator r = remove.begin(); r != remove.end(); ++r) {
+        removed.insert(r->first);
+      }
+    }
+  }
+  delete it;
+  CPPUNIT_ASSERT_EQUAL(num/2, (int)removed.size());
+  // Every record which was not removed is visited
+  for (int n = 0; n < num; n += 2) {
+    CPPUNIT_ASSERT(seen.find("i" + Arc::tostring(n)) != seen.end());
+  }
+}
+
+void FileRecordTest::TestListIDs() {
+  std::list<ARex::FileRecord*> stores = Stores();
+  for (std::list<ARex::FileRecord*>::iterator s = stores.begin(); s != stores.end(); ++s) {
+    ListIDs(**s);
+    delete *s;
+  }
+}
+
+void FileRecordTest::TestBatchRemove() {
+  std::list<ARex::FileRecord*> stores = Stores();
+  for (std::list<ARex::FileRecord*>::iterator s = stores.begin(); s != stores.end(); ++s) {
+    BatchRemove(**s);
+    delete *s;
+  }
+}
+
+void FileRecordTest::TestIterateRemove() {
+  std::list<ARex::FileRecord*> stores = Stores();
+  for (std::list<ARex::FileRecord*>::iterator s = stores.begin(); s != stores.end(); ++s) {
+    IterateRemove(**s);
+    delete *s;
+  }
+}
+
+static int CountCallback(void* arg, int colnum, char** texts, char** names) {
+  ++(*(int*)arg);
+  return 0;
+}
+
+void FileRecordTest::TestOwnerIndexSQLite() {
+  // Database made by version without owner index
+  sqlite3* db = NULL;
+  CPPUNIT_ASSERT_EQUAL(SQLITE_OK, sqlite3_open((dir + "/list").c_str(), &db));
+  CPPUNIT_ASSERT_EQUAL(SQLITE_OK, sqlite3_exec(db, "CREATE TABLE rec(id, owner, uid, meta, UNIQUE(id, owner), UNIQUE(uid))", NULL, NULL, NULL));
+  CPPUNIT_ASSERT_EQUAL(SQLITE_OK, sqlite3_exec(db, "CREATE TABLE lock(lockid, uid)", NULL, NULL, NULL));
+  CPPUNIT_ASSERT_EQUAL(SQLITE_OK, sqlite3_exec(db, "INSERT INTO rec(id, owner, uid, meta) VALUES ('old', 'owner', '0123456789', '')", NULL, NULL, NULL));
+  sqlite3_close(db);
+
+  // Opened by process which is not allowed to create database
+  ARex::FileRecordSQLite frec(dir, false);
+  CPPUNIT_ASSERT(frec);
+  std::list<std::string> ids;
+  CPPUNIT_ASSERT(frec.ListIDs("owner", ids));
+  CPPUNIT_ASSERT_EQUAL(1, (int)ids.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("old"), ids.front());
+
+  int count = 0;
+  CPPUNIT_ASSERT_EQUAL(SQLITE_OK, sqlite3_open((dir + "/list").c_str(), &db));
+  CPPUNIT_ASSERT_EQUAL(SQLITE_OK, sqlite3_exec(db, "SELECT name FROM sqlite_master WHERE type = 'index' AND name = 'owner'", &CountCallback, &count, NULL));
+  sqlite3_close(db);
+  CPPUNIT_ASSERT_EQUAL(1, count);
+}
+
+#ifdef HAVE_DBCXX
+void FileRecordTest::TestOwnerIndexBDB() {
+  std::list<std::string> meta;
+  {
+    ARex::FileRecordBDB frec(dir, true);
+    CPPUNIT_ASSERT(frec);
+    std::string id = "old";
+    CPPUNIT_ASSERT(!frec.Add(id, "owner", meta).empty());
+  }
+  // Drop index to get store as made by version without it
+  {
+    Db db(NULL, DB_CXX_NO_EXCEPTIONS);
+    CPPUNIT_ASSERT_EQUAL(0, db.remove((dir + "/list").c_str(), "owner", 0));
+  }
+  // Opened by process which is not allowed to create database
+  ARex::FileRecordBDB frec(dir, false);
+  CPPUNIT_ASSERT(frec);
+  std::list<std::string> ids;
+  CPPUNIT_ASSERT(frec.ListIDs("owner", ids));
+  CPPUNIT_ASSERT_EQUAL(1, (int)ids.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("old"), ids.front());
+}
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FileRecordTest);
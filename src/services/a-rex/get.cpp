@@ -201,7 +201,7 @@ Arc::MCC_Status ARexService::GetJob(Arc::Message& inmsg,Arc::Message& outmsg,ARe
     off_t range_start;
     off_t range_end;
     ExtractRange(inmsg, range_start, range_end);
-    Arc::MessagePayload* h = newFileRead(file,range_start,range_end);
+    Arc::MessagePayload* h = newFileRead(file,job.GetFilePath(hpath),range_start,range_end);
     if(!h) {
       file->fa_close(); Arc::FileAccess::Release(file);
       return Arc::MCC_Status(Arc::UNKNOWN_SERVICE_ERROR);
@@ -260,9 +260,7 @@ Arc::MCC_Status ARexService::GetLogs(Arc::Message& inmsg,Arc::Message& outmsg,AR
         outmsg.Payload(h);
         outmsg.Attributes()->set("HTTP:content-type","text/plain");
         return Arc::MCC_Status(Arc::STATUS_OK);
-      } else {
-        ::close(file);
-      }
+      };
     };
   };
   return Arc::MCC_Status(Arc::UNKNOWN_SERVICE_ERROR);
@@ -277,7 +275,7 @@ Arc::MCC_Status ARexService::GetInfo(Arc::Message& inmsg,Arc::Message& outmsg) {
   int h = OpenInfoDocument();
   if(h == -1) return Arc::MCC_Status();
   Arc::MessagePayload* payload = newFileRead(h);
-  if(!payload) { ::close(h); return Arc::MCC_Status(); };
+  if(!payload) return Arc::MCC_Status();
   outmsg.Payload(payload);
   outmsg.Attributes()->set("HTTP:content-type","text/xml");
   return Arc::MCC_Status(Arc::STATUS_OK);
@@ -5,6 +5,7 @@
 #include <fcntl.h>
 #include <signal.h>
 #include <sys/time.h>
+#include <sys/stat.h>
 
 #include <arc/ArcLocation.h>
 #include <arc/FileUtils.h>
@@ -282,6 +283,7 @@ bool GridManager::thread() {
   /* main loop - forever */
   logger.msg(Arc::INFO,"Starting jobs' monitoring");
   time_t poll_job_time = time(NULL); // run once immediately + config_.WakeupPeriod();
+  time_t stats_time = 0;
   for(;;) {
     if(tostop_) break;
     // TODO: make processing of SSH async or remove SSH from GridManager completely
@@ -315,6 +317,21 @@ bool GridManager::thread() {
     if(metrics) metrics->Sync();
     // Process jobs which need attention ASAP
     jobs.ActJobsAttention();
+    if(((int)(time(NULL) - stats_time)) >= JOBS_STATS_PERIOD) {
+      // Refresh counters used by information system
+      stats_time = time(NULL);
+      JobsStatistics stats;
+      jobs.CollectStatistics(stats);
+      {
+        Glib::Mutex::Lock lock(stats_lock_);
+        stats_ = stats;
+        stats_valid_ = true;
+      };
+      // Information provider removes file after using it
+      std::string jobs_info = config_.ControlDir() + "/" + JOBS_INFO_FILE;
+      struct stat st;
+      if(!Arc::FileStat(jobs_info, &st, false)) jobs.WriteJobsInfo(jobs_info);
+    };
     if(((int)(time(NULL) - poll_job_time)) >= 0) {
       // Polling time
       poll_job_time = time(NULL) + config_.WakeupPeriod();
@@ -381,7 +398,14 @@ void GridManager::RequestJobAttention(const std::string& job_id) {
   };
 }
 
-GridManager::GridManager(GMConfig& config):tostop_(false), config_(config) {
+bool GridManager::GetJobsStatistics(JobsStatistics& stats) {
+  Glib::Mutex::Lock lock(stats_lock_);
+  if(!stats_valid_) return false;
+  stats = stats_;
+  return true;
+}
+
+GridManager::GridManager(GMConfig& config):tostop_(false), config_(config), stats_valid_(false) {
   jobs_ = NULL;
   if(!Arc::CreateThreadFunction(&grid_manager,(void*)this,&active_)) { };
 }
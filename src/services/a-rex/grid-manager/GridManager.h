@@ -3,6 +3,8 @@
 
 #include <arc/Thread.h>
 
+#include "jobs/JobsStatistics.h"
+
 namespace ARex {
 
 class JobsList;
@@ -15,6 +17,9 @@ class GridManager {
   bool tostop_;
   GMConfig& config_;
   JobsList* jobs_;
+  Glib::Mutex stats_lock_;
+  JobsStatistics stats_;
+  bool stats_valid_;
   GridManager();
   GridManager(const GridManager&);
   static void grid_manager(void* arg);
@@ -24,6 +29,9 @@ class GridManager {
   ~GridManager(void);
   operator bool(void) { return (active_.get()>0); };
   void RequestJobAttention(const std::string& job_id);
+  /// Obtain recent counters of jobs in memory. Returns false if
+  /// counters were not collected yet.
+  bool GetJobsStatistics(JobsStatistics& stats);
 };
 
 } // namespace ARex
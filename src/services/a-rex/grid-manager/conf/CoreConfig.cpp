@@ -88,6 +88,8 @@ bool CoreConfig::ParseConfINI(GMConfig& config, Arc::ConfigFile& cfile) {
   std::string jobreport_publisher;
   bool helper_log_is_set = false;
   bool job_log_log_is_set = false;
+  std::string perflog_dir = "/var/log/arc/perfdata";
+  bool perflog_tracing = false;
   Arc::ConfigIni cf(cfile);
   cf.SetSectionIndicator(".");
   static const int perflog_secnum     = 0;
@@ -146,9 +148,13 @@ bool CoreConfig::ParseConfINI(GMConfig& config, Arc::ConfigFile& cfile) {
         if (command == "perflogdir") { // 
           if (!config.job_perf_log) continue;
           std::string fname = rest;  // empty is allowed too
+          perflog_dir = fname;
           if(!fname.empty()) fname += "/arex.perflog";
           config.job_perf_log->SetOutput(fname.c_str());
         }
+        else if (command == "tracing") {
+          if (!CheckYesNoCommand(perflog_tracing, command, rest)) return false;
+        }
       };
       continue;
     };
@@ -243,6 +249,13 @@ bool CoreConfig::ParseConfINI(GMConfig& config, Arc::ConfigFile& cfile) {
             logger.msg(Arc::ERROR,"Wrong number in wakeupperiod: %s",wakeup_s); return false;
           }
         }
+        else if (command == "processingthreads") {
+          std::string threads_s = Arc::ConfigIni::NextArg(rest);
+          if (!Arc::stringto(threads_s, config.processing_threads)) {
+            logger.msg(Arc::ERROR,"Wrong number in processingthreads: %s",threads_s); return false;
+          }
+          if (config.processing_threads < 1) config.processing_threads = 1;
+        }
         else if (command == "mail") { // internal address from which to send mail
           config.support_email_address = rest;
           if (config.support_email_address.empty()) {
@@ -614,6 +627,12 @@ bool CoreConfig::ParseConfINI(GMConfig& config, Arc::ConfigFile& cfile) {
   };
   // End of parsing conf commands
 
+  // Trace file is shared with data staging so that spans of
+  // single job are collected in one place
+  if(config.job_perf_log && perflog_tracing && !perflog_dir.empty()) {
+    config.job_perf_log->SetTraceOutput(perflog_dir + "/trace.json");
+  }
+
   // Define accounting reporter and database manager if configured
   if(config.job_log) {
     if(!jobreport_publisher.empty()) {
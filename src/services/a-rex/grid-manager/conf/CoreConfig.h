@@ -13,13 +13,13 @@ class CoreConfig {
 public:
   /// Parse config
   static bool ParseConf(GMConfig& config);
+  /// Function handle yes/no config commands
+  static bool CheckYesNoCommand(bool& config_param, const std::string& name, std::string& rest);
 private:
   /// Parse ini-style config from stream cfile
   static bool ParseConfINI(GMConfig& config, Arc::ConfigFile& cfile);
   /// Function to check that LRMS scripts are available
   static void CheckLRMSBackends(const std::string& default_lrms);
-  /// Function handle yes/no config commands
-  static bool CheckYesNoCommand(bool& config_param, const std::string& name, std::string& rest);
   /// Logger
   static Arc::Logger logger;
 };
@@ -87,6 +87,7 @@ void GMConfig::SetDefaults() {
   reruns = DEFAULT_JOB_RERUNS;
   maxjobdesc = DEFAULT_MAX_JOB_DESC;
   wakeup_period = DEFAULT_WAKE_UP;
+  processing_threads = 1;
   allow_new = true;
 
   max_jobs_running = -1;
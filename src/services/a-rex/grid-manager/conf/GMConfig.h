@@ -231,6 +231,9 @@ public:
   /// Maxmimum time for A-REX to wait between job processing loops
   unsigned int WakeupPeriod() const { return wakeup_period; }
 
+  /// Number of threads processing jobs through state machine
+  unsigned int ProcessingThreads() const { return processing_threads; }
+
   const std::list<std::string> & Helpers() const { return helpers; }
 
   /// Max jobs being processed (from PREPARING to FINISHING)
@@ -336,6 +339,8 @@ private:
   bool allow_new;
   /// Maximum time for A-REX to wait between each loop processing jobs
   unsigned int wakeup_period;
+  /// Number of threads moving jobs through states in parallel
+  unsigned int processing_threads;
   /// Groups allowed to submit while job submission is disabled
   std::list<std::string> allow_submit;
   /// List of associated external processes
@@ -3,6 +3,7 @@
 #include <arc/ArcConfig.h>
 #include <arc/ArcConfigIni.h>
 
+#include "CoreConfig.h"
 #include "StagingConfig.h"
 
 namespace ARex {
@@ -53,6 +54,8 @@ StagingConfig::StagingConfig(const GMConfig& config):
 bool StagingConfig::readStagingConf(Arc::ConfigFile& cfile) {
 
   Arc::ConfigIni cf(cfile);
+  std::string perflog_dir = "/var/log/arc/perfdata";
+  bool perflog_tracing = false;
   static const int common_perflog_secnum = 0;
   cf.AddSection("common/perflog");
   cf.AddSection("arex/data-staging");
@@ -66,8 +69,12 @@ bool StagingConfig::readStagingConf(Arc::ConfigFile& cfile) {
       if (cf.SubSection()[0] == '\0') {
         perf_log.SetEnabled(true);
         if (command == "perflogdir") {
+          perflog_dir = rest;
           perf_log.SetOutput(rest + "/data.perflog");
         }
+        else if (command == "tracing") {
+          if (!CoreConfig::CheckYesNoCommand(perflog_tracing, command, rest)) return false;
+        }
       }
       continue;
     }
@@ -186,6 +193,9 @@ bool StagingConfig::readStagingConf(Arc::ConfigFile& cfile) {
       acix_endpoint = endpoint;
     }
   }
+  if (perflog_tracing && !perflog_dir.empty()) {
+    perf_log.SetTraceOutput(perflog_dir + "/trace.json");
+  }
   return true;
 }
 
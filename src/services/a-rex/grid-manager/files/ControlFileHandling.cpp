@@ -9,6 +9,7 @@
 #include <arc/FileAccess.h>
 #include <arc/FileUtils.h>
 #include <arc/FileLock.h>
+#include <arc/JobPerfLog.h>
 
 #include "../run/RunRedirected.h"
 #include "../conf/GMConfig.h"
@@ -411,6 +412,7 @@ job_state_t job_state_read_file(const JobId &id,const GMConfig &config) {
 }
 
 job_state_t job_state_read_file(const JobId &id,const GMConfig &config,bool& pending) {
+  Arc::JobPerfSpan span(config.GetJobPerfLog(), "control:state_read", id);
   std::string fname = config.ControlDir() + "/job." + id + sfx_status;
   job_state_t st = job_state_read_file(fname,pending);
   if(st != JOB_STATE_DELETED) return st;
@@ -428,6 +430,7 @@ job_state_t job_state_read_file(const JobId &id,const GMConfig &config,bool& pen
 }
 
 bool job_state_write_file(const GMJob &job,const GMConfig &config,job_state_t state,bool pending) {
+  Arc::JobPerfSpan span(config.GetJobPerfLog(), "control:state_write", job.get_id());
   std::string fname;
   if(state == JOB_STATE_ACCEPTED) { 
     fname = config.ControlDir() + "/" + subdir_old + "/job." + job.get_id() + sfx_status; remove(fname.c_str());
@@ -481,6 +484,7 @@ time_t job_description_time(const JobId &id,const GMConfig &config) {
 }
 
 bool job_description_read_file(const JobId &id,const GMConfig &config,std::string &desc) {
+  Arc::JobPerfSpan span(config.GetJobPerfLog(), "control:description_read", id);
   std::string fname = config.ControlDir() + "/job." + id + sfx_desc;
   return job_description_read_file(fname,desc);
 }
@@ -522,6 +526,7 @@ bool job_xml_write_file(const JobId &id,const GMConfig &config,const std::string
 }
 
 bool job_local_write_file(const GMJob &job,const GMConfig &config,const JobLocalDescription &job_desc) {
+  Arc::JobPerfSpan span(config.GetJobPerfLog(), "control:local_write", job.get_id());
   std::string fname = config.ControlDir() + "/job." + job.get_id() + sfx_local;
   return job_local_write_file(fname,job_desc) && fix_file_owner(fname,job) && fix_file_permissions(fname,job,config);
 }
@@ -531,6 +536,7 @@ bool job_local_write_file(const std::string &fname,const JobLocalDescription &jo
 }
 
 bool job_local_read_file(const JobId &id,const GMConfig &config,JobLocalDescription &job_desc) {
+  Arc::JobPerfSpan span(config.GetJobPerfLog(), "control:local_read", id);
   std::string fname = config.ControlDir() + "/job." + id + sfx_local;
   return job_local_read_file(fname,job_desc);
 }
@@ -569,19 +575,24 @@ bool job_local_read_delegationid(const JobId &id,const GMConfig &config,std::str
 /* job.ID.input functions */
 
 bool job_input_write_file(const GMJob &job,const GMConfig &config,std::list<FileData> &files) {
+  Arc::JobPerfSpan span(config.GetJobPerfLog(), "control:input_write", job.get_id());
   std::string fname = config.ControlDir() + "/job." + job.get_id() + sfx_input;
   return job_Xput_write_file(fname,files) && fix_file_owner(fname,job) && fix_file_permissions(fname);
 }
 
 bool job_input_read_file(const JobId &id,const GMConfig &config,std::list<FileData> &files) {
+  Arc::JobPerfSpan span(config.GetJobPerfLog(), "control:input_read", id);
   std::string fname = config.ControlDir() + "/job." + id + sfx_input;
   return job_Xput_read_file(fname,files);
 }
 
 bool job_input_status_add_file(const GMJob &job,const GMConfig &config,const std::string& file) {
-  // 1. lock
-  // 2. add
-  // 3. unlock
+  return job_input_status_add_files(job,config,std::list<std::string>(1,file));
+}
+
+bool job_input_status_add_files(const GMJob &job,const GMConfig &config,const std::list<std::string>& files) {
+  Arc::JobPerfSpan span(config.GetJobPerfLog(), "control:input_status_add", job.get_id());
+  // File is rewritten once for all files
   std::string fname = config.ControlDir() + "/job." + job.get_id() + sfx_inputstatus;
   Arc::FileLock lock(fname);
   for (int i = 10; !lock.acquire() && i >= 0; --i)  {
@@ -593,9 +604,10 @@ bool job_input_status_add_file(const GMJob &job,const GMConfig &config,const std
     lock.release();
     return false;
   }
-  std::ostringstream line;
-  line<<file<<"\n";
-  data += line.str();
+  for (std::list<std::string>::const_iterator file = files.begin(); file != files.end(); ++file) {
+    data += *file;
+    data += "\n";
+  }
   bool r = Arc::FileCreate(fname, data);
   lock.release();
   return r && fix_file_owner(fname,job) && fix_file_permissions(fname);
@@ -615,16 +627,19 @@ bool job_input_status_read_file(const JobId &id,const GMConfig &config,std::list
 
 /* job.ID.output functions */
 bool job_output_write_file(const GMJob &job,const GMConfig &config,std::list<FileData> &files,job_output_mode mode) {
+  Arc::JobPerfSpan span(config.GetJobPerfLog(), "control:output_write", job.get_id());
   std::string fname = config.ControlDir() + "/job." + job.get_id() + sfx_output;
   return job_Xput_write_file(fname,files,mode) && fix_file_owner(fname,job) && fix_file_permissions(fname);
 }
 
 bool job_output_read_file(const JobId &id,const GMConfig &config,std::list<FileData> &files) {
+  Arc::JobPerfSpan span(config.GetJobPerfLog(), "control:output_read", id);
   std::string fname = config.ControlDir() + "/job." + id + sfx_output;
   return job_Xput_read_file(fname,files);
 }
 
 bool job_output_status_add_file(const GMJob &job,const GMConfig &config,const FileData& file) {
+  Arc::JobPerfSpan span(config.GetJobPerfLog(), "control:output_status_add", job.get_id());
   // Not using lock here because concurrent read/write is not expected
   std::string fname = config.ControlDir() + "/job." + job.get_id() + sfx_outputstatus;
   std::string data;
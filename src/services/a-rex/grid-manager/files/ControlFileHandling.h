@@ -168,6 +168,8 @@ bool job_input_write_file(const GMJob &job,const GMConfig &config,std::list<File
 bool job_input_read_file(const JobId &id,const GMConfig &config,std::list<FileData> &files);
 
 bool job_input_status_add_file(const GMJob &job,const GMConfig &config,const std::string& file = "");
+/// Same as job_input_status_add_file() for many files at once
+bool job_input_status_add_files(const GMJob &job,const GMConfig &config,const std::list<std::string>& files);
 bool job_input_status_read_file(const JobId &id,const GMConfig &config,std::list<std::string>& files);
 
 // Write and read file containing list of output files. Each line of file
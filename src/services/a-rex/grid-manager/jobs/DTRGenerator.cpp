@@ -8,6 +8,7 @@
 #include <arc/FileUtils.h>
 #include <arc/FileAccess.h>
 #include <arc/data/FileCache.h>
+#include <arc/data-staging/DTRJournal.h>
 
 #include "../conf/UrlMapConfig.h"
 #include "../files/ControlFileHandling.h"
@@ -182,7 +183,8 @@ DTRGenerator::DTRGenerator(const GMConfig& config, JobsList& jobs) :
   scheduler->SetDumpLocation(staging_conf.dtr_log);
 
   // Read DTR state from previous dump to find any transfers stopped half-way
-  // If those destinations appear again, add overwrite=yes
+  // If those destinations appear again, add overwrite=yes. Jobs which had
+  // DTRs in the journal are regenerated first.
   readDTRState(staging_conf.dtr_log);
 
   // Processing limits
@@ -265,7 +267,16 @@ bool DTRGenerator::receiveJob(GMJobRef& job) {
   // Add to jobs list even if Generator is stopped, so that A-REX doesn't
   // think that staging has finished.
   Arc::AutoLock<Arc::SimpleCondition> elock(event_lock);
-  bool result = jobs_received.PushSorted(job, compare_job_description);
+  bool result = false;
+  std::set<std::string>::iterator recovered = recovered_jobs.find(job->get_id());
+  if (recovered != recovered_jobs.end()) {
+    // Transfers interrupted by restart go first, ahead of new work
+    logger.msg(Arc::DEBUG, "%s: Job had unfinished DTRs in previous run, processing it first", job->get_id());
+    recovered_jobs.erase(recovered);
+    result = jobs_received.Unpop(job);
+  } else {
+    result = jobs_received.PushSorted(job, compare_job_description);
+  }
   if(result) {
     logger.msg(Arc::DEBUG, "%s: Received job in DTR generator", job->get_id());
     event_lock.signal_nonblock();
@@ -1041,6 +1052,7 @@ bool DTRGenerator::processReceivedJob(GMJobRef& job) {
     }
     dtr->get_job_perf_log().SetOutput(staging_conf.perf_log.GetOutput());
     dtr->get_job_perf_log().SetEnabled(staging_conf.perf_log.GetEnabled());
+    dtr->get_job_perf_log().SetTraceOutput(staging_conf.perf_log.GetTraceOutput());
 
     DataStaging::DTRCacheParameters cache_parameters;
     CacheConfig cache_params(config.CacheParams());
@@ -1328,6 +1340,26 @@ int DTRGenerator::user_file_exists(FileData &dt,
 
 void DTRGenerator::readDTRState(const std::string& dtr_log) {
 
+  // Journal is written more often than full dump so prefer it if available
+  std::map<std::string, DataStaging::DTRJournal::Record> records;
+  if (DataStaging::DTRJournal::Read(dtr_log + ".journal", records)) {
+    if (!records.empty()) {
+      logger.msg(Arc::WARNING, "Found unfinished DTR transfers. It is possible the "
+          "previous A-REX process did not shut down normally");
+    }
+    for (std::map<std::string, DataStaging::DTRJournal::Record>::iterator rec = records.begin();
+         rec != records.end(); ++rec) {
+      recovered_jobs.insert(rec->second.job_id);
+      if ((rec->second.status == "TRANSFERRING" || rec->second.status == "TRANSFER") &&
+          !rec->second.destination.empty()) {
+        logger.msg(Arc::VERBOSE, "Found DTR %s for file %s left in transferring state from previous run "
+                   "(%llu bytes transferred)", rec->first, rec->second.destination, rec->second.bytes);
+        recovered_files.push_back(rec->second.destination);
+      }
+    }
+    return;
+  }
+
   std::list<std::string> lines;
   // file may not exist if this is the first use of DTR
   if (!Arc::FileRead(dtr_log, lines)) return;
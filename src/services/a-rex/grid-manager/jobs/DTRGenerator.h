@@ -1,6 +1,8 @@
 #ifndef DTR_GENERATOR_H_
 #define DTR_GENERATOR_H_
 
+#include <set>
+
 #include <arc/data-staging/DTR.h>
 #include <arc/data-staging/Scheduler.h>
 
@@ -78,6 +80,9 @@ class DTRGenerator: public DataStaging::DTRCallback {
   /** A list of files left mid-transfer from a previous process.
       This list is not protected and is used only from DTRGenerator::thread() */
   std::list<std::string> recovered_files;
+  /** IDs of jobs which had DTRs when previous process stopped.
+      Protected by event_lock. */
+  std::set<std::string> recovered_jobs;
   /** logger to a-rex log */
   static Arc::Logger logger;
   /** Associated scheduler */
@@ -108,7 +113,8 @@ class DTRGenerator: public DataStaging::DTRCallback {
   /** Process a cancelled job */
   bool processCancelledJob(const std::string& jobid);
 
-  /** Read in state left from previous process and fill recovered_files */
+  /** Read in state left from previous process and fill recovered_files
+      and recovered_jobs */
   void readDTRState(const std::string& dtr_log);
 
   /** Clean up joblinks dir in caches for given job (called at the end of upload) */
@@ -7,6 +7,7 @@
 
 #include "../files/ControlFileContent.h"
 #include "../files/ControlFileHandling.h"
+#include "../run/RunParallel.h"
 #include "GMJob.h"
 
 namespace ARex {
@@ -95,8 +96,7 @@ GMJob::~GMJob(void){
   if(child) {
     // Wait for downloader/uploader/script to finish
     child->Wait();
-    delete child;
-    child=NULL;
+    RunParallel::release(child);
   }
   delete local;
 }
@@ -4,9 +4,12 @@
 
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <ctype.h>
 
 #include <arc/ArcLocation.h>
 #include <arc/JobPerfLog.h>
+#include <arc/FileUtils.h>
+#include <arc/StringConv.h>
 #include <arc/credential/VOMSUtil.h>
 
 #include "../files/ControlFileHandling.h"
@@ -33,9 +36,33 @@ namespace ARex {
    decide that it is gone.
    Only for protecting against lost child. */
 #define CHILD_RUN_TIME_TOO_LONG (60*60)
+/* max number of jobs passed to single invocation of
+   submit-*-jobs/cancel-*-jobs. */
+#define LRMS_BATCH_MAX_JOBS (100)
 
 static Arc::Logger& logger = Arc::Logger::getRootLogger();
 
+// Jobs handled by batch script. Used to wake them up when script exits.
+class LRMSBatchRef {
+ private:
+  JobsList& list;
+  std::list<JobId> ids;
+ public:
+  LRMSBatchRef(JobsList& list, std::list<JobId> const& ids): list(list), ids(ids) {};
+  static void kicker(void* arg);
+};
+
+void LRMSBatchRef::kicker(void* arg) {
+  LRMSBatchRef* ref = reinterpret_cast<LRMSBatchRef*>(arg);
+  if(ref) {
+    logger.msg(Arc::DEBUG,"Batch of %u jobs exited",(unsigned int)ref->ids.size());
+    for(std::list<JobId>::iterator id = ref->ids.begin(); id != ref->ids.end(); ++id) {
+      ref->list.RequestAttention(*id);
+    };
+    delete ref;
+  };
+}
+
 JobsList::ExternalHelpers::ExternalHelpers(const std::list<std::string>& commands, JobsList const& jobs):
                                                   Arc::Thread(), jobs_list(jobs), stop_request(false) {
   for (std::list<std::string>::const_iterator command = commands.begin(); command != commands.end(); ++command) {
@@ -73,6 +100,8 @@ JobsList::JobsList(const GMConfig& gmconfig) :
     jobs_attention(AttentionQueuePriority, "attention"),
     jobs_polling(0, "polling"),
     jobs_wait_for_running(WaitQueuePriority, "wait for running"),
+    processing_threads_num(0), processing_active(0),
+    processing_round(false), processing_stop(false),
     config(gmconfig), staging_config(gmconfig),
     dtr_generator(config, *this),
     job_desc_handler(config), jobs_pending(0),
@@ -96,6 +125,12 @@ JobsList::JobsList(const GMConfig& gmconfig) :
 }
 
 JobsList::~JobsList(void) {
+  {
+    Glib::Mutex::Lock lock(jobs_busy_lock);
+    processing_stop = true;
+    processing_cond.broadcast();
+  };
+  processing_threads.wait();
 }
 
 GMJobRef JobsList::FindJob(const JobId &id) {
@@ -212,6 +247,7 @@ bool JobsList::AddJob(const JobId &id,uid_t uid,gid_t gid,job_state_t state,cons
 }
 
 int JobsList::AcceptedJobs() const {
+  Glib::Mutex::Lock lock(counters_lock);
   return jobs_num[JOB_STATE_ACCEPTED] +
          jobs_num[JOB_STATE_PREPARING] +
          jobs_num[JOB_STATE_SUBMITTING] +
@@ -222,11 +258,114 @@ int JobsList::AcceptedJobs() const {
 
 bool JobsList::RunningJobsLimitReached() const {
   if(config.MaxRunning()==-1) return false;
+  Glib::Mutex::Lock lock(counters_lock);
   int num = jobs_num[JOB_STATE_SUBMITTING] +
             jobs_num[JOB_STATE_INLRMS];
   return num >= config.MaxRunning();
 }
 
+bool JobsList::ScriptsLimitReached(void) const {
+  if(config.MaxScripts()==-1) return false;
+  Glib::Mutex::Lock lock(counters_lock);
+  return jobs_scripts >= config.MaxScripts();
+}
+
+void JobsList::CollectStatistics(JobsStatistics& stats) const {
+  Glib::RecMutex::Lock lock(jobs_lock);
+  for(std::map<JobId,GMJobRef>::const_iterator i=jobs.begin();i!=jobs.end();++i) {
+    GMJobRef job = i->second;
+    std::string share;
+    std::string vo;
+    if(job->local) {
+      share = job->local->queue;
+      if(!job->local->voms.empty()) {
+        // Same as information provider - first word of first FQAN
+        const std::string& fqan = job->local->voms.front();
+        std::string::size_type start = fqan.find_first_not_of('/');
+        if(start != std::string::npos) {
+          std::string::size_type end = start;
+          while((end < fqan.length()) && (isalnum(fqan[end]) || (fqan[end] == '_'))) ++end;
+          vo = fqan.substr(start, end-start);
+        }
+      }
+    }
+    stats.Add(job->job_state, job->job_pending, share, vo);
+  }
+}
+
+// Values are written one per line, so line breaks are not allowed in them
+static void AddJobInfo(std::string& info, const char* name, const std::string& value) {
+  if(value.empty()) return;
+  std::string::size_type end = value.find_first_of("\r\n");
+  info += name;
+  info += "=";
+  info += value.substr(0, end);
+  info += "\n";
+}
+
+static void AddJobInfo(std::string& info, const char* name, const Arc::Time& value) {
+  if(value == -1) return;
+  AddJobInfo(info, name, value.str(Arc::MDSTime));
+}
+
+static void AddJobInfo(std::string& info, const char* name, const std::list<std::string>& values) {
+  for(std::list<std::string>::const_iterator v = values.begin(); v != values.end(); ++v) {
+    AddJobInfo(info, name, *v);
+  }
+}
+
+bool JobsList::WriteJobsInfo(const std::string& fname) const {
+  std::list<GMJobRef> active;
+  {
+    Glib::RecMutex::Lock lock(jobs_lock);
+    for(std::map<JobId,GMJobRef>::const_iterator i=jobs.begin();i!=jobs.end();++i) {
+      active.push_back(i->second);
+    }
+  }
+  // Every job starts with its identifier followed by state and content
+  // of local description using same names as in .local file.
+  std::string info;
+  for(std::list<GMJobRef>::iterator i = active.begin(); i != active.end(); ++i) {
+    GMJobRef& job = *i;
+    if((job->job_state == JOB_STATE_FINISHED) || (job->job_state == JOB_STATE_DELETED)) continue;
+    AddJobInfo(info, "job", job->job_id);
+    AddJobInfo(info, "status", (job->job_pending ? std::string("PENDING:") : std::string()) + job->get_state_name());
+    AddJobInfo(info, "localowner", job->user.Name());
+    const JobLocalDescription* local = job->local;
+    if(local) {
+      AddJobInfo(info, "globalid", local->globalid);
+      AddJobInfo(info, "headnode", local->headnode);
+      AddJobInfo(info, "interface", local->interface);
+      AddJobInfo(info, "lrms", local->lrms);
+      AddJobInfo(info, "queue", local->queue);
+      AddJobInfo(info, "localid", local->localid);
+      AddJobInfo(info, "subject", local->DN);
+      AddJobInfo(info, "starttime", local->starttime);
+      AddJobInfo(info, "lifetime", local->lifetime);
+      AddJobInfo(info, "jobname", local->jobname);
+      AddJobInfo(info, "gmlog", local->stdlog);
+      AddJobInfo(info, "cleanuptime", local->cleanuptime);
+      AddJobInfo(info, "delegexpiretime", local->expiretime);
+      AddJobInfo(info, "clientname", local->clientname);
+      AddJobInfo(info, "clientsoftware", local->clientsoftware);
+      AddJobInfo(info, "sessiondir", local->sessiondir);
+      AddJobInfo(info, "diskspace", Arc::tostring(local->diskspace));
+      AddJobInfo(info, "failedstate", local->failedstate);
+      AddJobInfo(info, "transfershare", local->transfershare);
+      AddJobInfo(info, "jobreport", local->jobreport);
+      AddJobInfo(info, "projectname", local->projectnames);
+      AddJobInfo(info, "voms", local->voms);
+      AddJobInfo(info, "activityid", local->activityid);
+    }
+    info += "\n";
+  }
+  if(!Arc::FileCreate(fname, info, 0, 0, S_IRUSR|S_IWUSR)) {
+    logger.msg(Arc::WARNING, "Failed to write information about jobs to %s", fname);
+    return false;
+  }
+  return true;
+}
+
 void JobsList::PrepareToDestroy(void) {
   Glib::RecMutex::Lock lock(jobs_lock);
   for(std::map<JobId,GMJobRef>::iterator i=jobs.begin();i!=jobs.end();++i) {
@@ -342,13 +481,88 @@ bool JobsList::RequestReprocess(GMJobRef i) {
   return false;
 }
 
-bool JobsList::ActJobsProcessing(void) {
-  while(true) {
-    GMJobRef i = jobs_processing.Pop();
-    if(!i) break;
-    logger.msg(Arc::DEBUG, "%s: job being processed", i->job_id);
+bool JobsList::IsLimitedState(GMJobRef i) const {
+  switch(i->job_state) {
+    case JOB_STATE_UNDEFINED: return (config.MaxJobs() != -1);
+    case JOB_STATE_ACCEPTED: return (config.MaxPerDN() > 0);
+    case JOB_STATE_PREPARING: return (config.MaxRunning() != -1);
+    case JOB_STATE_SUBMITTING: return (config.MaxScripts() != -1);
+    case JOB_STATE_CANCELING: return (config.MaxScripts() != -1);
+    default: break;
+  };
+  return false;
+}
+
+void JobsList::ActJobsProcessingThread(void* arg) {
+  reinterpret_cast<JobsList*>(arg)->ActJobsProcessingWorker();
+}
+
+void JobsList::ActJobsProcessingWorker(void) {
+  Glib::Mutex::Lock lock(jobs_busy_lock);
+  while(!processing_stop) {
+    if(!processing_round || !ActJobsProcessingStep()) processing_cond.wait(jobs_busy_lock);
+  };
+}
+
+bool JobsList::ActJobsProcessingStep(void) {
+  GMJobRef i = jobs_processing.Pop();
+  if(!i) return false;
+  // Job may be destroyed inside ActJob
+  JobId id = i->job_id;
+  if(jobs_busy.find(id) != jobs_busy.end()) {
+    // Job requested reprocessing while still being handled by
+    // another thread. Keep it till that thread is done.
+    jobs_deferred[id] = i;
+    return true;
+  };
+  jobs_busy.insert(id);
+  ++processing_active;
+  jobs_busy_lock.unlock();
+  logger.msg(Arc::DEBUG, "%s: job being processed", id);
+  if(IsLimitedState(i)) {
+    Glib::Mutex::Lock lock(limits_lock);
+    ActJob(i);
+  } else {
     ActJob(i);
   };
+  i = GMJobRef();
+  jobs_busy_lock.lock();
+  jobs_busy.erase(id);
+  --processing_active;
+  std::map<JobId,GMJobRef>::iterator d = jobs_deferred.find(id);
+  if(d != jobs_deferred.end()) {
+    // Now postponed request can be handled by any thread
+    jobs_processing.Push(d->second);
+    jobs_deferred.erase(d);
+  };
+  // Wake up threads waiting for postponed job or for end of round
+  processing_cond.broadcast();
+  return true;
+}
+
+bool JobsList::ActJobsProcessing(void) {
+  {
+    Glib::Mutex::Lock lock(jobs_busy_lock);
+    // Main thread is processing jobs too
+    while(processing_threads_num < ((int)config.ProcessingThreads())-1) {
+      if(!Arc::CreateThreadFunction(&ActJobsProcessingThread, this, &processing_threads)) {
+        logger.msg(Arc::WARNING, "Failed to start job processing thread");
+        break;
+      };
+      ++processing_threads_num;
+    };
+    processing_round = true;
+    processing_cond.broadcast();
+    while(true) {
+      if(ActJobsProcessingStep()) continue;
+      // Queue is empty but other threads may still put postponed jobs into it
+      if(processing_active <= 0) break;
+      processing_cond.wait(jobs_busy_lock);
+    };
+    processing_round = false;
+  };
+  // Jobs collected for batch submission/cancellation during this round
+  ProcessLRMSBatches();
   // Check limit on number of running jobs and activate some of them if possible
   if(!RunningJobsLimitReached()) {
     GMJobRef i = jobs_wait_for_running.Pop();
@@ -464,8 +678,128 @@ bool JobsList::GetLocalDescription(GMJobRef i) const {
 
 void JobsList::CleanChildProcess(GMJobRef i) {
   if(i->child) {
-    delete i->child; i->child=NULL;
-    if((i->job_state == JOB_STATE_SUBMITTING) || (i->job_state == JOB_STATE_CANCELING)) --jobs_scripts;
+    RunParallel::release(i->child);
+    if((i->job_state == JOB_STATE_SUBMITTING) || (i->job_state == JOB_STATE_CANCELING)) {
+      Glib::Mutex::Lock lock(counters_lock);
+      --jobs_scripts;
+    };
+  }
+  Glib::Mutex::Lock lock(lrms_batches_lock);
+  std::map<JobId,LRMSBatch*>::iterator batch = lrms_batched_jobs.find(i->job_id);
+  if(batch != lrms_batched_jobs.end()) {
+    batch->second->jobs.remove(i->job_id);
+    lrms_batched_jobs.erase(batch);
+  }
+}
+
+bool JobsList::AddToLRMSBatch(GMJobRef i,const std::string& operation,const std::string& lrms) {
+  std::string cmd = Arc::ArcLocation::GetDataDir()+"/"+operation+"-"+lrms+"-jobs";
+  Glib::Mutex::Lock lock(lrms_batches_lock);
+  std::map<std::string,bool>::iterator supported = lrms_batch_supported.find(cmd);
+  if(supported == lrms_batch_supported.end()) {
+    bool executable = Glib::file_test(cmd, Glib::FILE_TEST_IS_EXECUTABLE);
+    if(executable) logger.msg(Arc::INFO,"Using %s for batch processing of jobs",cmd);
+    supported = lrms_batch_supported.insert(std::make_pair(cmd,executable)).first;
+  }
+  if(!supported->second) return false;
+  LRMSBatch* batch = NULL;
+  for(std::list<LRMSBatch*>::iterator b = lrms_batches.begin(); b != lrms_batches.end(); ++b) {
+    if((*b)->started) continue;
+    if((*b)->operation != operation) continue;
+    if((*b)->lrms != lrms) continue;
+    if(((*b)->uid != i->get_user().get_uid()) || ((*b)->gid != i->get_user().get_gid())) continue;
+    if((*b)->jobs.size() >= LRMS_BATCH_MAX_JOBS) continue;
+    batch = *b;
+    break;
+  }
+  if(!batch) {
+    batch = new LRMSBatch;
+    batch->operation = operation;
+    batch->lrms = lrms;
+    batch->uid = i->get_user().get_uid();
+    batch->gid = i->get_user().get_gid();
+    batch->started = false;
+    batch->counted = false;
+    batch->child = NULL;
+    batch->exit_time = Arc::Time(Arc::Time::UNDEFINED);
+    lrms_batches.push_back(batch);
+  }
+  batch->jobs.push_back(i->job_id);
+  lrms_batched_jobs[i->job_id] = batch;
+  return true;
+}
+
+bool JobsList::InLRMSBatch(GMJobRef i,Arc::Time& exit_time) {
+  exit_time = Arc::Time(Arc::Time::UNDEFINED);
+  Glib::Mutex::Lock lock(lrms_batches_lock);
+  std::map<JobId,LRMSBatch*>::iterator b = lrms_batched_jobs.find(i->job_id);
+  if(b == lrms_batched_jobs.end()) return false;
+  LRMSBatch& batch = *(b->second);
+  if(batch.child) {
+    if(!batch.child->Running()) {
+      exit_time = batch.child->ExitTime();
+      if(exit_time == Arc::Time(Arc::Time::UNDEFINED)) exit_time = Arc::Time();
+    }
+  } else if(batch.started) {
+    exit_time = batch.exit_time;
+  }
+  return true;
+}
+
+void JobsList::ProcessLRMSBatches(void) {
+  Glib::Mutex::Lock lock(lrms_batches_lock);
+  for(std::list<LRMSBatch*>::iterator b = lrms_batches.begin(); b != lrms_batches.end();) {
+    LRMSBatch& batch = **b;
+    if(!batch.started && !batch.jobs.empty()) {
+      // Batch script counts as one script against limit
+      if(ScriptsLimitReached()) { ++b; continue; }
+      std::string cmd = Arc::ArcLocation::GetDataDir()+"/"+batch.operation+"-"+batch.lrms+"-jobs";
+      logger.msg(Arc::INFO,"Starting %s for %u jobs",cmd,(unsigned int)batch.jobs.size());
+      cmd += " --config " + config.ConfigFile();
+      for(std::list<JobId>::iterator id = batch.jobs.begin(); id != batch.jobs.end(); ++id) {
+        cmd += " " + config.ControlDir() + "/job." + (*id) + ".grami";
+      }
+      // Diagnostics specific to jobs are written into their .errors files by
+      // script itself. Rest goes to errors file of first job.
+      std::string errlog = config.ControlDir() + "/job." + batch.jobs.front() + ".errors";
+      LRMSBatchRef* ref = new LRMSBatchRef(*this, batch.jobs);
+      if(RunParallel::run(config, Arc::User(batch.uid, batch.gid), batch.jobs.front().c_str(), errlog,
+                          cmd, &(batch.child), &LRMSBatchRef::kicker, ref)) {
+        Glib::Mutex::Lock lock(counters_lock);
+        ++jobs_scripts;
+        batch.counted = true;
+      } else {
+        delete ref;
+        logger.msg(Arc::ERROR,"Failed running batch process for %u jobs",(unsigned int)batch.jobs.size());
+        batch.exit_time = Arc::Time();
+        // Let jobs notice failure
+        for(std::list<JobId>::iterator id = batch.jobs.begin(); id != batch.jobs.end(); ++id) {
+          RequestAttention(*id);
+        }
+      }
+      batch.started = true;
+    }
+    if(batch.child && batch.child->Running()) { ++b; continue; }
+    if(batch.counted) {
+      Glib::Mutex::Lock lock(counters_lock);
+      --jobs_scripts;
+      batch.counted = false;
+    }
+    if(batch.started) {
+      // Jobs removed from memory without cleaning would keep batch forever
+      for(std::list<JobId>::iterator id = batch.jobs.begin(); id != batch.jobs.end();) {
+        if(HasJob(*id)) { ++id; continue; }
+        lrms_batched_jobs.erase(*id);
+        id = batch.jobs.erase(id);
+      }
+    }
+    if(batch.jobs.empty()) {
+      RunParallel::release(batch.child);
+      delete *b;
+      b = lrms_batches.erase(b);
+      continue;
+    }
+    ++b;
   }
 }
 
@@ -498,8 +832,21 @@ bool JobsList::state_submitting_success(GMJobRef i,bool &state_changed,std::stri
 
 bool JobsList::state_submitting(GMJobRef i,bool &state_changed) {
   if(i->child == NULL) {
+    Arc::Time batch_exit_time;
+    if(InLRMSBatch(i,batch_exit_time)) {
+      // job is handled by batch script
+      if(batch_exit_time == Arc::Time(Arc::Time::UNDEFINED)) return true; // come later
+      // Batch script reports successful submission by storing local id
+      std::string local_id=job_desc_handler.get_local_id(i->job_id);
+      if(!local_id.empty()) return state_submitting_success(i,state_changed,local_id);
+      logger.msg(Arc::ERROR,"%s: Job submission to LRMS failed",i->job_id);
+      JobFailStateRemember(i,JOB_STATE_SUBMITTING);
+      CleanChildProcess(i);
+      i->AddFailure("Job submission to LRMS failed");
+      return false;
+    }
     // no child was running yet, or recovering from fault
-    if((config.MaxScripts()!=-1) && (jobs_scripts>=config.MaxScripts())) {
+    if(ScriptsLimitReached()) {
       //logger.msg(Arc::WARNING,"%s: Too many LRMS scripts running - limit is %u",
       //                     i->job_id,config.MaxScripts());
       // returning true but not advancing to next state should cause retry
@@ -530,6 +877,11 @@ bool JobsList::state_submitting(GMJobRef i,bool &state_changed) {
     // precreate file to store diagnostics from lrms
     job_diagnostics_mark_put(*i,config);
     job_lrmsoutput_mark_put(*i,config);
+    if(AddToLRMSBatch(i,"submit",job_desc->lrms)) {
+      logger.msg(Arc::INFO,"%s: state SUBMIT: assigned to batch submission",i->job_id);
+      job_errors_mark_put(*i,config);
+      return true;
+    }
     // submit job to LRMS using submit-X-job
     std::string cmd = Arc::ArcLocation::GetDataDir()+"/submit-"+job_desc->lrms+"-job";
     logger.msg(Arc::INFO,"%s: state SUBMIT: starting child: %s",i->job_id,cmd);
@@ -542,8 +894,11 @@ bool JobsList::state_submitting(GMJobRef i,bool &state_changed) {
       logger.msg(Arc::ERROR,"%s: Failed running submission process",i->job_id);
       return false;
     }
-    ++jobs_scripts;
-    if((config.MaxScripts()!=-1) && (jobs_scripts>=config.MaxScripts())) {
+    {
+      Glib::Mutex::Lock lock(counters_lock);
+      ++jobs_scripts;
+    };
+    if(ScriptsLimitReached()) {
       logger.msg(Arc::WARNING,"%s: LRMS scripts limit of %u is reached - suspending submit/cancel",
                               i->job_id,config.MaxScripts());
     }
@@ -599,8 +954,10 @@ bool JobsList::state_canceling_success(GMJobRef i,bool &state_changed) {
   // job diagnostics collection done in background (scan-*-job script)
   if(!job_lrms_mark_check(i->job_id,config)) {
     // job diag not yet collected - come later
-    if((i->child->ExitTime() != Arc::Time::UNDEFINED) &&
-       ((Arc::Time() - i->child->ExitTime()) > Arc::Period(Arc::Time::HOUR))) {
+    Arc::Time exit_time(Arc::Time::UNDEFINED);
+    if(i->child) exit_time = i->child->ExitTime(); else (void)InLRMSBatch(i,exit_time);
+    if((exit_time != Arc::Time::UNDEFINED) &&
+       ((Arc::Time() - exit_time) > Arc::Period(Arc::Time::HOUR))) {
       // it takes too long
       logger.msg(Arc::ERROR,"%s: state CANCELING: timeout waiting for cancellation",i->job_id);
       CleanChildProcess(i);
@@ -619,8 +976,16 @@ bool JobsList::state_canceling_success(GMJobRef i,bool &state_changed) {
 
 bool JobsList::state_canceling(GMJobRef i,bool &state_changed) {
   if(i->child == NULL) {
+    Arc::Time batch_exit_time;
+    if(InLRMSBatch(i,batch_exit_time)) {
+      // job is handled by batch script
+      if(batch_exit_time == Arc::Time(Arc::Time::UNDEFINED)) return true; // come later
+      // Batch script does not report result for every job. Rely on
+      // diagnostics being collected by scan-*-job like for lost child.
+      return state_canceling_success(i,state_changed);
+    }
     // no child was running yet, or recovering from fault
-    if((config.MaxScripts()!=-1) && (jobs_scripts>=config.MaxScripts())) {
+    if(ScriptsLimitReached()) {
       //logger.msg(Arc::WARNING,"%s: Too many LRMS scripts running - limit is %u",
       //                     i->job_id,config.MaxScripts());
       // returning true but not advancing to next state should cause retry
@@ -642,15 +1007,22 @@ bool JobsList::state_canceling(GMJobRef i,bool &state_changed) {
       state_changed=true;
       return true;
     }
+    job_errors_mark_put(*i,config);
+    if(AddToLRMSBatch(i,"cancel",job_desc->lrms)) {
+      logger.msg(Arc::INFO,"%s: state CANCELING: assigned to batch cancellation",i->job_id);
+      return true;
+    }
     std::string grami = config.ControlDir()+"/job."+(*i).job_id+".grami";
     cmd += " --config " + config.ConfigFile() + " " + grami;
-    job_errors_mark_put(*i,config);
     if(!RunParallel::run(config,*i,*this,NULL,cmd,&(i->child))) {
       logger.msg(Arc::ERROR,"%s: Failed running cancellation process",i->job_id);
       return false;
     }
-    ++jobs_scripts;
-    if((config.MaxScripts()!=-1) && (jobs_scripts>=config.MaxScripts())) {
+    {
+      Glib::Mutex::Lock lock(counters_lock);
+      ++jobs_scripts;
+    };
+    if(ScriptsLimitReached()) {
       logger.msg(Arc::WARNING,"%s: LRMS scripts limit of %u is reached - suspending submit/cancel",
                            i->job_id,config.MaxScripts());
     }
@@ -1370,15 +1742,18 @@ bool JobsList::CheckJobContinuePlugins(GMJobRef i) {
 bool JobsList::NextJob(GMJobRef i, job_state_t old_state, bool old_pending) {
   bool at_limit = RunningJobsLimitReached();
   // update counters
-  if(!old_pending) {
-    jobs_num[old_state]--;
-  } else {
-    jobs_pending--;
-  }
-  if(!i->job_pending) {
-    jobs_num[i->job_state]++;
-  } else {
-    jobs_pending++;
+  {
+    Glib::Mutex::Lock lock(counters_lock);
+    if(!old_pending) {
+      jobs_num[old_state]--;
+    } else {
+      jobs_pending--;
+    }
+    if(!i->job_pending) {
+      jobs_num[i->job_state]++;
+    } else {
+      jobs_pending++;
+    }
   }
   if(at_limit && !RunningJobsLimitReached()) {
     // Report about change in conditions
@@ -1390,10 +1765,13 @@ bool JobsList::NextJob(GMJobRef i, job_state_t old_state, bool old_pending) {
 bool JobsList::DropJob(GMJobRef& i, job_state_t old_state, bool old_pending) {
   bool at_limit = RunningJobsLimitReached();
   // update counters
-  if(!old_pending) {
-    jobs_num[old_state]--;
-  } else {
-    jobs_pending--;
+  {
+    Glib::Mutex::Lock lock(counters_lock);
+    if(!old_pending) {
+      jobs_num[old_state]--;
+    } else {
+      jobs_pending--;
+    }
   }
   if(at_limit && !RunningJobsLimitReached()) {
     // Report about change in conditions
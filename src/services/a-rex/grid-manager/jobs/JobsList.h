@@ -3,8 +3,10 @@
 
 #include <sys/types.h>
 #include <list>
+#include <set>
 #include <glib.h>
 
+#include <arc/DateTime.h>
 #include <arc/Thread.h>
 
 #include "../conf/StagingConfig.h"
@@ -12,6 +14,7 @@
 #include "GMJob.h"
 #include "JobDescriptionHandler.h"
 #include "DTRGenerator.h"
+#include "JobsStatistics.h"
 
 namespace ARex {
 
@@ -62,6 +65,28 @@ class JobsList {
 
   GMJobQueue jobs_wait_for_running; // List of jobs waiting for limit on running jobs
 
+  // Jobs currently being processed by one of processing threads and jobs
+  // which were requested for processing while being processed already.
+  // Both are protected by jobs_busy_lock.
+  std::set<JobId> jobs_busy;
+  std::map<JobId,GMJobRef> jobs_deferred;
+  Glib::Mutex jobs_busy_lock;
+  // State of processing threads pool, also protected by jobs_busy_lock.
+  // Threads are started once and are waiting on processing_cond for
+  // processing round to begin.
+  Glib::Cond processing_cond;
+  Arc::SimpleCounter processing_threads;
+  int processing_threads_num;  // number of started threads
+  int processing_active;       // number of threads processing job right now
+  bool processing_round;       // main thread is processing jobs
+  bool processing_stop;        // threads must exit
+
+  // Protects jobs_num, jobs_pending and jobs_scripts
+  mutable Glib::Mutex counters_lock;
+  // Serializes processing of jobs for which decision to advance state
+  // depends on limits. Otherwise multiple threads could pass same limit
+  // check before counters are updated.
+  Glib::Mutex limits_lock;
 
   time_t job_slow_polling_last;
   static time_t const job_slow_polling_period = 24UL*60UL*60UL; // todo: variable
@@ -78,6 +103,25 @@ class JobsList {
   // number of jobs for every state
   int jobs_num[JOB_STATE_NUM];
   int jobs_scripts;
+  // Jobs waiting for or being handled by single invocation of batch
+  // submission/cancellation script. Scripts are named <operation>-<lrms>-jobs
+  // and accept grami files of multiple jobs. Backends which do not provide
+  // such scripts are handled by per-job scripts as before.
+  struct LRMSBatch {
+    std::string operation; // submit or cancel
+    std::string lrms;
+    uid_t uid;
+    gid_t gid;
+    std::list<JobId> jobs;
+    bool started;
+    bool counted;          // is counted in jobs_scripts
+    Arc::Run* child;
+    Arc::Time exit_time;
+  };
+  std::list<LRMSBatch*> lrms_batches;
+  std::map<JobId,LRMSBatch*> lrms_batched_jobs;
+  std::map<std::string,bool> lrms_batch_supported;
+  Glib::Mutex lrms_batches_lock;
   // map of number of active jobs for each DN
   std::map<std::string, ZeroUInt> jobs_dn;
   // number of jobs currently in pending state
@@ -95,6 +139,14 @@ class JobsList {
 
   // Cleaning reference to running child process
   void CleanChildProcess(GMJobRef i);
+  // Assign job to batch of LRMS operations if backend supports batches.
+  // Returns false if job has to be handled individually.
+  bool AddToLRMSBatch(GMJobRef i,const std::string& operation,const std::string& lrms);
+  // Returns true if job is assigned to batch. If batch script already
+  // exited exit_time is set to time of exit, otherwise it is undefined.
+  bool InLRMSBatch(GMJobRef i,Arc::Time& exit_time);
+  // Start collected batches and release finished ones
+  void ProcessLRMSBatches(void);
   // Remove Job from list. All corresponding files are deleted and pointer is
   // advanced. If finished is false - job is not destroyed if it is FINISHED
   // If active is false - job is not destroyed if it is not UNDEFINED. Returns
@@ -193,6 +245,24 @@ class JobsList {
   // Call ActJob for all jobs in processing queue
   bool ActJobsProcessing(void);
 
+  // Pick one job from processing queue and call ActJob for it. Must be
+  // called with jobs_busy_lock locked, the lock is released while job is
+  // processed. Returns false if queue is empty. Can be run by multiple
+  // threads simultaneously.
+  bool ActJobsProcessingStep(void);
+
+  // Body of processing thread. Runs ActJobsProcessingStep while main
+  // thread is in processing round and waits for next round otherwise.
+  void ActJobsProcessingWorker(void);
+
+  static void ActJobsProcessingThread(void* arg);
+
+  // Returns true if processing of job in its current state checks limits
+  bool IsLimitedState(GMJobRef i) const;
+
+  // Limit on number of simultaneously running LRMS scripts
+  bool ScriptsLimitReached(void) const;
+
   // Inform this instance that job with specified id needs immediate re-processing
   bool RequestReprocess(GMJobRef i);
 
@@ -281,6 +351,12 @@ class JobsList {
   int AcceptedJobs() const;
   // No of jobs in batch system or in process of submission to batch system
   bool RunningJobsLimitReached() const;
+  // Counters of jobs per state and per share for information system.
+  // Must be called from thread processing jobs.
+  void CollectStatistics(JobsStatistics& stats) const;
+  // Write state and local description of all jobs in memory to file
+  // for information provider. Must be called from thread processing jobs.
+  bool WriteJobsInfo(const std::string& fname) const;
   // No of jobs in data staging
   //int ProcessingJobs() const;
   // No of jobs staging in data before job execution
@@ -0,0 +1,106 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <time.h>
+
+#include <arc/StringConv.h>
+
+#include "JobsStatistics.h"
+
+namespace ARex {
+
+JobsStatistics::Counters::Counters(void):
+    undefined(0), accepted(0), preparing(0), inlrms(0), finishing(0) {
+}
+
+void JobsStatistics::Counters::Add(job_state_t state, bool pending) {
+  switch(state) {
+    case JOB_STATE_ACCEPTED: ++accepted; break;
+    case JOB_STATE_PREPARING: ++preparing; break;
+    case JOB_STATE_SUBMITTING: ++preparing; break;
+    case JOB_STATE_INLRMS: if(pending) ++finishing; else ++inlrms; break;
+    case JOB_STATE_FINISHING: ++finishing; break;
+    case JOB_STATE_CANCELING: ++finishing; break;
+    case JOB_STATE_FINISHED: break;
+    case JOB_STATE_DELETED: break;
+    default: ++undefined; break;
+  };
+}
+
+bool JobsStatistics::Counters::operator==(const Counters& other) const {
+  return (undefined == other.undefined) && (accepted == other.accepted) &&
+         (preparing == other.preparing) && (inlrms == other.inlrms) &&
+         (finishing == other.finishing);
+}
+
+JobsStatistics::JobsStatistics(void):time_(::time(NULL)) {
+}
+
+void JobsStatistics::Add(job_state_t state, bool pending, const std::string& share, const std::string& vo) {
+  total_.Add(state, pending);
+  shares_[share].Add(state, pending);
+  if(!vo.empty()) shares_[share+"_"+vo].Add(state, pending);
+}
+
+bool JobsStatistics::operator==(const JobsStatistics& other) const {
+  if(total_ != other.total_) return false;
+  if(shares_.size() != other.shares_.size()) return false;
+  std::map<std::string,Counters>::const_iterator s = shares_.begin();
+  std::map<std::string,Counters>::const_iterator os = other.shares_.begin();
+  for(;s != shares_.end();++s,++os) {
+    if(s->first != os->first) return false;
+    if(s->second != os->second) return false;
+  };
+  return true;
+}
+
+bool JobsStatistics::ServiceCounter(const std::string& name, unsigned int& value) const {
+  if(name == "TotalJobs") value = total_.NotFinished();
+  else if(name == "StagingJobs") value = total_.Staging();
+  else if(name == "PreLRMSWaitingJobs") value = total_.undefined + total_.accepted;
+  else return false;
+  return true;
+}
+
+bool JobsStatistics::ShareCounter(const std::string& share, const std::string& name, unsigned int& value) const {
+  static const Counters empty;
+  std::map<std::string,Counters>::const_iterator counters = shares_.find(share);
+  const Counters& c = (counters != shares_.end()) ? counters->second : empty;
+  // Share's TotalJobs also includes jobs submitted to LRMS
+  // directly and hence is left as computed by information provider.
+  if(name == "StagingJobs") value = c.Staging();
+  else if(name == "PreLRMSWaitingJobs") value = c.NotSubmitted();
+  else return false;
+  return true;
+}
+
+static void SetCounter(Arc::XMLNode node, unsigned int value) {
+  if((bool)node) node = Arc::tostring(value);
+}
+
+static const char* const service_counters[] = { "TotalJobs", "StagingJobs", "PreLRMSWaitingJobs", NULL };
+static const char* const share_counters[] = { "StagingJobs", "PreLRMSWaitingJobs", NULL };
+
+void JobsStatistics::Apply(Arc::XMLNode glue2) const {
+  Arc::XMLNode service = glue2["Domains"]["AdminDomain"]["Services"]["ComputingService"];
+  for(;(bool)service;++service) {
+    for(int n = 0; service_counters[n]; ++n) {
+      unsigned int value = 0;
+      if(!ServiceCounter(service_counters[n], value)) continue;
+      SetCounter(service[service_counters[n]], value);
+      for(Arc::XMLNode endpoint = service["ComputingEndpoint"];(bool)endpoint;++endpoint) {
+        SetCounter(endpoint[service_counters[n]], value);
+      };
+    };
+    for(Arc::XMLNode share = service["ComputingShare"];(bool)share;++share) {
+      for(int n = 0; share_counters[n]; ++n) {
+        unsigned int value = 0;
+        if(!ShareCounter((std::string)(share["Name"]), share_counters[n], value)) continue;
+        SetCounter(share[share_counters[n]], value);
+      };
+    };
+  };
+}
+
+} // namespace ARex
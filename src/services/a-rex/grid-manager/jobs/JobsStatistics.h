@@ -0,0 +1,72 @@
+#ifndef GRID_MANAGER_JOBS_STATISTICS_H
+#define GRID_MANAGER_JOBS_STATISTICS_H
+
+#include <string>
+#include <map>
+#include <list>
+
+#include <arc/XMLNode.h>
+
+#include "GMJob.h"
+
+namespace ARex {
+
+/// How often counters of jobs for information system are refreshed (seconds)
+#define JOBS_STATS_PERIOD 30
+
+/// File in control directory to which jobs processing writes information
+/// about jobs it holds in memory. It is consumed by information provider
+/// instead of reading control files of those jobs.
+#define JOBS_INFO_FILE "info.jobs"
+
+/// Counters of jobs handled by A-REX, collected from in-memory job list.
+/** Jobs are counted in same categories as information provider does for
+  GLUE2 rendering, so values can directly replace those computed by
+  information provider from control files. Only jobs which have not
+  reached FINISHED state are tracked in memory, hence only counters
+  related to active jobs are available. */
+class JobsStatistics {
+ public:
+  class Counters {
+   public:
+    unsigned int undefined;
+    unsigned int accepted;   // ACCEPTED, PENDING:ACCEPTED
+    unsigned int preparing;  // PREPARING, PENDING:PREPARING, SUBMIT
+    unsigned int inlrms;     // INLRMS
+    unsigned int finishing;  // PENDING:INLRMS, FINISHING, CANCELING
+    Counters(void);
+    void Add(job_state_t state, bool pending);
+    /// Jobs not yet finished
+    unsigned int NotFinished(void) const { return undefined + accepted + preparing + inlrms + finishing; };
+    /// Jobs not yet passed to LRMS
+    unsigned int NotSubmitted(void) const { return undefined + accepted + preparing; };
+    /// Jobs transferring input or output files
+    unsigned int Staging(void) const { return preparing + finishing; };
+    bool operator==(const Counters& other) const;
+    bool operator!=(const Counters& other) const { return !operator==(other); };
+  };
+  JobsStatistics(void);
+  /// Count job in total and in share it belongs to. The vo is first VOMS
+  /// FQAN of job owner and is used to count job also in VO specific share.
+  void Add(job_state_t state, bool pending, const std::string& share, const std::string& vo);
+  /// Replace job counters in GLUE2 document with values from this object
+  void Apply(Arc::XMLNode glue2) const;
+  /// Value of named counter of ComputingService or its ComputingEndpoint.
+  /// Returns false if counter is not provided by this object.
+  bool ServiceCounter(const std::string& name, unsigned int& value) const;
+  /// Value of named counter of ComputingShare with specified name.
+  /// Returns false if counter is not provided by this object.
+  bool ShareCounter(const std::string& share, const std::string& name, unsigned int& value) const;
+  /// Time when statistics was collected
+  time_t Time(void) const { return time_; };
+  bool operator==(const JobsStatistics& other) const;
+  bool operator!=(const JobsStatistics& other) const { return !operator==(other); };
+ private:
+  Counters total_;
+  std::map<std::string,Counters> shares_;
+  time_t time_;
+};
+
+} // namespace ARex
+
+#endif // GRID_MANAGER_JOBS_STATISTICS_H
@@ -82,7 +82,7 @@ bool send_mail(GMJob &job,const GMConfig& config) {
     return false;
   };
   child->Abandon();
-  delete child;
+  RunParallel::release(child);
   return true;
 }
 
@@ -7,9 +7,12 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#include <map>
+
 #include <arc/Logger.h>
 #include <arc/Utils.h>
 #include <arc/FileUtils.h>
+#include <arc/JobPerfLog.h>
 
 #include "../conf/GMConfig.h"
 #include "RunParallel.h"
@@ -36,6 +39,42 @@ void JobRefInList::kicker(void* arg) {
   };
 }
 
+// Records time from start till exit of child process into trace
+// and then passes control to original kicker. Kicker is not called
+// if child process object is destroyed before process exits, hence
+// instances are kept in traces and destroyed by RunParallel::release.
+class RunTrace {
+ private:
+  Arc::JobPerfRecord record;
+  std::string name;
+  void (*kicker_func)(void*);
+  void* kicker_arg;
+ public:
+  RunTrace(Arc::JobPerfLog& log, const std::string& args, const char* procid,
+           void (*kicker_func)(void*), void* kicker_arg);
+  static void kicker(void* arg);
+};
+
+static Glib::Mutex traces_lock;
+static std::map<Arc::Run*,RunTrace*> traces;
+
+RunTrace::RunTrace(Arc::JobPerfLog& log, const std::string& args, const char* procid,
+                   void (*kicker_func)(void*), void* kicker_arg):
+    record(log, procid?procid:""), kicker_func(kicker_func), kicker_arg(kicker_arg) {
+  std::string cmd = args.substr(0, args.find(' '));
+  std::string::size_type p = cmd.rfind('/');
+  if(p != std::string::npos) cmd.erase(0, p+1);
+  name = "script:" + cmd;
+}
+
+void RunTrace::kicker(void* arg) {
+  RunTrace* trace = reinterpret_cast<RunTrace*>(arg);
+  if(trace) {
+    trace->record.Trace(trace->name);
+    if(trace->kicker_func) (*(trace->kicker_func))(trace->kicker_arg);
+  };
+}
+
 bool RunParallel::run(const GMConfig& config,const GMJob& job, JobsList& list, std::string* errstr,
                       const std::string& args,Arc::Run** ere,bool su) {
   std::string errlog = config.ControlDir()+"/job."+job.get_id()+".errors";
@@ -56,6 +95,13 @@ bool RunParallel::run(const GMConfig& config,const GMJob& job, std::string* errs
   return result;
 }
 
+bool RunParallel::run(const GMConfig& config, const Arc::User& user, const char* procid,
+                      const std::string& errlog, const std::string& args, Arc::Run** ere,
+                      void (*kicker_func)(void*), void* kicker_arg, bool su) {
+  return run(config, user, procid, errlog.c_str(), NULL,
+             args, ere, NULL, su, kicker_func, kicker_arg);
+}
+
 /* fork & execute child process with stderr redirected 
    to job.ID.errors, stdin and stdout to /dev/null */
 bool RunParallel::run(const GMConfig& config, const Arc::User& user,
@@ -70,6 +116,13 @@ bool RunParallel::run(const GMConfig& config, const Arc::User& user,
     logger.msg(Arc::ERROR,"%s: Failure creating slot for child process",procid?procid:"");
     return false;
   };
+  RunTrace* trace = NULL;
+  Arc::JobPerfLog* perf_log = config.GetJobPerfLog();
+  if(perf_log && perf_log->GetTraceEnabled()) {
+    trace = new RunTrace(*perf_log, args, procid, kicker_func, kicker_arg);
+    kicker_func = &RunTrace::kicker;
+    kicker_arg = trace;
+  };
   if(kicker_func) re->AssignKicker(kicker_func,kicker_arg);
   re->AssignInitializer(&initializer,(void*)errlog,false);
   if(su) {
@@ -116,13 +169,36 @@ bool RunParallel::run(const GMConfig& config, const Arc::User& user,
   re->KeepStderr(true);
   if(!re->Start()) {
     delete re;
+    delete trace;
     logger.msg(Arc::ERROR,"%s: Failure starting child process",procid?procid:"");
     return false;
   };
+  if(trace) {
+    Glib::Mutex::Lock lock(traces_lock);
+    traces[re] = trace;
+  };
   *ere=re;
   return true;
 }
 
+void RunParallel::release(Arc::Run*& ere) {
+  if(!ere) return;
+  RunTrace* trace = NULL;
+  {
+    Glib::Mutex::Lock lock(traces_lock);
+    std::map<Arc::Run*,RunTrace*>::iterator t = traces.find(ere);
+    if(t != traces.end()) {
+      trace = t->second;
+      traces.erase(t);
+    };
+  };
+  // Once child process object is destroyed its kicker is either
+  // finished or will never be called.
+  delete ere;
+  ere = NULL;
+  delete trace;
+}
+
 void RunParallel::initializer(void* arg) {
   // child
   char const * errlog = (char const *)arg;
@@ -27,6 +27,14 @@ class RunParallel {
   static bool run(const GMConfig& config, const GMJob& job, std::string* errstr,
                   const std::string& args, Arc::Run**,
                   bool su = true);
+  /// Run child process not associated with single job (like batch of LRMS
+  /// operations). The kicker_func is called with kicker_arg when process exits.
+  static bool run(const GMConfig& config, const Arc::User& user, const char* procid,
+                  const std::string& errlog, const std::string& args, Arc::Run**,
+                  void (*kicker_func)(void*), void* kicker_arg, bool su = true);
+  /// Destroy child process object created by run() and data associated
+  /// with it. Must be used instead of deleting object directly.
+  static void release(Arc::Run*& ere);
 };
 
 } // namespace ARex
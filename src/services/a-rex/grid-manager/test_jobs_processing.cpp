@@ -0,0 +1,193 @@
+// -*- indent-tabs-mode: nil -*-
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <iostream>
+
+#include <glibmm.h>
+
+#include <arc/OptionParser.h>
+#include <arc/IString.h>
+#include <arc/Logger.h>
+#include <arc/DateTime.h>
+#include <arc/FileUtils.h>
+#include <arc/StringConv.h>
+#include <arc/JobPerfLog.h>
+
+#include "conf/GMConfig.h"
+#include "jobs/GMJob.h"
+#include "jobs/JobsList.h"
+#include "files/ControlFileContent.h"
+#include "files/ControlFileHandling.h"
+
+// Stress test for job processing. Creates many jobs which look like
+// finished in LRMS and lets JobsList move them through FINISHING to
+// FINISHED exactly like A-REX does after restart. Then checks every
+// job went through each state exactly once and counters are balanced.
+
+static Arc::Logger logger(Arc::Logger::getRootLogger(), "test_jobs_processing");
+
+static bool WriteConfig(const std::string& fname, const std::string& tmpdir, int threads) {
+  std::ofstream conf(fname.c_str());
+  if(!conf) return false;
+  conf << "[arex]" << std::endl;
+  conf << "controldir=" << tmpdir << "/control" << std::endl;
+  conf << "sessiondir=" << tmpdir << "/session" << std::endl;
+  conf << "processingthreads=" << threads << std::endl;
+  conf << "maxjobs=-1 10 -1 -1 -1" << std::endl;
+  conf << "[lrms]" << std::endl;
+  conf << "lrms=fork" << std::endl;
+  return (bool)conf;
+}
+
+static bool CreateJob(const ARex::GMConfig& config, const ARex::JobId& id) {
+  std::string sessiondir = config.SessionRoots().front() + "/" + id;
+  if(::mkdir(sessiondir.c_str(), S_IRWXU) != 0) return false;
+  ARex::GMJob job(id, Arc::User(), sessiondir, ARex::JOB_STATE_INLRMS);
+  ARex::JobLocalDescription local;
+  local.jobid = id;
+  local.globalid = id;
+  local.lrms = "fork";
+  local.queue = "fork";
+  local.DN = "/CN=test user " + Arc::tostring(rand() % 10);
+  local.sessiondir = sessiondir;
+  local.lifetime = "3600";
+  std::list<ARex::FileData> nofiles;
+  if(!ARex::job_local_write_file(job, config, local)) return false;
+  if(!ARex::job_output_write_file(job, config, nofiles)) return false;
+  if(!ARex::job_mark_write(config.ControlDir() + "/job." + id + ".lrms_done", "0 Job finished")) return false;
+  return ARex::job_state_write_file(job, config, ARex::JOB_STATE_INLRMS, false);
+}
+
+static int CountTransitions(const ARex::GMConfig& config, const ARex::JobId& id, const std::string& to) {
+  std::ifstream errors(ARex::job_errors_filename(id, config).c_str());
+  std::string line;
+  int count = 0;
+  while(std::getline(errors, line)) {
+    if(line.find("Job state change") == std::string::npos) continue;
+    std::string::size_type p = line.find("-> ");
+    if(p == std::string::npos) continue;
+    if(line.compare(p+3, to.length()+1, to+" ") == 0) ++count;
+  }
+  return count;
+}
+
+int main(int argc, char **argv) {
+
+  Arc::LogStream logcerr(std::cerr);
+  Arc::Logger::getRootLogger().addDestination(logcerr);
+  Arc::Logger::getRootLogger().setThreshold(Arc::WARNING);
+
+  Arc::OptionParser options("",
+                            istring("Stress test for A-REX job processing with many simultaneous jobs."));
+
+  int jobs_num = 500;
+  options.AddOption('n', "jobs",
+                    istring("Number of jobs to process"),
+                    istring("number"), jobs_num);
+
+  int threads = 8;
+  options.AddOption('t', "threads",
+                    istring("Number of processing threads"),
+                    istring("number"), threads);
+
+  int timeout = 600;
+  options.AddOption('w', "timeout",
+                    istring("Maximal time to wait for jobs to be processed"),
+                    istring("seconds"), timeout);
+
+  std::string debug;
+  options.AddOption('d', "debug",
+                    istring("FATAL, ERROR, WARNING, INFO, VERBOSE or DEBUG"),
+                    istring("debuglevel"), debug);
+
+  options.Parse(argc, argv);
+  if (!debug.empty()) Arc::Logger::getRootLogger().setThreshold(Arc::string_to_level(debug));
+
+  std::string tmpdir;
+  if(!Arc::TmpDirCreate(tmpdir)) {
+    logger.msg(Arc::ERROR, "Failed to create temporary directory");
+    return 1;
+  }
+  std::string conffile = tmpdir + "/arc.conf";
+  if(!WriteConfig(conffile, tmpdir, threads)) {
+    logger.msg(Arc::ERROR, "Failed to write configuration file %s", conffile);
+    return 1;
+  }
+  ARex::GMConfig config(conffile);
+  if(!config.Load()) {
+    logger.msg(Arc::ERROR, "Failed to load configuration file %s", conffile);
+    return 1;
+  }
+  Arc::JobPerfLog perf_log;
+  config.SetJobPerfLog(&perf_log);
+  if(!config.CreateControlDirectory() ||
+     !Arc::DirCreate(config.SessionRoots().front(), S_IRWXU, true)) {
+    logger.msg(Arc::ERROR, "Failed to create directories in %s", tmpdir);
+    return 1;
+  }
+
+  std::list<ARex::JobId> ids;
+  for(int n = 0; n < jobs_num; ++n) {
+    ARex::JobId id = "stress" + Arc::tostring(n);
+    if(!CreateJob(config, id)) {
+      logger.msg(Arc::ERROR, "Failed to create job %s", id);
+      return 1;
+    }
+    ids.push_back(id);
+  }
+
+  int result = 0;
+  {
+    ARex::JobsList jobs(config);
+    if(!jobs) {
+      logger.msg(Arc::ERROR, "Failed to create jobs list");
+      return 1;
+    }
+    Arc::Time start;
+    jobs.RestartJobs();
+    jobs.ScanNewJobs();
+    // Same calls as main loop of grid manager but without waiting
+    // for external events.
+    bool picked = false;
+    for(;;) {
+      jobs.ActJobsAttention();
+      jobs.ActJobsPolling();
+      if(jobs.AcceptedJobs() > 0) picked = true;
+      if(picked && (jobs.AcceptedJobs() == 0)) break;
+      if((Arc::Time() - start) > Arc::Period(timeout)) {
+        logger.msg(Arc::ERROR, "Jobs not processed in %i seconds, %i still active",
+                   timeout, jobs.AcceptedJobs());
+        result = 1;
+        break;
+      }
+      Glib::usleep(10000);
+    }
+    std::cout << jobs_num << " jobs processed by " << threads << " threads in "
+              << (Arc::Time() - start) << std::endl;
+  }
+
+  for(std::list<ARex::JobId>::iterator id = ids.begin(); id != ids.end(); ++id) {
+    if(ARex::job_state_read_file(*id, config) != ARex::JOB_STATE_FINISHED) {
+      logger.msg(Arc::ERROR, "%s: job is not FINISHED", *id);
+      result = 1;
+      continue;
+    }
+    // Job processed by two threads at once would register transitions twice
+    if((CountTransitions(config, *id, "FINISHING") != 1) ||
+       (CountTransitions(config, *id, "FINISHED") != 1)) {
+      logger.msg(Arc::ERROR, "%s: job has unexpected state transitions", *id);
+      result = 1;
+    }
+  }
+
+  Arc::DirDelete(tmpdir, true);
+  if(result == 0) std::cout << "All jobs processed correctly" << std::endl;
+  return result;
+}
@@ -83,14 +83,69 @@ sub switchEffectiveUser {
     };
 }
 
+# Stores value from .local file into job hash
+sub add_local_value {
+    my ($job, $name, $value) = @_;
+    # TODO: multiple activityid support. 
+    # is this still used? if not, remove the code.
+    # looking at trunk it doesn't seem to exist anymore.
+    if ($name eq "activityid") {
+        push @{$job->{activityid}}, $value;
+    } elsif ($name eq "voms") {
+        # a job can belong to a user that has multiple voms roles
+        # for completeness all added to the datastructure 
+        # in an array
+        push @{$job->{voms}}, $value;
+        # vomsvo to hold the selected vo, I assume is the first in the list.
+        # will be used to calculate vo statistics
+        # must match advertised (i.e. slashes are removed)
+        unless (defined $job->{vomsvo}) {
+            my $vostring = $value;
+            if ($vostring =~ /^\/+(\w+)/) { $vostring = $1;  };
+            $job->{vomsvo} = $vostring;
+        }
+    } else {
+        $job->{$name} = $value;
+    }
+}
+
+# Reads information about jobs which A-REX holds in memory. Every job
+# starts with 'job=ID' line followed by its state, owner and content of
+# its .local file. Returns reference to hash of jobs indexed by ID.
+sub read_jobsinfo {
+    my ($jobsinfo) = @_;
+
+    my %jobs;
+    unless (open (JOBSINFO, "<$jobsinfo")) {
+        $log->warning("Can't read information about active jobs from $jobsinfo");
+        return {};
+    }
+    my $job;
+    while (my $line = <JOBSINFO>) {
+        next unless $line =~ m/^(\w+)=(.+)$/;
+        my ($name, $value) = ($1, $2);
+        if ($name eq "job") {
+            $job = $jobs{$value} = { activityid => [] };
+        } elsif ($job) {
+            add_local_value($job, $name, $value);
+        }
+    }
+    close JOBSINFO;
+    $log->verbose("Found ". scalar(keys %jobs). " active jobs in $jobsinfo");
+    return \%jobs;
+}
+
 sub collect {
-    my ($controls, $remotegmdirs, $nojobs) = @_;
+    my ($controls, $remotegmdirs, $nojobs, $jobsinfo) = @_;
+
+    # Jobs known to A-REX are taken from its memory instead of control files
+    my $activejobs = $jobsinfo ? read_jobsinfo($jobsinfo) : {};
 
     my $gmjobs = {};
     while (my ($user, $control) = each %$controls) {
         switchEffectiveUser($user);
         my $controldir = $control->{controldir};
-        my $newjobs = get_gmjobs($controldir, $nojobs);
+        my $newjobs = get_gmjobs($controldir, $nojobs, $activejobs);
         $newjobs->{$_}{gmuser} = $user for keys %$newjobs;
         $gmjobs->{$_} = $newjobs->{$_} for keys %$newjobs;
     }
@@ -115,7 +170,8 @@ sub collect {
 
 sub get_gmjobs {
 
-    my ($controldir, $nojobs) = @_;
+    my ($controldir, $nojobs, $activejobs) = @_;
+    $activejobs ||= {};
 
     my %gmjobs;
 
@@ -150,45 +206,30 @@ sub get_gmjobs {
         my $gmjob_grami       = $controldir."/job.".$ID.".grami";
         my $gmjob_diag        = $controldir."/job.".$ID.".diag";
 
-        unless ( open (GMJOB_LOCAL, "<$gmjob_local") ) {
-            $log->debug( "Job $ID: Can't read jobfile $gmjob_local, skipping job" );
-            delete $gmjobs{$ID};
-            $jobsskipped++;
-            next;
-        }
-        my @local_allines = <GMJOB_LOCAL>;
-
-        $job->{activityid} = [];
-
-        # parse the content of the job.ID.local into the %gmjobs hash
-        foreach my $line (@local_allines) {
-            if ($line=~m/^(\w+)=(.+)$/) {
-                # TODO: multiple activityid support. 
-                # is this still used? if not, remove the code.
-                # looking at trunk it doesn't seem to exist anymore.
-                if ($1 eq "activityid") {
-                    push @{$job->{activityid}}, $2;
-                } else {
-                    # a job can belong to a user that has multiple voms roles
-                    # for completeness all added to the datastructure 
-                    # in an array
-                    if ($1 eq "voms") {
-                       push @{$job->{voms}}, $2;
-                       # vomsvo to hold the selected vo, I assume is the first in the list.
-                       # will be used to calculate vo statistics
-                       # must match advertised (i.e. slashes are removed)
-                       unless (defined $job->{vomsvo}) {
-                           my $vostring = $2;
-                           if ($vostring =~ /^\/+(\w+)/) { $vostring = $1;  };
-                           $job->{vomsvo} = $vostring;
-                       }
-                    } else {
-                       $job->{$1}=$2;
-                    }
+        # Jobs which finished meanwhile are not in memory anymore
+        my $activejob = ($controlsubdir ne "$controldir/finished") ? $activejobs->{$ID} : undef;
+        if ($activejob) {
+            # State and content of .local are already known
+            %$job = %$activejob;
+        } else {
+            unless ( open (GMJOB_LOCAL, "<$gmjob_local") ) {
+                $log->debug( "Job $ID: Can't read jobfile $gmjob_local, skipping job" );
+                delete $gmjobs{$ID};
+                $jobsskipped++;
+                next;
+            }
+            my @local_allines = <GMJOB_LOCAL>;
+
+            $job->{activityid} = [];
+
+            # parse the content of the job.ID.local into the %gmjobs hash
+            foreach my $line (@local_allines) {
+                if ($line=~m/^(\w+)=(.+)$/) {
+                    add_local_value($job, $1, $2);
                 }
             }
+            close GMJOB_LOCAL;
         }
-        close GMJOB_LOCAL;
 
         # Extrasct jobID uri
         if ($job->{globalid}) {
@@ -211,7 +252,9 @@ sub get_gmjobs {
         }
         
         # read the job.ID.status into "status"
-        unless (open (GMJOB_STATUS, "<$gmjob_status")) {
+        if ($activejob) {
+            $job->{"statusread"} = time();
+        } elsif (not open (GMJOB_STATUS, "<$gmjob_status")) {
             $log->debug("Job $ID: Can't open status file $gmjob_status, skipping job");
             delete $gmjobs{$ID};
             $jobsskipped++;
@@ -0,0 +1,58 @@
+#!/usr/bin/perl
+
+use strict;
+use File::Temp qw(tempdir);
+use Test::More tests => 9;
+
+use GMJobsInfo;
+
+LogUtils::level('ERROR');
+
+my $controldir = tempdir(CLEANUP => 1);
+mkdir "$controldir/$_" for qw(accepting processing finished);
+
+sub write_file {
+    my ($name, $content) = @_;
+    open my $fh, '>', $name or die "Can't write $name: $!";
+    print $fh $content;
+    close $fh;
+}
+
+# Job held in memory by A-REX - its control files are outdated
+write_file("$controldir/processing/job.active.status", "PREPARING\n");
+write_file("$controldir/job.active.local", "queue=old\nsubject=/CN=old\n");
+# Job which finished after A-REX wrote information about it
+write_file("$controldir/finished/job.done.status", "FINISHED\n");
+write_file("$controldir/job.done.local", "queue=q2\nsubject=/CN=done\n");
+# Job not yet picked up by A-REX
+write_file("$controldir/accepting/job.new.status", "ACCEPTED\n");
+write_file("$controldir/job.new.local", "queue=q1\nsubject=/CN=new\n");
+
+write_file("$controldir/info.jobs", <<ENDJOBS);
+job=active
+status=INLRMS
+localowner=griduser
+queue=q1
+localid=1234
+subject=/CN=user
+voms=/vo1/Role=NULL
+voms=/vo2
+
+job=done
+status=INLRMS
+queue=q2
+ENDJOBS
+
+my $jobs = GMJobsInfo::collect({ '.' => { controldir => $controldir } }, undef, 1, "$controldir/info.jobs");
+
+is(scalar keys %$jobs, 3, "all jobs found");
+is($jobs->{active}{status}, 'INLRMS', "state of active job taken from A-REX");
+is($jobs->{active}{share}, 'q1', "share of active job taken from A-REX");
+is($jobs->{active}{localid}, '1234', "local id of active job");
+is($jobs->{active}{localowner}, 'griduser', "owner of active job");
+is($jobs->{active}{vomsvo}, 'vo1', "first VO of active job");
+is($jobs->{done}{status}, 'FINISHED', "finished job read from control directory");
+is($jobs->{new}{subject}, '/CN=new', "job unknown to A-REX read from control directory");
+
+$jobs = GMJobsInfo::collect({ '.' => { controldir => $controldir } }, undef, 1);
+is($jobs->{active}{status}, 'PREPARING', "control files used without information from A-REX");
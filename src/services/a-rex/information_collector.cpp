@@ -11,8 +11,10 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <time.h>
+#include <string.h>
 
 #include <glibmm.h>
+#include <libxml/parser.h>
 
 #include <arc/ArcLocation.h>
 #include <arc/Run.h>
@@ -25,6 +27,339 @@
 
 namespace ARex {
 
+// Stores output of information provider into temporary file as it
+// arrives and scans it on the fly for values needed by A-REX itself
+// and for positions of elements A-REX modifies before publishing.
+// So whole document never has to be kept in memory.
+class InfoDocumentCollector: public Arc::Run::Data {
+ public:
+  InfoDocumentCollector(const std::string& filename);
+  virtual ~InfoDocumentCollector(void);
+  virtual void Append(char const* data, unsigned int size);
+  virtual void Remove(unsigned int /* size */) { };
+  virtual char const* Get() const { return head_.c_str(); };
+  virtual unsigned int Size() const { return size_; };
+  // Complete processing. Returns false if document could not be stored
+  // or is not well-formed XML.
+  bool Finish(void);
+  // Name of temporary file. File is removed in destructor unless Release() is called.
+  const std::string& Filename(void) const { return tmpname_; };
+  void Release(void) { tmpname_.clear(); };
+  // Beginning of document for logging
+  const std::string& Head(void) const { return head_; };
+  // Value of ComputingService/AllJobs if present
+  bool AllJobs(unsigned int& count) const;
+  // Elements to be modified. Only valid if Finish() succeeded and
+  // SlotsResolved() returns true.
+  const std::list<InfoDocumentTemplate::Slot>& Slots(void) const { return slots_; };
+  bool SlotsResolved(void) const { return slots_resolved_; };
+ private:
+  static const unsigned int head_size_ = 100;
+  std::string tmpname_;
+  int h_;
+  unsigned int size_;
+  std::string head_;
+  bool failed_;
+  xmlParserCtxtPtr parser_;
+  // Names of currently open elements starting from root
+  std::vector<std::string> path_;
+  bool all_jobs_found_;
+  std::string all_jobs_;
+  std::list<InfoDocumentTemplate::Slot> slots_;
+  bool slots_resolved_;
+  // Slots of currently processed ComputingShare waiting for its Name
+  std::list<InfoDocumentTemplate::Slot>::iterator share_slots_;
+  std::string share_name_;
+  // Where content of current element is collected
+  std::string* text_;
+  std::vector<std::string>::size_type text_depth_;
+  bool InService(void) const;
+  void AddSlot(const std::string& name, bool service);
+  bool Resolve(InfoDocumentTemplate::Slot& slot);
+  static void StartElement(void* ctx, const xmlChar* localname, const xmlChar* prefix, const xmlChar* uri,
+                           int nb_namespaces, const xmlChar** namespaces,
+                           int nb_attributes, int nb_defaulted, const xmlChar** attributes);
+  static void EndElement(void* ctx, const xmlChar* localname, const xmlChar* prefix, const xmlChar* uri);
+  static void Characters(void* ctx, const xmlChar* ch, int len);
+};
+
+// Counters of ComputingService and ComputingEndpoint A-REX keeps up to date
+static bool IsServiceCounter(const std::string& name) {
+  return (name == "TotalJobs") || (name == "StagingJobs") || (name == "PreLRMSWaitingJobs");
+}
+
+// Counters of ComputingShare A-REX keeps up to date
+static bool IsShareCounter(const std::string& name) {
+  return (name == "StagingJobs") || (name == "PreLRMSWaitingJobs");
+}
+
+InfoDocumentCollector::InfoDocumentCollector(const std::string& filename):
+    h_(-1), size_(0), failed_(false), parser_(NULL), all_jobs_found_(false),
+    slots_resolved_(false), text_(NULL), text_depth_(0) {
+  share_slots_ = slots_.end();
+  tmpname_ = filename + ".tmpXXXXXX";
+  h_ = Glib::mkstemp(tmpname_);
+  if(h_ == -1) {
+    tmpname_.clear();
+    failed_ = true;
+    return;
+  };
+  xmlSAXHandler handler;
+  memset(&handler, 0, sizeof(handler));
+  handler.initialized = XML_SAX2_MAGIC;
+  handler.startElementNs = &StartElement;
+  handler.endElementNs = &EndElement;
+  handler.characters = &Characters;
+  parser_ = xmlCreatePushParserCtxt(&handler, this, NULL, 0, NULL);
+  if(!parser_) failed_ = true;
+}
+
+InfoDocumentCollector::~InfoDocumentCollector(void) {
+  if(parser_) xmlFreeParserCtxt(parser_);
+  if(h_ != -1) ::close(h_);
+  if(!tmpname_.empty()) ::unlink(tmpname_.c_str());
+}
+
+void InfoDocumentCollector::Append(char const* data, unsigned int size) {
+  if(failed_) return;
+  if(head_.length() < head_size_) head_.append(data, std::min(size, (unsigned int)(head_size_ - head_.length())));
+  for(unsigned int p = 0; p < size;) {
+    ssize_t l = ::write(h_, data+p, size-p);
+    if(l == -1) {
+      if(errno == EINTR) continue;
+      failed_ = true;
+      return;
+    };
+    p += l;
+  };
+  size_ += size;
+  if(xmlParseChunk(parser_, data, size, 0) != 0) failed_ = true;
+}
+
+bool InfoDocumentCollector::Finish(void) {
+  if(failed_) return false;
+  if(xmlParseChunk(parser_, NULL, 0, 1) != 0) failed_ = true;
+  if(!parser_->wellFormed) failed_ = true;
+  if(!failed_) {
+    slots_resolved_ = true;
+    for(std::list<InfoDocumentTemplate::Slot>::iterator slot = slots_.begin(); slot != slots_.end(); ++slot) {
+      if(!Resolve(*slot)) { slots_resolved_ = false; break; };
+    };
+  };
+  if(::close(h_) != 0) failed_ = true;
+  h_ = -1;
+  return !failed_;
+}
+
+// Parser reports position inside or right after start tag of element.
+// Exact boundaries of element and its content are found in stored document.
+bool InfoDocumentCollector::Resolve(InfoDocumentTemplate::Slot& slot) {
+  static const off_t window = 4096;
+  off_t pos = slot.element_start;
+  off_t wstart = (pos > window) ? (pos - window) : 0;
+  char buf[2*window];
+  ssize_t l = ::pread(h_, buf, sizeof(buf), wstart);
+  if(l <= 0) return false;
+  std::string data(buf, l);
+  std::string::size_type p = pos - wstart;
+  if((p == 0) || (p > data.length())) return false;
+  std::string::size_type lt = data.rfind('<', p-1);
+  if(lt == std::string::npos) return false;
+  std::string::size_type cs = data.find('>', lt);
+  // Empty element has no content which could be replaced
+  if((cs == std::string::npos) || (data[cs-1] == '/')) return false;
+  ++cs;
+  std::string::size_type ce = data.find('<', cs);
+  if((ce == std::string::npos) || (ce+1 >= data.length()) || (data[ce+1] != '/')) return false;
+  std::string::size_type ee = data.find('>', ce);
+  if(ee == std::string::npos) return false;
+  slot.element_start = wstart + lt;
+  slot.content_start = wstart + cs;
+  slot.content_end = wstart + ce;
+  slot.element_end = wstart + ee + 1;
+  return true;
+}
+
+bool InfoDocumentCollector::AllJobs(unsigned int& count) const {
+  if(!all_jobs_found_) return false;
+  return Arc::stringto(all_jobs_, count);
+}
+
+// Root element is not part of path and only ComputingService elements
+// are processed.
+bool InfoDocumentCollector::InService(void) const {
+  return (path_.size() > 4) && (path_[1] == "Domains") && (path_[2] == "AdminDomain") &&
+         (path_[3] == "Services") && (path_[4] == "ComputingService");
+}
+
+void InfoDocumentCollector::AddSlot(const std::string& name, bool service) {
+  InfoDocumentTemplate::Slot slot;
+  slot.service = service;
+  slot.name = name;
+  slot.element_start = xmlByteConsumed(parser_);
+  slot.content_start = slot.content_end = slot.element_end = slot.element_start;
+  slots_.push_back(slot);
+  if(slot.element_start < 0) failed_ = true;
+}
+
+void InfoDocumentCollector::StartElement(void* ctx, const xmlChar* localname, const xmlChar*, const xmlChar*,
+                                         int, const xmlChar**, int, int, const xmlChar**) {
+  InfoDocumentCollector& it = *(InfoDocumentCollector*)ctx;
+  it.path_.push_back((char const *)localname);
+  if(it.failed_) return;
+  if(!it.InService()) return;
+  const std::string& name = it.path_.back();
+  if(it.path_.size() == 6) {
+    if(name == "AllJobs") {
+      // Counter of all jobs is not glue2 info but is used by A-REX
+      it.AddSlot("", false);
+      if(!it.all_jobs_found_) {
+        it.text_ = &(it.all_jobs_);
+        it.text_depth_ = it.path_.size();
+      };
+    } else if(IsServiceCounter(name)) {
+      it.AddSlot(name, true);
+    } else if(name == "ComputingShare") {
+      it.share_slots_ = it.slots_.end();
+      it.share_name_.clear();
+    };
+  } else if(it.path_.size() == 7) {
+    if(it.path_[5] == "ComputingEndpoint") {
+      if(IsServiceCounter(name)) it.AddSlot(name, true);
+    } else if(it.path_[5] == "ComputingShare") {
+      if(IsShareCounter(name)) {
+        it.AddSlot(name, false);
+        if(it.share_slots_ == it.slots_.end()) --(it.share_slots_);
+      } else if(name == "Name") {
+        it.share_name_.clear();
+        it.text_ = &(it.share_name_);
+        it.text_depth_ = it.path_.size();
+      };
+    };
+  };
+}
+
+void InfoDocumentCollector::EndElement(void* ctx, const xmlChar*, const xmlChar*, const xmlChar*) {
+  InfoDocumentCollector& it = *(InfoDocumentCollector*)ctx;
+  if(it.text_ && (it.text_depth_ == it.path_.size())) {
+    if(it.text_ == &(it.all_jobs_)) it.all_jobs_found_ = true;
+    it.text_ = NULL;
+  };
+  if((it.path_.size() == 6) && it.InService() && (it.path_[5] == "ComputingShare")) {
+    // Name of share may come after its counters
+    for(;it.share_slots_ != it.slots_.end();++(it.share_slots_)) it.share_slots_->share = it.share_name_;
+  };
+  it.path_.pop_back();
+}
+
+void InfoDocumentCollector::Characters(void* ctx, const xmlChar* ch, int len) {
+  InfoDocumentCollector& it = *(InfoDocumentCollector*)ctx;
+  if(!it.text_) return;
+  if(it.text_depth_ != it.path_.size()) return;
+  it.text_->append((char const *)ch, len);
+}
+
+InfoDocumentTemplate::InfoDocumentTemplate(void): valid_(false) {
+}
+
+InfoDocumentTemplate::~InfoDocumentTemplate(void) {
+  if(!filename_.empty()) ::unlink(filename_.c_str());
+}
+
+bool InfoDocumentTemplate::Assign(const std::string& tmpfilename, const std::string& filename, const std::list<Slot>* slots) {
+  if(::rename(tmpfilename.c_str(), filename.c_str()) != 0) return false;
+  filename_ = filename;
+  valid_ = (slots != NULL);
+  if(slots) slots_ = *slots; else slots_.clear();
+  return true;
+}
+
+static bool CopyFileRange(int src, int dst, off_t start, off_t end) {
+  char buf[65536];
+  for(;;) {
+    size_t size = sizeof(buf);
+    if(end >= 0) {
+      if(start >= end) break;
+      if((end - start) < (off_t)size) size = end - start;
+    };
+    ssize_t l = ::pread(src, buf, size, start);
+    if(l == -1) {
+      if(errno == EINTR) continue;
+      return false;
+    };
+    if(l == 0) return (end < 0);
+    start += l;
+    for(ssize_t p = 0; p < l;) {
+      ssize_t ll = ::write(dst, buf+p, l-p);
+      if(ll == -1) {
+        if(errno == EINTR) continue;
+        return false;
+      };
+      p += ll;
+    };
+  };
+  return true;
+}
+
+static bool WriteString(int dst, const std::string& str) {
+  for(std::string::size_type p = 0; p < str.length();) {
+    ssize_t l = ::write(dst, str.c_str()+p, str.length()-p);
+    if(l == -1) {
+      if(errno == EINTR) continue;
+      return false;
+    };
+    p += l;
+  };
+  return true;
+}
+
+bool InfoDocumentTemplate::Render(const JobsStatistics* stats, const std::string& filename, std::string& tmpfilename) const {
+  if(filename_.empty()) return false;
+  tmpfilename = filename + ".tmpXXXXXX";
+  int dst = Glib::mkstemp(tmpfilename);
+  if(dst == -1) return false;
+  bool result = false;
+  if(valid_) {
+    int src = ::open(filename_.c_str(), O_RDONLY);
+    if(src != -1) {
+      result = true;
+      off_t pos = 0;
+      for(std::list<Slot>::const_iterator slot = slots_.begin(); result && (slot != slots_.end()); ++slot) {
+        unsigned int value = 0;
+        if(slot->name.empty()) {
+          // Element to be removed
+          result = CopyFileRange(src, dst, pos, slot->element_start);
+          pos = slot->element_end;
+        } else if(stats && (slot->service ? stats->ServiceCounter(slot->name, value)
+                                          : stats->ShareCounter(slot->share, slot->name, value))) {
+          result = CopyFileRange(src, dst, pos, slot->content_start) && WriteString(dst, Arc::tostring(value));
+          pos = slot->content_end;
+        };
+      };
+      if(result) result = CopyFileRange(src, dst, pos, -1);
+      ::close(src);
+    };
+  } else {
+    // Layout of document was not recognized - fall back to parsing it
+    Arc::XMLNode root;
+    if(root.ReadFromFile(filename_)) {
+      Arc::XMLNode service = root["Domains"]["AdminDomain"]["Services"]["ComputingService"];
+      for(;(bool)service;++service) {
+        while((bool)(service["AllJobs"])) service["AllJobs"].Destroy();
+      };
+      if(stats) stats->Apply(root);
+      std::string xml_str;
+      root.GetDoc(xml_str);
+      result = (!xml_str.empty()) && WriteString(dst, xml_str);
+    };
+  };
+  if(::close(dst) != 0) result = false;
+  if(!result) {
+    ::unlink(tmpfilename.c_str());
+    tmpfilename.clear();
+  };
+  return result;
+}
 
 int ARexService::OpenInfoDocument() {
   int h = infodoc_.OpenDocument();
@@ -39,22 +374,33 @@ void ARexService::InformationCollector(void) {
   thread_count_.RegisterThread();
   for(;;) {
     // Run information provider
-    std::string xml_str;
+    InfoDocumentCollector xml_doc(config_.InformationFile());
     int r = -1;
+    // Information about jobs in memory is provided by jobs processing,
+    // so provider does not need to read control files of those jobs.
+    std::string jobs_info = config_.ControlDir() + "/" + JOBS_INFO_FILE;
     {
       std::string cmd;
       cmd=Arc::ArcLocation::GetDataDir()+"/CEinfo.pl --splitjobs --config "+config_.ConfigFile();
+      struct stat st;
+      if(Arc::FileStat(jobs_info, &st, false)) cmd += " --jobsinfo "+jobs_info;
       std::string stdin_str;
       std::string stderr_str;
       Arc::Run run(cmd);
       run.AssignStdin(stdin_str);
-      run.AssignStdout(xml_str, 1024*1024); // can information document become bigger than 1MB?
+      run.AssignStdout(xml_doc);
       run.AssignStderr(stderr_str);
       logger_.msg(Arc::DEBUG,"Resource information provider: %s",cmd);
       if(!run.Start()) {
         // Failed to fork proces
         logger_.msg(Arc::DEBUG,"Resource information provider failed to start");
       } else {
+        // Provider may run for long time. Meanwhile keep counters of
+        // jobs in current document up to date.
+        while(!run.Wait(JOBS_STATS_PERIOD)) {
+          if(!run.Running()) break;
+          UpdateJobsStatistics(false);
+        };
         if(!run.Wait()) {
           logger_.msg(Arc::DEBUG,"Resource information provider failed to run");
         } else {
@@ -67,31 +413,73 @@ void ARexService::InformationCollector(void) {
         };
       };
     };
+    // Let jobs processing write fresh information for next run
+    ::unlink(jobs_info.c_str());
     if (r!=0) {
       logger_.msg(Arc::WARNING,"No new informational document assigned");
     } else {
-      logger_.msg(Arc::VERBOSE,"Obtained XML: %s",xml_str.substr(0,100));
-      // Following code is suboptimal. Most of it should go away
-      // and functionality to be moved to information providers.
-      if(!xml_str.empty()) {
-        // Currently glue states are lost. Counter of all jobs is lost too.
-        infodoc_.Assign(xml_str, config_.InformationFile());
-        Arc::XMLNode root = infodoc_.Acquire();
-        Arc::XMLNode all_jobs_count = root["Domains"]["AdminDomain"]["Services"]["ComputingService"]["AllJobs"];
-        if((bool)all_jobs_count) {
-          Arc::stringto((std::string)all_jobs_count,all_jobs_count_);
-          all_jobs_count.Destroy(); // is not glue2 info
-        };
-        infodoc_.Release();
-      } else {
+      logger_.msg(Arc::VERBOSE,"Obtained XML: %s",xml_doc.Head());
+      if(xml_doc.Size() == 0) {
         logger_.msg(Arc::ERROR,"Informational document is empty");
+      } else if(!xml_doc.Finish()) {
+        logger_.msg(Arc::ERROR,"Failed to store or parse informational document");
+      } else {
+        // Counter of all jobs is not glue2 info but is used by A-REX
+        if(!xml_doc.AllJobs(all_jobs_count_)) all_jobs_count_ = 0;
+        if(!xml_doc.SlotsResolved()) {
+          logger_.msg(Arc::WARNING,"Layout of informational document is not recognized - it will be parsed for every update");
+        };
+        // Output of provider is kept as is and published document is rendered from it
+        if(infotemplate_.Assign(xml_doc.Filename(), config_.InformationFile()+".provider",
+                                xml_doc.SlotsResolved() ? &(xml_doc.Slots()) : NULL)) {
+          xml_doc.Release();
+          // Counters of active jobs are taken from jobs processing because
+          // those computed by provider are already outdated.
+          if(!UpdateJobsStatistics(true)) {
+            if(PublishInfoDocument(NULL)) {
+              // Let REST interface prepare rendered document in advance
+              rest_.InformationUpdated();
+            };
+          };
+        } else {
+          logger_.msg(Arc::ERROR,"Failed to store informational document");
+        };
       };
     };
-    if(thread_count_.WaitOrCancel(infoprovider_wakeup_period_*100)) break;
+    bool cancelled = false;
+    for(unsigned int waited = 0; waited < infoprovider_wakeup_period_*100; waited += JOBS_STATS_PERIOD*1000) {
+      unsigned int slice = infoprovider_wakeup_period_*100 - waited;
+      if(slice > JOBS_STATS_PERIOD*1000) slice = JOBS_STATS_PERIOD*1000;
+      if((cancelled = thread_count_.WaitOrCancel(slice))) break;
+      UpdateJobsStatistics(false);
+    };
+    if(cancelled) break;
   };
   thread_count_.UnregisterThread();
 }
 
+bool ARexService::PublishInfoDocument(const JobsStatistics* stats) {
+  std::string tmpfilename;
+  if(!infotemplate_.Render(stats, config_.InformationFile(), tmpfilename)) return false;
+  if(!infodoc_.AssignFile(tmpfilename, config_.InformationFile())) {
+    ::unlink(tmpfilename.c_str());
+    return false;
+  };
+  return true;
+}
+
+bool ARexService::UpdateJobsStatistics(bool force) {
+  if(!gm_) return false;
+  JobsStatistics stats;
+  if(!gm_->GetJobsStatistics(stats)) return false;
+  if((!force) && (stats == jobs_stats_)) return false;
+  if(!PublishInfoDocument(&stats)) return false;
+  jobs_stats_ = stats;
+  logger_.msg(Arc::DEBUG,"Updated counters of jobs in informational document");
+  rest_.InformationUpdated();
+  return true;
+}
+
 std::string ARexService::getID() {
   return "ARC:AREX";
 }
@@ -230,6 +618,25 @@ void OptimizedInformationContainer::Assign(const std::string& xml, const std::st
     Arc::Logger::getRootLogger().msg(Arc::ERROR,"OptimizedInformationContainer failed to parse XML");
     return;
   };
+  Attach(h, tmpfilename, filename, newxml);
+}
+
+bool OptimizedInformationContainer::AssignFile(const std::string& tmpfilename, const std::string& filename) {
+  int h = ::open(tmpfilename.c_str(), O_RDONLY);
+  if(h == -1) {
+    Arc::Logger::getRootLogger().msg(Arc::ERROR,"OptimizedInformationContainer failed to open XML document %s",tmpfilename);
+    return false;
+  };
+  Arc::XMLNode newxml;
+  if(parse_xml_ && !newxml.ReadFromFile(tmpfilename)) {
+    ::close(h);
+    Arc::Logger::getRootLogger().msg(Arc::ERROR,"OptimizedInformationContainer failed to parse XML");
+    return false;
+  };
+  return Attach(h, tmpfilename, filename, newxml);
+}
+
+bool OptimizedInformationContainer::Attach(int h, const std::string& tmpfilename, const std::string& filename, Arc::XMLNode& newxml) {
   // Here we have XML stored in file and optionally parsed
   // Attach to new file
   olock_.lock();
@@ -239,8 +646,10 @@ void OptimizedInformationContainer::Assign(const std::string& xml, const std::st
   } else {
     if(::rename(tmpfilename.c_str(), filename.c_str()) != 0) {
       olock_.unlock();
+      ::unlink(tmpfilename.c_str());
+      ::close(h);
       Arc::Logger::getRootLogger().msg(Arc::ERROR,"OptimizedInformationContainer failed to rename temporary file");
-      return;
+      return false;
     };
     // Do not delete old file if same name requested - it is removed by rename()
     if(!filename_.empty()) if(filename_ != filename) ::unlink(filename_.c_str());
@@ -256,6 +665,7 @@ void OptimizedInformationContainer::Assign(const std::string& xml, const std::st
     Arc::InformationContainer::Assign(doc_,false);
   };
   olock_.unlock();
+  return true;
 }
 
 #define ESINFOFAULT(MSG) { \
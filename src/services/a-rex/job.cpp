@@ -1251,6 +1251,20 @@ bool ARexJob::ReportFileComplete(const std::string& filename) {
   return true;
 }
 
+bool ARexJob::ReportFilesComplete(const std::list<std::string>& filenames) {
+  if(id_.empty()) return false;
+  std::list<std::string> fnames;
+  for(std::list<std::string>::const_iterator filename = filenames.begin(); filename != filenames.end(); ++filename) {
+    std::string fname = *filename;
+    if(!normalize_filename(fname)) return false;
+    fnames.push_back("/"+fname);
+  };
+  if(fnames.empty()) return true;
+  if(!job_input_status_add_files(GMJob(id_,Arc::User(uid_)),config_.GmConfig(),fnames)) return false;
+  CommFIFO::Signal(config_.GmConfig().ControlDir(),id_);
+  return true;
+}
+
 bool ARexJob::ReportFilesComplete(void) {
   if(id_.empty()) return false;
   if(!job_input_status_add_file(GMJob(id_,Arc::User(uid_)),config_.GmConfig(),"/")) return false;
@@ -151,6 +151,8 @@ class ARexJob {
   std::string GetFilePath(const std::string& filename);
   bool ReportFileComplete(const std::string& filename);
   bool ReportFilesComplete();
+  /** Reports many uploaded files at once */
+  bool ReportFilesComplete(const std::list<std::string>& filenames);
   /** Opens log file in control directory */
   int OpenLogFile(const std::string& name);
   std::string GetLogFilePath(const std::string& name);
@@ -3,8 +3,9 @@ Methods for logging.
 """
 
 
-import sys, time
+import os, sys, time
 import arc
+from contextlib import contextmanager
 
 
 def debug(message = '', caller = None):
@@ -76,3 +77,31 @@ class ArcError(Exception):
 
     def __init__(self, msg, caller = None):
         error(msg, caller)
+
+
+@contextmanager
+def job_stderr(grami):
+    """
+    Redirect stderr to the ``.errors`` file of the job described by GRAMi
+    file ``grami`` (located in the same control directory). Used when
+    several jobs are handled by one process, so that diagnostics end up
+    where A-REX expects them.
+
+    :param str grami: path to GRAMi file
+    """
+
+    sys.stderr.flush()
+    saved = os.dup(2)
+    try:
+        errors = os.open(grami[:-len('.grami')] + '.errors',
+                         os.O_WRONLY | os.O_CREAT | os.O_APPEND, 0o600)
+        os.dup2(errors, 2)
+        os.close(errors)
+    except OSError:
+        pass
+    try:
+        yield
+    finally:
+        sys.stderr.flush()
+        os.dup2(saved, 2)
+        os.close(saved)
@@ -2,7 +2,7 @@ import sys, traceback
 
 try:
     import arc
-    from arc.lrms.common.log import ArcError, error
+    from arc.lrms.common.log import ArcError, error, job_stderr
 except:
     sys.stderr.write('Failed to import arc or arc.lrms.common module\n')
     sys.exit(2)
@@ -27,6 +27,41 @@ def main(lrms, jobid, conf = "/etc/arc.conf"):
     return 1
 
 
+def main_batch(lrms, gramis, conf = "/etc/arc.conf"):
+    """
+    Cancel several jobs from one process. A-REX passes GRAMi files,
+    local ID of job is taken from them. Diagnostics of every job go to
+    its own ``.errors`` file.
+
+    :return: 0 if all jobs were cancelled, else 1
+    """
+    lrms = get_lrms_module(lrms)
+    rc = 0
+    for grami in gramis:
+        with job_stderr(grami):
+            try:
+                jobid = get_local_id(grami)
+                if jobid and lrms.Cancel(conf, jobid):
+                    continue
+                if not jobid:
+                    error('%s: Local job ID not found' % grami, 'pyCancel')
+            except ArcError:
+                pass
+            except Exception:
+                error('Unexpected exception:\n%s' % traceback.format_exc(), 'pyCancel')
+            rc = 1
+    return rc
+
+
+def get_local_id(grami):
+    jobid = None
+    with open(grami, 'r') as jobdesc:
+        for line in jobdesc:
+            if line.startswith('joboption_jobid='):
+                jobid = line[len('joboption_jobid='):].strip().strip("'\"")
+    return jobid
+
+
 if __name__ == '__main__':
 
     if len(sys.argv) != 4:
@@ -2,7 +2,7 @@ import sys, traceback
 
 try:
     import arc
-    from arc.lrms.common.log import ArcError, error
+    from arc.lrms.common.log import ArcError, error, job_stderr
     from arc.lrms.common.parse import JobDescriptionParserGRAMi
 except:
     sys.stderr.write('Failed to import arc or arc.lrms.common module\n')
@@ -17,7 +17,28 @@ def get_lrms_module(lrmsname):
 
 
 def main(lrms, grami, conf = "/etc/arc.conf"):
+    return submit(get_lrms_module(lrms), grami, conf)
+
+
+def main_batch(lrms, gramis, conf = "/etc/arc.conf"):
+    """
+    Submit several jobs from one process, so that interpreter startup,
+    configuration parsing and connection to batch system are shared.
+    Diagnostics of every job go to its own ``.errors`` file and local
+    ID of every submitted job is stored in its GRAMi file.
+
+    :return: 0 if all jobs were submitted, else 1
+    """
     lrms = get_lrms_module(lrms)
+    rc = 0
+    for grami in gramis:
+        with job_stderr(grami):
+            if submit(lrms, grami, conf) != 0:
+                rc = 1
+    return rc
+
+
+def submit(lrms, grami, conf):
     gridid = grami.split('.')[-2]
     is_parsed = False
     try:
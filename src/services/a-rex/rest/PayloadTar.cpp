@@ -0,0 +1,74 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "../PayloadFile.h"
+#include "PayloadTar.h"
+
+namespace ARex {
+
+PayloadTarStream::PayloadTarStream(uid_t uid, gid_t gid):
+    Arc::PayloadTarStream(uid,gid),uid_(uid),gid_(gid),fa_(NULL),handle_(-1) {
+}
+
+PayloadTarStream::~PayloadTarStream(void) {
+  CloseFile();
+  if(fa_) Arc::FileAccess::Release(fa_);
+}
+
+bool PayloadTarStream::OpenFile(Entry const& entry) {
+  if(!fa_) {
+    fa_ = Arc::FileAccess::Acquire();
+    if((!*fa_) || (!fa_->fa_setuid(uid_,gid_))) {
+      Arc::FileAccess::Release(fa_);
+      fa_ = NULL;
+      return false;
+    };
+  };
+  // Entry may have been replaced by FIFO since it was listed
+  if(!fa_->fa_open(entry.path,O_RDONLY | O_NOFOLLOW | O_NONBLOCK,0)) return false;
+  struct stat fst;
+  if(!fa_->fa_fstat(fst) || !S_ISREG(fst.st_mode)) {
+    fa_->fa_close();
+    return false;
+  };
+  // File was opened with permissions of user. Opening it again
+  // is safe as long as it is still same file and avoids passing
+  // content through helper process.
+  int h = reopen_file_read(entry.path,fst);
+  if(h != -1) {
+    fa_->fa_close();
+    handle_ = h;
+  };
+  return true;
+}
+
+bool PayloadTarStream::ReadFile(char* buf,int& size) {
+  ssize_t l;
+  if(handle_ != -1) {
+    do { l = ::read(handle_,buf,size); } while((l == -1) && (errno == EINTR));
+  } else if(fa_) {
+    l = fa_->fa_read(buf,size);
+  } else {
+    l = -1;
+  };
+  if(l < 0) { size = 0; return false; };
+  size = l;
+  return true;
+}
+
+void PayloadTarStream::CloseFile(void) {
+  if(handle_ != -1) {
+    ::close(handle_);
+    handle_ = -1;
+  } else if(fa_) {
+    fa_->fa_close();
+  };
+}
+
+} // namespace ARex
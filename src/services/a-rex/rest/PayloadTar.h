@@ -0,0 +1,32 @@
+#ifndef __ARC_AREX_REST_PAYLOADTAR_H__
+#define __ARC_AREX_REST_PAYLOADTAR_H__
+
+#include <sys/types.h>
+
+#include <arc/FileAccess.h>
+#include <arc/message/PayloadTar.h>
+
+namespace ARex {
+
+  /// Stream producing tar archive of files from job's session directory.
+  /** Files are opened with permissions of specified user. Archive
+    format and handling of files changing while being archived are
+    described in Arc::PayloadTarStream. */
+  class PayloadTarStream: public Arc::PayloadTarStream {
+   public:
+    PayloadTarStream(uid_t uid, gid_t gid);
+    virtual ~PayloadTarStream(void);
+   protected:
+    virtual bool OpenFile(Entry const& entry);
+    virtual bool ReadFile(char* buf,int& size);
+    virtual void CloseFile(void);
+   private:
+    uid_t uid_;
+    gid_t gid_;
+    Arc::FileAccess* fa_;
+    int handle_;
+  };
+
+} // namespace ARex
+
+#endif // __ARC_AREX_REST_PAYLOADTAR_H__
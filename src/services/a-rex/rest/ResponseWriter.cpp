@@ -0,0 +1,464 @@
+#include <config.h>
+
+#include <list>
+
+#include <arc/StringConv.h>
+
+#include "ResponseWriter.h"
+
+using namespace Arc;
+
+namespace ARex {
+
+static std::list< std::pair<std::string,int> >::iterator FindFirst(std::list< std::pair<std::string,int> >::iterator first, std::list< std::pair<std::string,int> >::iterator last, std::string const & str) {
+    while (first != last) {
+        if (first->first == str) return first;
+        ++first;
+    }
+    return last;
+}
+
+void RenderToJson(Arc::XMLNode xml, std::string& output, int depth) {
+    if(xml.Size() == 0) {
+        std::string val = json_encode((std::string)xml);
+        if((depth != 0) || (!val.empty())) {
+            output += "\"";
+            output += val;
+            output += "\"";
+        }
+        return;
+    }
+    output += "{";
+    // Because JSON does not allow for same key we must first
+    // group XML elements by names. Using list to preserve order
+    // in which elements appear.
+    std::list< std::pair<std::string,int> > names;
+    for(int n = 0; ; ++n) {
+        XMLNode child = xml.Child(n);
+        if(!child) break;
+        std::string name = child.Name();
+        std::list< std::pair<std::string,int> >::iterator nameIt = FindFirst(names.begin(),names.end(),name);
+        if(nameIt == names.end())
+            names.push_back(std::make_pair(name,1));
+        else
+            ++(nameIt->second);
+    }
+    bool newElement = true;
+    for(std::list< std::pair<std::string,int> >::iterator nameIt = names.begin(); nameIt != names.end(); ++nameIt) {
+        XMLNode child = xml[nameIt->first.c_str()];
+        if(child) {
+            if(!newElement) output += ",";
+            newElement = false;
+            output += "\"";
+            output += child.Name();
+            output += "\"";
+            output += ":";
+            if(nameIt->second == 1) {
+                RenderToJson(child, output, depth+1);
+            } else {
+                output += "[";
+                bool newItem = true;
+                while(child) {
+                    if(!newItem) output += ",";
+                    newItem = false;
+                    RenderToJson(child, output, depth+1);
+                    ++child;
+                }
+                output += "]";
+            }
+        }
+    }
+    // Hope no attributes with same name
+    if(xml.AttributesSize() > 0) {
+        if(!newElement) output += ",";
+        output += "\"_attributes\":{";
+        for(int n = 0; ; ++n) {
+            XMLNode child = xml.Attribute(n);
+            if (!child) break;
+            if(n != 0) output += ",";
+            std::string val = json_encode((std::string)child);
+            output += "\"";
+            output += child.Name();
+            output += "\":\"";
+            output += val;
+            output += "\"";
+        }
+        output += "}";
+    }
+    output += "}";
+}
+
+void RenderToHtml(Arc::XMLNode xml, std::string& output, int depth) {
+    if(depth == 0) {
+        output += "<HTML><HEAD>";
+        output += xml.Name();
+        output += "</HEAD><BODY>";
+    }
+
+    if(xml.Size() == 0) {
+        output += (std::string)xml;
+    } else {
+        output += "<table border=\"1\">";
+        for(int n = 0; ; ++n) {
+            XMLNode child = xml.Child(n);
+            if (!child) break;
+            output += "<tr><td>";
+            output += child.Name();
+            output += "</td><td>";
+            RenderToHtml(child, output, depth+1);
+            output += "</td></tr>";
+        }
+        output += "</table>";
+    }
+
+    if(depth == 0) {
+        output += "</BODY></HTML>";
+    }
+}
+
+void RenderToXml(Arc::XMLNode xml, std::string& output, int depth) {
+    xml.GetXML(output, "utf-8");
+}
+
+void RenderResponse(Arc::XMLNode xml, ResponseFormat format, std::string& output) {
+    switch(format) {
+        case ResponseFormatXml:
+            RenderToXml(xml, output);
+            break;
+        case ResponseFormatHtml:
+            RenderToHtml(xml, output);
+            break;
+        case ResponseFormatJson:
+            RenderToJson(xml, output);
+            break;
+        default:
+            break;
+    }
+}
+
+// Same characters libxml2 escapes in text content.
+static std::string XmlEscape(std::string const& str) {
+    std::string::size_type pos = str.find_first_of("<>&\r");
+    if(pos == std::string::npos) return str;
+    std::string out(str, 0, pos);
+    for(; pos < str.length(); ++pos) {
+        switch(str[pos]) {
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '&': out += "&amp;"; break;
+            case '\r': out += "&#13;"; break;
+            default: out += str[pos]; break;
+        }
+    }
+    return out;
+}
+
+// ------------------------------------------------------------------------
+
+class ResponseWriterXml: public ResponseWriter {
+ public:
+    ResponseWriterXml(Arc::PayloadRaw& payload, bool count_only):ResponseWriter(payload, count_only),tag_open_(false) {};
+    virtual ~ResponseWriterXml(void) {};
+    virtual void Begin(std::string const& name);
+    virtual void End(void);
+    virtual void Value(std::string const& name, std::string const& value);
+    virtual void Node(Arc::XMLNode node);
+ protected:
+    virtual unsigned int Depth(void) const { return names_.size(); };
+ private:
+    std::vector<std::string> names_;
+    // Tag of last open element is not closed with '>' yet
+    bool tag_open_;
+    void CloseTag(void);
+};
+
+void ResponseWriterXml::CloseTag(void) {
+    if(tag_open_) {
+        Write(">");
+        tag_open_ = false;
+    }
+}
+
+void ResponseWriterXml::Begin(std::string const& name) {
+    CloseTag();
+    Write("<");
+    Write(name);
+    names_.push_back(name);
+    tag_open_ = true;
+}
+
+void ResponseWriterXml::End(void) {
+    if(names_.empty()) return;
+    if(tag_open_) {
+        Write("/>");
+        tag_open_ = false;
+    } else {
+        Write("</");
+        Write(names_.back());
+        Write(">");
+    }
+    names_.pop_back();
+}
+
+void ResponseWriterXml::Value(std::string const& name, std::string const& value) {
+    CloseTag();
+    Write("<");
+    Write(name);
+    if(value.empty()) {
+        Write("/>");
+    } else {
+        Write(">");
+        Write(XmlEscape(value));
+        Write("</");
+        Write(name);
+        Write(">");
+    }
+}
+
+void ResponseWriterXml::Node(Arc::XMLNode node) {
+    CloseTag();
+    std::string str;
+    node.GetXML(str, "utf-8");
+    Write(str);
+}
+
+// ------------------------------------------------------------------------
+
+class ResponseWriterHtml: public ResponseWriter {
+ public:
+    ResponseWriterHtml(Arc::PayloadRaw& payload, bool count_only):ResponseWriter(payload, count_only) {};
+    virtual ~ResponseWriterHtml(void) {};
+    virtual void Begin(std::string const& name);
+    virtual void End(void);
+    virtual void Value(std::string const& name, std::string const& value);
+    virtual void Node(Arc::XMLNode node);
+ protected:
+    virtual unsigned int Depth(void) const { return has_children_.size(); };
+ private:
+    std::vector<bool> has_children_;
+    void ChildStart(std::string const& name);
+};
+
+void ResponseWriterHtml::ChildStart(std::string const& name) {
+    if(!has_children_.back()) {
+        Write("<table border=\"1\">");
+        has_children_.back() = true;
+    }
+    Write("<tr><td>");
+    Write(name);
+    Write("</td><td>");
+}
+
+void ResponseWriterHtml::Begin(std::string const& name) {
+    if(has_children_.empty()) {
+        Write("<HTML><HEAD>");
+        Write(name);
+        Write("</HEAD><BODY>");
+    } else {
+        ChildStart(name);
+    }
+    has_children_.push_back(false);
+}
+
+void ResponseWriterHtml::End(void) {
+    if(has_children_.empty()) return;
+    if(has_children_.back()) Write("</table>");
+    has_children_.pop_back();
+    if(has_children_.empty()) {
+        Write("</BODY></HTML>");
+    } else {
+        Write("</td></tr>");
+    }
+}
+
+void ResponseWriterHtml::Value(std::string const& name, std::string const& value) {
+    if(has_children_.empty()) {
+        Write("<HTML><HEAD>");
+        Write(name);
+        Write("</HEAD><BODY>");
+        Write(value);
+        Write("</BODY></HTML>");
+        return;
+    }
+    ChildStart(name);
+    Write(value);
+    Write("</td></tr>");
+}
+
+void ResponseWriterHtml::Node(Arc::XMLNode node) {
+    std::string str;
+    RenderToHtml(node, str, has_children_.size());
+    if(has_children_.empty()) {
+        Write(str);
+        return;
+    }
+    ChildStart(node.Name());
+    Write(str);
+    Write("</td></tr>");
+}
+
+// ------------------------------------------------------------------------
+
+// JSON can't have repeated keys, so same named elements are merged into
+// array. To decide between single value and array rendering of each child
+// is kept pending till next sibling arrives. Only those pending children
+// are held in memory, the rest goes to payload directly.
+class ResponseWriterJson: public ResponseWriter {
+ public:
+    ResponseWriterJson(Arc::PayloadRaw& payload, bool count_only):ResponseWriter(payload, count_only) {};
+    virtual ~ResponseWriterJson(void) {};
+    virtual void Begin(std::string const& name);
+    virtual void End(void);
+    virtual void Value(std::string const& name, std::string const& value);
+    virtual void Node(Arc::XMLNode node);
+ protected:
+    virtual unsigned int Depth(void) const { return frames_.size(); };
+ private:
+    class Frame {
+     public:
+        std::string name;
+        std::string content;      // rendered content (not used for top level)
+        bool has_children;
+        bool has_groups;          // at least one group of children is rendered
+        std::string pending_name; // name of children group being collected
+        std::string pending;      // last rendered child of that group
+        int pending_count;        // number of children in the group
+        Frame(std::string const& n):name(n),has_children(false),has_groups(false),pending_count(0) {};
+    };
+    std::vector<Frame> frames_;
+    void Emit(unsigned int level, std::string const& str);
+    void AddChild(unsigned int level, std::string const& name, std::string const& rendered);
+    void FlushPending(unsigned int level);
+};
+
+void ResponseWriterJson::Emit(unsigned int level, std::string const& str) {
+    if(level == 0) {
+        Write(str);
+    } else {
+        frames_[level].content += str;
+    }
+}
+
+void ResponseWriterJson::FlushPending(unsigned int level) {
+    Frame& frame = frames_[level];
+    if(frame.pending_count <= 0) return;
+    if(frame.pending_count == 1) {
+        Emit(level, (frame.has_groups?",\"":"\"") + frame.pending_name + "\":" + frame.pending);
+        frame.has_groups = true;
+    } else {
+        Emit(level, "," + frame.pending + "]");
+    }
+    frame.pending.resize(0);
+    frame.pending_count = 0;
+}
+
+void ResponseWriterJson::AddChild(unsigned int level, std::string const& name, std::string const& rendered) {
+    Frame& frame = frames_[level];
+    if(!frame.has_children) {
+        Emit(level, "{");
+        frame.has_children = true;
+    }
+    if((frame.pending_count > 0) && (frame.pending_name == name)) {
+        if(frame.pending_count == 1) {
+            Emit(level, (frame.has_groups?",\"":"\"") + frame.pending_name + "\":[" + frame.pending);
+            frame.has_groups = true;
+        } else {
+            Emit(level, "," + frame.pending);
+        }
+        frames_[level].pending = rendered;
+        ++(frames_[level].pending_count);
+        return;
+    }
+    FlushPending(level);
+    frames_[level].pending_name = name;
+    frames_[level].pending = rendered;
+    frames_[level].pending_count = 1;
+}
+
+void ResponseWriterJson::Begin(std::string const& name) {
+    frames_.push_back(Frame(name));
+}
+
+void ResponseWriterJson::End(void) {
+    if(frames_.empty()) return;
+    unsigned int level = frames_.size()-1;
+    std::string rendered;
+    if(frames_[level].has_children) {
+        FlushPending(level);
+        Emit(level, "}");
+        rendered.swap(frames_[level].content);
+    } else if(level != 0) {
+        rendered = "\"\"";
+    }
+    std::string name = frames_[level].name;
+    frames_.pop_back();
+    if(level != 0) AddChild(level-1, name, rendered);
+}
+
+void ResponseWriterJson::Value(std::string const& name, std::string const& value) {
+    if(frames_.empty()) {
+        if(!value.empty()) Write("\"" + json_encode(value) + "\"");
+        return;
+    }
+    AddChild(frames_.size()-1, name, "\"" + json_encode(value) + "\"");
+}
+
+void ResponseWriterJson::Node(Arc::XMLNode node) {
+    std::string rendered;
+    RenderToJson(node, rendered, frames_.size());
+    if(frames_.empty()) {
+        Write(rendered);
+        return;
+    }
+    AddChild(frames_.size()-1, node.Name(), rendered);
+}
+
+// ------------------------------------------------------------------------
+
+ResponseWriter* ResponseWriter::Create(ResponseFormat format, Arc::PayloadRaw& payload, bool count_only) {
+    switch(format) {
+        case ResponseFormatXml:
+            return new ResponseWriterXml(payload, count_only);
+        case ResponseFormatJson:
+            return new ResponseWriterJson(payload, count_only);
+        case ResponseFormatHtml:
+        default:
+            break;
+    }
+    return new ResponseWriterHtml(payload, count_only);
+}
+
+ResponseWriter::ResponseWriter(Arc::PayloadRaw& payload, bool count_only):
+    payload_(payload), count_only_(count_only), size_(0) {
+}
+
+ResponseWriter::~ResponseWriter(void) {
+}
+
+void ResponseWriter::Write(std::string const& str) {
+    size_ += str.length();
+    if(count_only_) return;
+    chunk_ += str;
+    if(chunk_.length() >= chunk_size_) Flush();
+}
+
+void ResponseWriter::Write(char const* str) {
+    Write(std::string(str));
+}
+
+void ResponseWriter::Flush(void) {
+    if(chunk_.empty()) return;
+    payload_.Insert(chunk_.c_str(), payload_.Size(), chunk_.length());
+    chunk_.resize(0);
+}
+
+void ResponseWriter::Finish(void) {
+    while(Depth() > 0) End();
+    if(count_only_) {
+        payload_.Truncate(size_);
+    } else {
+        Flush();
+    }
+}
+
+} // namespace ARex
@@ -0,0 +1,68 @@
+#ifndef __ARC_AREX_REST_RESPONSEWRITER_H__
+#define __ARC_AREX_REST_RESPONSEWRITER_H__
+
+#include <string>
+#include <vector>
+
+#include <arc/XMLNode.h>
+#include <arc/message/PayloadRaw.h>
+
+namespace ARex {
+
+  enum ResponseFormat {
+    ResponseFormatHtml,
+    ResponseFormatXml,
+    ResponseFormatJson
+  };
+
+  // DOM based renderers. Used for small responses and for embedding
+  // already parsed documents into streamed responses.
+  void RenderToJson(Arc::XMLNode xml, std::string& output, int depth = 0);
+  void RenderToHtml(Arc::XMLNode xml, std::string& output, int depth = 0);
+  void RenderToXml(Arc::XMLNode xml, std::string& output, int depth = 0);
+  void RenderResponse(Arc::XMLNode xml, ResponseFormat format, std::string& output);
+
+  /// Streaming generator of structured REST responses.
+  /** Response is described as a sequence of Begin/Value/Node/End calls
+    mirroring the XML tree which would be otherwise built with XMLNode.
+    Rendered content is appended to provided payload in chunks as soon as
+    it is available, so no full document is kept in memory. JSON and HTML
+    output is identical to what RenderResponse() produces for equivalent
+    tree as long as elements with same name are written contiguously. XML
+    output differs only in absence of indentation. */
+  class ResponseWriter {
+   public:
+    /// Creates writer for specified format. If count_only is true
+    /// content is not stored but payload is truncated to size of
+    /// rendered response when Finish() is called (for HEAD requests).
+    static ResponseWriter* Create(ResponseFormat format, Arc::PayloadRaw& payload, bool count_only = false);
+    virtual ~ResponseWriter(void);
+    /// Open element as child of currently open one.
+    virtual void Begin(std::string const& name) = 0;
+    /// Close currently open element.
+    virtual void End(void) = 0;
+    /// Add element with textual content and no children.
+    virtual void Value(std::string const& name, std::string const& value) = 0;
+    /// Add pre-built XML tree as child of currently open element.
+    virtual void Node(Arc::XMLNode node) = 0;
+    /// Close all open elements and pass remaining content to payload.
+    void Finish(void);
+    /// Size of content rendered so far.
+    Arc::PayloadRaw::Size_t Size(void) const { return size_; };
+   protected:
+    ResponseWriter(Arc::PayloadRaw& payload, bool count_only);
+    void Write(std::string const& str);
+    void Write(char const* str);
+    virtual unsigned int Depth(void) const = 0;
+   private:
+    static const std::string::size_type chunk_size_ = 64*1024;
+    Arc::PayloadRaw& payload_;
+    bool count_only_;
+    std::string chunk_;
+    Arc::PayloadRaw::Size_t size_;
+    void Flush(void);
+  };
+
+} // namespace ARex
+
+#endif // __ARC_AREX_REST_RESPONSEWRITER_H__
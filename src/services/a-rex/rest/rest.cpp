@@ -7,8 +7,10 @@
 
 #include <arc/message/PayloadRaw.h>
 #include <arc/message/PayloadStream.h>
+#include <arc/message/PayloadGzip.h>
 #include <arc/URL.h>
 #include <arc/FileUtils.h>
+#include <arc/DateTime.h>
 #include <arc/Utils.h>
 
 #include "../job.h"
@@ -17,130 +19,13 @@
 #include "../delegation/DelegationStores.h"
 #include "../grid-manager/files/ControlFileHandling.h"
 
+#include "ResponseWriter.h"
+#include "PayloadTar.h"
 #include "rest.h"
 
-namespace Arc {
-  std::list< std::pair<std::string,int> >::iterator FindFirst(std::list< std::pair<std::string,int> >::iterator first, std::list< std::pair<std::string,int> >::iterator last, std::string const & str) {
-    while (first != last) {
-      if (first->first == str) return first;
-      ++first;
-    }
-    return last;
-  }
-}
-
 using namespace ARex;
 using namespace Arc;
 
-enum ResponseFormat {
-    ResponseFormatHtml,
-    ResponseFormatXml,
-    ResponseFormatJson
-};
-
-static void RenderToJson(Arc::XMLNode xml, std::string& output, int depth = 0) {
-    if(xml.Size() == 0) {
-        std::string val = json_encode((std::string)xml);
-        if((depth != 0) || (!val.empty())) {
-            output += "\"";
-            output += val;
-            output += "\"";
-        }
-        return;
-    }
-    output += "{";
-    // Because JSON does not allow for same key we must first
-    // group XML elements by names. Using list to preserve order
-    // in which elements appear.
-    std::list< std::pair<std::string,int> > names;
-    for(int n = 0; ; ++n) {
-        XMLNode child = xml.Child(n);
-        if(!child) break;
-        std::string name = child.Name();
-        std::list< std::pair<std::string,int> >::iterator nameIt = FindFirst(names.begin(),names.end(),name);
-        if(nameIt == names.end())
-            names.push_back(std::make_pair(name,1));
-        else
-            ++(nameIt->second); 
-    }
-    bool newElement = true;
-    for(std::list< std::pair<std::string,int> >::iterator nameIt = names.begin(); nameIt != names.end(); ++nameIt) {
-        XMLNode child = xml[nameIt->first.c_str()];
-        if(child) {
-            if(!newElement) output += ",";
-            newElement = false;
-            output += "\"";
-            output += child.Name();
-            output += "\"";
-            output += ":";
-            if(nameIt->second == 1) {
-                RenderToJson(child, output, depth+1);
-            } else {
-                output += "[";
-                bool newItem = true;
-                while(child) {
-                    if(!newItem) output += ",";
-                    newItem = false;
-                    RenderToJson(child, output, depth+1);
-                    ++child;
-                }
-                output += "]";
-            }
-        }
-    }
-    // Hope no attributes with same name
-    if(xml.AttributesSize() > 0) {
-        if(!newElement) output += ",";
-        output += "\"_attributes\":{";
-        for(int n = 0; ; ++n) {
-            XMLNode child = xml.Attribute(n);
-            if (!child) break;
-            if(n != 0) output += ",";
-            std::string val = json_encode((std::string)child);
-            output += "\"";
-            output += child.Name();
-            output += "\":\"";
-            output += val;
-            output += "\"";
-        }
-        output += "}";
-    } 
-    output += "}";
-}
-
-static void RenderToHtml(Arc::XMLNode xml, std::string& output, int depth = 0) {
-    if(depth == 0) {
-        output += "<HTML><HEAD>";
-        output += xml.Name();
-        output += "</HEAD><BODY>";
-    }
-
-    if(xml.Size() == 0) {
-        output += (std::string)xml;
-    } else {
-        output += "<table border=\"1\">";
-        for(int n = 0; ; ++n) {
-            XMLNode child = xml.Child(n);
-            if (!child) break;
-            output += "<tr><td>";
-            output += child.Name();
-            output += "</td><td>";
-            RenderToHtml(child, output, depth+1);
-            output += "</td></tr>";
-        }
-        output += "</table>";
-    }
-
-    if(depth == 0) {
-        output += "</BODY></HTML>";
-    }
-}
-
-static void RenderToXml(Arc::XMLNode xml, std::string& output, int depth = 0) {
-    xml.GetXML(output, "utf-8");
-}
-
-
 static char const * SkipWS(char const * input) {
     while(*input) {
         if(!std::isspace(*input))
@@ -253,22 +138,6 @@ static char const * ParseFromJson(Arc::XMLNode& xml, char const * input, int dep
     return input;
 }
 
-static void RenderResponse(Arc::XMLNode xml, ResponseFormat format, std::string& output) {
-    switch(format) {
-        case ResponseFormatXml:
-            RenderToXml(xml, output);
-            break;
-        case ResponseFormatHtml:
-            RenderToHtml(xml, output);
-            break;
-        case ResponseFormatJson:
-            RenderToJson(xml, output);
-            break;
-        default:
-            break;
-    }
-}
-
 static void ExtractRange(Arc::Message& inmsg, off_t& range_start, off_t& range_end) {
   range_start = 0;
   range_end = (off_t)(-1);
@@ -411,7 +280,8 @@ static Arc::MCC_Status HTTPResponseFile(Arc::Message& inmsg, Arc::Message& outms
 }
 
 static Arc::MCC_Status HTTPResponseFile(Arc::Message& inmsg, Arc::Message& outmsg,
-                                        Arc::FileAccess*& fileHandle, std::string const& mime) {
+                                        Arc::FileAccess*& fileHandle, std::string const& filePath,
+                                        std::string const& mime) {
   if(inmsg.Attributes()->get("HTTP:METHOD") == "HEAD") {
     Arc::PayloadRaw* outpayload = new Arc::PayloadRaw();
     struct stat st;
@@ -421,7 +291,7 @@ static Arc::MCC_Status HTTPResponseFile(Arc::Message& inmsg, Arc::Message& outms
     off_t range_start;
     off_t range_end;
     ExtractRange(inmsg, range_start, range_end);
-    Arc::MessagePayload* outpayload = newFileRead(fileHandle,range_start,range_end);
+    Arc::MessagePayload* outpayload = newFileRead(fileHandle,filePath,range_start,range_end);
     delete outmsg.Payload(outpayload);
     fileHandle = NULL;
   }
@@ -493,6 +363,35 @@ static ResponseFormat ProcessAcceptedFormat(Arc::Message& inmsg, Arc::Message& o
   return outFormat;
 }
 
+static char const * FormatMimeType(ResponseFormat format) {
+  switch(format) {
+    case ResponseFormatJson: return "application/json";
+    case ResponseFormatXml: return "application/xml";
+    default: break;
+  }
+  return "text/html";
+}
+
+// Checks if client accepts gzip content coding.
+static bool AcceptsGzip(Arc::Message& inmsg) {
+  std::list<std::string> encodings;
+  for(Arc::AttributeIterator attrIt = inmsg.Attributes()->getAll("HTTP:accept-encoding"); attrIt.hasMore(); ++attrIt) encodings.push_back(*attrIt);
+  return Arc::GzipAccepted(encodings);
+}
+
+// Checks if If-None-Match header of request contains specified entity tag.
+static bool MatchesETag(Arc::Message& inmsg, std::string const& etag) {
+  std::list<std::string> tags;
+  for(Arc::AttributeIterator attrIt = inmsg.Attributes()->getAll("HTTP:if-none-match"); attrIt.hasMore(); ++attrIt) tokenize(*attrIt, tags, ",");
+  for(std::list<std::string>::iterator tag = tags.begin(); tag != tags.end(); ++tag) {
+    std::string t = Arc::trim(*tag, " ");
+    // Weak comparison is sufficient for GET/HEAD
+    if(t.compare(0, 2, "W/") == 0) t.erase(0, 2);
+    if((t == "*") || (t == etag)) return true;
+  }
+  return false;
+}
+
 // Insert structured positive response into outmsg.
 static Arc::MCC_Status HTTPResponse(Arc::Message& inmsg, Arc::Message& outmsg, Arc::XMLNode& resp) {
   ResponseFormat outFormat = ProcessAcceptedFormat(inmsg,outmsg);
@@ -526,6 +425,25 @@ static Arc::MCC_Status HTTPPOSTResponse(Arc::Message& inmsg, Arc::Message& outms
   return Arc::MCC_Status(Arc::STATUS_OK);
 }
 
+// Start structured response which is rendered directly into payload of outmsg.
+// Nothing may replace payload of outmsg till HTTPResponseFinish() is called.
+static ResponseWriter* HTTPResponseStart(Arc::Message& inmsg, Arc::Message& outmsg) {
+  ResponseFormat outFormat = ProcessAcceptedFormat(inmsg,outmsg);
+  Arc::PayloadRaw* outpayload = new Arc::PayloadRaw();
+  delete outmsg.Payload(outpayload);
+  return ResponseWriter::Create(outFormat, *outpayload, inmsg.Attributes()->get("HTTP:METHOD") == "HEAD");
+}
+
+static Arc::MCC_Status HTTPResponseFinish(Arc::Message& outmsg, ResponseWriter* writer,
+                                    int code = 200, char const * reason = "OK", std::string const & redir = "") {
+  writer->Finish();
+  delete writer;
+  outmsg.Attributes()->set("HTTP:CODE",Arc::tostring(code));
+  outmsg.Attributes()->set("HTTP:REASON",reason);
+  if(!redir.empty()) outmsg.Attributes()->set("HTTP:location",redir);
+  return Arc::MCC_Status(Arc::STATUS_OK);
+}
+
 static std::string GetPath(Arc::Message &inmsg,std::string &base,std::multimap<std::string,std::string>& query) {
   base = inmsg.Attributes()->get("HTTP:ENDPOINT");
   Arc::AttributeIterator iterator = inmsg.Attributes()->getAll("PLEXER:EXTENSION");
@@ -665,6 +583,210 @@ ARexRest::ARexRest(Arc::Config *cfg, Arc::PluginArgument *parg, GMConfig& config
 ARexRest::~ARexRest(void)  {
 }
 
+void ARexRest::InformationUpdated(void) {
+  info_cache_.Refresh(config_.InformationFile());
+}
+
+// ---------------------------- INFO CACHE ---------------------------------
+
+// Compressed content is not produced for small documents
+static const std::string::size_type InfoCompressThreshold = 4096;
+
+// Read-only payload made of shared content. Content is not copied.
+class PayloadSharedContent: public Arc::PayloadRawInterface {
+ public:
+  PayloadSharedContent(ARexRest::SharedContent* content):content_(content->Acquire()) { };
+  virtual ~PayloadSharedContent(void) { content_->Release(); };
+  virtual char operator[](Size_t pos) const {
+    if((pos < 0) || (pos >= (Size_t)content_->content.length())) return 0;
+    return content_->content[pos];
+  };
+  virtual char* Content(Size_t pos = -1) {
+    if(pos == -1) pos = 0;
+    if((pos < 0) || (pos >= (Size_t)content_->content.length())) return NULL;
+    return const_cast<char*>(content_->content.c_str()) + pos;
+  };
+  virtual Size_t Size(void) const { return content_->content.length(); };
+  virtual char* Insert(Size_t pos = 0,Size_t size = 0) { return NULL; };
+  virtual char* Insert(const char* s,Size_t pos = 0,Size_t size = -1) { return NULL; };
+  virtual char* Buffer(unsigned int num) {
+    if((num != 0) || content_->content.empty()) return NULL;
+    return const_cast<char*>(content_->content.c_str());
+  };
+  virtual Size_t BufferSize(unsigned int num) const {
+    if(num != 0) return 0;
+    return content_->content.length();
+  };
+  virtual Size_t BufferPos(unsigned int num) const {
+    if(num != 0) return content_->content.length();
+    return 0;
+  };
+  virtual bool Truncate(Size_t size) { return false; };
+ private:
+  ARexRest::SharedContent* content_;
+};
+
+ARexRest::SharedContent::SharedContent(void):refs_(1) {
+}
+
+ARexRest::SharedContent::~SharedContent(void) {
+}
+
+ARexRest::SharedContent* ARexRest::SharedContent::Acquire(void) {
+  Glib::Mutex::Lock lock(lock_);
+  ++refs_;
+  return this;
+}
+
+void ARexRest::SharedContent::Release(void) {
+  bool last = false;
+  {
+    Glib::Mutex::Lock lock(lock_);
+    last = ((--refs_) <= 0);
+  };
+  if(last) delete this;
+}
+
+// Produces gzip compressed copy of content. Returns NULL on failure.
+static ARexRest::SharedContent* GzipCompress(ARexRest::SharedContent* in) {
+  // Document is compressed once per version, so best compression is affordable
+  Arc::PayloadGzipStream gzip(*(new PayloadSharedContent(in)), true, 9);
+  ARexRest::SharedContent* out = new ARexRest::SharedContent;
+  char buf[65536];
+  for(;;) {
+    int size = sizeof(buf);
+    if(!gzip.Get(buf, size)) break;
+    out->content.append(buf, size);
+  }
+  if(!gzip) {
+    out->Release();
+    return NULL;
+  }
+  return out;
+}
+
+ARexRest::InfoCache::InfoCache(void):modified_(0) {
+  for(int n = 0; n < 3; ++n) {
+    rendered_[n] = NULL;
+    compressed_[n] = NULL;
+    compressed_valid_[n] = false;
+  }
+}
+
+ARexRest::InfoCache::~InfoCache(void) {
+  Clear();
+}
+
+// Must be called with lock_ held. Responses still using content keep it.
+void ARexRest::InfoCache::Clear(void) {
+  for(int n = 0; n < 3; ++n) {
+    if(rendered_[n]) rendered_[n]->Release();
+    rendered_[n] = NULL;
+    if(compressed_[n]) compressed_[n]->Release();
+    compressed_[n] = NULL;
+    compressed_valid_[n] = false;
+  }
+}
+
+// Makes cached representations follow current information document.
+// Rendering is done without holding lock_, so meanwhile requests are
+// served from previous version. If document can't be read for a moment
+// (e.g. collector is replacing it) previous version is kept. Returns false
+// only if no version of document is available.
+bool ARexRest::InfoCache::Update(std::string const& filename) {
+  struct stat st;
+  std::string version;
+  if(::stat(filename.c_str(), &st) == 0) {
+    // Collector replaces file on every update, so combination of inode,
+    // size and modification time identifies document version.
+    version = Arc::tostring((unsigned long long int)st.st_ino) + "-" +
+              Arc::tostring((unsigned long long int)st.st_size) + "-" +
+              Arc::tostring((unsigned long long int)st.st_mtime);
+  }
+  {
+    Glib::Mutex::Lock lock(lock_);
+    for(;;) {
+      if(version.empty() || (version == version_)) return (rendered_[0] != NULL);
+      if(rendering_.empty()) break;
+      // Other request is already rendering new version
+      if(rendered_[0]) return true;
+      rendered_cond_.wait(lock_);
+    }
+    rendering_ = version;
+  }
+  SharedContent* rendered[3] = { NULL, NULL, NULL };
+  std::string infoStr;
+  if(Arc::FileRead(filename, infoStr)) {
+    XMLNode infoXml(infoStr);
+    infoStr.clear();
+    if(infoXml) {
+      for(int n = 0; n < 3; ++n) {
+        rendered[n] = new SharedContent;
+        RenderResponse(infoXml, (ResponseFormat)n, rendered[n]->content);
+      }
+    }
+  }
+  Glib::Mutex::Lock lock(lock_);
+  rendering_.clear();
+  if(rendered[0]) {
+    Clear();
+    for(int n = 0; n < 3; ++n) rendered_[n] = rendered[n];
+    version_ = version;
+    modified_ = st.st_mtime;
+  }
+  rendered_cond_.broadcast();
+  return (rendered_[0] != NULL);
+}
+
+void ARexRest::InfoCache::Refresh(std::string const& filename) {
+  (void)Update(filename);
+}
+
+bool ARexRest::InfoCache::Get(std::string const& filename, ResponseFormat format, bool& compressed,
+                              SharedContent*& content, std::string& etag, time_t& modified) {
+  int idx = (int)format;
+  if((idx < 0) || (idx >= 3)) return false;
+  if(!Update(filename)) return false;
+  SharedContent* rendered = NULL;
+  std::string version;
+  {
+    Glib::Mutex::Lock lock(lock_);
+    if(!rendered_[idx]) return false;
+    if(compressed && (rendered_[idx]->content.length() >= InfoCompressThreshold)) {
+      if(!compressed_valid_[idx]) {
+        rendered = rendered_[idx]->Acquire();
+      } else if(!compressed_[idx]) {
+        compressed = false;
+      }
+    } else {
+      compressed = false;
+    }
+    version = version_;
+    modified = modified_;
+    if(!rendered) content = (compressed ? compressed_[idx] : rendered_[idx])->Acquire();
+  }
+  if(rendered) {
+    // Compression is done once per version and outside of lock
+    SharedContent* packed = GzipCompress(rendered);
+    {
+      Glib::Mutex::Lock lock(lock_);
+      if((version == version_) && !compressed_valid_[idx]) {
+        compressed_[idx] = packed ? packed->Acquire() : NULL;
+        compressed_valid_[idx] = true;
+      }
+    }
+    if(packed) {
+      rendered->Release();
+      content = packed;
+    } else {
+      content = rendered;
+      compressed = false;
+    }
+  }
+  etag = "\"" + version + "-" + Arc::tostring(idx) + (compressed?"-gz":"") + "\"";
+  return true;
+}
+
 // Main request processor of REST interface
 Arc::MCC_Status ARexRest::process(Arc::Message& inmsg,Arc::Message& outmsg) {
   // Split request path into parts: service, jobs, files, etc. 
@@ -751,10 +873,37 @@ Arc::MCC_Status ARexRest::processInfo(Arc::Message& inmsg,Arc::Message& outmsg,
     return HTTPFault(inmsg,outmsg,501,"Schema not implemented");
   }
 
-  std::string infoStr;
-  Arc::FileRead(config_.InformationFile(), infoStr);
-  XMLNode infoXml(infoStr);
-  return HTTPResponse(inmsg, outmsg, infoXml);
+  ResponseFormat outFormat = ProcessAcceptedFormat(inmsg,outmsg);
+  bool compressed = AcceptsGzip(inmsg);
+  SharedContent* info = NULL;
+  std::string etag;
+  time_t modified = 0;
+  if(!info_cache_.Get(config_.InformationFile(), outFormat, compressed, info, etag, modified))
+    return HTTPFault(inmsg,outmsg,500,"Failed to obtain resource information");
+  outmsg.Attributes()->set("HTTP:etag",etag);
+  outmsg.Attributes()->set("HTTP:last-modified",Arc::Time(modified).str(Arc::RFC1123Time));
+  outmsg.Attributes()->set("HTTP:vary","Accept, Accept-Encoding");
+  if(compressed) outmsg.Attributes()->set("HTTP:content-encoding","gzip");
+  if(MatchesETag(inmsg, etag)) {
+    Arc::PayloadRaw* outpayload = new Arc::PayloadRaw();
+    delete outmsg.Payload(outpayload);
+    outmsg.Attributes()->set("HTTP:CODE","304");
+    outmsg.Attributes()->set("HTTP:REASON","Not Modified");
+    info->Release();
+    return Arc::MCC_Status(Arc::STATUS_OK);
+  }
+  if(context.method == "HEAD") {
+    Arc::PayloadRaw* outpayload = new Arc::PayloadRaw();
+    if(outpayload) outpayload->Truncate(info->content.length());
+    delete outmsg.Payload(outpayload);
+  } else {
+    delete outmsg.Payload(new PayloadSharedContent(info));
+  }
+  info->Release();
+  outmsg.Attributes()->set("HTTP:CODE","200");
+  outmsg.Attributes()->set("HTTP:REASON","OK");
+  outmsg.Attributes()->set("HTTP:content-type",FormatMimeType(outFormat));
+  return Arc::MCC_Status(Arc::STATUS_OK);
 }
 
 // ---------------------------- DELEGATIONS ---------------------------------
@@ -777,12 +926,15 @@ Arc::MCC_Status ARexRest::processDelegations(Arc::Message& inmsg,Arc::Message& o
     return HTTPFault(inmsg,outmsg,500,"User can't be assigned configuration");
   }
   if((context.method == "GET") || (context.method == "HEAD")) {
-    XMLNode listXml("<delegations/>");
     std::list<std::string> ids = delegation_stores_[config_.DelegationDir()].ListCredIDs(config->GridName());
+    ResponseWriter* writer = HTTPResponseStart(inmsg, outmsg);
+    writer->Begin("delegations");
     for(std::list<std::string>::iterator itId = ids.begin(); itId != ids.end(); ++itId) {
-      listXml.NewChild("delegation").NewChild("id") = *itId;
+      writer->Begin("delegation");
+      writer->Value("id", *itId);
+      writer->End();
     }
-    return HTTPResponse(inmsg, outmsg, listXml);
+    return HTTPResponseFinish(outmsg, writer);
   } else if(context.method == "POST") {
     std::string action = context["action"];
     if(action != "new") 
@@ -881,12 +1033,27 @@ Arc::MCC_Status ARexRest::processDelegation(Arc::Message& inmsg,Arc::Message& ou
 
 // ---------------------------- JOBS ---------------------------------
 
-static bool processJobInfo(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, XMLNode jobXml);
-static bool processJobStatus(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, XMLNode jobXml);
-static bool processJobKill(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, XMLNode jobXml);
-static bool processJobClean(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, XMLNode jobXml);
-static bool processJobRestart(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, XMLNode jobXml);
-static bool processJobDelegations(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, XMLNode jobXml, ARex::DelegationStores& delegation_stores);
+static bool processJobInfo(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, ResponseWriter& writer);
+static bool processJobStatus(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, ResponseWriter& writer);
+static bool processJobKill(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, ResponseWriter& writer);
+static bool processJobClean(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, ResponseWriter& writer);
+static bool processJobRestart(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, ResponseWriter& writer);
+static bool processJobDelegations(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, ResponseWriter& writer, ARex::DelegationStores& delegation_stores);
+
+// Renders result of job creation as one element of jobs list.
+static void RenderNewJob(ResponseWriter& writer, ARexJob& job) {
+  writer.Begin("job");
+  if(!job) {
+    writer.Value("status-code", "500");
+    writer.Value("reason", job.Failure());
+  } else {
+    writer.Value("status-code", "201");
+    writer.Value("reason", "Created");
+    writer.Value("id", job.ID());
+    writer.Value("state", "ACCEPTING");
+  }
+  writer.End();
+}
 
 Arc::MCC_Status ARexRest::processJobs(Arc::Message& inmsg,Arc::Message& outmsg,ProcessingContext& context) {
   // GET <base URL>/jobs[?state=<state1[,state2[...]]>]
@@ -910,8 +1077,9 @@ Arc::MCC_Status ARexRest::processJobs(Arc::Message& inmsg,Arc::Message& outmsg,P
   if((context.method == "GET") || (context.method == "HEAD")) {
     std::list<std::string> states;
     tokenize(context["state"], states, ",");
-    XMLNode listXml("<jobs/>");
     std::list<std::string> ids = ARexJob::Jobs(*config,logger_);
+    ResponseWriter* writer = HTTPResponseStart(inmsg, outmsg);
+    writer->Begin("jobs");
     for(std::list<std::string>::iterator itId = ids.begin(); itId != ids.end(); ++itId) {
       std::string rest_state;
       if(!states.empty()) {
@@ -932,12 +1100,13 @@ Arc::MCC_Status ARexRest::processJobs(Arc::Message& inmsg,Arc::Message& outmsg,P
         }
         if(!state_found) continue;
       } // states filter
-      XMLNode jobXml = listXml.NewChild("job");
-      jobXml.NewChild("id") = *itId;
+      writer->Begin("job");
+      writer->Value("id", *itId);
       if(!rest_state.empty())
-        jobXml.NewChild("state") = rest_state;
+        writer->Value("state", rest_state);
+      writer->End();
     }
-    return HTTPResponse(inmsg, outmsg, listXml);
+    return HTTPResponseFinish(outmsg, writer);
   } else if(context.method == "POST") {
     std::string action = context["action"];
     if(action == "new") {
@@ -958,57 +1127,35 @@ Arc::MCC_Status ARexRest::processJobs(Arc::Message& inmsg,Arc::Message& outmsg,P
       if(start_pos == std::string::npos)
         return HTTPFault(inmsg,outmsg,500,"Payload is empty");
 
-      XMLNode listXml("<jobs/>");
       // TODO: Split to separate functions
       switch(desc_str[start_pos]) {
         case '<': { // XML (multi- or single-ADL)
           Arc::XMLNode jobs_desc_xml(desc_str);
+          ResponseWriter* writer = HTTPResponseStart(inmsg, outmsg);
+          writer->Begin("jobs");
           if (jobs_desc_xml.Name() == "ActivityDescriptions") {
             // multi
             for(int idx = 0;;++idx) {
               Arc::XMLNode job_desc_xml = jobs_desc_xml.Child(idx);
               if(!job_desc_xml)
                 break;
-              XMLNode jobXml = listXml.NewChild("job");
               ARexJob job(job_desc_xml,*config,"",clientid,logger_,idgenerator);
-              if(!job) {
-                jobXml.NewChild("status-code") = "500";
-                jobXml.NewChild("reason") = job.Failure();
-              } else {
-                jobXml.NewChild("status-code") = "201";
-                jobXml.NewChild("reason") = "Created";
-                jobXml.NewChild("id") = job.ID();
-                jobXml.NewChild("state") = "ACCEPTING";
-              } 
+              RenderNewJob(*writer, job);
             }
           } else {
             // maybe single
-            XMLNode jobXml = listXml.NewChild("job");
             ARexJob job(jobs_desc_xml,*config,"",clientid,logger_,idgenerator);
-            if(!job) {
-              jobXml.NewChild("status-code") = "500";
-              jobXml.NewChild("reason") = job.Failure();
-            } else {
-              jobXml.NewChild("status-code") = "201";
-              jobXml.NewChild("reason") = "Created";
-              jobXml.NewChild("id") = job.ID();
-              jobXml.NewChild("state") = "ACCEPTING";
-            } 
+            RenderNewJob(*writer, job);
           }
+          return HTTPResponseFinish(outmsg, writer, 201, "Created");
         }; break;
 
         case '&': { // single-xRSL
-          XMLNode jobXml = listXml.NewChild("job");
+          ResponseWriter* writer = HTTPResponseStart(inmsg, outmsg);
+          writer->Begin("jobs");
           ARexJob job(desc_str,*config,"",clientid,logger_,idgenerator);
-          if(!job) {
-            jobXml.NewChild("status-code") = "500";
-            jobXml.NewChild("reason") = job.Failure();
-          } else {
-            jobXml.NewChild("status-code") = "201";
-            jobXml.NewChild("reason") = "Created";
-            jobXml.NewChild("id") = job.ID();
-            jobXml.NewChild("state") = "ACCEPTING";
-          } 
+          RenderNewJob(*writer, job);
+          return HTTPResponseFinish(outmsg, writer, 201, "Created");
         }; break;
 
         case '+': { // multi-xRSL
@@ -1016,89 +1163,95 @@ Arc::MCC_Status ARexRest::processJobs(Arc::Message& inmsg,Arc::Message& outmsg,P
           Arc::JobDescriptionResult result = Arc::JobDescription::Parse(desc_str, jobdescs, "nordugrid:xrsl", "GRIDMANAGER");
           if (!result) {
             return HTTPFault(inmsg,outmsg,500,result.str().c_str());
-          } else {
-            for(std::list<JobDescription>::iterator jobdesc = jobdescs.begin(); jobdesc != jobdescs.end(); ++jobdesc) {
-              XMLNode jobXml = listXml.NewChild("job");
-              std::string jobdesc_str;
-              result = jobdesc->UnParse(jobdesc_str, "nordugrid:xrsl", "GRIDMANAGER");
-              if (!result) {
-                jobXml.NewChild("status-code") = "500";
-                jobXml.NewChild("reason") = result.str();
-              } else {
-                ARexJob job(jobdesc_str,*config,"",clientid,logger_,idgenerator);
-                if(!job) {
-                  jobXml.NewChild("status-code") = "500";
-                  jobXml.NewChild("reason") = job.Failure();
-                } else {
-                  jobXml.NewChild("status-code") = "201";
-                  jobXml.NewChild("reason") = "Created";
-                  jobXml.NewChild("id") = job.ID();
-                  jobXml.NewChild("state") = "ACCEPTING";
-                } 
-              }
+          }
+          ResponseWriter* writer = HTTPResponseStart(inmsg, outmsg);
+          writer->Begin("jobs");
+          for(std::list<JobDescription>::iterator jobdesc = jobdescs.begin(); jobdesc != jobdescs.end(); ++jobdesc) {
+            std::string jobdesc_str;
+            result = jobdesc->UnParse(jobdesc_str, "nordugrid:xrsl", "GRIDMANAGER");
+            if (!result) {
+              writer->Begin("job");
+              writer->Value("status-code", "500");
+              writer->Value("reason", result.str());
+              writer->End();
+            } else {
+              ARexJob job(jobdesc_str,*config,"",clientid,logger_,idgenerator);
+              RenderNewJob(*writer, job);
             }
           }
+          return HTTPResponseFinish(outmsg, writer, 201, "Created");
         }; break;
 
         default:
-          return HTTPFault(inmsg,outmsg,500,"Payload is not recognized");
           break;
       }
-      return HTTPPOSTResponse(inmsg, outmsg, listXml);
+      return HTTPFault(inmsg,outmsg,500,"Payload is not recognized");
     } else if(action == "info") {
       std::list<std::string> ids;
       ParseJobIds(inmsg,outmsg,ids);
-      XMLNode listXml("<jobs/>");
+      ResponseWriter* writer = HTTPResponseStart(inmsg, outmsg);
+      writer->Begin("jobs");
       for(std::list<std::string>::iterator id = ids.begin(); id != ids.end(); ++id) {
-        XMLNode jobXml = listXml.NewChild("job");
-        (void)processJobInfo(inmsg,*config,logger_,*id,jobXml);
+        writer->Begin("job");
+        (void)processJobInfo(inmsg,*config,logger_,*id,*writer);
+        writer->End();
       }
-      return HTTPPOSTResponse(inmsg, outmsg, listXml);
+      return HTTPResponseFinish(outmsg, writer, 201, "Created");
     } else if(action == "status") {
       std::list<std::string> ids;
       ParseJobIds(inmsg,outmsg,ids);
-      XMLNode listXml("<jobs/>");
+      ResponseWriter* writer = HTTPResponseStart(inmsg, outmsg);
+      writer->Begin("jobs");
       for(std::list<std::string>::iterator id = ids.begin(); id != ids.end(); ++id) {
-        XMLNode jobXml = listXml.NewChild("job");
-        (void)processJobStatus(inmsg,*config,logger_,*id,jobXml);
+        writer->Begin("job");
+        (void)processJobStatus(inmsg,*config,logger_,*id,*writer);
+        writer->End();
       }
-      return HTTPPOSTResponse(inmsg, outmsg, listXml);
+      return HTTPResponseFinish(outmsg, writer, 201, "Created");
     } else if(action == "kill") {
       std::list<std::string> ids;
       ParseJobIds(inmsg,outmsg,ids);
-      XMLNode listXml("<jobs/>");
+      ResponseWriter* writer = HTTPResponseStart(inmsg, outmsg);
+      writer->Begin("jobs");
       for(std::list<std::string>::iterator id = ids.begin(); id != ids.end(); ++id) {
-        XMLNode jobXml = listXml.NewChild("job");
-        (void)processJobKill(inmsg,*config,logger_,*id,jobXml);
+        writer->Begin("job");
+        (void)processJobKill(inmsg,*config,logger_,*id,*writer);
+        writer->End();
       }
-      return HTTPPOSTResponse(inmsg, outmsg, listXml);
+      return HTTPResponseFinish(outmsg, writer, 201, "Created");
     } else if(action == "clean") {
       std::list<std::string> ids;
       ParseJobIds(inmsg,outmsg,ids);
-      XMLNode listXml("<jobs/>");
+      ResponseWriter* writer = HTTPResponseStart(inmsg, outmsg);
+      writer->Begin("jobs");
       for(std::list<std::string>::iterator id = ids.begin(); id != ids.end(); ++id) {
-        XMLNode jobXml = listXml.NewChild("job");
-        (void)processJobClean(inmsg,*config,logger_,*id,jobXml);
+        writer->Begin("job");
+        (void)processJobClean(inmsg,*config,logger_,*id,*writer);
+        writer->End();
       }
-      return HTTPPOSTResponse(inmsg, outmsg, listXml);
+      return HTTPResponseFinish(outmsg, writer, 201, "Created");
     } else if(action == "restart") {
       std::list<std::string> ids;
       ParseJobIds(inmsg,outmsg,ids);
-      XMLNode listXml("<jobs/>");
+      ResponseWriter* writer = HTTPResponseStart(inmsg, outmsg);
+      writer->Begin("jobs");
       for(std::list<std::string>::iterator id = ids.begin(); id != ids.end(); ++id) {
-        XMLNode jobXml = listXml.NewChild("job");
-        (void)processJobRestart(inmsg,*config,logger_,*id,jobXml);
+        writer->Begin("job");
+        (void)processJobRestart(inmsg,*config,logger_,*id,*writer);
+        writer->End();
       }
-      return HTTPPOSTResponse(inmsg, outmsg, listXml);
+      return HTTPResponseFinish(outmsg, writer, 201, "Created");
     } else if(action == "delegations") {
       std::list<std::string> ids;
       ParseJobIds(inmsg,outmsg,ids);
-      XMLNode listXml("<jobs/>");
+      ResponseWriter* writer = HTTPResponseStart(inmsg, outmsg);
+      writer->Begin("jobs");
       for(std::list<std::string>::iterator id = ids.begin(); id != ids.end(); ++id) {
-        XMLNode jobXml = listXml.NewChild("job");
-        (void)processJobDelegations(inmsg,*config,logger_,*id,jobXml,delegation_stores_);
+        writer->Begin("job");
+        (void)processJobDelegations(inmsg,*config,logger_,*id,*writer,delegation_stores_);
+        writer->End();
       }
-      return HTTPPOSTResponse(inmsg, outmsg, listXml);      
+      return HTTPResponseFinish(outmsg, writer, 201, "Created");      
     }
     logger_.msg(Arc::VERBOSE, "process: action %s is not supported for subpath %s",action,context.processed);
     return HTTPFault(inmsg,outmsg,501,"Action not implemented");
@@ -1107,16 +1260,16 @@ Arc::MCC_Status ARexRest::processJobs(Arc::Message& inmsg,Arc::Message& outmsg,P
   return HTTPFault(inmsg,outmsg,501,"Not Implemented");
 }
 
-static bool processJobInfo(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, XMLNode jobXml) {
+static bool processJobInfo(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, ResponseWriter& writer) {
   ARexJob job(id,config,logger);
   if(!job) {
     // There is no such job
     std::string failure = job.Failure();
     logger.msg(Arc::ERROR, "REST:GET job %s - %s", id, failure);
-    jobXml.NewChild("status-code") = "404";
-    jobXml.NewChild("reason") = (!failure.empty()) ? failure : "Job not found";
-    jobXml.NewChild("id") = id;
-    jobXml.NewChild("info_document");
+    writer.Value("status-code", "404");
+    writer.Value("reason", (!failure.empty()) ? failure : "Job not found");
+    writer.Value("id", id);
+    writer.Value("info_document", "");
     return false;
   }
   std::string glue_s;
@@ -1169,23 +1322,25 @@ static bool processJobInfo(Arc::Message& inmsg,ARexConfigContext& config, Arc::L
     glue_xml.Attribute("CreationTime") = job.Created().str(Arc::ISOTime);
   };
   // Delegation ids?
-  jobXml.NewChild("status-code") = "200";
-  jobXml.NewChild("reason") = "OK";
-  jobXml.NewChild("id") = id;
-  jobXml.NewChild("info_document").NewChild("ComputingActivity").Exchange(glue_xml);
+  writer.Value("status-code", "200");
+  writer.Value("reason", "OK");
+  writer.Value("id", id);
+  writer.Begin("info_document");
+  writer.Node(glue_xml);
+  writer.End();
   return true;
 }
 
-static bool processJobStatus(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, XMLNode jobXml) {
+static bool processJobStatus(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, ResponseWriter& writer) {
   ARexJob job(id,config,logger);
   if(!job) {
     // There is no such job
     std::string failure = job.Failure();
     logger.msg(Arc::ERROR, "REST:GET job %s - %s", id, failure);
-    jobXml.NewChild("status-code") = "404";
-    jobXml.NewChild("reason") = (!failure.empty()) ? failure : "Job not found";
-    jobXml.NewChild("id") = id;
-    jobXml.NewChild("state") = "None";
+    writer.Value("status-code", "404");
+    writer.Value("reason", (!failure.empty()) ? failure : "Job not found");
+    writer.Value("id", id);
+    writer.Value("state", "None");
     return false;
   }
   // Collecting job state
@@ -1216,105 +1371,105 @@ static bool processJobStatus(Arc::Message& inmsg,ARexConfigContext& config, Arc:
     convertActivityStatusREST(gm_state,rest_state,
                               job_failed,job_pending,failed_state,failed_cause);
   }
-  jobXml.NewChild("status-code") = "200";
-  jobXml.NewChild("reason") = "OK";
-  jobXml.NewChild("id") = id;
-  jobXml.NewChild("state") = rest_state;
+  writer.Value("status-code", "200");
+  writer.Value("reason", "OK");
+  writer.Value("id", id);
+  writer.Value("state", rest_state);
   return true;
 }
 
-static bool processJobKill(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, XMLNode jobXml) {
+static bool processJobKill(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, ResponseWriter& writer) {
   ARexJob job(id,config,logger);
   if(!job) {
     // There is no such job
     std::string failure = job.Failure();
     logger.msg(Arc::ERROR, "REST:KILL job %s - %s", id, failure);
-    jobXml.NewChild("status-code") = "404";
-    jobXml.NewChild("reason") = (!failure.empty()) ? failure : "Job not found";
-    jobXml.NewChild("id") = id;
+    writer.Value("status-code", "404");
+    writer.Value("reason", (!failure.empty()) ? failure : "Job not found");
+    writer.Value("id", id);
     return false;
   }
   if(!job.Cancel()) {
     std::string failure = job.Failure();
     logger.msg(Arc::ERROR, "REST:KILL job %s - %s", id, failure);
-    jobXml.NewChild("status-code") = "505";
-    jobXml.NewChild("reason") = (!failure.empty()) ? failure : "Job could not be canceled";
-    jobXml.NewChild("id") = id;
+    writer.Value("status-code", "505");
+    writer.Value("reason", (!failure.empty()) ? failure : "Job could not be canceled");
+    writer.Value("id", id);
     return false;
   }
-  jobXml.NewChild("status-code") = "202";
-  jobXml.NewChild("reason") = "Queued for killing";
-  jobXml.NewChild("id") = id;
+  writer.Value("status-code", "202");
+  writer.Value("reason", "Queued for killing");
+  writer.Value("id", id);
   return true;
 }
 
-static bool processJobClean(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, XMLNode jobXml) {
+static bool processJobClean(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, ResponseWriter& writer) {
   ARexJob job(id,config,logger);
   if(!job) {
     // There is no such job
     std::string failure = job.Failure();
     logger.msg(Arc::ERROR, "REST:CLEAN job %s - %s", id, failure);
-    jobXml.NewChild("status-code") = "404";
-    jobXml.NewChild("reason") = (!failure.empty()) ? failure : "Job not found";
-    jobXml.NewChild("id") = id;
+    writer.Value("status-code", "404");
+    writer.Value("reason", (!failure.empty()) ? failure : "Job not found");
+    writer.Value("id", id);
     return false;
   }
   if(!job.Clean()) {
     std::string failure = job.Failure();
     logger.msg(Arc::ERROR, "REST:CLEAN job %s - %s", id, failure);
-    jobXml.NewChild("status-code") = "505";
-    jobXml.NewChild("reason") = (!failure.empty()) ? failure : "Job could not be cleaned";
-    jobXml.NewChild("id") = id;
+    writer.Value("status-code", "505");
+    writer.Value("reason", (!failure.empty()) ? failure : "Job could not be cleaned");
+    writer.Value("id", id);
     return false;
   }
-  jobXml.NewChild("status-code") = "202";
-  jobXml.NewChild("reason") = "Queued for cleaning";
-  jobXml.NewChild("id") = id;
+  writer.Value("status-code", "202");
+  writer.Value("reason", "Queued for cleaning");
+  writer.Value("id", id);
   return true;
 }
 
-static bool processJobRestart(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, XMLNode jobXml) {
+static bool processJobRestart(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, ResponseWriter& writer) {
   ARexJob job(id,config,logger);
   if(!job) {
     // There is no such job
     std::string failure = job.Failure();
     logger.msg(Arc::ERROR, "REST:RESTART job %s - %s", id, failure);
-    jobXml.NewChild("status-code") = "404";
-    jobXml.NewChild("reason") = (!failure.empty()) ? failure : "Job not found";
-    jobXml.NewChild("id") = id;
+    writer.Value("status-code", "404");
+    writer.Value("reason", (!failure.empty()) ? failure : "Job not found");
+    writer.Value("id", id);
     return false;
   }
   if(!job.Resume()) {
     std::string failure = job.Failure();
     logger.msg(Arc::ERROR, "REST:RESTART job %s - %s", id, failure);
-    jobXml.NewChild("status-code") = "505";
-    jobXml.NewChild("reason") = (!failure.empty()) ? failure : "Job could not be resumed";
-    jobXml.NewChild("id") = id;
+    writer.Value("status-code", "505");
+    writer.Value("reason", (!failure.empty()) ? failure : "Job could not be resumed");
+    writer.Value("id", id);
     return false;
   }
-  jobXml.NewChild("status-code") = "202";
-  jobXml.NewChild("reason") = "Queued for restarting";
-  jobXml.NewChild("id") = id;
+  writer.Value("status-code", "202");
+  writer.Value("reason", "Queued for restarting");
+  writer.Value("id", id);
   return true;
 }
 
-static bool processJobDelegations(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, XMLNode jobXml, ARex::DelegationStores& delegation_stores) {
+static bool processJobDelegations(Arc::Message& inmsg,ARexConfigContext& config, Arc::Logger& logger, std::string const & id, ResponseWriter& writer, ARex::DelegationStores& delegation_stores) {
   ARexJob job(id,config,logger);
   if(!job) {
     // There is no such job
     std::string failure = job.Failure();
     logger.msg(Arc::ERROR, "REST:RESTART job %s - %s", id, failure);
-    jobXml.NewChild("status-code") = "404";
-    jobXml.NewChild("reason") = (!failure.empty()) ? failure : "Job not found";
-    jobXml.NewChild("id") = id;
+    writer.Value("status-code", "404");
+    writer.Value("reason", (!failure.empty()) ? failure : "Job not found");
+    writer.Value("id", id);
     return false;
   }
-  jobXml.NewChild("status-code") = "200";
-  jobXml.NewChild("reason") = "OK";
-  jobXml.NewChild("id") = id;
+  writer.Value("status-code", "200");
+  writer.Value("reason", "OK");
+  writer.Value("id", id);
   std::list<std::string> ids = delegation_stores[config.GmConfig().DelegationDir()].ListLockedCredIDs(id,config.GridName());
   for(std::list<std::string>::iterator itId = ids.begin(); itId != ids.end(); ++itId) {
-    jobXml.NewChild("delegation_id") = *itId;
+    writer.Value("delegation_id", *itId);
   }
   return true;
 }
@@ -1420,6 +1575,64 @@ static Arc::MCC_Status PutJobFile(Arc::Message& inmsg, Arc::Message& outmsg, Arc
   return HTTPResponse(inmsg,outmsg);
 }
 
+// Unpacks tar archive into session directory. Every completely written
+// file is reported as uploaded, so job may proceed without other requests.
+static Arc::MCC_Status PutJobArchive(Arc::Message& inmsg, Arc::Message& outmsg, ARexJob& job,
+                                     std::string const& subpath, Arc::PayloadStreamInterface& stream,
+                                     std::string& errstr) {
+  const int bufsize = 1024*1024;
+  char* buf = new char[bufsize];
+  Arc::TarReader archive(stream);
+  Arc::PayloadTarStream::Entry entry;
+  std::list<std::string> files;
+  int code = 0;
+  char const * reason = NULL;
+  while(archive.Next(entry)) {
+    std::string name = entry.name;
+    if((!CanonicalDir(name, false, false)) || name.empty()) {
+      errstr = "unacceptable path in archive - "+entry.name;
+      code = 400; reason = "Wrong path in archive";
+      break;
+    };
+    // Directories are created together with files
+    if(entry.dir) continue;
+    if(!subpath.empty()) name = subpath + "/" + name;
+    Arc::FileAccess* file = job.CreateFile(name);
+    if(!file) {
+      errstr = "failed to create file "+name+" - "+job.Failure();
+      code = 500; reason = "Error creating file";
+      break;
+    };
+    bool written = file->fa_ftruncate(0);
+    for(;written;) {
+      int size = bufsize;
+      if(!archive.Read(buf,size)) break;
+      written = write_file(*file,buf,size);
+    };
+    if(!written) errstr = "failed to write to file "+name+" - "+Arc::StrError(file->geterrno());
+    file->fa_close(); Arc::FileAccess::Release(file);
+    if(!written) {
+      code = 500; reason = "Error writing to file";
+      break;
+    };
+    if(archive.Failed()) break;
+    files.push_back(name);
+  };
+  delete[] buf;
+  if((code == 0) && archive.Failed()) {
+    errstr = "archive is broken or truncated";
+    code = 400; reason = "Broken archive";
+  };
+  if(!job.ReportFilesComplete(files)) {
+    if(code == 0) {
+      errstr = "failed to report uploaded files";
+      code = 500; reason = "Error reporting uploaded files";
+    };
+  };
+  if(code != 0) return HTTPFault(inmsg, outmsg, code, reason);
+  return HTTPResponse(inmsg,outmsg);
+}
+
 static void STATtoPROP(std::string const& name, struct stat& st,
                        std::list<std::string> requestProps, XMLNode& response) {
   XMLNode propstat = response.NewChild("d:propstat");
@@ -1484,6 +1697,96 @@ static void ProcessPROPFIND(Arc::FileAccess* fa, Arc::XMLNode& multistatus,URL c
   }
 }
 
+// Adds regular files and directories found at path to archive. Symbolic
+// links and special files are skipped.
+static void CollectArchiveEntries(Arc::FileAccess& fa, Arc::PayloadTarStream& archive,
+                                  std::string const& path, std::string const& name, int depth) {
+  struct stat st;
+  if(!fa.fa_lstat(path,st)) return;
+  Arc::PayloadTarStream::Entry entry;
+  entry.name = name;
+  entry.path = path;
+  entry.mode = st.st_mode;
+  entry.mtime = st.st_mtime;
+  if(S_ISREG(st.st_mode)) {
+    entry.size = st.st_size;
+    archive.Add(entry);
+  } else if(S_ISDIR(st.st_mode)) {
+    entry.dir = true;
+    if(!name.empty()) archive.Add(entry);
+    if(depth <= 0) return;
+    if(!fa.fa_opendir(path)) return;
+    std::list<std::string> names;
+    std::string subname;
+    while(fa.fa_readdir(subname)) {
+      if(subname == ".") continue;
+      if(subname == "..") continue;
+      names.push_back(subname);
+    }
+    fa.fa_closedir();
+    names.sort();
+    for(std::list<std::string>::iterator subname = names.begin(); subname != names.end(); ++subname) {
+      CollectArchiveEntries(fa, archive, path + "/" + *subname,
+                            name.empty() ? *subname : (name + "/" + *subname), depth-1);
+    }
+  }
+}
+
+// Sends tar archive of specified files or whole directory. Archive is
+// produced while being sent. If client accepts it archive is compressed.
+static Arc::MCC_Status HTTPResponseArchive(Arc::Message& inmsg, Arc::Message& outmsg, ARexJob& job,
+                                           std::string const& subpath, std::list<std::string> const& names) {
+  std::string path = job.GetFilePath(subpath);
+  if(path.empty()) return HTTPFault(inmsg,outmsg,404,"Wrong path");
+  Arc::FileAccess* fa = Arc::FileAccess::Acquire();
+  if((!*fa) || (!fa->fa_setuid(job.UID(),job.GID()))) {
+    Arc::FileAccess::Release(fa);
+    return HTTPFault(inmsg,outmsg,500,"Failed to access files");
+  }
+  struct stat st;
+  if((!fa->fa_lstat(path,st)) || !(S_ISDIR(st.st_mode) || (S_ISREG(st.st_mode) && names.empty()))) {
+    Arc::FileAccess::Release(fa);
+    return HTTPFault(inmsg,outmsg,404,"Not found");
+  }
+  bool compressed = AcceptsGzip(inmsg);
+  ARex::PayloadTarStream* archive = new ARex::PayloadTarStream(job.UID(),job.GID());
+  if(names.empty()) {
+    // Content of directory is stored with paths relative to it and single file under own name
+    std::string name;
+    if(S_ISREG(st.st_mode)) {
+      std::string::size_type pos = path.rfind('/');
+      name = (pos == std::string::npos) ? path : path.substr(pos+1);
+    }
+    CollectArchiveEntries(*fa, *archive, path, name, 100);
+  } else {
+    for(std::list<std::string>::const_iterator name = names.begin(); name != names.end(); ++name) {
+      CollectArchiveEntries(*fa, *archive, path + "/" + *name, *name, 100);
+    }
+  }
+  Arc::FileAccess::Release(fa);
+  if(!*archive) {
+    delete archive;
+    return HTTPFault(inmsg,outmsg,500,"Failed to create archive");
+  }
+  if(inmsg.Attributes()->get("HTTP:METHOD") == "HEAD") {
+    // Size of compressed archive is not known in advance
+    Arc::PayloadRaw* outpayload = new Arc::PayloadRaw();
+    if(outpayload && !compressed) outpayload->Truncate(archive->Size());
+    delete outmsg.Payload(outpayload);
+    delete archive;
+  } else if(compressed) {
+    delete outmsg.Payload(new Arc::PayloadGzipStream(*archive,true));
+  } else {
+    delete outmsg.Payload(archive);
+  }
+  outmsg.Attributes()->set("HTTP:CODE","200");
+  outmsg.Attributes()->set("HTTP:REASON","OK");
+  outmsg.Attributes()->set("HTTP:content-type","application/x-tar");
+  outmsg.Attributes()->set("HTTP:vary","Accept-Encoding");
+  if(compressed) outmsg.Attributes()->set("HTTP:content-encoding","gzip");
+  return Arc::MCC_Status(Arc::STATUS_OK);
+}
+
 Arc::MCC_Status ARexRest::processJobSessionDir(Arc::Message& inmsg,Arc::Message& outmsg,
                                             ProcessingContext& context,std::string const & id) {
   class FileAccessRef {
@@ -1529,8 +1832,11 @@ Arc::MCC_Status ARexRest::processJobSessionDir(Arc::Message& inmsg,Arc::Message&
 
   // GET,HEAD,PUT,DELETE - supported for files stored in job's session directory and perform usual actions.
   // GET,HEAD - for directories retrieves list of stored files (consider WebDAV for format).
+  // GET,HEAD with archive=tar - retrieves tar archive of file or directory. Repeated file=<path>
+  //           options select files and directories inside directory to be archived.
   // DELETE - for directories removes whole directory.
   // PUT - for directory not supported.
+  // PUT with archive=tar - unpacks tar archive into directory and marks stored files as uploaded.
   // POST - not supported.
   // PATCH - for files modifies part of files (body format need to be defined, all files treated as binary, currently support non-standard PUT with ranges).
   // PROPFIND - list diectories, stat files.
@@ -1549,6 +1855,19 @@ Arc::MCC_Status ARexRest::processJobSessionDir(Arc::Message& inmsg,Arc::Message&
     return HTTPFault(inmsg,outmsg,404,"Wrong path");
 
   if((context.method == "GET") || (context.method == "HEAD")) {
+    std::string archive = context["archive"];
+    if(!archive.empty()) {
+      if(archive != "tar") return HTTPFault(inmsg,outmsg,400,"Unsupported archive format");
+      std::list<std::string> names;
+      for(std::multimap<std::string,std::string>::iterator file = context.query.lower_bound("file");
+                              file != context.query.upper_bound("file"); ++file) {
+        std::string name = file->second;
+        if((!CanonicalDir(name, false, false)) || name.empty())
+          return HTTPFault(inmsg,outmsg,404,"Wrong path");
+        names.push_back(name);
+      }
+      return HTTPResponseArchive(inmsg,outmsg,job,context.subpath,names);
+    }
     // File or folder
     FileAccessRef dir(job.OpenDir(context.subpath));
     if(dir) {
@@ -1577,7 +1896,7 @@ Arc::MCC_Status ARexRest::processJobSessionDir(Arc::Message& inmsg,Arc::Message&
     FileAccessRef file(job.OpenFile(context.subpath,true,false));
     if(file) {
       // File or similar
-      Arc::MCC_Status r = HTTPResponseFile(inmsg,outmsg,file.get(),"application/octet-stream");
+      Arc::MCC_Status r = HTTPResponseFile(inmsg,outmsg,file.get(),job.GetFilePath(context.subpath),"application/octet-stream");
       return r;
     }
     return HTTPFault(inmsg,outmsg,404,"Not found");
@@ -1590,6 +1909,15 @@ Arc::MCC_Status ARexRest::processJobSessionDir(Arc::Message& inmsg,Arc::Message&
       logger_.msg(Arc::ERROR, "REST:PUT job %s: file %s: there is no payload", id, context.subpath);
       return HTTPFault(inmsg, outmsg, 500, "Missing payload");
     };
+    std::string archive = context["archive"];
+    if(!archive.empty()) {
+      if(archive != "tar") return HTTPFault(inmsg,outmsg,400,"Unsupported archive format");
+      if(!stream) return HTTPFault(inmsg, outmsg, 500, "Error processing payload");
+      std::string err;
+      Arc::MCC_Status r = PutJobArchive(inmsg,outmsg,job,context.subpath,*stream,err);
+      if(!err.empty()) logger_.msg(Arc::ERROR, "HTTP:PUT %s: put archive into %s: %s", job.ID(), context.subpath, err);
+      return r;
+    };
     // Prepare access to file 
     FileAccessRef file(job.CreateFile(context.subpath));
     if(!file) {
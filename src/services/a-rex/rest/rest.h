@@ -5,7 +5,9 @@
 #include <arc/loader/Plugin.h>
 #include <arc/Logger.h>
 #include <arc/ArcConfig.h>
+#include <glibmm/thread.h>
 #include "../grid-manager/conf/GMConfig.h"
+#include "ResponseWriter.h"
 
 namespace ARex {
 
@@ -15,6 +17,25 @@ namespace ARex {
     ARexRest(Arc::Config *cfg, Arc::PluginArgument *parg, GMConfig& config, ARex::DelegationStores& delegation_stores, unsigned int& all_jobs_count);
     virtual ~ARexRest(void);
     Arc::MCC_Status process(Arc::Message& inmsg,Arc::Message& outmsg);
+    /// To be called when new information document is available. Prepares
+    /// rendered representations in advance.
+    void InformationUpdated(void);
+
+    // Immutable content shared between cache and responses made of it.
+    // Reference counting is thread-safe, so response may be sent after
+    // cache switched to newer document.
+    class SharedContent {
+     public:
+      // Created object has one reference
+      SharedContent(void);
+      SharedContent* Acquire(void);
+      void Release(void);
+      std::string content;
+     private:
+      ~SharedContent(void);
+      Glib::Mutex lock_;
+      int refs_;
+    };
 
    private:
     class ProcessingContext {
@@ -26,6 +47,32 @@ namespace ARex {
       std::string operator[](char const * key) const;
     };
 
+    // Rendered representations of information document. Kept valid as
+    // long as file with information document is not changed.
+    class InfoCache {
+     public:
+      InfoCache(void);
+      ~InfoCache(void);
+      // Obtain rendered document in specified format. If compressed is true
+      // gzip compressed content is requested. It is reset to false if content
+      // is not compressed (e.g. because it is too small). Returned content
+      // must be released by caller.
+      bool Get(std::string const& filename, ResponseFormat format, bool& compressed,
+               SharedContent*& content, std::string& etag, time_t& modified);
+      void Refresh(std::string const& filename);
+     private:
+      Glib::Mutex lock_;
+      Glib::Cond rendered_cond_;
+      std::string version_;
+      std::string rendering_;  // version being rendered now, if any
+      time_t modified_;
+      SharedContent* rendered_[3];
+      SharedContent* compressed_[3];
+      bool compressed_valid_[3];
+      bool Update(std::string const& filename);
+      void Clear(void);
+    };
+
     Arc::Logger logger_;
     std::string uname_;
     std::string endpoint_;
@@ -34,6 +81,7 @@ namespace ARex {
     ARex::GMConfig& config_;
     ARex::DelegationStores& delegation_stores_;
     unsigned int& all_jobs_count_;
+    InfoCache info_cache_;
 
     Arc::MCC_Status processVersions(Arc::Message& inmsg,Arc::Message& outmsg,ProcessingContext& context);
 
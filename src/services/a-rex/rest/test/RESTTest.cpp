@@ -8,6 +8,12 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <arc/StringConv.h>
+#include <arc/XMLNode.h>
+#include <arc/message/PayloadRaw.h>
+
+#include "../ResponseWriter.h"
+
 // #include "../rest.cpp"
 
 class RESTTest
@@ -15,12 +21,14 @@ class RESTTest
 
   CPPUNIT_TEST_SUITE(RESTTest);
   CPPUNIT_TEST(TestJsonParse);
+  CPPUNIT_TEST(TestResponseWriter);
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void setUp();
   void tearDown();
   void TestJsonParse();
+  void TestResponseWriter();
 };
 
 
@@ -36,4 +44,56 @@ void RESTTest::TestJsonParse() {
   // TODO: Implement
 }
 
+static std::string WriteJobs(ARex::ResponseFormat format, bool count_only = false) {
+  Arc::PayloadRaw payload;
+  ARex::ResponseWriter* writer = ARex::ResponseWriter::Create(format, payload, count_only);
+  writer->Begin("jobs");
+  for(int n = 0; n < 3; ++n) {
+    writer->Begin("job");
+    writer->Value("id", "job<" + Arc::tostring(n) + ">");
+    writer->Value("state", "");
+    writer->Begin("info_document");
+    writer->Node(Arc::XMLNode("<ComputingActivity><State>a</State><State>b</State></ComputingActivity>"));
+    writer->End();
+    writer->End();
+  }
+  writer->Begin("delegation");
+  writer->Value("id", "d\"1");
+  writer->End();
+  writer->Finish();
+  delete writer;
+  if(count_only) return Arc::tostring(payload.Size());
+  std::string out;
+  for(unsigned int n = 0; payload.Buffer(n); ++n) out.append(payload.Buffer(n), payload.BufferSize(n));
+  return out;
+}
+
+void RESTTest::TestResponseWriter() {
+  Arc::XMLNode jobs("<jobs/>");
+  for(int n = 0; n < 3; ++n) {
+    Arc::XMLNode job = jobs.NewChild("job");
+    job.NewChild("id") = "job<" + Arc::tostring(n) + ">";
+    job.NewChild("state");
+    job.NewChild("info_document").NewChild(Arc::XMLNode("<ComputingActivity><State>a</State><State>b</State></ComputingActivity>"));
+  }
+  jobs.NewChild("delegation").NewChild("id") = "d\"1";
+
+  std::string expected;
+  ARex::RenderResponse(jobs, ARex::ResponseFormatJson, expected);
+  CPPUNIT_ASSERT_EQUAL(expected, WriteJobs(ARex::ResponseFormatJson));
+  CPPUNIT_ASSERT_EQUAL(Arc::tostring(expected.length()), WriteJobs(ARex::ResponseFormatJson, true));
+
+  expected.clear();
+  ARex::RenderResponse(jobs, ARex::ResponseFormatHtml, expected);
+  CPPUNIT_ASSERT_EQUAL(expected, WriteJobs(ARex::ResponseFormatHtml));
+
+  // XML differs in formatting only, so compare parsed documents
+  std::string xml_str = WriteJobs(ARex::ResponseFormatXml);
+  Arc::XMLNode xml(xml_str);
+  CPPUNIT_ASSERT((bool)xml);
+  expected.clear();
+  ARex::RenderResponse(xml, ARex::ResponseFormatJson, expected);
+  CPPUNIT_ASSERT_EQUAL(expected, WriteJobs(ARex::ResponseFormatJson));
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(RESTTest);
@@ -357,31 +357,31 @@ namespace DataStaging {
     Arc::XMLNode resp = out.NewChild("DataDeliveryQueryResponse");
     Arc::XMLNode results = resp.NewChild("DataDeliveryQueryResult");
 
-    for(int n = 0;;++n) {
-      Arc::XMLNode dtrnode = in["DataDeliveryQuery"]["DTR"][n];
+    // Clients ask for many DTRs in one request, so index active DTRs once
+    // instead of scanning whole list for every requested one.
+    active_dtrs_lock.lock();
+    std::map<std::string, std::map<DTR_ptr, sstream_ptr>::iterator> active_index;
+    for (std::map<DTR_ptr, sstream_ptr>::iterator dtr_it = active_dtrs.begin();
+         dtr_it != active_dtrs.end(); ++dtr_it) {
+      active_index[dtr_it->first->get_id()] = dtr_it;
+    }
 
-      if (!dtrnode) break;
+    for(Arc::XMLNode dtrnode = in["DataDeliveryQuery"]["DTR"]; dtrnode; ++dtrnode) {
 
       std::string dtrid((std::string)dtrnode["ID"]);
 
       Arc::XMLNode resultelement = results.NewChild("Result");
       resultelement.NewChild("ID") = dtrid;
 
-      active_dtrs_lock.lock();
-      std::map<DTR_ptr, sstream_ptr>::iterator dtr_it = active_dtrs.begin();
-      for (; dtr_it != active_dtrs.end(); ++dtr_it) {
-        if (dtr_it->first->get_id() == dtrid) break;
-      }
-
-      if (dtr_it == active_dtrs.end()) {
-        active_dtrs_lock.unlock();
+      std::map<std::string, std::map<DTR_ptr, sstream_ptr>::iterator>::iterator index_it = active_index.find(dtrid);
 
+      if (index_it == active_index.end()) {
         // if not in active list, look in archived list
         archived_dtrs_lock.lock();
         std::map<std::string, std::pair<std::string, std::string> >::const_iterator arc_it = archived_dtrs.find(dtrid);
         if (arc_it != archived_dtrs.end()) {
-          resultelement.NewChild("ResultCode") = archived_dtrs[dtrid].first;
-          resultelement.NewChild("ErrorDescription") = archived_dtrs[dtrid].second;
+          resultelement.NewChild("ResultCode") = arc_it->second.first;
+          resultelement.NewChild("ErrorDescription") = arc_it->second.second;
           archived_dtrs_lock.unlock();
           continue;
         }
@@ -393,8 +393,8 @@ namespace DataStaging {
         continue;
       }
 
+      std::map<DTR_ptr, sstream_ptr>::iterator dtr_it = index_it->second;
       DTR_ptr dtr = dtr_it->first;
-      resultelement.NewChild("Log") = dtr_it->second->str();
       resultelement.NewChild("BytesTransferred") = Arc::tostring(dtr->get_bytes_transferred());
 
       if (dtr->error()) {
@@ -422,14 +422,15 @@ namespace DataStaging {
         logger.msg(Arc::VERBOSE, "DTR %s still in progress (%lluB transferred)",
                    dtrid, dtr->get_bytes_transferred());
         resultelement.NewChild("ResultCode") = "TRANSFERRING";
-        active_dtrs_lock.unlock();
-        return Arc::MCC_Status(Arc::STATUS_OK);
+        continue;
       }
-      // Terminal state
+      // Terminal state. Log is only needed by client at the end of transfer.
+      resultelement.NewChild("Log") = dtr_it->second->str();
       //delete dtr_it->second;
       active_dtrs.erase(dtr_it);
-      active_dtrs_lock.unlock();
+      active_index.erase(index_it);
     }
+    active_dtrs_lock.unlock();
     return Arc::MCC_Status(Arc::STATUS_OK);
   }
 
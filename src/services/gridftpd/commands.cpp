@@ -23,6 +23,7 @@ static Arc::Logger logger(Arc::Logger::getRootLogger(),"GridFTP_Commands");
 
 extern unsigned long long int max_data_buffer_size;
 extern unsigned long long int default_data_buffer_size;
+extern unsigned int disk_data_buffer_num;
 
 #ifndef __DONT_USE_FORK__
 static int fork_done;
@@ -1104,7 +1105,11 @@ void GridFTP_Commands::commands_callback(void* arg,globus_ftp_control_handle_t *
   };
 }
 
+/* must be called with data_lock locked */
 void GridFTP_Commands::free_data_buffer(void) {
+  stop_data_io();
+  data_io_queue.clear();
+  data_net_queue.clear();
   if(data_buffer == NULL) return;
   for(unsigned int i = 0;i<data_buffer_num;i++) {
     free(data_buffer[i].data);
@@ -1115,20 +1120,16 @@ void GridFTP_Commands::free_data_buffer(void) {
 
 void GridFTP_Commands::compute_data_buffer(void) {
   globus_ftp_control_parallelism_t dp;
-  if(globus_ftp_control_get_parallelism(&handle,&dp) != GLOBUS_SUCCESS) {
-    data_buffer_num=3;
-    data_buffer_size=default_data_buffer_size;
-    return;
-  };
-  if(dp.mode != GLOBUS_FTP_CONTROL_PARALLELISM_FIXED) {
-    data_buffer_num=3;
-    data_buffer_size=default_data_buffer_size;
-    return;
+  data_net_num=3;
+  if((globus_ftp_control_get_parallelism(&handle,&dp) == GLOBUS_SUCCESS) &&
+     (dp.mode == GLOBUS_FTP_CONTROL_PARALLELISM_FIXED)) {
+    data_net_num=dp.fixed.size*2+1;
+    if(data_net_num > 41) data_net_num=41;
+    if(data_net_num < 3) data_net_num=3;
   };
-  data_buffer_num=dp.fixed.size*2+1;
+  /* additional buffers let disk I/O run ahead/behind of network */
+  data_buffer_num=data_net_num+disk_data_buffer_num;
   data_buffer_size=default_data_buffer_size;
-  if(data_buffer_num > 41) data_buffer_num=41;
-  if(data_buffer_num < 3) data_buffer_num=3;
   if((data_buffer_num * data_buffer_size) > max_data_buffer_size) {
     data_buffer_size=max_data_buffer_size/data_buffer_num;
   };
@@ -1143,6 +1144,8 @@ bool GridFTP_Commands::allocate_data_buffer(void) {
   unsigned int i;
   for(i = 0;i<data_buffer_num;i++) {
     data_buffer[i].used=0;
+    data_buffer[i].offset=0;
+    data_buffer[i].eof=false;
     data_buffer[i].data=(unsigned char*)malloc(data_buffer_size);
     if(data_buffer[i].data == NULL) {
       logger.msg(Arc::ERROR, "Failed to allocate memory for buffer");
@@ -1154,9 +1157,43 @@ bool GridFTP_Commands::allocate_data_buffer(void) {
   };
   logger.msg(Arc::VERBOSE, "Allocated %u buffers %llu bytes each.", i, data_buffer_size);
   data_buffer_num=i;
+  if(data_net_num > data_buffer_num) data_net_num=data_buffer_num;
+  return true;
+}
+
+/* start thread doing file access for current transfer,
+   must be called with data_lock locked */
+bool GridFTP_Commands::start_data_io(void* (*func)(void*)) {
+  data_io_stop=false;
+  data_io_busy=false;
+  data_io_eof=false;
+  if(globus_thread_create(&data_io_thread,NULL,func,(void*)this) != 0) {
+    logger.msg(Arc::ERROR, "Failed to start thread for file access");
+    return false;
+  };
+  data_io_running=true;
   return true;
 }
 
+/* tell disk I/O thread to exit and wait for it unless called
+   by that thread itself, must be called with data_lock locked */
+void GridFTP_Commands::stop_data_io(void) {
+  if(!data_io_running) return;
+  data_io_stop=true;
+  globus_cond_broadcast(&data_io_cond);
+  if(globus_thread_equal(globus_thread_self(),data_io_thread)) return;
+  while(data_io_running) globus_cond_wait(&data_io_cond,&data_lock);
+}
+
+void GridFTP_Commands::log_data_statistics(void) {
+  logger.msg(Arc::VERBOSE, "Time spent waiting for network: %.3f ms", (float)(time_spent_network/1000.0));
+  logger.msg(Arc::VERBOSE, "Time spent waiting for disc: %.3f ms", (float)(time_spent_disc/1000.0));
+  float disc_rate = 0;
+  if(time_spent_disc > 0) disc_rate = ((float)bytes_disc)/((float)time_spent_disc);
+  logger.msg(Arc::VERBOSE, "Transferred %llu bytes, disc throughput %.3f MB/s, network stalled %u times",
+             bytes_disc, disc_rate, network_stalls);
+}
+
 void GridFTP_Commands::abort_callback(void* arg,globus_ftp_control_handle_t*,globus_object_t *error) {
   GridFTP_Commands *it = (GridFTP_Commands*)arg;
   logger.msg(Arc::VERBOSE, "abort_callback: start");
@@ -1199,15 +1236,22 @@ void GridFTP_Commands::make_abort(bool already_locked,bool wait_abort) {
     logger.msg(Arc::INFO, "make_abort: wait for abort flag to be reset");
     globus_cond_wait(&abort_cond,&abort_lock);
   };
+  globus_mutex_unlock(&abort_lock);
   if(t) {
     /* transfer_mode=false; */
+    /* File is accessed by disk I/O thread without holding data_lock,
+       so that thread must be stopped before file is closed. The
+       abort_lock is released first because data transfer callbacks
+       acquire abort_lock while holding data_lock. */
+    globus_mutex_lock(&data_lock);
+    stop_data_io();
     /* close (if) opened files */
     froot.close(false);
     virt_offset=0;
     virt_restrict=false;
+    globus_mutex_unlock(&data_lock);
   };
   logger.msg(Arc::VERBOSE, "make_abort: leaving");
-  globus_mutex_unlock(&abort_lock);
 }
 
 /* check for globus error, print it and abort connection if necessary */
@@ -1273,8 +1317,14 @@ GridFTP_Commands::GridFTP_Commands(int n,unsigned int* f) {
   data_buffer=NULL;
   data_buffer_size=default_data_buffer_size;
   data_buffer_num=3;
+  data_net_num=3;
   data_buf_count=0;
   data_callbacks=0;
+  globus_cond_init(&data_io_cond,GLOBUS_NULL);
+  data_io_running=false;
+  data_io_stop=false;
+  data_io_busy=false;
+  data_io_eof=false;
   data_offset=0;
   globus_ftp_control_handle_init(&handle);
   data_dcau.mode=GLOBUS_FTP_CONTROL_DCAU_DEFAULT;
@@ -1285,6 +1335,8 @@ GridFTP_Commands::GridFTP_Commands(int n,unsigned int* f) {
   virt_restrict=false;
   time_spent_disc=0;
   time_spent_network=0;
+  bytes_disc=0;
+  network_stalls=0;
   transfer_mode=false;
   transfer_abort=false;
   data_eof=false;
@@ -1303,6 +1355,10 @@ GridFTP_Commands::GridFTP_Commands(int n,unsigned int* f) {
 
 GridFTP_Commands::~GridFTP_Commands(void) {
 /* here all connections should be closed and all callbacks unregistered */
+  globus_mutex_lock(&data_lock);
+  free_data_buffer();
+  globus_mutex_unlock(&data_lock);
+  globus_cond_destroy(&data_io_cond);
   globus_mutex_destroy(&response_lock);
   globus_cond_destroy(&response_cond);
   globus_mutex_destroy(&abort_lock);
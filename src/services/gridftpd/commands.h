@@ -56,13 +56,33 @@ class GridFTP_Commands {
     typedef struct {
       unsigned char* data;
       unsigned long long int used;
+      unsigned long long int offset;
+      bool eof;
       struct timeval time_last;
     } data_buffer_t;
     data_buffer_t* data_buffer; 
     /* size of every buffer - should it be equal to PBSZ ? */
     unsigned long long int data_buffer_size;
     unsigned int data_buffer_num;
+    /* maximal number of buffers registered in network at same time,
+       remaining ones are used by disk I/O thread */
+    unsigned int data_net_num;
     unsigned int data_callbacks;
+    /* buffers waiting for disk I/O thread - free ones for retrieve,
+       filled ones for store */
+    std::list<unsigned int> data_io_queue;
+    /* buffers waiting to be registered in network - filled ones for
+       retrieve, free ones for store */
+    std::list<unsigned int> data_net_queue;
+    /* disk I/O thread reads file ahead of network during retrieve and
+       writes behind network during store. It shares data_lock with
+       callbacks but releases it while accessing file. */
+    globus_cond_t data_io_cond;
+    globus_thread_t data_io_thread;
+    bool data_io_running;
+    bool data_io_stop;
+    bool data_io_busy;
+    bool data_io_eof;
     /* keeps offset in file for reading */
     unsigned long long data_offset;
     unsigned long long virt_offset;
@@ -72,10 +92,20 @@ class GridFTP_Commands {
     /* statistics */
     unsigned long long int time_spent_disc;
     unsigned long long int time_spent_network;
+    unsigned long long int bytes_disc;
+    unsigned int network_stalls;
 
     void compute_data_buffer(void);
     bool allocate_data_buffer(void);
     void free_data_buffer(void);
+    bool start_data_io(void* (*func)(void*));
+    void stop_data_io(void);
+    bool register_retrieve_buffers(void);
+    globus_result_t register_store_buffers(void);
+    bool finish_store(void);
+    void log_data_statistics(void);
+    static void* data_retrieve_io_thread(void* arg);
+    static void* data_store_io_thread(void* arg);
     int send_response(const std::string& response) { return send_response(response.c_str()); };
     int send_response(const char* response);
     int wait_response(void);
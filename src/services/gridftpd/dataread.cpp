@@ -17,8 +17,101 @@ static Arc::Logger logger(Arc::Logger::getRootLogger(),"GridFTP_Commands");
 
 /* 
   file retrieve callbacks 
+
+  File is read by separate disk I/O thread into free buffers taken from
+  data_io_queue. Filled buffers are put into data_net_queue and registered
+  for sending in order of offset as long as there are less than data_net_num
+  buffers in network. Sent buffers are returned to data_io_queue.
 */
 
+/* register filled buffers for sending, called with data_lock locked */
+bool GridFTP_Commands::register_retrieve_buffers(void) {
+  while((!data_eof) && (data_callbacks < data_net_num) && (!data_net_queue.empty())) {
+    unsigned int i = data_net_queue.front();
+    data_net_queue.pop_front();
+    struct timezone tz;
+    gettimeofday(&(data_buffer[i].time_last),&tz);
+    globus_result_t res;
+    res=globus_ftp_control_data_write(&handle,
+            (globus_byte_t*)(data_buffer[i].data),
+            data_buffer[i].used,data_buffer[i].offset,
+            data_buffer[i].eof?GLOBUS_TRUE:GLOBUS_FALSE,
+            &data_retrieve_callback,this);
+    if(res != GLOBUS_SUCCESS) {
+      logger.msg(Arc::ERROR, "Buffer registration failed");
+      logger.msg(Arc::ERROR, "Globus error: %s", Arc::GlobusResult(res).str());
+      force_abort();
+      return false;
+    };
+    data_callbacks++;
+    if(data_buffer[i].eof) data_eof=true;
+  };
+  return true;
+}
+
+void* GridFTP_Commands::data_retrieve_io_thread(void* arg) {
+  GridFTP_Commands *it = (GridFTP_Commands*)arg;
+  globus_mutex_lock(&(it->data_lock));
+  for(;;) {
+    if(it->data_io_stop) break;
+    if(it->data_io_eof || it->data_io_queue.empty()) {
+      globus_cond_wait(&(it->data_io_cond),&(it->data_lock));
+      continue;
+    };
+    unsigned int i = it->data_io_queue.front();
+    it->data_io_queue.pop_front();
+    /* read data from file */
+    unsigned long long offset = it->data_offset;
+    unsigned long long size = it->data_buffer_size;
+    if(it->virt_restrict) {
+      if((offset + size) > it->virt_size) size=it->virt_size-offset;
+    };
+    /* Only this thread accesses file, so data_lock is released to
+       let network callbacks proceed while waiting for disk */
+    it->data_io_busy=true;
+    globus_mutex_unlock(&(it->data_lock));
+    struct timezone tz;
+    struct timeval tv_last;
+    struct timeval tv;
+    gettimeofday(&tv_last,&tz);
+    int fres=it->froot.read(it->data_buffer[i].data,
+                (it->virt_offset)+offset,&size);
+    gettimeofday(&tv,&tz);
+    globus_mutex_lock(&(it->data_lock));
+    it->data_io_busy=false;
+    it->time_spent_disc+=(tv.tv_sec-tv_last.tv_sec)*1000000+(tv.tv_usec-tv_last.tv_usec);
+    if(it->data_io_stop) break;
+    if((fres != 0) || (!it->transfer_mode) || (it->transfer_abort)) {
+      if(fres != 0) {
+        logger.msg(Arc::ERROR, "Closing channel (retrieve) due to local read error: %s", it->froot.error);
+      } else {
+        logger.msg(Arc::VERBOSE, "Closing channel (retrieve) due to transfer abort");
+      };
+      it->force_abort();
+      /* force_abort releases data_lock, so transfer may be already cleaned */
+      if(it->data_io_stop) break;
+      if(it->data_callbacks==0){it->free_data_buffer();it->froot.close(false);};
+      break;
+    }; 
+    it->data_offset+=size;
+    it->bytes_disc+=size;
+    it->data_buffer[i].used=size;
+    it->data_buffer[i].offset=offset;
+    it->data_buffer[i].eof=(size == 0);
+    if(size == 0) it->data_io_eof=true;
+    it->data_net_queue.push_back(i);
+    if(!it->register_retrieve_buffers()) {
+      if(it->data_io_stop) break;
+      if(it->data_callbacks==0){it->free_data_buffer();it->froot.close(false);};
+      break;
+    };
+  };
+  it->data_io_running=false;
+  globus_cond_broadcast(&(it->data_io_cond));
+  globus_mutex_unlock(&(it->data_lock));
+  return NULL;
+}
+
 void GridFTP_Commands::data_connect_retrieve_callback(void* arg,globus_ftp_control_handle_t*,unsigned int /* stripendx */,globus_bool_t /* reused */,globus_object_t *error) {
   GridFTP_Commands *it = (GridFTP_Commands*)arg;
   logger.msg(Arc::VERBOSE, "data_connect_retrieve_callback");
@@ -26,6 +119,8 @@ void GridFTP_Commands::data_connect_retrieve_callback(void* arg,globus_ftp_contr
   globus_mutex_lock(&(it->data_lock));
   it->time_spent_disc=0;
   it->time_spent_network=0;
+  it->bytes_disc=0;
+  it->network_stalls=0;
   it->last_action_time=time(NULL);
   logger.msg(Arc::VERBOSE, "Data channel connected (retrieve)");
   if(it->check_abort(error)) {
@@ -41,45 +136,15 @@ void GridFTP_Commands::data_connect_retrieve_callback(void* arg,globus_ftp_contr
     it->froot.close(false);
     it->force_abort(); globus_mutex_unlock(&(it->data_lock)); return;
   };
-  /* fill and register all available buffers */
+  /* pass all buffers to disk I/O thread which fills and registers them */
   it->data_callbacks=0;
   it->data_offset=0;
   for(unsigned int i = 0;i<it->data_buffer_num;i++) {
-    logger.msg(Arc::VERBOSE, "data_connect_retrieve_callback: check for buffer %u", i);
-    if(!((it->data_buffer)[i].data)) continue;
-    /* read data from file */
-    unsigned long long size = it->data_buffer_size;
-    if(it->virt_restrict) {
-      if((it->data_offset + size) > it->virt_size)
-                             size=it->virt_size-it->data_offset;
-    };
-    struct timezone tz;
-    gettimeofday(&(it->data_buffer[i].time_last),&tz);
-    int fres=it->froot.read(it->data_buffer[i].data,
-                (it->virt_offset)+(it->data_offset),&size);
-    if(fres != 0) {
-      logger.msg(Arc::ERROR, "Closing channel (retrieve) due to local read error: %s", it->froot.error);
-      it->force_abort();
-      it->free_data_buffer();it->froot.close(false);
-      globus_mutex_unlock(&(it->data_lock)); return;
-    }; 
-    if(size == 0) it->data_eof=GLOBUS_TRUE;
-    /* register buffer */
-    globus_result_t res;
-    res=globus_ftp_control_data_write(&(it->handle),
-            (globus_byte_t*)(it->data_buffer[i].data),
-            size,it->data_offset,it->data_eof,
-            &data_retrieve_callback,it);
-    it->data_offset+=size;
-    if(res != GLOBUS_SUCCESS) {
-      logger.msg(Arc::ERROR, "Buffer registration failed");
-      logger.msg(Arc::ERROR, "Globus error: %s", Arc::GlobusResult(res).str());
-      it->force_abort();
-      if(it->data_callbacks==0){it->free_data_buffer();it->froot.close(false);};
-      globus_mutex_unlock(&(it->data_lock)); return;
-    };
-    it->data_callbacks++;
-    if(it->data_eof == GLOBUS_TRUE) break;
+    it->data_io_queue.push_back(i);
+  };
+  if(!(it->start_data_io(&data_retrieve_io_thread))) {
+    it->free_data_buffer();it->froot.close(false);
+    it->force_abort(); globus_mutex_unlock(&(it->data_lock)); return;
   };
   globus_mutex_unlock(&(it->data_lock)); return;
 }
@@ -107,8 +172,7 @@ void GridFTP_Commands::data_retrieve_callback(void* arg,globus_ftp_control_handl
       it->virt_restrict=false;
       it->transfer_mode=false;
       it->froot.close();
-      logger.msg(Arc::VERBOSE, "Time spent waiting for network: %.3f ms", (float)(it->time_spent_network/1000.0));
-      logger.msg(Arc::VERBOSE, "Time spent waiting for disc: %.3f ms", (float)(it->time_spent_disc/1000.0));
+      it->log_data_statistics();
       it->send_response("226 Requested file transfer completed\r\n");
     };
     globus_mutex_unlock(&(it->data_lock)); return;
@@ -128,54 +192,16 @@ void GridFTP_Commands::data_retrieve_callback(void* arg,globus_ftp_control_handl
      (tv.tv_sec-(it->data_buffer[i].time_last.tv_sec))*1000000+
      (tv.tv_usec-(it->data_buffer[i].time_last.tv_usec));
   it->time_spent_network+=time_diff;
-  /* read data from file */
-  unsigned long long size = it->data_buffer_size;
-  if(it->virt_restrict) {
-    if((it->data_offset + size) > it->virt_size) size=it->virt_size-it->data_offset;
+  /* give buffer back for refilling and send whatever is already read */
+  it->data_io_queue.push_back(i);
+  globus_cond_signal(&(it->data_io_cond));
+  if((it->data_callbacks==0) && it->data_net_queue.empty()) {
+    /* network has nothing to send till disk catches up */
+    it->network_stalls++;
   };
-#ifdef __USE_PARALLEL_FILE_ACCESS__
-  it->data_callbacks++;
-  /*
-     Unlock while reading file, so to allow others to read in parallel.
-     This can speed up read if on striped device/filesystem.
-  */
-  globus_mutex_unlock(&(it->data_lock));
-#endif
-  /* NOTE: it->data_lock is not unlocked here because it->froot.write
-     is not thread safe */
-  struct timeval tv_last;
-  gettimeofday(&tv_last,&tz);
-  int fres=it->froot.read(it->data_buffer[i].data,
-                (it->virt_offset)+(it->data_offset),&size);
-#ifdef __USE_PARALLEL_FILE_ACCESS__
-  globus_mutex_lock(&(it->data_lock));
-  it->data_callbacks--;
-#endif
-  gettimeofday(&tv,&tz);
-  time_diff=(tv.tv_sec-tv_last.tv_sec)*1000000+(tv.tv_usec-tv_last.tv_usec);
-  it->time_spent_disc+=time_diff;
-  if((fres != 0) || (!it->transfer_mode) || (it->transfer_abort)) {
-    logger.msg(Arc::ERROR, "Closing channel (retrieve) due to local read error: %s", it->froot.error);
-    it->force_abort();
+  if(!(it->register_retrieve_buffers())) {
     if(it->data_callbacks==0){it->free_data_buffer();it->froot.close(false);};
-    globus_mutex_unlock(&(it->data_lock)); return;
-  }; 
-  if(size == 0) it->data_eof=true;
-  /* register buffer */
-  globus_result_t res;
-  res=globus_ftp_control_data_write(&(it->handle),
-            (globus_byte_t*)(it->data_buffer[i].data),
-            size,it->data_offset,it->data_eof,
-            &data_retrieve_callback,it);
-  it->data_offset+=size;
-  if(res != GLOBUS_SUCCESS) {
-    logger.msg(Arc::ERROR, "Buffer registration failed");
-    logger.msg(Arc::ERROR, "Globus error: %s", Arc::GlobusResult(res).str());
-    it->force_abort();
-    if(it->data_callbacks==0){it->free_data_buffer();it->froot.close(false);};
-    globus_mutex_unlock(&(it->data_lock)); return;
   };
-  it->data_callbacks++;
   globus_mutex_unlock(&(it->data_lock)); return;
 }
 
@@ -17,8 +17,111 @@ static Arc::Logger logger(Arc::Logger::getRootLogger(),"GridFTP_Commands");
 
 /* 
   file store callbacks 
+
+  Free buffers are taken from data_net_queue and registered for receiving
+  as long as there are less than data_net_num buffers in network. Received
+  data is passed through data_io_queue to separate disk I/O thread which
+  writes it to file and returns buffer to data_net_queue.
 */
 
+/* register free buffers for receiving, called with data_lock locked */
+globus_result_t GridFTP_Commands::register_store_buffers(void) {
+  while((!data_eof) && (data_callbacks < data_net_num) && (!data_net_queue.empty())) {
+    unsigned int i = data_net_queue.front();
+    struct timezone tz;
+    gettimeofday(&(data_buffer[i].time_last),&tz);
+    globus_result_t res;
+    res=globus_ftp_control_data_read(&handle,
+            (globus_byte_t*)(data_buffer[i].data),
+            data_buffer_size,
+            &data_store_callback,this);
+    if(res != GLOBUS_SUCCESS) return res;
+    data_net_queue.pop_front();
+    data_callbacks++;
+  };
+  return GLOBUS_SUCCESS;
+}
+
+/* complete transfer if all data is received and written,
+   called with data_lock locked */
+bool GridFTP_Commands::finish_store(void) {
+  if(data_buffer == NULL) return false;
+  if((!data_eof) || (data_callbacks != 0)) return false;
+  if((!data_io_queue.empty()) || data_io_busy) return false;
+  logger.msg(Arc::VERBOSE, "Closing channel (store)");
+  free_data_buffer();
+  virt_offset=0;
+  virt_restrict=false;
+  transfer_mode=false;
+  if(froot.close() != 0) {
+    if(froot.error.length()) {
+      send_response("451 "+froot.error+"\r\n");
+    } else {
+      send_response("451 Local error\r\n");
+    };
+  }
+  else {
+    log_data_statistics();
+    send_response("226 Requested file transfer completed\r\n");
+  };
+  return true;
+}
+
+void* GridFTP_Commands::data_store_io_thread(void* arg) {
+  GridFTP_Commands *it = (GridFTP_Commands*)arg;
+  globus_mutex_lock(&(it->data_lock));
+  for(;;) {
+    if(it->data_io_stop) break;
+    if(it->data_io_queue.empty()) {
+      globus_cond_wait(&(it->data_io_cond),&(it->data_lock));
+      continue;
+    };
+    unsigned int i = it->data_io_queue.front();
+    it->data_io_queue.pop_front();
+    /* write data to file 
+       Only this thread accesses file, so data_lock is released to
+       let network callbacks proceed while waiting for disk */
+    it->data_io_busy=true;
+    globus_mutex_unlock(&(it->data_lock));
+    struct timezone tz;
+    struct timeval tv_last;
+    struct timeval tv;
+    gettimeofday(&tv_last,&tz);
+    int fres=it->froot.write(it->data_buffer[i].data,
+                (it->virt_offset)+(it->data_buffer[i].offset),
+                it->data_buffer[i].used);
+    gettimeofday(&tv,&tz);
+    globus_mutex_lock(&(it->data_lock));
+    it->data_io_busy=false;
+    it->time_spent_disc+=(tv.tv_sec-tv_last.tv_sec)*1000000+(tv.tv_usec-tv_last.tv_usec);
+    if(it->data_io_stop) break;
+    if(fres != 0) {
+      logger.msg(Arc::ERROR, "Closing channel (store) due to error: %s", it->froot.error);
+      it->force_abort();
+      /* force_abort releases data_lock, so transfer may be already cleaned */
+      if(it->data_io_stop) break;
+      if(it->data_callbacks==0){it->free_data_buffer();it->froot.close(false);};
+      break;
+    }; 
+    it->bytes_disc+=it->data_buffer[i].used;
+    /* buffer is free again */
+    it->data_net_queue.push_back(i);
+    globus_result_t res = it->register_store_buffers();
+    if((res != GLOBUS_SUCCESS) && (it->data_callbacks==0)) {
+      logger.msg(Arc::ERROR, "Globus error: %s", Arc::GlobusResult(res).str());
+      it->force_abort();
+      if(it->data_io_stop) break;
+      it->free_data_buffer();it->froot.close(false);
+      break;
+    };
+    if(it->finish_store()) break;
+  };
+  it->data_io_running=false;
+  globus_cond_broadcast(&(it->data_io_cond));
+  globus_mutex_unlock(&(it->data_lock));
+  return NULL;
+}
+
 void GridFTP_Commands::data_connect_store_callback(void* arg,globus_ftp_control_handle_t*,unsigned int /* stripendx */,globus_bool_t /* reused */,globus_object_t *error) {
   GridFTP_Commands *it = (GridFTP_Commands*)arg;
   logger.msg(Arc::VERBOSE, "data_connect_store_callback");
@@ -26,6 +129,8 @@ void GridFTP_Commands::data_connect_store_callback(void* arg,globus_ftp_control_
   globus_mutex_lock(&(it->data_lock));
   it->time_spent_disc=0;
   it->time_spent_network=0;
+  it->bytes_disc=0;
+  it->network_stalls=0;
   it->last_action_time=time(NULL);
   logger.msg(Arc::VERBOSE, "Data channel connected (store)");
   if(it->check_abort(error)) {
@@ -39,20 +144,16 @@ void GridFTP_Commands::data_connect_store_callback(void* arg,globus_ftp_control_
     it->froot.close(false);
     it->force_abort(); globus_mutex_unlock(&(it->data_lock)); return;
   };
-  /* register all available buffers */
   it->data_callbacks=0;
-  globus_result_t res = GLOBUS_SUCCESS;
+  if(!(it->start_data_io(&data_store_io_thread))) {
+    it->free_data_buffer();it->froot.close(false);
+    it->force_abort(); globus_mutex_unlock(&(it->data_lock)); return;
+  };
+  /* register as many buffers as network may use, rest stay in queue */
   for(unsigned int i = 0;i<it->data_buffer_num;i++) {
-    if(!((it->data_buffer)[i].data)) continue;
-    struct timezone tz;
-    gettimeofday(&(it->data_buffer[i].time_last),&tz);
-    res=globus_ftp_control_data_read(&(it->handle),
-            (globus_byte_t*)(it->data_buffer[i].data),
-            it->data_buffer_size,
-            &data_store_callback,it);
-    if(res==GLOBUS_SUCCESS) { it->data_callbacks++; }
-    else { break; };
+    it->data_net_queue.push_back(i);
   };
+  globus_result_t res = it->register_store_buffers();
   if(it->data_callbacks==0) {
     logger.msg(Arc::ERROR, "Failed to register any buffer");
     if(res != GLOBUS_SUCCESS) {
@@ -95,50 +196,21 @@ void GridFTP_Commands::data_store_callback(void* arg,globus_ftp_control_handle_t
      (tv.tv_sec-(it->data_buffer[i].time_last.tv_sec))*1000000+
      (tv.tv_usec-(it->data_buffer[i].time_last.tv_usec));
   it->time_spent_network+=time_diff;
-  /* write data to file 
-     NOTE: it->data_lock is not unlocked here because it->froot.write 
-     is not thread safe */
-  struct timeval tv_last;
-  gettimeofday(&tv_last,&tz);
-  if(it->froot.write(it->data_buffer[i].data,
-                (it->virt_offset)+offset,length) != 0) {
-    logger.msg(Arc::ERROR, "Closing channel (store) due to error: %s", it->froot.error);
-    it->force_abort();
-    if(it->data_callbacks==0){it->free_data_buffer();it->froot.close(false);};
-    globus_mutex_unlock(&(it->data_lock)); return;
-  }; 
-  gettimeofday(&tv,&tz);
-  time_diff=(tv.tv_sec-tv_last.tv_sec)*1000000+(tv.tv_usec-tv_last.tv_usec);
-  it->time_spent_disc+=time_diff;
+  /* pass data to disk I/O thread, transfer is completed by that
+     thread once all data is written */
+  it->data_buffer[i].used=length;
+  it->data_buffer[i].offset=offset;
+  it->data_io_queue.push_back(i);
+  globus_cond_signal(&(it->data_io_cond));
   if(it->data_eof) {
-    if(it->data_callbacks==0) {
-      logger.msg(Arc::VERBOSE, "Closing channel (store)");
-      it->free_data_buffer();
-      it->virt_offset=0;
-      it->virt_restrict=false;
-      it->transfer_mode=false;
-      if(it->froot.close() != 0) {
-        if(it->froot.error.length()) {
-          it->send_response("451 "+it->froot.error+"\r\n");
-        } else {
-          it->send_response("451 Local error\r\n");
-        };
-      }
-      else {
-        logger.msg(Arc::VERBOSE, "Time spent waiting for network: %.3f ms", (float)(it->time_spent_network/1000.0));
-        logger.msg(Arc::VERBOSE, "Time spent waiting for disc: %.3f ms", (float)(it->time_spent_disc/1000.0));
-        it->send_response("226 Requested file transfer completed\r\n");
-      };
-    };
     globus_mutex_unlock(&(it->data_lock)); return;
   };
-  /* register buffer */
-  globus_result_t res;
-  gettimeofday(&(it->data_buffer[i].time_last),&tz);
-  res=globus_ftp_control_data_read(&(it->handle),
-            (globus_byte_t*)(it->data_buffer[i].data),
-            it->data_buffer_size,
-            &data_store_callback,it);
+  if((it->data_callbacks==0) && it->data_net_queue.empty()) {
+    /* network can't receive more till disk catches up */
+    it->network_stalls++;
+  };
+  /* register free buffers */
+  globus_result_t res = it->register_store_buffers();
   if(res != GLOBUS_SUCCESS) {
     /* Because this error can be caused by EOF, abort should not be
        called unless this is last buffer */
@@ -149,7 +221,5 @@ void GridFTP_Commands::data_store_callback(void* arg,globus_ftp_control_handle_t
     };
     globus_mutex_unlock(&(it->data_lock)); return;
   };
-  it->data_callbacks++;
   globus_mutex_unlock(&(it->data_lock)); return;
 }
-
@@ -187,7 +187,8 @@ class FileRoot {
     unsigned int max_connections;
     unsigned int default_buffer;
     unsigned int max_buffer;
-    ServerParams(void):port(0),max_connections(0),default_buffer(0),max_buffer(0) {
+    int disk_buffers;
+    ServerParams(void):port(0),max_connections(0),default_buffer(0),max_buffer(0),disk_buffers(-1) {
       firewall[0]=0;
       firewall[1]=0;
       firewall[2]=0;
@@ -84,6 +84,16 @@ int FileRoot::config(gridftpd::Daemon &daemon,ServerParams* params) {
             return 1;
           };
         };
+      } else if(command == "diskbuffers") {
+        if(params) {
+          if((sscanf(rest.c_str(),"%d",&(params->disk_buffers)) != 1) ||
+             (params->disk_buffers < 0)) {
+            logger.msg(Arc::ERROR, "Wrong diskbuffers number in configuration");
+            cfile.close();
+            delete cf;
+            return 1;
+          };
+        };
       } else if(command == "firewall") {
         if(params) {
           std::string value=rest;
@@ -24,6 +24,7 @@
 
 #define DEFAULT_MAX_BUFFER_SIZE (10*65536)
 #define DEFAULT_BUFFER_SIZE (65536)
+#define DEFAULT_DISK_BUFFERS (4)
 #define DEFAULT_MAX_CONECTIONS (100)
 #define DEFAULT_GRIDFTP_PORT 2811
 #define DEFAULT_LOG_FILE "/var/log/arc/gridftpd.log"
@@ -35,6 +36,7 @@ static volatile int started_connections = 0;
 static volatile int finished_connections = 0;
 unsigned long long int max_data_buffer_size = 0;
 unsigned long long int default_data_buffer_size = 0;
+unsigned int disk_data_buffer_num = DEFAULT_DISK_BUFFERS;
 unsigned int firewall_interface[4] = { 0, 0, 0, 0 };
 
 static Arc::Logger logger(Arc::Logger::getRootLogger(), "gridftpd");
@@ -308,6 +310,7 @@ int main(int argc,char** argv) {
   if(max_data_buffer_size == 0) max_data_buffer_size=DEFAULT_MAX_BUFFER_SIZE;
   if(default_data_buffer_size == 0) default_data_buffer_size=params.default_buffer;
   if(default_data_buffer_size == 0) default_data_buffer_size=DEFAULT_BUFFER_SIZE;
+  if(params.disk_buffers >= 0) disk_data_buffer_num=params.disk_buffers;
   firewall_interface[0]=params.firewall[0];
   firewall_interface[1]=params.firewall[1];
   firewall_interface[2]=params.firewall[2];
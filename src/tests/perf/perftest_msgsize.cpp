@@ -18,6 +18,7 @@
 #include <arc/ArcConfig.h>
 #include <arc/Logger.h>
 #include <arc/URL.h>
+#include <arc/message/PayloadRaw.h>
 #include <arc/message/PayloadSOAP.h>
 #include <arc/message/MCC.h>
 #include <arc/communication/ClientInterface.h>
@@ -37,6 +38,7 @@ bool alwaysReconnect = false;
 bool printTimings = false;
 bool tcpNoDelay = false;
 bool fixedMsgSize = false;
+bool localOnly = false;
 int start;
 int stop;
 int steplength;
@@ -47,6 +49,51 @@ int Round(double x){
   return int(x+0.5);
 }
 
+// Render and parse messages without sending them - measures
+// cost of SOAP processing in MCC alone.
+void processMessages(){
+  unsigned long completedRequests = 0;
+  unsigned long failedRequests = 0;
+  Glib::TimeVal completedTime(0,0);
+  Glib::TimeVal failedTime(0,0);
+  Glib::TimeVal tBefore;
+  Glib::TimeVal tAfter;
+
+  Arc::NS echo_ns; echo_ns["echo"]="http://www.nordugrid.org/schemas/echo";
+
+  while(run){
+    for(int i=start; i<stop; i+=steplength){
+      int size = fixedMsgSize ? msgSize : i;
+      Arc::PayloadSOAP req(echo_ns);
+      req.NewChild("echo:echo").NewChild("echo:say")=std::string(size,'x');
+      tBefore.assign_current_time();
+      Arc::PayloadRaw raw;
+      bool ok = Arc::SOAPToPayload(req,raw);
+      if(ok) {
+        Arc::PayloadSOAP resp(raw);
+        ok = (std::string(resp["echo"]["say"]).size() == (std::string::size_type)size);
+      }
+      tAfter.assign_current_time();
+      if(!ok) {
+        failedRequests++;
+        failedTime+=tAfter-tBefore;
+      } else {
+        completedRequests++;
+        completedTime+=tAfter-tBefore;
+        if (printTimings) std::cout << completedRequests << " " << size << " " << tAfter.as_double()-tBefore.as_double() << std::endl;
+      }
+    }
+  }
+
+  Glib::Mutex::Lock lock(*mutex);
+  ::completedRequests+=completedRequests;
+  ::failedRequests+=failedRequests;
+  ::completedTime+=completedTime;
+  ::failedTime+=failedTime;
+  finishedThreads++;
+  std::cout << "Number of finished threads: " << finishedThreads << std::endl;
+}
+
 // Send requests and collect statistics.
 void sendRequests(){
   // Some variables...
@@ -172,6 +219,8 @@ int main(int argc, char* argv[]){
       printTimings=true; argv+=1; argc-=1;
     } else if(strcmp(argv[1],"-t") == 0) {
       tcpNoDelay=true; argv+=1; argc-=1;
+    } else if(strcmp(argv[1],"-l") == 0) {
+      localOnly=true; argv+=1; argc-=1;
     } else {
       break;
     };
@@ -185,7 +234,7 @@ int main(int argc, char* argv[]){
     std::cerr << "Wrong number of arguments!" << std::endl
               << std::endl
               << "Usage:" << std::endl
-              << "perftest [-c config] [-d debug] [-r] [-t] [-v] url threads duration start stop steplength" << std::endl
+              << "perftest [-c config] [-d debug] [-r] [-t] [-l] [-f size] [-v] url threads duration start stop steplength" << std::endl
               << std::endl
               << "Arguments:" << std::endl
               << "url        The url of the service." << std::endl
@@ -203,6 +252,8 @@ int main(int argc, char* argv[]){
               << "            every request." << std::endl
               << "-t         Toggles TCP_NODELAY option " << std::endl
               << "-f size    Fixed message size " << std::endl
+              << "-l         Do not send messages, only render and parse them " << std::endl
+              << "            locally. Sizes are then those of sent messages. " << std::endl
               << "-v         If specified print out timings for each iteration " << std::endl;
     exit(EXIT_FAILURE);
   }
@@ -220,7 +271,7 @@ int main(int argc, char* argv[]){
   mutex=new Glib::Mutex;
   threads = new Glib::Thread*[numberOfThreads];
   for (i=0; i<numberOfThreads; i++)
-    threads[i]=Glib::Thread::create(sigc::ptr_fun(sendRequests),true);
+    threads[i]=Glib::Thread::create(sigc::ptr_fun(localOnly?processMessages:sendRequests),true);
 
   // Sleep while the threads are working.
   Glib::usleep(duration*1000000);
@@ -36,6 +36,8 @@
 %ignore Arc::XMLNodeContainer::operator=(const XMLNodeContainer&);
 %ignore operator<<(std::ostream&, const XMLNode&);
 %ignore operator>>(std::istream&, XMLNode&);
+%ignore Arc::XMLNode::GetXML(std::ostream&, bool) const;
+%ignore Arc::XMLNode::ReadFromStreamBuf(std::streambuf&);
 #ifdef SWIGPYTHON
 %include <typemaps.i>
 %apply std::string& OUTPUT { std::string& out_xml_str };
@@ -105,6 +105,8 @@
 #include <arc/message/SOAPEnvelope.h>
 %}
 %ignore Arc::SOAPEnvelope::operator=(const SOAPEnvelope&);
+%ignore Arc::SOAPEnvelope::SOAPEnvelope(std::streambuf&);
+%ignore Arc::SOAPEnvelope::GetXML(std::ostream&, bool) const;
 /* The 'operator XMLNode' method cannot be wrapped. If it is needed in
  * the bindings, it should be renamed.
  */